@@ -0,0 +1,50 @@
+#include "Arithmetic.hpp"
+#include "Operand.hpp"
+
+namespace avm {
+
+	bool IsArithmetic(ast::Instruction::Type p_type)
+	{
+		switch (p_type)
+		{
+			case ast::Instruction::Type::ADD:
+			case ast::Instruction::Type::SUB:
+			case ast::Instruction::Type::MUL:
+			case ast::Instruction::Type::DIV:
+			case ast::Instruction::Type::MOD:
+				return true;
+			default:
+				return false;
+		}
+	}
+
+	IOperand const *Apply(ast::Instruction::Type p_type, IOperand const &p_lhs, IOperand const &p_rhs)
+	{
+		switch (p_type)
+		{
+			case ast::Instruction::Type::ADD: return p_lhs + p_rhs;
+			case ast::Instruction::Type::SUB: return p_lhs - p_rhs;
+			case ast::Instruction::Type::MUL: return p_lhs * p_rhs;
+			case ast::Instruction::Type::DIV: return p_lhs / p_rhs;
+			case ast::Instruction::Type::MOD: return p_lhs % p_rhs;
+			default:
+				throw std::runtime_error("Unreachable!");
+		}
+	}
+
+	IOperand const *ApplyUnchecked(ast::Instruction::Type p_type, IOperand const &p_lhs, IOperand const &p_rhs)
+	{
+		OperandBase const &l_lhs = dynamic_cast<OperandBase const &>(p_lhs);
+
+		switch (p_type)
+		{
+			case ast::Instruction::Type::ADD: return l_lhs.UncheckedAdd(p_rhs);
+			case ast::Instruction::Type::SUB: return l_lhs.UncheckedSub(p_rhs);
+			case ast::Instruction::Type::MUL: return l_lhs.UncheckedMul(p_rhs);
+			case ast::Instruction::Type::DIV: return l_lhs.UncheckedDiv(p_rhs);
+			case ast::Instruction::Type::MOD: return l_lhs.UncheckedMod(p_rhs);
+			default:
+				throw std::runtime_error("Unreachable!");
+		}
+	}
+}
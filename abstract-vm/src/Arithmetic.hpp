@@ -0,0 +1,14 @@
+#pragma once
+#include "IOperand.hpp"
+#include "ast/Instruction.hpp"
+
+namespace avm {
+
+	bool IsArithmetic(ast::Instruction::Type p_type);
+
+	// Runs the checked operator matching an arithmetic instruction
+	IOperand const *Apply(ast::Instruction::Type p_type, IOperand const &p_lhs, IOperand const &p_rhs);
+
+	// Same without the overflow checks, for sites proven safe
+	IOperand const *ApplyUnchecked(ast::Instruction::Type p_type, IOperand const &p_lhs, IOperand const &p_rhs);
+}
@@ -0,0 +1,253 @@
+#include "Format.hpp"
+#include <cmath>
+#include <cstring>
+#include <fmt/format.h>
+
+namespace avm {
+
+	namespace {
+
+		// "00" to "99"
+		struct DigitPairs
+		{
+			char m_digits[200];
+
+			constexpr DigitPairs() : m_digits()
+			{
+				for (int l_i = 0; l_i < 100; l_i++)
+				{
+					m_digits[l_i * 2] = static_cast<char>('0' + l_i / 10);
+					m_digits[l_i * 2 + 1] = static_cast<char>('0' + l_i % 10);
+				}
+			}
+		};
+
+		constexpr DigitPairs s_pairs;
+
+		char *WritePair(uint64_t p_value, char *p_out)
+		{
+			std::memcpy(p_out, &s_pairs.m_digits[p_value * 2], 2);
+			return p_out + 2;
+		}
+
+		char *WriteUnsigned(uint64_t p_value, char *p_out)
+		{
+			size_t l_digits = 1;
+
+			for (uint64_t l_power = 10; l_digits < 20 && p_value >= l_power; l_power *= 10)
+			{
+				l_digits++;
+			}
+
+			char *const l_end = p_out + l_digits;
+			char *l_cursor = l_end;
+
+			while (p_value >= 100)
+			{
+				l_cursor -= 2;
+				WritePair(p_value % 100, l_cursor);
+				p_value /= 100;
+			}
+			if (p_value >= 10)
+			{
+				WritePair(p_value, l_cursor - 2);
+			}
+			else
+			{
+				*--l_cursor = static_cast<char>('0' + p_value);
+			}
+			return l_end;
+		}
+
+		// Rounds p_numerator / p_denominator to the nearest integer, ties to even
+		template <typename Integer>
+		Integer RoundedQuotient(Integer p_numerator, Integer p_denominator)
+		{
+			Integer l_quotient = p_numerator / p_denominator;
+			Integer const l_remainder = (p_numerator - l_quotient * p_denominator) * 2;
+
+			if (l_remainder > p_denominator || (l_remainder == p_denominator && (l_quotient & 1) != 0))
+			{
+				l_quotient++;
+			}
+			return l_quotient;
+		}
+	}
+
+	char *FormatInteger(int64_t p_value, char *p_out)
+	{
+		uint64_t l_magnitude = static_cast<uint64_t>(p_value);
+
+		if (p_value < 0)
+		{
+			*p_out++ = '-';
+			l_magnitude = 0 - l_magnitude;
+		}
+		return WriteUnsigned(l_magnitude, p_out);
+	}
+
+	// Fixed with two decimals: m * 2^e times 100, rounded
+	char *FormatFloat(float p_value, char *p_out)
+	{
+		uint32_t l_bits;
+
+		std::memcpy(&l_bits, &p_value, sizeof(l_bits));
+
+		uint32_t const l_biased = (l_bits >> 23) & 0xff;
+		uint64_t const l_mantissa = l_biased ? (l_bits & 0x7fffff) | (1u << 23) : (l_bits & 0x7fffff);
+		int const l_exponent = static_cast<int>(l_biased ? l_biased : 1) - 150;
+
+		// Integers up to 2^63, and everything that is not finite
+		if (l_biased == 0xff || l_exponent > 39)
+		{
+			return fmt::format_to(p_out, "{:.2f}", p_value);
+		}
+
+		uint64_t l_integer = 0;
+		uint64_t l_hundredths = 0;
+
+		if (l_exponent >= 0)
+		{
+			l_integer = l_mantissa << l_exponent;
+		}
+		else if (l_exponent > -32)
+		{
+			// Below 2^31, the product is exact
+			uint64_t const l_rounded = RoundedQuotient<uint64_t>(l_mantissa * 100, uint64_t(1) << -l_exponent);
+
+			l_integer = l_rounded / 100;
+			l_hundredths = l_rounded % 100;
+		}
+
+		if (l_bits >> 31)
+		{
+			*p_out++ = '-';
+		}
+		p_out = WriteUnsigned(l_integer, p_out);
+		*p_out++ = '.';
+		return WritePair(l_hundredths, p_out);
+	}
+
+	/*
+	 * General with two significant digits: the value is scaled by the power
+	 * of ten that leaves two digits before the point, then rounded. Like
+	 * fmt, trailing zeros are dropped but one digit always follows the
+	 * point, and the exponent form is used outside of 1e-4 to 1e2.
+	 */
+	char *FormatDouble(double p_value, char *p_out)
+	{
+		double const l_magnitude = std::fabs(p_value);
+
+		if (l_magnitude == 0.0)
+		{
+			if (std::signbit(p_value))
+			{
+				*p_out++ = '-';
+			}
+			std::memcpy(p_out, "0.0", 3);
+			return p_out + 3;
+		}
+
+#if defined(__SIZEOF_INT128__)
+		using Wide = unsigned __int128;
+
+		// m * 2^-s, with s from 3 to 66 in this range
+		if (!(l_magnitude >= 1e-4 && l_magnitude < 1e15))
+		{
+			return fmt::format_to(p_out, "{:.2}", p_value);
+		}
+
+		uint64_t l_bits;
+
+		std::memcpy(&l_bits, &p_value, sizeof(l_bits));
+
+		Wide const l_mantissa = (l_bits & ((uint64_t(1) << 52) - 1)) | (uint64_t(1) << 52);
+		int const l_shift = 1075 - static_cast<int>((l_bits >> 52) & 0x7ff);
+		int l_decimal = static_cast<int>(std::floor(std::log10(l_magnitude)));
+		Wide l_numerator = 0;
+		Wide l_denominator = 0;
+		Wide l_digits = 0;
+
+		// The logarithm may be one off: the quotient tells
+		for (;;)
+		{
+			int const l_scale = 1 - l_decimal;
+			Wide l_power = 1;
+
+			for (int l_i = 0; l_i < std::abs(l_scale); l_i++)
+			{
+				l_power *= 10;
+			}
+			l_numerator = l_scale >= 0 ? l_mantissa * l_power : l_mantissa;
+			l_denominator = l_scale >= 0 ? Wide(1) << l_shift : (Wide(1) << l_shift) * l_power;
+			l_digits = l_numerator / l_denominator;
+			if (l_digits < 10)
+			{
+				l_decimal--;
+			}
+			else if (l_digits >= 100)
+			{
+				l_decimal++;
+			}
+			else
+			{
+				break;
+			}
+		}
+
+		l_digits = RoundedQuotient(l_numerator, l_denominator);
+		if (l_digits == 100)
+		{
+			l_digits = 10;
+			l_decimal++;
+		}
+
+		char const l_first = static_cast<char>('0' + static_cast<unsigned>(l_digits / 10));
+		char const l_second = static_cast<char>('0' + static_cast<unsigned>(l_digits % 10));
+
+		if (p_value < 0)
+		{
+			*p_out++ = '-';
+		}
+		if (l_decimal < -4 || l_decimal >= 2)
+		{
+			*p_out++ = l_first;
+			*p_out++ = '.';
+			*p_out++ = l_second;
+			*p_out++ = 'e';
+			*p_out++ = l_decimal < 0 ? '-' : '+';
+			// Two digits from 1e-5 to 1e15
+			return WritePair(static_cast<uint64_t>(std::abs(l_decimal)), p_out);
+		}
+		if (l_decimal == 1)
+		{
+			*p_out++ = l_first;
+			*p_out++ = l_second;
+			std::memcpy(p_out, ".0", 2);
+			return p_out + 2;
+		}
+		if (l_decimal == 0)
+		{
+			*p_out++ = l_first;
+			*p_out++ = '.';
+			*p_out++ = l_second;
+			return p_out;
+		}
+
+		*p_out++ = '0';
+		*p_out++ = '.';
+		for (int l_i = -1; l_i > l_decimal; l_i--)
+		{
+			*p_out++ = '0';
+		}
+		*p_out++ = l_first;
+		if (l_second != '0')
+		{
+			*p_out++ = l_second;
+		}
+		return p_out;
+#else
+		return fmt::format_to(p_out, "{:.2}", p_value);
+#endif
+	}
+}
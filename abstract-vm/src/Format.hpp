@@ -0,0 +1,22 @@
+#pragma once
+#include <cstdint>
+#include "abstractvm.hpp"
+
+namespace avm {
+
+	/*
+	 * Number formatting kernels, with the output of the formats the
+	 * operands used byte for byte: "{}" for integers, "{:.2f}" for float
+	 * and "{:.2}" for double. Each writes at p_out, at most s_formatSize
+	 * bytes, and returns the end of what it wrote.
+	 *
+	 * Integers are converted two digits at a time from a table. Floating
+	 * point values are rounded exactly, ties to even, in integer
+	 * arithmetic; values too large or too small for it go through fmt.
+	 */
+	constexpr size_t s_formatSize = 64;
+
+	char *FormatInteger(int64_t p_value, char *p_out);
+	char *FormatFloat(float p_value, char *p_out);
+	char *FormatDouble(double p_value, char *p_out);
+}
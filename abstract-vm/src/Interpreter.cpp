@@ -1,9 +1,80 @@
 #include "Interpreter.hpp"
+#include "ast/Code.hpp"
+#include "MappedFile.hpp"
+#include "Arithmetic.hpp"
+#include "Quickening.hpp"
+#include "Format.hpp"
 
 namespace avm {
 
 	Interpreter::~Interpreter()
 	{
+		try
+		{
+			m_output->Flush();
+		}
+		catch (std::exception const &)
+		{
+		}
+	}
+
+	void Interpreter::Run(ast::Program const &p_program)
+	{
+		try
+		{
+			Execute(p_program);
+		}
+		catch (...)
+		{
+			m_output->Flush();
+			throw;
+		}
+		m_output->Flush();
+	}
+
+	void Interpreter::Execute(ast::Program const &p_program)
+	{
+		ast::Code const l_code(p_program);
+		size_t l_pc = 0;
+
+		if (p_program.GetStackCapacity() && !m_stack.GetCapacity())
+		{
+			m_stack.SetCapacity(*p_program.GetStackCapacity());
+		}
+		if (p_program.HasQuery())
+		{
+			m_stack.TrackAggregates();
+		}
+		m_frames.clear();
+		while (l_pc < l_code.GetSize() && !m_shouldExit)
+		{
+			ast::Instruction const &l_instruction = l_code.At(l_pc);
+
+			switch (l_instruction.GetType())
+			{
+				case ast::Instruction::Type::JMP:
+				case ast::Instruction::Type::JZ:
+				case ast::Instruction::Type::JNZ:
+					l_pc = Branch(l_instruction.GetType()) ? l_code.GetTarget(l_pc) : l_pc + 1;
+					break;
+				case ast::Instruction::Type::DEF:
+					// Routines only run when called
+					l_pc = l_code.GetTarget(l_pc);
+					break;
+				case ast::Instruction::Type::CALL:
+					Call(static_cast<ast::InstructionWithEffect const &>(l_code.At(l_code.GetTarget(l_pc))), l_pc + 1);
+					l_pc = l_code.GetTarget(l_pc) + 1;
+					break;
+				case ast::Instruction::Type::RET:
+				case ast::Instruction::Type::END:
+					l_pc = Return();
+					break;
+				default:
+					l_instruction.Accept(*this);
+					l_pc++;
+					break;
+			}
+		}
 	}
 
 	bool Interpreter::Evaluate(ast::Instruction const &p_instruction)
@@ -13,7 +84,16 @@ namespace avm {
 			return m_shouldExit;
 		}
 
-		p_instruction.Accept(*this);
+		try
+		{
+			p_instruction.Accept(*this);
+		}
+		catch (...)
+		{
+			m_output->Flush();
+			throw;
+		}
+		m_output->Flush();
 
 		return m_shouldExit;
 	}
@@ -26,41 +106,128 @@ namespace avm {
 		UniquePtr<IOperand const> l_rhs = nullptr;
 		IOperand const *l_result = nullptr;
 
-		static const UnorderedMap<ast::Instruction::Type, std::function<IOperand const *(IOperand const &, IOperand const &)>>
-			l_operandFnLookUp {
-			{ ast::Instruction::Type::ADD, [] (IOperand const &p_lhs, IOperand const &p_rhs) { return p_lhs + p_rhs; } },
-			{ ast::Instruction::Type::SUB, [] (IOperand const &p_lhs, IOperand const &p_rhs) { return p_lhs - p_rhs; } },
-			{ ast::Instruction::Type::MUL, [] (IOperand const &p_lhs, IOperand const &p_rhs) { return p_lhs * p_rhs; } },
-			{ ast::Instruction::Type::DIV, [] (IOperand const &p_lhs, IOperand const &p_rhs) { return p_lhs / p_rhs; } },
-			{ ast::Instruction::Type::MOD, [] (IOperand const &p_lhs, IOperand const &p_rhs) { return p_lhs % p_rhs; } },
-		};
-		static const UnorderedMap<ast::Instruction::Type, std::function<void()>> l_operandLookUpNoParam {
-			{ ast::Instruction::Type::POP,   [&] () { Pop(); }  },
-			{ ast::Instruction::Type::DUMP,  [&] () { Dump(); } },
-			{ ast::Instruction::Type::PRINT, [&] () { Print(); }},
-			{ ast::Instruction::Type::EXIT,  [&] () { Exit(); } },
+		// Static tables outlive this instance: take the interpreter as a parameter
+		static const UnorderedMap<ast::Instruction::Type, std::function<void(Interpreter &)>> l_operandLookUpNoParam {
+			{ ast::Instruction::Type::POP,   [] (Interpreter &p_self) { p_self.Pop(); }  },
+			{ ast::Instruction::Type::DUMP,  [] (Interpreter &p_self) { p_self.Dump(); } },
+			{ ast::Instruction::Type::PRINT, [] (Interpreter &p_self) { p_self.Print(); }},
+			{ ast::Instruction::Type::EXIT,  [] (Interpreter &p_self) { p_self.Exit(); } },
+			{ ast::Instruction::Type::DUP,   [] (Interpreter &p_self) { p_self.m_stack.Dup(); } },
+			{ ast::Instruction::Type::SWAP,  [] (Interpreter &p_self) { p_self.m_stack.Swap(); } },
+			{ ast::Instruction::Type::OVER,  [] (Interpreter &p_self) { p_self.m_stack.Over(); } },
+			{ ast::Instruction::Type::ROT,   [] (Interpreter &p_self) { p_self.m_stack.Rot(); } },
+			{ ast::Instruction::Type::SORT,  [] (Interpreter &p_self) { p_self.m_stack.Sort(); } },
 		};
 
-		if (l_operandFnLookUp.find(l_type) != l_operandFnLookUp.end())
+		if (IsArithmetic(l_type))
 		{
-			if (m_stack.size() < 2)
+			if (m_stack.Size() < 2)
 			{
 				throw EmptyStackError();
 			}
 
-			l_rhs = std::move(m_stack.back());
-			m_stack.pop_back();
+			l_rhs = m_stack.Pop();
+			l_lhs = m_stack.Pop();
 
-			l_lhs = std::move(m_stack.back());
-			m_stack.pop_back();
+			bool const l_checked = m_uncheckedSites.empty()
+				|| m_uncheckedSites.find(&p_instruction) == m_uncheckedSites.end();
 
-			l_result = l_operandFnLookUp.at(l_type)(*l_lhs, *l_rhs);
+			l_result = Quicken(m_sites[&p_instruction], p_instruction, *l_lhs, *l_rhs, l_checked);
 
-			m_stack.emplace_back(UniquePtr<IOperand const>(l_result));
+			m_stack.Push(UniquePtr<IOperand const>(l_result));
+		}
+		else if (ast::Instruction::IsComparison(l_type))
+		{
+			m_stack.Compare(l_type);
+		}
+		else if (ast::Instruction::IsQuery(l_type))
+		{
+			m_stack.Query(l_type);
+		}
+		else if (l_type == ast::Instruction::Type::RET || l_type == ast::Instruction::Type::END)
+		{
+			// Calls need the whole program, see Run()
+			throw UnsupportedInstruction(p_instruction);
 		}
 		else if (l_operandLookUpNoParam.find(l_type) != l_operandLookUpNoParam.end())
 		{
-			l_operandLookUpNoParam.at(l_type)();
+			l_operandLookUpNoParam.at(l_type)(*this);
+		}
+		else
+		{
+			// Bulk reductions without a count cover the whole stack
+			m_stack.Reduce(l_type);
+		}
+	}
+
+	void Interpreter::VisitInstructionWithArgument(ast::InstructionWithArgument const &p_instruction)
+	{
+		switch (p_instruction.GetType())
+		{
+			case ast::Instruction::Type::STORE:
+				m_registers.Store(p_instruction.GetArgument(), m_stack);
+				break;
+			case ast::Instruction::Type::LOAD:
+				m_registers.Load(p_instruction.GetArgument(), m_stack);
+				break;
+			case ast::Instruction::Type::SORT:
+				m_stack.Sort(p_instruction.GetArgument());
+				break;
+			default:
+				m_stack.Reduce(p_instruction.GetType(), p_instruction.GetArgument());
+				break;
+		}
+	}
+
+	void Interpreter::VisitInstructionWithValues(ast::InstructionWithValues const &p_instruction)
+	{
+		m_stack.Append(p_instruction.GetOperandType(), p_instruction.GetValues());
+	}
+
+	void Interpreter::VisitInstructionWithFile(ast::InstructionWithFile const &p_instruction)
+	{
+		MappedFile const l_file(p_instruction.GetPath());
+		eOperandType const l_type = p_instruction.GetOperandType();
+		size_t const l_size = OperandStack::GetRawSize(l_type);
+
+		if (l_file.GetSize() % l_size != 0)
+		{
+			throw FileError(fmt::format("\"{}\" holds {} bytes, not a whole number of {}-byte values",
+				p_instruction.GetPath(), l_file.GetSize(), l_size));
+		}
+
+		Optional<size_t> const l_invalid = m_stack.AppendRaw(l_type, l_file.GetData(), l_file.GetSize() / l_size);
+
+		if (l_invalid)
+		{
+			throw FileError(fmt::format("\"{}\": value {} is not a finite number", p_instruction.GetPath(), *l_invalid));
+		}
+	}
+
+	void Interpreter::VisitInstructionWithLabel(ast::InstructionWithLabel const &p_instruction)
+	{
+		// Jumps and calls need the whole program, see Run()
+		if (p_instruction.GetType() != ast::Instruction::Type::LABEL)
+		{
+			throw UnsupportedInstruction(p_instruction);
+		}
+	}
+
+	void Interpreter::VisitInstructionWithBlock(ast::InstructionWithBlock const &p_instruction)
+	{
+		auto const &l_body = p_instruction.GetBody().GetInstructions();
+
+		// Not through Evaluate(): the output is flushed once, by whoever runs the block
+		for (size_t l_iteration = 0; l_iteration < p_instruction.GetCount(); l_iteration++)
+		{
+			for (auto const &l_instruction : l_body)
+			{
+				l_instruction->Accept(*this);
+				if (m_shouldExit)
+				{
+					return;
+				}
+			}
 		}
 	}
 
@@ -84,6 +251,44 @@ namespace avm {
 		return m_shouldExit;
 	}
 
+	QuickSite Interpreter::GetSite(ast::Instruction const &p_instruction) const
+	{
+		auto const l_site = m_sites.find(&p_instruction);
+
+		return l_site != m_sites.end() ? l_site->second : QuickSite();
+	}
+
+	void Interpreter::SetUncheckedSites(UnorderedSet<ast::Instruction const *> p_sites)
+	{
+		m_uncheckedSites = std::move(p_sites);
+	}
+
+	void Interpreter::SetStackCapacity(size_t p_capacity)
+	{
+		m_stack.SetCapacity(p_capacity);
+	}
+
+	void Interpreter::ReserveStack(size_t p_count)
+	{
+		m_stack.Reserve(p_count);
+	}
+
+	void Interpreter::SetOutput(SharedPtr<OutputSink> p_output)
+	{
+		m_output->Flush();
+		m_output = std::move(p_output);
+	}
+
+	OutputSink &Interpreter::GetOutput() const
+	{
+		return *m_output;
+	}
+
+	void Interpreter::SetStackStorage(SegmentStorage p_storage)
+	{
+		m_stack.SetStorage(std::move(p_storage));
+	}
+
 	eOperandType Interpreter::StringToOperandType(String const &l_str) const
 	{
 		static const UnorderedMap<String, eOperandType> l_lookUp {
@@ -117,38 +322,42 @@ namespace avm {
 		UniquePtr<IOperand const> l_stackValue(OperandFactory::Get().CreateOperand(
 			StringToOperandType(l_type), l_literal));
 
-		m_stack.push_back(std::move(l_stackValue));
+		m_stack.Push(std::move(l_stackValue));
 	}
 
 	void Interpreter::Pop()
 	{
-		if (m_stack.empty())
+		if (m_stack.Empty())
 		{
 			throw EmptyStackError();
 		}
-		m_stack.pop_back();
+		m_stack.Drop();
 	}
 
 	void Interpreter::Dump() const
 	{
-		for (auto l_stackVal = m_stack.rbegin(); l_stackVal != m_stack.rend(); l_stackVal++)
+		char l_line[s_formatSize + 1];
+
+		// Straight from the payloads, without building operand objects
+		for (size_t l_index = m_stack.Size(); l_index > 0; l_index--)
 		{
-			fmt::print("{}\n", (*l_stackVal)->toString());
+			char *const l_end = m_stack.Format(l_index - 1, l_line);
+
+			*l_end = '\n';
+			m_output->Write(StringView(l_line, static_cast<size_t>(l_end - l_line) + 1));
 		}
 	}
 
 	void Interpreter::Print() const
 	{
-		if (m_stack.empty())
+		if (m_stack.Empty())
 		{
 			throw EmptyStackError();
 		}
 
-		Operand<int8_t> const *l_operand = dynamic_cast<Operand<int8_t> const *>(m_stack.back().get());
-
-		if (l_operand != nullptr)
+		if (m_stack.GetType(m_stack.Size() - 1) == eOperandType::INT8)
 		{
-			fmt::print("{}", (char)l_operand->GetValue());
+			m_output->Put((char)m_stack.GetPayload(m_stack.Size() - 1).m_integer);
 		}
 		else
 		{
@@ -158,14 +367,9 @@ namespace avm {
 
 	void Interpreter::Assert(ast::Value const &p_value)
 	{
-		if (m_stack.empty())
-		{
-			throw EmptyStackError();
-		}
-
-		UniquePtr<IOperand const> &l_assertion = m_stack.back();
+		IOperand const &l_assertion = m_stack.Top();
 
-		if (TokenTypeToOperandType(p_value.GetType().m_type) != l_assertion->getType())
+		if (TokenTypeToOperandType(p_value.GetType().m_type) != l_assertion.getType())
 		{
 			throw AssertError();
 		}
@@ -174,7 +378,7 @@ namespace avm {
 			StringToOperandType(p_value.GetType().m_lexeme),
 			p_value.GetToken().m_lexeme);
 
-		if (*l_assertion != *l_value)
+		if (l_assertion != *l_value)
 		{
 			throw AssertError();
 		}
@@ -183,6 +387,78 @@ namespace avm {
 	void Interpreter::Exit()
 	{
 		m_shouldExit = true;
+		m_output->Flush();
+	}
+
+	bool Interpreter::Branch(ast::Instruction::Type p_type)
+	{
+		switch (p_type)
+		{
+			case ast::Instruction::Type::JMP:
+				return true;
+			case ast::Instruction::Type::JZ:
+				return m_stack.PopZero();
+			case ast::Instruction::Type::JNZ:
+				return !m_stack.PopZero();
+			default:
+				throw std::runtime_error("Unreachable!");
+		}
+	}
+
+	void Interpreter::Call(ast::InstructionWithEffect const &p_routine, size_t p_return)
+	{
+		size_t l_base = m_stack.Size();
+
+		if (m_frames.size() == s_maxDepth)
+		{
+			throw CallError("Return stack overflow");
+		}
+		if (p_routine.GetEffect())
+		{
+			if (!HasOnTop(p_routine.GetEffect()->m_inputs))
+			{
+				throw CallError(p_routine, false);
+			}
+			l_base -= p_routine.GetEffect()->m_inputs.size();
+		}
+		m_frames.push_back({ p_return, l_base, &p_routine });
+	}
+
+	size_t Interpreter::Return()
+	{
+		if (m_frames.empty())
+		{
+			throw CallError("Return outside of a routine");
+		}
+
+		Frame const l_frame = m_frames.back();
+		Optional<ast::StackEffect> const &l_effect = l_frame.m_routine->GetEffect();
+
+		m_frames.pop_back();
+		if (l_effect && (m_stack.Size() != l_frame.m_base + l_effect->m_outputs.size() || !HasOnTop(l_effect->m_outputs)))
+		{
+			throw CallError(*l_frame.m_routine, true);
+		}
+		return l_frame.m_return;
+	}
+
+	bool Interpreter::HasOnTop(Vector<eOperandType> const &p_types) const
+	{
+		if (m_stack.Size() < p_types.size())
+		{
+			return false;
+		}
+
+		size_t const l_first = m_stack.Size() - p_types.size();
+
+		for (size_t l_index = 0; l_index < p_types.size(); l_index++)
+		{
+			if (m_stack.GetType(l_first + l_index) != p_types[l_index])
+			{
+				return false;
+			}
+		}
+		return true;
 	}
 
 	// Exceptions
@@ -211,4 +487,67 @@ namespace avm {
 	{
 		return "Value is not of type int8";
 	}
+
+	char const *EmptyRegisterError::what() const noexcept
+	{
+		return "Register is empty";
+	}
+
+	FileError::FileError(String p_message) : m_message(std::move(p_message))
+	{
+	}
+
+	char const *FileError::what() const noexcept
+	{
+		return m_message.c_str();
+	}
+
+	StackOverflowError::StackOverflowError(String p_message) : m_message(std::move(p_message))
+	{
+	}
+
+	char const *StackOverflowError::what() const noexcept
+	{
+		return m_message.c_str();
+	}
+
+	CallError::CallError(ast::InstructionWithEffect const &p_routine, bool p_return)
+	{
+		static const UnorderedMap<eOperandType, char const *> l_names {
+			{ eOperandType::INT8,   "int8"   },
+			{ eOperandType::INT16,  "int16"  },
+			{ eOperandType::INT32,  "int32"  },
+			{ eOperandType::FLOAT,  "float"  },
+			{ eOperandType::DOUBLE, "double" },
+		};
+
+		auto const &l_types = p_return ? p_routine.GetEffect()->m_outputs : p_routine.GetEffect()->m_inputs;
+		String l_expected;
+
+		for (eOperandType l_type : l_types)
+		{
+			l_expected += l_expected.empty() ? "" : " ";
+			l_expected += l_names.at(l_type);
+		}
+
+		m_message = p_return
+			? fmt::format("Return from {}: expected {} in place of its inputs", p_routine.GetLabel(),
+				l_expected.empty() ? "nothing" : l_expected)
+			: fmt::format("Call to {}: expected {} on top of the stack", p_routine.GetLabel(), l_expected);
+	}
+
+	CallError::CallError(String p_message) : m_message(std::move(p_message))
+	{
+	}
+
+	char const *CallError::what() const noexcept
+	{
+		return m_message.c_str();
+	}
+
+	UnsupportedInstruction::UnsupportedInstruction(ast::Instruction const &p_instruction)
+		: std::runtime_error(fmt::format("[line {}] {} is not supported by this engine",
+			p_instruction.GetLine(), p_instruction.GetName()))
+	{
+	}
 }
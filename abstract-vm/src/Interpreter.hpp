@@ -1,6 +1,10 @@
 #pragma once
 #include "ast/Instruction.hpp"
 #include "Operand.hpp"
+#include "OperandStack.hpp"
+#include "OutputSink.hpp"
+#include "Quickening.hpp"
+#include "RegisterFile.hpp"
 
 namespace avm {
 
@@ -13,13 +17,53 @@ namespace avm {
 
 		Interpreter &operator=(const Interpreter &) = delete;
 
+		/*
+		 * Runs the program until its end or an exit, following the jumps and
+		 * calls. Evaluate() runs a single instruction and can do neither.
+		 * Both flush the output when they return or throw.
+		 */
+		void Run(ast::Program const &p_program);
 		bool Evaluate(ast::Instruction const &p_instruction);
 		void VisitInstruction(ast::Instruction const &p_instruction) override;
 		void VisitInstructionWithValue(ast::InstructionWithValue const &p_instruction) override;
+		void VisitInstructionWithArgument(ast::InstructionWithArgument const &p_instruction) override;
+		void VisitInstructionWithValues(ast::InstructionWithValues const &p_instruction) override;
+		void VisitInstructionWithFile(ast::InstructionWithFile const &p_instruction) override;
+		void VisitInstructionWithLabel(ast::InstructionWithLabel const &p_instruction) override;
+		void VisitInstructionWithBlock(ast::InstructionWithBlock const &p_instruction) override;
 
 		bool HasExited() const;
 
+		/*
+		 * Arithmetic instructions listed here skip the overflow checks, see
+		 * analysis::IntervalAnalysis::GetProvenSafe().
+		 */
+		void SetUncheckedSites(UnorderedSet<ast::Instruction const *> p_sites);
+
+		// Quickened state of an arithmetic instruction, generic when it never ran here, see Quickening.hpp
+		QuickSite GetSite(ast::Instruction const &p_instruction) const;
+
+		/*
+		 * Room reserved on the operand stack before the program runs, see
+		 * OperandStack::SetCapacity(). A capacity is also the limit of the
+		 * stack and takes the place of a ";@stack" pragma of the program.
+		 */
+		void SetStackCapacity(size_t p_capacity);
+		void ReserveStack(size_t p_count);
+
+		// Where the segments of the stack live, see OperandStack::SetStorage()
+		void SetStackStorage(SegmentStorage p_storage);
+
+		/*
+		 * Where dump and print write, a FileSink on stdout by default. The
+		 * output is buffered, and flushed on exit, on error, at the end of
+		 * Run() or Evaluate() and when the buffer is full.
+		 */
+		void SetOutput(SharedPtr<OutputSink> p_output);
+		OutputSink &GetOutput() const;
+
 	private:
+		void Execute(ast::Program const &p_program);
 		eOperandType StringToOperandType(String const &l_str) const;
 		eOperandType TokenTypeToOperandType(TokenType p_type);
 
@@ -29,9 +73,28 @@ namespace avm {
 		void Print() const;
 		void Assert(ast::Value const &p_value);
 		void Exit();
+		bool Branch(ast::Instruction::Type p_type);
+		void Call(ast::InstructionWithEffect const &p_routine, size_t p_return);
+		size_t Return();
+		bool HasOnTop(Vector<eOperandType> const &p_types) const;
 
 	private:
-		Vector<UniquePtr<IOperand const>> m_stack;
+		// A call in progress: where to return, and the stack below its inputs
+		struct Frame
+		{
+			size_t m_return;
+			size_t m_base;
+			ast::InstructionWithEffect const *m_routine;
+		};
+
+		static constexpr size_t s_maxDepth = 1 << 16;
+
+		OperandStack m_stack;
+		SharedPtr<OutputSink> m_output = MakeShared<FileSink>();
+		RegisterFile m_registers;
+		Vector<Frame> m_frames;
+		UnorderedSet<ast::Instruction const *> m_uncheckedSites;
+		UnorderedMap<ast::Instruction const *, QuickSite> m_sites;
 		bool m_shouldExit = false;
 	};
 
@@ -63,4 +126,54 @@ namespace avm {
 	public:
 		char const *what() const noexcept override;
 	};
+
+	class EmptyRegisterError : public InterpreterError
+	{
+	public:
+		char const *what() const noexcept override;
+	};
+
+	// A data file that cannot be read or does not hold values of its type
+	class FileError : public InterpreterError
+	{
+	public:
+		FileError(String p_message);
+
+		char const *what() const noexcept override;
+
+	private:
+		String m_message;
+	};
+
+	// A stack past its capacity, or a capacity that cannot be reserved
+	class StackOverflowError : public InterpreterError
+	{
+	public:
+		StackOverflowError(String p_message);
+
+		char const *what() const noexcept override;
+
+	private:
+		String m_message;
+	};
+
+	// A call or return that does not match the stack effect of its routine
+	class CallError : public InterpreterError
+	{
+	public:
+		CallError(ast::InstructionWithEffect const &p_routine, bool p_return);
+		CallError(String p_message);
+
+		char const *what() const noexcept override;
+
+	private:
+		String m_message;
+	};
+
+	// Raised by the engines that only run the base instructions
+	class UnsupportedInstruction : public std::runtime_error
+	{
+	public:
+		UnsupportedInstruction(ast::Instruction const &p_instruction);
+	};
 }
@@ -0,0 +1,223 @@
+#include "LazyInterpreter.hpp"
+#include "Arithmetic.hpp"
+#include "Interpreter.hpp"
+
+namespace avm {
+
+	// Thunk
+	// =====
+
+	LazyInterpreter::Thunk::Thunk(UniquePtr<IOperand const> p_value)
+		: m_operation(ast::Instruction::Type::PUSH), m_value(std::move(p_value))
+	{
+	}
+
+	LazyInterpreter::Thunk::Thunk(ast::Instruction::Type p_operation, UniquePtr<Thunk> p_lhs, UniquePtr<Thunk> p_rhs)
+		: m_operation(p_operation), m_lhs(std::move(p_lhs)), m_rhs(std::move(p_rhs))
+	{
+	}
+
+	// Expression trees can be as deep as the program is long: no recursion
+	LazyInterpreter::Thunk::~Thunk()
+	{
+		Vector<UniquePtr<Thunk>> l_pending;
+
+		if (m_lhs) l_pending.push_back(std::move(m_lhs));
+		if (m_rhs) l_pending.push_back(std::move(m_rhs));
+
+		while (!l_pending.empty())
+		{
+			UniquePtr<Thunk> l_thunk = std::move(l_pending.back());
+			l_pending.pop_back();
+
+			if (l_thunk->m_lhs) l_pending.push_back(std::move(l_thunk->m_lhs));
+			if (l_thunk->m_rhs) l_pending.push_back(std::move(l_thunk->m_rhs));
+		}
+	}
+
+	// LazyInterpreter
+	// ===============
+
+	bool LazyInterpreter::Evaluate(ast::Instruction const &p_instruction)
+	{
+		if (m_shouldExit)
+		{
+			return m_shouldExit;
+		}
+
+		p_instruction.Accept(*this);
+
+		return m_shouldExit;
+	}
+
+	void LazyInterpreter::VisitInstruction(ast::Instruction const &p_instruction)
+	{
+		ast::Instruction::Type const l_type = p_instruction.GetType();
+
+		if (IsArithmetic(l_type))
+		{
+			if (m_stack.size() < 2)
+			{
+				throw EmptyStackError();
+			}
+
+			UniquePtr<Thunk> l_rhs = std::move(m_stack.back());
+			m_stack.pop_back();
+			UniquePtr<Thunk> l_lhs = std::move(m_stack.back());
+			m_stack.pop_back();
+
+			m_stack.push_back(MakeUnique<Thunk>(l_type, std::move(l_lhs), std::move(l_rhs)));
+			return;
+		}
+
+		switch (l_type)
+		{
+			case ast::Instruction::Type::POP:
+				Pop();
+				break;
+			case ast::Instruction::Type::DUMP:
+				Dump();
+				break;
+			case ast::Instruction::Type::PRINT:
+				Print();
+				break;
+			case ast::Instruction::Type::EXIT:
+				m_shouldExit = true;
+				break;
+			default:
+				throw UnsupportedInstruction(p_instruction);
+		}
+	}
+
+	void LazyInterpreter::VisitInstructionWithValue(ast::InstructionWithValue const &p_instruction)
+	{
+		switch (p_instruction.GetType())
+		{
+			case ast::Instruction::Type::PUSH:
+				PushValueToStack(*p_instruction.GetValue());
+				break;
+			case ast::Instruction::Type::ASSERT:
+				Assert(*p_instruction.GetValue());
+				break;
+			default:
+				throw std::runtime_error("Unreachable!");
+		};
+	}
+
+	bool LazyInterpreter::HasExited() const
+	{
+		return m_shouldExit;
+	}
+
+	size_t LazyInterpreter::GetForcedCount() const
+	{
+		return m_forced;
+	}
+
+	IOperand const &LazyInterpreter::Force(Thunk &p_thunk)
+	{
+		Vector<Thunk *> l_work { &p_thunk };
+
+		while (!l_work.empty())
+		{
+			Thunk &l_thunk = *l_work.back();
+
+			if (l_thunk.m_value)
+			{
+				l_work.pop_back();
+			}
+			else if (!l_thunk.m_lhs->m_value)
+			{
+				l_work.push_back(l_thunk.m_lhs.get());
+			}
+			else if (!l_thunk.m_rhs->m_value)
+			{
+				l_work.push_back(l_thunk.m_rhs.get());
+			}
+			else
+			{
+				l_thunk.m_value.reset(Apply(l_thunk.m_operation, *l_thunk.m_lhs->m_value, *l_thunk.m_rhs->m_value));
+				l_thunk.m_lhs.reset();
+				l_thunk.m_rhs.reset();
+				m_forced++;
+				l_work.pop_back();
+			}
+		}
+
+		return *p_thunk.m_value;
+	}
+
+	// Literals are still converted right away, like Interpreter does
+	void LazyInterpreter::PushValueToStack(ast::Value const &p_value)
+	{
+		UniquePtr<IOperand const> l_operand(OperandFactory::Get().CreateOperand(
+			p_value.GetOperandType(), *p_value.GetToken().m_literal));
+
+		m_stack.push_back(MakeUnique<Thunk>(std::move(l_operand)));
+	}
+
+	void LazyInterpreter::Pop()
+	{
+		if (m_stack.empty())
+		{
+			throw EmptyStackError();
+		}
+		m_stack.pop_back();
+	}
+
+	void LazyInterpreter::Dump()
+	{
+		// Oldest values first, so faults come out in program order
+		for (auto &l_thunk : m_stack)
+		{
+			Force(*l_thunk);
+		}
+
+		for (auto l_stackVal = m_stack.rbegin(); l_stackVal != m_stack.rend(); l_stackVal++)
+		{
+			fmt::print("{}\n", (*l_stackVal)->m_value->toString());
+		}
+	}
+
+	void LazyInterpreter::Print()
+	{
+		if (m_stack.empty())
+		{
+			throw EmptyStackError();
+		}
+
+		Operand<int8_t> const *l_operand = dynamic_cast<Operand<int8_t> const *>(&Force(*m_stack.back()));
+
+		if (l_operand != nullptr)
+		{
+			fmt::print("{}", (char)l_operand->GetValue());
+		}
+		else
+		{
+			throw PrintError();
+		}
+	}
+
+	void LazyInterpreter::Assert(ast::Value const &p_value)
+	{
+		if (m_stack.empty())
+		{
+			throw EmptyStackError();
+		}
+
+		IOperand const &l_assertion = Force(*m_stack.back());
+
+		if (p_value.GetOperandType() != l_assertion.getType())
+		{
+			throw AssertError();
+		}
+
+		UniquePtr<IOperand const> l_value(OperandFactory::Get().CreateOperand(
+			p_value.GetOperandType(), p_value.GetToken().m_lexeme));
+
+		if (l_assertion != *l_value)
+		{
+			throw AssertError();
+		}
+	}
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include "ast/Instruction.hpp"
+#include "Operand.hpp"
+
+namespace avm {
+
+	/*
+	 * Alternative to Interpreter that defers arithmetic: binary instructions
+	 * push an expression node and the value is only computed when dump,
+	 * assert or print observe it. Popped expressions are never computed.
+	 * Forcing evaluates operands before operators, left to right, so the
+	 * faults of the forced values come out in program order.
+	 */
+	class LazyInterpreter : public ast::InstructionVisitor
+	{
+	public:
+		LazyInterpreter() = default;
+		LazyInterpreter(const LazyInterpreter &) = delete;
+		virtual ~LazyInterpreter() = default;
+
+		LazyInterpreter &operator=(const LazyInterpreter &) = delete;
+
+		bool Evaluate(ast::Instruction const &p_instruction);
+		void VisitInstruction(ast::Instruction const &p_instruction) override;
+		void VisitInstructionWithValue(ast::InstructionWithValue const &p_instruction) override;
+
+		bool HasExited() const;
+
+		// Number of arithmetic instructions actually computed so far
+		size_t GetForcedCount() const;
+
+	private:
+		struct Thunk
+		{
+			Thunk(UniquePtr<IOperand const> p_value);
+			Thunk(ast::Instruction::Type p_operation, UniquePtr<Thunk> p_lhs, UniquePtr<Thunk> p_rhs);
+			Thunk(const Thunk &) = delete;
+			~Thunk();
+
+			Thunk &operator=(const Thunk &) = delete;
+
+			ast::Instruction::Type m_operation;
+			UniquePtr<Thunk> m_lhs;
+			UniquePtr<Thunk> m_rhs;
+			UniquePtr<IOperand const> m_value;
+		};
+
+		IOperand const &Force(Thunk &p_thunk);
+
+		void PushValueToStack(ast::Value const &p_value);
+		void Pop();
+		void Dump();
+		void Print();
+		void Assert(ast::Value const &p_value);
+
+	private:
+		Vector<UniquePtr<Thunk>> m_stack;
+		size_t m_forced = 0;
+		bool m_shouldExit = false;
+	};
+}
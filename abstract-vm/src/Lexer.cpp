@@ -1,4 +1,5 @@
 #include "Lexer.hpp"
+#include "simd/Integers.hpp"
 
 namespace avm {
 
@@ -15,6 +16,9 @@ namespace avm {
 			CASE_TOKEN(NEWLINE)
 			CASE_TOKEN(LPAREN)
 			CASE_TOKEN(RPAREN)
+			CASE_TOKEN(LBRACE)
+			CASE_TOKEN(RBRACE)
+			CASE_TOKEN(DASHES)
 			CASE_TOKEN(NUMBER)
 			CASE_TOKEN(FLOAT_NUMBER)
 			CASE_TOKEN(INT8)
@@ -33,6 +37,43 @@ namespace avm {
 			CASE_TOKEN(MOD)
 			CASE_TOKEN(PRINT)
 			CASE_TOKEN(EXIT)
+			CASE_TOKEN(SUM)
+			CASE_TOKEN(PROD)
+			CASE_TOKEN(MIN)
+			CASE_TOKEN(MAX)
+			CASE_TOKEN(MEAN)
+			CASE_TOKEN(DUP)
+			CASE_TOKEN(SWAP)
+			CASE_TOKEN(OVER)
+			CASE_TOKEN(ROT)
+			CASE_TOKEN(STORE)
+			CASE_TOKEN(LOAD)
+			CASE_TOKEN(REGISTER)
+			CASE_TOKEN(ARRAY)
+			CASE_TOKEN(STRING)
+			CASE_TOKEN(LABEL)
+			CASE_TOKEN(IDENTIFIER)
+			CASE_TOKEN(JMP)
+			CASE_TOKEN(JZ)
+			CASE_TOKEN(JNZ)
+			CASE_TOKEN(EQ)
+			CASE_TOKEN(NE)
+			CASE_TOKEN(LT)
+			CASE_TOKEN(LE)
+			CASE_TOKEN(GT)
+			CASE_TOKEN(GE)
+			CASE_TOKEN(REPEAT)
+			CASE_TOKEN(MACRO)
+			CASE_TOKEN(DEF)
+			CASE_TOKEN(END)
+			CASE_TOKEN(CALL)
+			CASE_TOKEN(RET)
+			CASE_TOKEN(INCLUDE)
+			CASE_TOKEN(SORT)
+			CASE_TOKEN(STACKMIN)
+			CASE_TOKEN(STACKMAX)
+			CASE_TOKEN(STACKSUM)
+			CASE_TOKEN(STACKCOUNT)
 			default:
 				return "";
 		}
@@ -82,7 +123,23 @@ namespace avm {
 			case ')':
 				AddToken(RPAREN);
 				break;
+			case '{':
+				AddToken(LBRACE);
+				break;
+			case '}':
+				AddToken(RBRACE);
+				break;
+			case '[':
+				Array();
+				break;
+			case '"':
+				Text();
+				break;
 			case ';':
+				if (Match('@'))
+				{
+					Pragma();
+				}
 				// Comment: skip until new line
 				while (!IsAtEnd() && Peek() != '\n') Advance();
 				break;
@@ -99,6 +156,11 @@ namespace avm {
 				{
 					Identifier();
 				}
+				else if (l_ch == '-' && Match('-'))
+				{
+					// Separates the inputs from the outputs of a stack effect
+					AddToken(DASHES);
+				}
 				else if (IsDigit(l_ch) || l_ch == '-')
 				{
 					Number();
@@ -172,11 +234,46 @@ namespace avm {
 			Advance();
 
 		String l_text = m_source.substr(m_start, m_current - m_start);
+
+		// Label definition: "loop:", the literal is its name
+		if (Match(':'))
+		{
+			AddToken(LABEL, l_text);
+			return;
+		}
+
+		// Label name after a jump, macro or routine name, keywords included
+		if (!m_tokens.empty())
+		{
+			TokenType const l_previous = m_tokens.back().m_type;
+
+			if (l_previous == MACRO)
+			{
+				m_macros.insert(l_text);
+			}
+			if (l_previous == JMP || l_previous == JZ || l_previous == JNZ || l_previous == MACRO
+				|| l_previous == DEF || l_previous == CALL)
+			{
+				AddToken(IDENTIFIER, l_text);
+				return;
+			}
+		}
+
 		decltype(s_keywords)::const_iterator l_tokenType = s_keywords.find(l_text);
 		if (l_tokenType != s_keywords.end())
 		{
 			AddToken(l_tokenType->second);
 		}
+		else if (l_text.size() > 1 && l_text[0] == 'r' && l_text.find_first_not_of("0123456789", 1) == String::npos)
+		{
+			// Register name, the literal is its index
+			AddToken(REGISTER, l_text.substr(1));
+		}
+		else if (m_macros.find(l_text) != m_macros.end())
+		{
+			// Macro use
+			AddToken(IDENTIFIER, l_text);
+		}
 		else
 		{
 			m_lexer.Error(m_line, fmt::format("Unexpected Identifier: '{}'", l_text));
@@ -202,6 +299,48 @@ namespace avm {
 		AddToken(NUMBER, m_source.substr(m_start, m_current - m_start));
 	}
 
+	// Bulk values: "[1, -2, 3]" on a single line
+	void Scanner::Array()
+	{
+		size_t const l_end = m_source.find_first_of("]\n", m_current);
+
+		if (l_end == String::npos || m_source[l_end] != ']')
+		{
+			m_lexer.Error(m_line, "Expected \"]\" after values");
+			m_current = l_end == String::npos ? m_source.length() : l_end;
+			return;
+		}
+
+		StringView const l_body = StringView(m_source).substr(m_current, l_end - m_current);
+		auto l_values = MakeShared<Vector<int64_t>>();
+
+		if (simd::ParseIntegers(l_body, *l_values) != l_body.length())
+		{
+			m_lexer.Error(m_line, "Expected integers separated by \",\"");
+		}
+
+		// The lexeme stays short, it ends up in diagnostics
+		m_current = l_end + 1;
+		m_tokens.emplace_back(Token(ARRAY, "[", NullOpt, m_line));
+		m_tokens.back().m_values = std::move(l_values);
+	}
+
+	// Double quoted, on a single line, without escapes
+	void Scanner::Text()
+	{
+		while (!IsAtEnd() && Peek() != '"' && Peek() != '\n')
+		{
+			Advance();
+		}
+
+		if (!Match('"'))
+		{
+			m_lexer.Error(m_line, "Unterminated string");
+			return;
+		}
+		AddToken(STRING, m_source.substr(m_start + 1, m_current - m_start - 2));
+	}
+
 	void Scanner::NewLine()
 	{
 		AddToken(NEWLINE);
@@ -209,6 +348,39 @@ namespace avm {
 		while (!IsAtEnd() && Peek() == '\n') Advance();
 	}
 
+	// ";@stack 10000": the stack capacity, see Interpreter::SetStackCapacity()
+	// Any other ";@..." stays a plain comment
+	void Scanner::Pragma()
+	{
+		StringView::size_type l_end = m_current;
+
+		while (l_end < m_source.size() && IsAlpha(m_source[l_end])) l_end++;
+
+		if (m_source.substr(m_current, l_end - m_current) != "stack")
+		{
+			return;
+		}
+		m_current = l_end;
+
+		while (Peek() == ' ' || Peek() == '\t') Advance();
+
+		StringView::size_type const l_digits = m_current;
+
+		while (IsDigit(Peek())) Advance();
+
+		String const l_capacity = m_source.substr(l_digits, m_current - l_digits);
+
+		while (Peek() == ' ' || Peek() == '\t' || Peek() == '\r') Advance();
+
+		if (l_capacity.empty() || l_capacity.size() > 18 || (!IsAtEnd() && Peek() != '\n')
+			|| std::stoull(l_capacity) == 0)
+		{
+			m_lexer.Error(m_line, "Expected a positive stack capacity");
+			return;
+		}
+		m_lexer.SetStackCapacity(std::stoull(l_capacity));
+	}
+
 	void Lexer::RunFile(StringView p_path)
 	{
 		std::fstream l_file;
@@ -217,12 +389,14 @@ namespace avm {
 		std::ostringstream l_stringStream;
 		l_stringStream << l_file.rdbuf();
 
-		Run(l_stringStream.str());
+		Run(l_stringStream.str(), p_path);
 	}
 
-	void Lexer::Run(StringView p_source)
+	void Lexer::Run(StringView p_source, StringView p_path)
 	{
 		m_hadError = false;
+		m_path = String(p_path);
+		m_stackCapacity = NullOpt;
 
 		Scanner l_scanner(*this, p_source);
 		List<Token> l_tokens = l_scanner.ScanTokens();
@@ -267,4 +441,19 @@ namespace avm {
 	{
 		return m_tokens;
 	}
+
+	String const &Lexer::GetPath() const
+	{
+		return m_path;
+	}
+
+	void Lexer::SetStackCapacity(size_t p_capacity)
+	{
+		m_stackCapacity = p_capacity;
+	}
+
+	Optional<size_t> Lexer::GetStackCapacity() const
+	{
+		return m_stackCapacity;
+	}
 }
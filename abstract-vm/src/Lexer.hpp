@@ -16,13 +16,23 @@ namespace avm {
 
 		SEMICOLON, NEWLINE,
 
-		LPAREN, RPAREN,
+		LPAREN, RPAREN, LBRACE, RBRACE, DASHES,
 
 		NUMBER, FLOAT_NUMBER,
 
 		INT8, INT16, INT32, FLOAT, DOUBLE,
 
 		PUSH, POP, DUMP, ASSERT, ADD, SUB, MUL, DIV, MOD, PRINT, EXIT,
+		SUM, PROD, MIN, MAX, MEAN,
+		DUP, SWAP, OVER, ROT,
+		STORE, LOAD, REGISTER,
+		ARRAY, STRING,
+		LABEL, IDENTIFIER, JMP, JZ, JNZ,
+		EQ, NE, LT, LE, GT, GE,
+		REPEAT, MACRO,
+		DEF, END, CALL, RET,
+		INCLUDE, SORT,
+		STACKMIN, STACKMAX, STACKSUM, STACKCOUNT,
 		INPUT_STOP,
 	};
 
@@ -31,6 +41,8 @@ namespace avm {
 		String m_lexeme;
 		Optional<String> m_literal;
 		int m_line;
+		// Values of an ARRAY token, converted while scanning
+		SharedPtr<Vector<int64_t> const> m_values;
 
 		Token(TokenType p_type, String p_lexeme, Optional<String> p_literal, int p_line);
 		String TokenTypeToString();
@@ -64,12 +76,17 @@ namespace avm {
 			char IsAlphaNumeric(char);
 			void Identifier();
 			void Number();
+			void Array();
+			void Text();
 			void NewLine();
+			void Pragma();
 
 		private:
 			Lexer &m_lexer;
 			String m_source;
 			List<Token> m_tokens;
+			// Names given to "macro", scanned as identifiers from then on
+			UnorderedSet<String> m_macros;
 
 			StringView::size_type m_start;
 			StringView::size_type m_current;
@@ -92,6 +109,38 @@ namespace avm {
 				{ "assert", ASSERT },
 				{  "print", PRINT },
 				{   "exit", EXIT },
+				{    "sum", SUM },
+				{   "prod", PROD },
+				{    "min", MIN },
+				{    "max", MAX },
+				{   "mean", MEAN },
+				{    "dup", DUP },
+				{   "swap", SWAP },
+				{   "over", OVER },
+				{    "rot", ROT },
+				{  "store", STORE },
+				{   "load", LOAD },
+				{    "jmp", JMP },
+				{     "jz", JZ },
+				{    "jnz", JNZ },
+				{     "eq", EQ },
+				{     "ne", NE },
+				{     "lt", LT },
+				{     "le", LE },
+				{     "gt", GT },
+				{     "ge", GE },
+				{ "repeat", REPEAT },
+				{  "macro", MACRO },
+				{    "def", DEF },
+				{    "end", END },
+				{   "call", CALL },
+				{    "ret", RET },
+				{ "include", INCLUDE },
+				{   "sort", SORT },
+				{   "stackmin", STACKMIN },
+				{   "stackmax", STACKMAX },
+				{   "stacksum", STACKSUM },
+				{ "stackcount", STACKCOUNT },
 			};
 	};
 
@@ -105,16 +154,24 @@ namespace avm {
 			Lexer &operator=(Lexer const &) = delete;
 
 			void RunFile(StringView p_path);
-			void Run(StringView p_source);
+			// p_path names the file the source was read from, if any
+			void Run(StringView p_source, StringView p_path = "");
 			void Error(int p_line, StringView p_message);
 			void Error(Token p_token, String p_message);
 			void Report(int p_line, StringView p_where, StringView p_message);
 
 			bool HadError() const;
 			List<Token> const &GetTokens() const;
+			String const &GetPath() const;
+
+			// Set by a ";@stack N" pragma of the source
+			void SetStackCapacity(size_t p_capacity);
+			Optional<size_t> GetStackCapacity() const;
 
 		private:
 			bool m_hadError = false;
+			String m_path;
 			List<Token> m_tokens;
+			Optional<size_t> m_stackCapacity;
 	};
 }
@@ -0,0 +1,83 @@
+#include "MappedFile.hpp"
+#include "Interpreter.hpp"
+#include <cerrno>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+# define AVM_HAS_MMAP 1
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#else
+# define AVM_HAS_MMAP 0
+# include <fstream>
+# include <iterator>
+#endif
+
+namespace avm {
+
+	MappedFile::MappedFile(String const &p_path)
+	{
+#if AVM_HAS_MMAP
+		int const l_fd = open(p_path.c_str(), O_RDONLY);
+		struct stat l_stat;
+
+		if (l_fd < 0)
+		{
+			throw FileError(fmt::format("Cannot open \"{}\": {}", p_path, std::strerror(errno)));
+		}
+		if (fstat(l_fd, &l_stat) < 0 || !S_ISREG(l_stat.st_mode))
+		{
+			close(l_fd);
+			throw FileError(fmt::format("\"{}\" is not a regular file", p_path));
+		}
+
+		m_size = static_cast<size_t>(l_stat.st_size);
+
+		// mmap() rejects empty mappings
+		if (m_size > 0)
+		{
+			m_address = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, l_fd, 0);
+			if (m_address == MAP_FAILED)
+			{
+				m_address = nullptr;
+				close(l_fd);
+				throw FileError(fmt::format("Cannot map \"{}\": {}", p_path, std::strerror(errno)));
+			}
+			// One sequential pass follows
+			madvise(m_address, m_size, MADV_SEQUENTIAL);
+		}
+		close(l_fd);
+#else
+		std::ifstream l_file(p_path, std::ios::binary);
+
+		if (!l_file)
+		{
+			throw FileError(fmt::format("Cannot open \"{}\"", p_path));
+		}
+		m_buffer.assign(std::istreambuf_iterator<char>(l_file), std::istreambuf_iterator<char>());
+		m_size = m_buffer.size();
+#endif
+	}
+
+	MappedFile::~MappedFile()
+	{
+#if AVM_HAS_MMAP
+		if (m_address)
+		{
+			munmap(m_address, m_size);
+		}
+#endif
+	}
+
+	unsigned char const *MappedFile::GetData() const
+	{
+		return m_address ? static_cast<unsigned char const *>(m_address) : m_buffer.data();
+	}
+
+	size_t MappedFile::GetSize() const
+	{
+		return m_size;
+	}
+}
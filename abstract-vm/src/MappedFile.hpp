@@ -0,0 +1,29 @@
+#pragma once
+#include "abstractvm.hpp"
+
+namespace avm {
+
+	/*
+	 * Read-only view of a whole file. The file is mapped in memory where the
+	 * platform allows it, and read into a buffer otherwise. Throws FileError
+	 * when the file cannot be opened.
+	 */
+	class MappedFile
+	{
+	public:
+		MappedFile() = delete;
+		explicit MappedFile(String const &p_path);
+		MappedFile(const MappedFile &) = delete;
+		~MappedFile();
+
+		MappedFile &operator=(const MappedFile &) = delete;
+
+		unsigned char const *GetData() const;
+		size_t GetSize() const;
+
+	private:
+		void *m_address = nullptr;
+		size_t m_size = 0;
+		Vector<unsigned char> m_buffer;
+	};
+}
@@ -0,0 +1,581 @@
+#include "ModuleCache.hpp"
+#include "Lexer.hpp"
+#include "Parser.hpp"
+#include "MappedFile.hpp"
+#include "Interpreter.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace avm {
+
+	namespace {
+
+		// Bump when the stored format or the instruction set changes, see ReadInstruction()
+		constexpr uint32_t s_version = 1;
+		constexpr char s_magic[4] = { 'A', 'V', 'M', 'C' };
+
+		// Class of a stored instruction, which gives the fields that follow it
+		enum class Kind : uint8_t
+		{
+			PLAIN,
+			VALUE,
+			ARGUMENT,
+			VALUES,
+			FILE,
+			LABEL,
+			EFFECT,
+			BLOCK,
+		};
+
+		class Writer : public ast::InstructionVisitor
+		{
+		public:
+			template <typename T>
+			void Write(T p_value)
+			{
+				char l_bytes[sizeof(T)];
+
+				std::memcpy(l_bytes, &p_value, sizeof(T));
+				m_data.append(l_bytes, sizeof(T));
+			}
+
+			void WriteString(StringView p_string)
+			{
+				Write<uint32_t>(p_string.size());
+				m_data.append(p_string.data(), p_string.size());
+			}
+
+			void WriteProgram(ast::Program const &p_program)
+			{
+				Write<uint32_t>(p_program.GetInstructions().size());
+				for (auto const &l_instruction : p_program.GetInstructions())
+				{
+					l_instruction->Accept(*this);
+				}
+			}
+
+			String const &GetData() const
+			{
+				return m_data;
+			}
+
+			void VisitInstruction(ast::Instruction const &p_instruction) override
+			{
+				Header(Kind::PLAIN, p_instruction);
+			}
+
+			void VisitInstructionWithValue(ast::InstructionWithValue const &p_instruction) override
+			{
+				Header(Kind::VALUE, p_instruction);
+				WriteToken(p_instruction.GetValue()->GetType());
+				WriteToken(p_instruction.GetValue()->GetToken());
+			}
+
+			void VisitInstructionWithArgument(ast::InstructionWithArgument const &p_instruction) override
+			{
+				Header(Kind::ARGUMENT, p_instruction);
+				Write<uint64_t>(p_instruction.GetArgument());
+			}
+
+			void VisitInstructionWithValues(ast::InstructionWithValues const &p_instruction) override
+			{
+				Header(Kind::VALUES, p_instruction);
+				Write<uint8_t>(static_cast<uint8_t>(p_instruction.GetOperandType()));
+				Write<uint32_t>(p_instruction.GetValues().size());
+				for (int64_t l_value : p_instruction.GetValues())
+				{
+					Write<int64_t>(l_value);
+				}
+			}
+
+			void VisitInstructionWithFile(ast::InstructionWithFile const &p_instruction) override
+			{
+				Header(Kind::FILE, p_instruction);
+				Write<uint8_t>(static_cast<uint8_t>(p_instruction.GetOperandType()));
+				WriteString(p_instruction.GetPath());
+			}
+
+			void VisitInstructionWithLabel(ast::InstructionWithLabel const &p_instruction) override
+			{
+				Header(Kind::LABEL, p_instruction);
+				WriteString(p_instruction.GetLabel());
+			}
+
+			void VisitInstructionWithEffect(ast::InstructionWithEffect const &p_instruction) override
+			{
+				Header(Kind::EFFECT, p_instruction);
+				WriteString(p_instruction.GetLabel());
+				Write<uint8_t>(p_instruction.GetEffect().has_value());
+				if (p_instruction.GetEffect())
+				{
+					WriteTypes(p_instruction.GetEffect()->m_inputs);
+					WriteTypes(p_instruction.GetEffect()->m_outputs);
+				}
+			}
+
+			// A body shared by several instructions, like the uses of a macro, is stored once
+			void VisitInstructionWithBlock(ast::InstructionWithBlock const &p_instruction) override
+			{
+				Header(Kind::BLOCK, p_instruction);
+				Write<uint64_t>(p_instruction.GetCount());
+
+				auto const l_body = m_bodies.find(&p_instruction.GetBody());
+
+				Write<uint8_t>(l_body != m_bodies.end());
+				if (l_body != m_bodies.end())
+				{
+					Write<uint32_t>(l_body->second);
+					return;
+				}
+				m_bodies.emplace(&p_instruction.GetBody(), m_bodies.size());
+				WriteProgram(p_instruction.GetBody());
+			}
+
+		private:
+			void Header(Kind p_kind, ast::Instruction const &p_instruction)
+			{
+				Write<uint8_t>(static_cast<uint8_t>(p_kind));
+				Write<uint8_t>(static_cast<uint8_t>(p_instruction.GetType()));
+				Write<int32_t>(p_instruction.GetLine());
+			}
+
+			void WriteToken(Token const &p_token)
+			{
+				Write<uint32_t>(p_token.m_type);
+				WriteString(p_token.m_lexeme);
+				Write<uint8_t>(p_token.m_literal.has_value());
+				if (p_token.m_literal)
+				{
+					WriteString(*p_token.m_literal);
+				}
+				Write<int32_t>(p_token.m_line);
+			}
+
+			void WriteTypes(Vector<eOperandType> const &p_types)
+			{
+				Write<uint32_t>(p_types.size());
+				for (eOperandType l_type : p_types)
+				{
+					Write<uint8_t>(static_cast<uint8_t>(l_type));
+				}
+			}
+
+		private:
+			String m_data;
+			UnorderedMap<ast::Program const *, uint32_t> m_bodies;
+		};
+
+		// Reads what Writer wrote, throws ModuleError on anything else
+		class Reader
+		{
+		public:
+			Reader(unsigned char const *p_data, size_t p_size) : m_data(p_data), m_size(p_size)
+			{
+			}
+
+			template <typename T>
+			T Read()
+			{
+				T l_value;
+
+				std::memcpy(&l_value, Take(sizeof(T)), sizeof(T));
+				return l_value;
+			}
+
+			String ReadString()
+			{
+				uint32_t const l_size = Read<uint32_t>();
+
+				return String(reinterpret_cast<char const *>(Take(l_size)), l_size);
+			}
+
+			UniquePtr<ast::Program> ReadProgram()
+			{
+				auto l_program = MakeUnique<ast::Program>();
+
+				for (uint32_t l_count = Read<uint32_t>(); l_count > 0; l_count--)
+				{
+					l_program->AddInstruction(ReadInstruction());
+				}
+				return l_program;
+			}
+
+			bool IsAtEnd() const
+			{
+				return m_offset == m_size;
+			}
+
+		private:
+			unsigned char const *Take(size_t p_size)
+			{
+				if (m_size - m_offset < p_size)
+				{
+					throw ModuleError("Truncated module");
+				}
+				m_offset += p_size;
+				return m_data + m_offset - p_size;
+			}
+
+			UniquePtr<ast::Instruction const> ReadInstruction()
+			{
+				Kind const l_kind = static_cast<Kind>(Read<uint8_t>());
+				uint8_t const l_type = Read<uint8_t>();
+				int const l_line = Read<int32_t>();
+
+				// The last instruction type
+				if (l_type > static_cast<uint8_t>(ast::Instruction::Type::STACKCOUNT))
+				{
+					throw ModuleError("Unknown instruction");
+				}
+
+				ast::Instruction::Type const l_instructionType = static_cast<ast::Instruction::Type>(l_type);
+
+				switch (l_kind)
+				{
+					case Kind::PLAIN:
+						return MakeUnique<ast::Instruction>(l_instructionType, l_line);
+					case Kind::VALUE:
+					{
+						Token const l_operandType = ReadToken();
+						Token const l_number = ReadToken();
+
+						return MakeUnique<ast::InstructionWithValue>(l_instructionType,
+							MakeUnique<ast::Value const>(l_operandType, l_number), l_line);
+					}
+					case Kind::ARGUMENT:
+						return MakeUnique<ast::InstructionWithArgument>(l_instructionType, Read<uint64_t>(), l_line);
+					case Kind::VALUES:
+					{
+						eOperandType const l_operandType = ReadType();
+						auto l_values = MakeShared<Vector<int64_t>>(Read<uint32_t>());
+
+						for (int64_t &l_value : *l_values)
+						{
+							l_value = Read<int64_t>();
+						}
+						return MakeUnique<ast::InstructionWithValues>(l_operandType, std::move(l_values), l_line);
+					}
+					case Kind::FILE:
+					{
+						eOperandType const l_operandType = ReadType();
+
+						return MakeUnique<ast::InstructionWithFile>(l_operandType, ReadString(), l_line);
+					}
+					case Kind::LABEL:
+						return MakeUnique<ast::InstructionWithLabel>(l_instructionType, ReadString(), l_line);
+					case Kind::EFFECT:
+					{
+						String l_name = ReadString();
+						Optional<ast::StackEffect> l_effect;
+
+						if (Read<uint8_t>())
+						{
+							l_effect = ast::StackEffect{ ReadTypes(), {} };
+							l_effect->m_outputs = ReadTypes();
+						}
+						return MakeUnique<ast::InstructionWithEffect>(std::move(l_name), std::move(l_effect), l_line);
+					}
+					case Kind::BLOCK:
+						return ReadBlock(l_instructionType, l_line);
+					default:
+						throw ModuleError("Unknown instruction");
+				}
+			}
+
+			UniquePtr<ast::Instruction const> ReadBlock(ast::Instruction::Type p_type, int p_line)
+			{
+				uint64_t const l_count = Read<uint64_t>();
+
+				if (Read<uint8_t>())
+				{
+					uint32_t const l_index = Read<uint32_t>();
+
+					if (l_index >= m_bodies.size() || !m_bodies[l_index])
+					{
+						throw ModuleError("Unknown block");
+					}
+					return MakeUnique<ast::InstructionWithBlock>(p_type, l_count, m_bodies[l_index], p_line);
+				}
+
+				// Numbered before the blocks it holds, like Writer does
+				size_t const l_index = m_bodies.size();
+
+				m_bodies.emplace_back(nullptr);
+				m_bodies[l_index] = ReadProgram();
+				return MakeUnique<ast::InstructionWithBlock>(p_type, l_count, m_bodies[l_index], p_line);
+			}
+
+			Token ReadToken()
+			{
+				TokenType const l_type = static_cast<TokenType>(Read<uint32_t>());
+				String l_lexeme = ReadString();
+				Optional<String> l_literal;
+
+				if (Read<uint8_t>())
+				{
+					l_literal = ReadString();
+				}
+				return Token(l_type, std::move(l_lexeme), std::move(l_literal), Read<int32_t>());
+			}
+
+			eOperandType ReadType()
+			{
+				uint8_t const l_type = Read<uint8_t>();
+
+				if (l_type > static_cast<uint8_t>(eOperandType::DOUBLE))
+				{
+					throw ModuleError("Unknown type");
+				}
+				return static_cast<eOperandType>(l_type);
+			}
+
+			Vector<eOperandType> ReadTypes()
+			{
+				Vector<eOperandType> l_types(Read<uint32_t>());
+
+				for (eOperandType &l_type : l_types)
+				{
+					l_type = ReadType();
+				}
+				return l_types;
+			}
+
+		private:
+			unsigned char const *m_data;
+			size_t m_size;
+			size_t m_offset = 0;
+			Vector<SharedPtr<ast::Program const>> m_bodies;
+		};
+
+		String ReadSource(String const &p_path)
+		{
+			MappedFile const l_file(p_path);
+
+			return String(reinterpret_cast<char const *>(l_file.GetData()), l_file.GetSize());
+		}
+	}
+
+	ModuleCache::ModuleCache(String p_directory) : m_directory(std::move(p_directory))
+	{
+	}
+
+	SharedPtr<ast::Program const> ModuleCache::Get(String const &p_path)
+	{
+		String l_source;
+
+		try
+		{
+			l_source = ReadSource(p_path);
+		}
+		catch (FileError const &l_e)
+		{
+			throw ModuleError(l_e.what());
+		}
+
+		uint64_t const l_hash = Hash(l_source);
+		// The includes of the module are resolved next to it
+		uint64_t const l_key = Hash(l_source, Hash(p_path.substr(0, p_path.rfind('/') + 1)));
+
+		for (auto const &l_compiling : m_compiling)
+		{
+			if (l_compiling.first == l_key)
+			{
+				throw ModuleError("Module includes itself");
+			}
+		}
+
+		auto l_module = m_modules.find(l_key);
+
+		if (l_module == m_modules.end())
+		{
+			SharedPtr<Module const> l_compiled = m_directory ? Load(l_key) : nullptr;
+
+			if (!l_compiled)
+			{
+				l_compiled = Compile(p_path, l_source, l_key);
+				if (l_compiled && m_directory)
+				{
+					Store(l_key, *l_compiled);
+				}
+			}
+			l_module = m_modules.emplace(l_key, std::move(l_compiled)).first;
+		}
+		if (!l_module->second)
+		{
+			throw ModuleError("Module has errors");
+		}
+
+		// The module being compiled depends on this one and on what it includes
+		if (!m_compiling.empty())
+		{
+			Vector<Dependency> &l_dependencies = m_compiling.back().second;
+
+			l_dependencies.push_back({ p_path, l_hash });
+			l_dependencies.insert(l_dependencies.end(), l_module->second->m_dependencies.begin(),
+				l_module->second->m_dependencies.end());
+		}
+		return l_module->second->m_body;
+	}
+
+	size_t ModuleCache::GetCompiledCount() const
+	{
+		return m_compiled;
+	}
+
+	uint64_t ModuleCache::Hash(StringView p_data, uint64_t p_seed)
+	{
+		uint64_t l_hash = p_seed;
+
+		for (char l_c : p_data)
+		{
+			l_hash ^= static_cast<unsigned char>(l_c);
+			l_hash *= 0x100000001b3;
+		}
+		return l_hash;
+	}
+
+	SharedPtr<ModuleCache::Module const> ModuleCache::Compile(String const &p_path, StringView p_source, uint64_t p_key)
+	{
+		Lexer l_lexer;
+		UniquePtr<ast::Program> l_body;
+
+		m_compiled++;
+		m_compiling.emplace_back(p_key, Vector<Dependency>());
+		try
+		{
+			l_lexer.Run(p_source, p_path);
+			if (!l_lexer.HadError())
+			{
+				l_body = Parser(l_lexer, l_lexer.GetTokens(), this).Run();
+			}
+		}
+		catch (...)
+		{
+			m_compiling.pop_back();
+			throw;
+		}
+
+		auto l_module = MakeShared<Module>();
+
+		l_module->m_dependencies = std::move(m_compiling.back().second);
+		m_compiling.pop_back();
+
+		if (l_body == nullptr)
+		{
+			return nullptr;
+		}
+		for (auto const &l_instruction : l_body->GetInstructions())
+		{
+			ast::Instruction::Type const l_type = l_instruction->GetType();
+
+			if (l_type == ast::Instruction::Type::LABEL || ast::Instruction::IsJump(l_type)
+				|| ast::Instruction::IsRoutine(l_type))
+			{
+				l_lexer.Report(l_instruction->GetLine(), fmt::format(" at '{}'", l_instruction->GetName()),
+					"Expected no label, jump nor routine in a module");
+			}
+		}
+		if (l_lexer.HadError())
+		{
+			return nullptr;
+		}
+		l_module->m_body = std::move(l_body);
+		return l_module;
+	}
+
+	// Stored module, or nullptr when it is missing, stale or unreadable
+	SharedPtr<ModuleCache::Module const> ModuleCache::Load(uint64_t p_key) const
+	{
+		try
+		{
+			MappedFile const l_file(GetFile(p_key));
+			Reader l_reader(l_file.GetData(), l_file.GetSize());
+			auto l_module = MakeShared<Module>();
+
+			for (char l_c : s_magic)
+			{
+				if (l_reader.Read<char>() != l_c)
+				{
+					return nullptr;
+				}
+			}
+			if (l_reader.Read<uint32_t>() != s_version || l_reader.Read<uint64_t>() != p_key)
+			{
+				return nullptr;
+			}
+			for (uint32_t l_count = l_reader.Read<uint32_t>(); l_count > 0; l_count--)
+			{
+				String l_path = l_reader.ReadString();
+				uint64_t const l_hash = l_reader.Read<uint64_t>();
+
+				if (Hash(ReadSource(l_path)) != l_hash)
+				{
+					return nullptr;
+				}
+				l_module->m_dependencies.push_back({ std::move(l_path), l_hash });
+			}
+			l_module->m_body = l_reader.ReadProgram();
+			return l_reader.IsAtEnd() ? l_module : nullptr;
+		}
+		catch (FileError const &)
+		{
+			return nullptr;
+		}
+		catch (ModuleError const &)
+		{
+			return nullptr;
+		}
+	}
+
+	// Best effort: the module is only compiled again when it cannot be stored
+	void ModuleCache::Store(uint64_t p_key, Module const &p_module) const
+	{
+		Writer l_writer;
+
+		for (char l_c : s_magic)
+		{
+			l_writer.Write<char>(l_c);
+		}
+		l_writer.Write<uint32_t>(s_version);
+		l_writer.Write<uint64_t>(p_key);
+		l_writer.Write<uint32_t>(p_module.m_dependencies.size());
+		for (Dependency const &l_dependency : p_module.m_dependencies)
+		{
+			l_writer.WriteString(l_dependency.m_path);
+			l_writer.Write<uint64_t>(l_dependency.m_hash);
+		}
+		l_writer.WriteProgram(*p_module.m_body);
+
+		// Written aside then renamed, so concurrent runs never read half a module
+		String const l_file = GetFile(p_key);
+		String const l_temporary = fmt::format("{}.{:x}", l_file,
+			std::chrono::steady_clock::now().time_since_epoch().count());
+		std::ofstream l_stream(l_temporary, std::ios::binary);
+
+		l_stream.write(l_writer.GetData().data(), l_writer.GetData().size());
+		l_stream.close();
+		if (!l_stream || std::rename(l_temporary.c_str(), l_file.c_str()) != 0)
+		{
+			std::remove(l_temporary.c_str());
+		}
+	}
+
+	String ModuleCache::GetFile(uint64_t p_key) const
+	{
+		return fmt::format("{}/{:016x}.avmc", *m_directory, p_key);
+	}
+
+	// Exceptions
+	// ==========
+
+	ModuleError::ModuleError(String p_message) : std::runtime_error("Module Error"), m_message(std::move(p_message))
+	{
+	}
+
+	char const *ModuleError::what() const noexcept
+	{
+		return m_message.c_str();
+	}
+}
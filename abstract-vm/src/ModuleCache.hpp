@@ -0,0 +1,74 @@
+#pragma once
+#include "abstractvm.hpp"
+#include "ast/Instruction.hpp"
+
+namespace avm {
+
+	class ModuleError : public std::runtime_error
+	{
+	public:
+		ModuleError(String p_message);
+
+		char const *what() const noexcept override;
+
+	private:
+		String m_message;
+	};
+
+	/*
+	 * Modules named by "include", each lexed, parsed and checked once: the
+	 * compiled body is kept for the lifetime of the cache, so every program
+	 * of a batch shares it. With a directory, compiled modules are also
+	 * stored there, keyed by a hash of their source, and reused by the next
+	 * runs while the modules they include are unchanged.
+	 *
+	 * A module runs in place of its include like a macro does, so it holds
+	 * neither labels, jumps nor routines, and its macros stay private.
+	 */
+	class ModuleCache
+	{
+	public:
+		ModuleCache() = default;
+		explicit ModuleCache(String p_directory);
+		ModuleCache(const ModuleCache &) = delete;
+		~ModuleCache() = default;
+
+		ModuleCache &operator=(const ModuleCache &) = delete;
+
+		// Throws ModuleError when the module cannot be read or has errors
+		SharedPtr<ast::Program const> Get(String const &p_path);
+
+		// Modules lexed and parsed so far, the others came from a cache
+		size_t GetCompiledCount() const;
+
+		// FNV-1a, stable across runs and hosts
+		static uint64_t Hash(StringView p_data, uint64_t p_seed = 0xcbf29ce484222325);
+
+	private:
+		struct Dependency
+		{
+			String m_path;
+			uint64_t m_hash;
+		};
+
+		struct Module
+		{
+			SharedPtr<ast::Program const> m_body;
+			// Modules it includes, directly or not, with the hash of their source
+			Vector<Dependency> m_dependencies;
+		};
+
+		SharedPtr<Module const> Compile(String const &p_path, StringView p_source, uint64_t p_key);
+		SharedPtr<Module const> Load(uint64_t p_key) const;
+		void Store(uint64_t p_key, Module const &p_module) const;
+		String GetFile(uint64_t p_key) const;
+
+	private:
+		Optional<String> m_directory;
+		// By hash of the source and of where its includes are resolved, nullptr for modules with errors
+		UnorderedMap<uint64_t, SharedPtr<Module const>> m_modules;
+		// Modules being compiled, the innermost last, with what they included so far
+		Vector<Pair<uint64_t, Vector<Dependency>>> m_compiling;
+		size_t m_compiled = 0;
+	};
+}
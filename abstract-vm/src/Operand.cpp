@@ -1,4 +1,5 @@
 #include "Operand.hpp"
+#include "Format.hpp"
 
 namespace avm {
 
@@ -12,31 +13,41 @@ namespace avm {
 	template <>
 	Operand<int>::Operand(int p_value, eOperandType p_type) : m_value(p_value), m_type(p_type)
 	{
-		m_valueStr = fmt::format("{}", p_value);
+		char l_buffer[s_formatSize];
+
+		m_valueStr.assign(l_buffer, FormatInteger(p_value, l_buffer));
 	}
 
 	template <>
 	Operand<int16_t>::Operand(short p_value, eOperandType p_type) : m_value(p_value), m_type(p_type)
 	{
-		m_valueStr = fmt::format("{}", p_value);
+		char l_buffer[s_formatSize];
+
+		m_valueStr.assign(l_buffer, FormatInteger(p_value, l_buffer));
 	}
 
 	template <>
 	Operand<float>::Operand(float p_value, eOperandType p_type) : m_value(p_value), m_type(p_type)
 	{
-		m_valueStr = fmt::format("{:.2f}", p_value);
+		char l_buffer[s_formatSize];
+
+		m_valueStr.assign(l_buffer, FormatFloat(p_value, l_buffer));
 	}
 
 	template <>
 	Operand<double>::Operand(double p_value, eOperandType p_type) : m_value(p_value), m_type(p_type)
 	{
-		m_valueStr = fmt::format("{:.2}", p_value);
+		char l_buffer[s_formatSize];
+
+		m_valueStr.assign(l_buffer, FormatDouble(p_value, l_buffer));
 	}
 
 	template <>
 	Operand<int8_t>::Operand(int8_t p_value, eOperandType p_type) : m_value(p_value), m_type(p_type)
 	{
-		m_valueStr = fmt::format("{}", (int)p_value);
+		char l_buffer[s_formatSize];
+
+		m_valueStr.assign(l_buffer, FormatInteger(p_value, l_buffer));
 	}
 
 	template <typename T>
@@ -75,7 +86,7 @@ namespace avm {
 		if (rhs.getPrecision() > getPrecision())
 			return rhs + *this;
 
-		return new Operand<T>(std::stod(toString()) + std::stod(rhs.toString()), m_type);
+		return UncheckedAdd(rhs);
 	}
 
 	template <typename T>
@@ -90,7 +101,7 @@ namespace avm {
 			return *l_lhs - rhs;
 		}
 
-		return new Operand<T>(std::stod(toString()) - std::stod(rhs.toString()), m_type);
+		return UncheckedSub(rhs);
 	}
 
 	template <typename T>
@@ -101,7 +112,7 @@ namespace avm {
 		if (rhs.getPrecision() > getPrecision())
 			return rhs * *this;
 
-		return new Operand<T>(std::stod(toString()) * std::stod(rhs.toString()), m_type);
+		return UncheckedMul(rhs);
 	}
 
 	template <typename T>
@@ -120,7 +131,7 @@ namespace avm {
 
 		ThrowIfOverflowUnderflowDiv(rhs);
 
-		return new Operand<T>(std::stod(toString()) / std::stod(rhs.toString()), m_type);
+		return UncheckedDiv(rhs);
 	}
 
 	template <typename T>
@@ -135,6 +146,63 @@ namespace avm {
 			return *l_lhs % rhs;
 		}
 
+		return UncheckedMod(rhs);
+	}
+
+	template <typename T>
+	IOperand const *Operand<T>::UncheckedAdd(IOperand const &rhs) const
+	{
+		if (rhs.getPrecision() > getPrecision())
+			return dynamic_cast<OperandBase const &>(rhs).UncheckedAdd(*this);
+
+		return new Operand<T>(std::stod(toString()) + std::stod(rhs.toString()), m_type);
+	}
+
+	template <typename T>
+	IOperand const *Operand<T>::UncheckedSub(IOperand const &rhs) const
+	{
+		if (rhs.getPrecision() > getPrecision())
+		{
+			OperandBase const &l_rhsBase = dynamic_cast<OperandBase const &>(rhs);
+			UniquePtr<IOperand const> l_lhs(l_rhsBase.From(toString()));
+			return dynamic_cast<OperandBase const &>(*l_lhs).UncheckedSub(rhs);
+		}
+
+		return new Operand<T>(std::stod(toString()) - std::stod(rhs.toString()), m_type);
+	}
+
+	template <typename T>
+	IOperand const *Operand<T>::UncheckedMul(IOperand const &rhs) const
+	{
+		if (rhs.getPrecision() > getPrecision())
+			return dynamic_cast<OperandBase const &>(rhs).UncheckedMul(*this);
+
+		return new Operand<T>(std::stod(toString()) * std::stod(rhs.toString()), m_type);
+	}
+
+	template <typename T>
+	IOperand const *Operand<T>::UncheckedDiv(IOperand const &rhs) const
+	{
+		if (rhs.getPrecision() > getPrecision())
+		{
+			OperandBase const &l_rhsBase = dynamic_cast<OperandBase const &>(rhs);
+			UniquePtr<IOperand const> l_lhs(l_rhsBase.From(toString()));
+			return dynamic_cast<OperandBase const &>(*l_lhs).UncheckedDiv(rhs);
+		}
+
+		return new Operand<T>(std::stod(toString()) / std::stod(rhs.toString()), m_type);
+	}
+
+	template <typename T>
+	IOperand const *Operand<T>::UncheckedMod(IOperand const &rhs) const
+	{
+		if (rhs.getPrecision() > getPrecision())
+		{
+			OperandBase const &l_rhsBase = dynamic_cast<OperandBase const &>(rhs);
+			UniquePtr<IOperand const> l_lhs(l_rhsBase.From(toString()));
+			return dynamic_cast<OperandBase const &>(*l_lhs).UncheckedMod(rhs);
+		}
+
 		return new Operand<T>(fmod(std::stod(toString()), std::stod(rhs.toString())), m_type);
 	}
 
@@ -156,6 +224,12 @@ namespace avm {
 		return new Operand<T>(std::stod(p_value), m_type);
 	}
 
+	template <typename T>
+	double Operand<T>::ToDouble() const
+	{
+		return static_cast<double>(m_value);
+	}
+
 	template <typename T>
 	constexpr T Operand<T>::MinLimit() const
 	{
@@ -233,6 +307,15 @@ namespace avm {
 		}
 	}
 
+	// GetValue() is called from other translation units: instantiate every
+	// operand type here instead of relying on the implicit instantiations,
+	// which the optimizer inlines away
+	template class Operand<int8_t>;
+	template class Operand<int16_t>;
+	template class Operand<int32_t>;
+	template class Operand<float>;
+	template class Operand<double>;
+
 	DivisionByZero::DivisionByZero() : std::runtime_error("Division by zero")
 	{
 	}
@@ -11,6 +11,18 @@ namespace avm {
 	public:
 		virtual ~OperandBase() = default;
 		virtual IOperand const *From(String p_value) const = 0;
+		virtual double ToDouble() const = 0;
+
+		/*
+		 * Same results as the arithmetic operators, minus the overflow,
+		 * underflow and division by zero checks. Only call these once the
+		 * operation is known not to fault (see analysis::IntervalAnalysis).
+		 */
+		virtual IOperand const *UncheckedAdd(IOperand const &rhs) const = 0;
+		virtual IOperand const *UncheckedSub(IOperand const &rhs) const = 0;
+		virtual IOperand const *UncheckedMul(IOperand const &rhs) const = 0;
+		virtual IOperand const *UncheckedDiv(IOperand const &rhs) const = 0;
+		virtual IOperand const *UncheckedMod(IOperand const &rhs) const = 0;
 	};
 
 	template <typename T>
@@ -36,6 +48,13 @@ namespace avm {
 
 		std::string const &toString() const override;
 		IOperand const *From(String p_value) const override;
+		double ToDouble() const override;
+
+		IOperand const *UncheckedAdd(IOperand const &rhs) const override;
+		IOperand const *UncheckedSub(IOperand const &rhs) const override;
+		IOperand const *UncheckedMul(IOperand const &rhs) const override;
+		IOperand const *UncheckedDiv(IOperand const &rhs) const override;
+		IOperand const *UncheckedMod(IOperand const &rhs) const override;
 
 		constexpr T MinLimit() const;
 		constexpr T MaxLimit() const;
@@ -49,6 +49,29 @@ namespace avm {
 		*/
 	}
 
+	/*
+	 * Rebuilds an operand from a value that already went through one of the
+	 * Create* functions (or an arithmetic operator), so no range check here.
+	 */
+	IOperand const *OperandFactory::CreateOperand(eOperandType p_type, double p_value) const
+	{
+		switch (p_type)
+		{
+			case eOperandType::INT8:
+				return new Operand<int8_t>(static_cast<int8_t>(p_value), p_type);
+			case eOperandType::INT16:
+				return new Operand<int16_t>(static_cast<int16_t>(p_value), p_type);
+			case eOperandType::INT32:
+				return new Operand<int32_t>(static_cast<int32_t>(p_value), p_type);
+			case eOperandType::FLOAT:
+				return new Operand<float>(static_cast<float>(p_value), p_type);
+			case eOperandType::DOUBLE:
+				return new Operand<double>(p_value, p_type);
+		}
+
+		throw std::runtime_error("Unreachable!");
+	}
+
 	IOperand const *OperandFactory::CreateInt8(String const &p_value) const
 	{
 		int l_res = 0;
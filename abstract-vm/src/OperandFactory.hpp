@@ -12,6 +12,7 @@ namespace avm {
 		static OperandFactory &Get();
 
 		IOperand const *CreateOperand(eOperandType p_type, String const &p_value) const;
+		IOperand const *CreateOperand(eOperandType p_type, double p_value) const;
 
 	private:
 		IOperand const *CreateInt8(String const &p_value) const;
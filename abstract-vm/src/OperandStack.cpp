@@ -0,0 +1,1128 @@
+#include "OperandStack.hpp"
+#include "Arithmetic.hpp"
+#include "Format.hpp"
+#include "Interpreter.hpp"
+#include "Operand.hpp"
+#include "dataflow/WorkStealingPool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <thread>
+#include <tuple>
+
+namespace avm {
+
+	using Type = ast::Instruction::Type;
+
+	namespace {
+
+		template <typename T>
+		T ReadLittleEndian(unsigned char const *p_data)
+		{
+			T l_value;
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+			unsigned char l_bytes[sizeof(T)];
+
+			std::reverse_copy(p_data, p_data + sizeof(T), l_bytes);
+			std::memcpy(&l_value, l_bytes, sizeof(T));
+#else
+			std::memcpy(&l_value, p_data, sizeof(T));
+#endif
+			return l_value;
+		}
+
+		template <typename T>
+		void WidenIntegers(unsigned char const *p_data, size_t p_count, simd::Payload *p_payloads)
+		{
+			for (size_t l_i = 0; l_i < p_count; l_i++)
+			{
+				p_payloads[l_i].m_integer = ReadLittleEndian<T>(p_data + l_i * sizeof(T));
+			}
+		}
+
+		template <typename T>
+		Optional<size_t> WidenReals(unsigned char const *p_data, size_t p_count, simd::Payload *p_payloads)
+		{
+			for (size_t l_i = 0; l_i < p_count; l_i++)
+			{
+				p_payloads[l_i].m_real = ReadLittleEndian<T>(p_data + l_i * sizeof(T));
+			}
+			for (size_t l_i = 0; l_i < p_count; l_i++)
+			{
+				if (!std::isfinite(p_payloads[l_i].m_real))
+				{
+					return l_i;
+				}
+			}
+			return NullOpt;
+		}
+
+		// Range of the values of a type, as double
+		Pair<double, double> GetLimits(eOperandType p_type)
+		{
+			switch (p_type)
+			{
+				case eOperandType::INT8:
+					return { std::numeric_limits<int8_t>::min(), std::numeric_limits<int8_t>::max() };
+				case eOperandType::INT16:
+					return { std::numeric_limits<int16_t>::min(), std::numeric_limits<int16_t>::max() };
+				case eOperandType::INT32:
+					return { std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max() };
+				case eOperandType::FLOAT:
+					return { -std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+				case eOperandType::DOUBLE:
+					return { -std::numeric_limits<double>::max(), std::numeric_limits<double>::max() };
+			}
+			throw std::runtime_error("Unreachable!");
+		}
+
+		// Position of a slot in the sorted order: its value, then its type, then where it was
+		struct SortEntry
+		{
+			uint64_t m_key;
+			size_t m_index;
+			uint8_t m_type;
+		};
+
+		bool operator<(SortEntry const &p_lhs, SortEntry const &p_rhs)
+		{
+			return std::tie(p_lhs.m_key, p_lhs.m_type, p_lhs.m_index) < std::tie(p_rhs.m_key, p_rhs.m_type, p_rhs.m_index);
+		}
+
+		// Maps the value to an unsigned integer of the same order, -0.0 and 0.0 alike
+		uint64_t SortKey(double p_value)
+		{
+			double const l_value = p_value + 0.0;
+			uint64_t l_bits;
+
+			std::memcpy(&l_bits, &l_value, sizeof(l_bits));
+			return (l_bits >> 63) ? ~l_bits : l_bits | (uint64_t(1) << 63);
+		}
+
+		/*
+		 * One pass of a stable counting sort on one byte of the entries, from
+		 * p_from into p_to. A byte shared by every entry leaves the order as
+		 * it is, so the pass is skipped and false returned.
+		 */
+		template <typename Digit>
+		bool RadixPass(SortEntry const *p_from, SortEntry *p_to, size_t p_count, Digit p_digit)
+		{
+			Array<size_t, 256> l_offsets {};
+
+			for (size_t l_i = 0; l_i < p_count; l_i++)
+			{
+				l_offsets[p_digit(p_from[l_i])]++;
+			}
+			if (std::find(l_offsets.begin(), l_offsets.end(), p_count) != l_offsets.end())
+			{
+				return false;
+			}
+
+			size_t l_offset = 0;
+
+			for (size_t &l_bucket : l_offsets)
+			{
+				l_offset += l_bucket;
+				l_bucket = l_offset - l_bucket;
+			}
+			for (size_t l_i = 0; l_i < p_count; l_i++)
+			{
+				p_to[l_offsets[p_digit(p_from[l_i])]++] = p_from[l_i];
+			}
+			return true;
+		}
+
+		// LSD radix sort of entries in position order: the type first, then the key from its lowest byte
+		void RadixSort(SortEntry *p_entries, SortEntry *p_buffer, size_t p_count)
+		{
+			SortEntry *l_from = p_entries;
+			SortEntry *l_to = p_buffer;
+
+			if (RadixPass(l_from, l_to, p_count, [] (SortEntry const &p_entry) { return p_entry.m_type; }))
+			{
+				std::swap(l_from, l_to);
+			}
+			for (unsigned l_shift = 0; l_shift < 64; l_shift += 8)
+			{
+				if (RadixPass(l_from, l_to, p_count,
+					[l_shift] (SortEntry const &p_entry) { return (p_entry.m_key >> l_shift) & 0xff; }))
+				{
+					std::swap(l_from, l_to);
+				}
+			}
+			if (l_from != p_entries)
+			{
+				std::copy(l_from, l_from + p_count, p_entries);
+			}
+		}
+
+		/*
+		 * Radix sorts one chunk per thread, then merges neighbouring chunks
+		 * in rounds. Every entry has its own position, so the result does not
+		 * depend on the number of threads.
+		 */
+		void ParallelSort(Vector<SortEntry> &p_entries)
+		{
+			size_t const l_count = p_entries.size();
+			size_t const l_threads = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(),
+				l_count / (OperandStack::s_parallelSort / 4)));
+			Vector<SortEntry> l_buffer(l_count);
+			Vector<size_t> l_bounds;
+			dataflow::WorkStealingPool l_pool(l_threads);
+
+			for (size_t l_chunk = 0; l_chunk <= l_threads; l_chunk++)
+			{
+				l_bounds.push_back(l_count * l_chunk / l_threads);
+			}
+			for (size_t l_chunk = 0; l_chunk < l_threads; l_chunk++)
+			{
+				SortEntry *const l_entries = p_entries.data() + l_bounds[l_chunk];
+				SortEntry *const l_chunkBuffer = l_buffer.data() + l_bounds[l_chunk];
+				size_t const l_size = l_bounds[l_chunk + 1] - l_bounds[l_chunk];
+
+				l_pool.Submit([l_entries, l_chunkBuffer, l_size] () { RadixSort(l_entries, l_chunkBuffer, l_size); });
+			}
+			l_pool.Wait();
+
+			while (l_bounds.size() > 2)
+			{
+				Vector<size_t> l_merged;
+
+				for (size_t l_chunk = 0; l_chunk + 1 < l_bounds.size(); l_chunk += 2)
+				{
+					size_t const l_begin = l_bounds[l_chunk];
+					size_t const l_middle = l_bounds[l_chunk + 1];
+					size_t const l_end = l_chunk + 2 < l_bounds.size() ? l_bounds[l_chunk + 2] : l_middle;
+					SortEntry const *const l_entries = p_entries.data();
+					SortEntry *const l_merge = l_buffer.data();
+
+					l_pool.Submit([l_entries, l_merge, l_begin, l_middle, l_end] () {
+						std::merge(l_entries + l_begin, l_entries + l_middle, l_entries + l_middle, l_entries + l_end,
+							l_merge + l_begin);
+					});
+					l_merged.push_back(l_begin);
+				}
+				l_merged.push_back(l_count);
+				l_pool.Wait();
+				p_entries.swap(l_buffer);
+				l_bounds = std::move(l_merged);
+			}
+		}
+	}
+
+	size_t OperandStack::Size() const
+	{
+		return m_size;
+	}
+
+	bool OperandStack::Empty() const
+	{
+		return m_size == 0;
+	}
+
+	void OperandStack::Reserve(size_t p_capacity)
+	{
+		if (p_capacity > s_maxCapacity)
+		{
+			throw StackOverflowError(fmt::format("Stack capacity above {} values", s_maxCapacity));
+		}
+
+		size_t const l_segments = (p_capacity + s_segmentSize - 1) / s_segmentSize;
+
+		try
+		{
+			m_segments.reserve(l_segments);
+			while (m_segments.size() < l_segments)
+			{
+				AddSegment();
+			}
+		}
+		catch (std::bad_alloc const &)
+		{
+			throw StackOverflowError(fmt::format("Cannot reserve {} values", p_capacity));
+		}
+		m_reserved = std::max(m_reserved, l_segments);
+	}
+
+	void OperandStack::SetCapacity(size_t p_capacity)
+	{
+		Reserve(p_capacity);
+		if (Size() > p_capacity)
+		{
+			throw StackOverflowError(fmt::format("Stack overflow: {} values, above a capacity of {}", Size(), p_capacity));
+		}
+		m_capacity = p_capacity;
+	}
+
+	Optional<size_t> OperandStack::GetCapacity() const
+	{
+		return m_capacity;
+	}
+
+	void OperandStack::SetStorage(SegmentStorage p_storage)
+	{
+		if (!Empty())
+		{
+			throw std::runtime_error("The storage of the stack is set while it is empty");
+		}
+
+		size_t const l_reserved = m_segments.size();
+
+		while (!m_segments.empty())
+		{
+			m_segments.pop_back();
+			m_blocks.Unmap();
+		}
+		m_blocks.SetStorage(std::move(p_storage));
+		m_spilled = 0;
+		while (m_segments.size() < l_reserved)
+		{
+			AddSegment();
+		}
+	}
+
+	// Keeps the type and payload only, like the bulk pushes: the operand is built again on demand
+	void OperandStack::Push(UniquePtr<IOperand const> p_operand)
+	{
+		eOperandType const l_type = p_operand->getType();
+		double const l_value = dynamic_cast<OperandBase const &>(*p_operand).ToDouble();
+		Payload l_payload;
+
+		if (IsInteger(l_type))
+		{
+			l_payload.m_integer = static_cast<int64_t>(l_value);
+		}
+		else
+		{
+			l_payload.m_real = l_value;
+		}
+		Push(l_type, l_payload);
+	}
+
+	void OperandStack::Push(eOperandType p_type, Payload p_payload)
+	{
+		CheckCapacity(1);
+
+		size_t const l_index = Grow(1);
+
+		TypeAt(l_index) = static_cast<uint8_t>(p_type);
+		PayloadAt(l_index) = p_payload;
+		Track();
+	}
+
+	void OperandStack::Append(eOperandType p_type, Vector<int64_t> const &p_values)
+	{
+		static_assert(sizeof(Payload) == sizeof(int64_t), "Integer payloads are copied as they are");
+
+		CheckCapacity(p_values.size());
+
+		size_t const l_size = Grow(p_values.size());
+
+		for (size_t l_index = l_size; l_index < Size(); l_index += GetRun(l_index))
+		{
+			size_t const l_run = std::min(GetRun(l_index), Size() - l_index);
+
+			std::memcpy(&PayloadAt(l_index), &p_values[l_index - l_size], l_run * sizeof(Payload));
+			std::memset(&TypeAt(l_index), static_cast<uint8_t>(p_type), l_run);
+		}
+		Track();
+	}
+
+	Optional<size_t> OperandStack::AppendRaw(eOperandType p_type, unsigned char const *p_data, size_t p_count)
+	{
+		CheckCapacity(p_count);
+
+		size_t const l_size = Grow(p_count);
+		size_t const l_rawSize = GetRawSize(p_type);
+
+		for (size_t l_index = l_size; l_index < Size(); l_index += GetRun(l_index))
+		{
+			size_t const l_run = std::min(GetRun(l_index), Size() - l_index);
+			unsigned char const *const l_data = p_data + (l_index - l_size) * l_rawSize;
+			Payload *const l_payloads = &PayloadAt(l_index);
+			Optional<size_t> l_invalid = NullOpt;
+
+			switch (p_type)
+			{
+				case eOperandType::INT8:
+					WidenIntegers<int8_t>(l_data, l_run, l_payloads);
+					break;
+				case eOperandType::INT16:
+					WidenIntegers<int16_t>(l_data, l_run, l_payloads);
+					break;
+				case eOperandType::INT32:
+					WidenIntegers<int32_t>(l_data, l_run, l_payloads);
+					break;
+				case eOperandType::FLOAT:
+					l_invalid = WidenReals<float>(l_data, l_run, l_payloads);
+					break;
+				case eOperandType::DOUBLE:
+					l_invalid = WidenReals<double>(l_data, l_run, l_payloads);
+					break;
+			}
+
+			if (l_invalid)
+			{
+				Resize(l_size);
+				return l_index - l_size + *l_invalid;
+			}
+			std::memset(&TypeAt(l_index), static_cast<uint8_t>(p_type), l_run);
+		}
+		Track();
+		return NullOpt;
+	}
+
+	size_t OperandStack::GetRawSize(eOperandType p_type)
+	{
+		static const UnorderedMap<eOperandType, size_t> l_sizes {
+			{ eOperandType::INT8,   sizeof(int8_t)  },
+			{ eOperandType::INT16,  sizeof(int16_t) },
+			{ eOperandType::INT32,  sizeof(int32_t) },
+			{ eOperandType::FLOAT,  sizeof(float)   },
+			{ eOperandType::DOUBLE, sizeof(double)  },
+		};
+
+		return l_sizes.at(p_type);
+	}
+
+	UniquePtr<IOperand const> OperandStack::Pop()
+	{
+		if (Empty())
+		{
+			throw EmptyStackError();
+		}
+
+		UniquePtr<IOperand const> l_operand = TakeOperand(Size() - 1);
+
+		if (!l_operand)
+		{
+			l_operand = Materialize(Size() - 1);
+		}
+
+		Drop();
+		return l_operand;
+	}
+
+	OperandStack::Slot OperandStack::PopSlot()
+	{
+		if (Empty())
+		{
+			throw EmptyStackError();
+		}
+
+		Slot l_slot { GetType(Size() - 1), PayloadAt(Size() - 1), TakeOperand(Size() - 1) };
+
+		Drop();
+		return l_slot;
+	}
+
+	void OperandStack::Drop(size_t p_count)
+	{
+		if (p_count > Size())
+		{
+			throw EmptyStackError();
+		}
+
+		Resize(Size() - p_count);
+	}
+
+	eOperandType OperandStack::GetType(size_t p_index) const
+	{
+		return static_cast<eOperandType>(TypeAt(p_index));
+	}
+
+	OperandStack::Payload OperandStack::GetPayload(size_t p_index) const
+	{
+		return PayloadAt(p_index);
+	}
+
+	IOperand const &OperandStack::At(size_t p_index) const
+	{
+		UniquePtr<IOperand const> &l_operand = OperandAt(p_index);
+
+		if (!l_operand)
+		{
+			l_operand = Materialize(p_index);
+		}
+		return *l_operand;
+	}
+
+	char *OperandStack::Format(size_t p_index, char *p_out) const
+	{
+		Payload const l_payload = PayloadAt(p_index);
+
+		switch (GetType(p_index))
+		{
+			case eOperandType::INT8:
+			case eOperandType::INT16:
+			case eOperandType::INT32:
+				return FormatInteger(l_payload.m_integer, p_out);
+			case eOperandType::FLOAT:
+				return FormatFloat(static_cast<float>(l_payload.m_real), p_out);
+			case eOperandType::DOUBLE:
+				return FormatDouble(l_payload.m_real, p_out);
+		}
+		throw std::runtime_error("Unreachable!");
+	}
+
+	IOperand const &OperandStack::Top() const
+	{
+		if (Empty())
+		{
+			throw EmptyStackError();
+		}
+		return At(Size() - 1);
+	}
+
+	void OperandStack::Reduce(Type p_type, size_t p_count)
+	{
+		size_t const l_count = p_count == 0 ? Size() : p_count;
+
+		if (l_count == 0 || l_count > Size())
+		{
+			throw EmptyStackError();
+		}
+
+		size_t const l_begin = Size() - l_count;
+		UniquePtr<IOperand const> l_result = nullptr;
+
+		switch (p_type)
+		{
+			case Type::SUM:
+			case Type::PROD:
+				l_result = Fold(p_type, l_begin);
+				break;
+			case Type::MIN:
+			case Type::MAX:
+				l_result = Extreme(p_type, l_begin);
+				break;
+			case Type::MEAN:
+			{
+				UniquePtr<IOperand const> l_sum = Fold(Type::SUM, l_begin);
+				double const l_total = dynamic_cast<OperandBase const &>(*l_sum).ToDouble();
+
+				l_result.reset(OperandFactory::Get().CreateOperand(l_sum->getType(), IsInteger(l_sum->getType())
+					? static_cast<double>(static_cast<int64_t>(l_total) / static_cast<int64_t>(l_count))
+					: l_total / static_cast<double>(l_count)));
+				break;
+			}
+			default:
+				throw std::runtime_error("Unreachable!");
+		}
+
+		Drop(l_count);
+		Push(std::move(l_result));
+		Trim(l_begin);
+	}
+
+	void OperandStack::Dup()
+	{
+		if (Size() < 1)
+		{
+			throw EmptyStackError();
+		}
+		Copy(Size() - 1);
+	}
+
+	void OperandStack::Swap()
+	{
+		Rotate(2);
+	}
+
+	void OperandStack::Over()
+	{
+		if (Size() < 2)
+		{
+			throw EmptyStackError();
+		}
+		Copy(Size() - 2);
+	}
+
+	void OperandStack::Rot()
+	{
+		Rotate(3);
+	}
+
+	void OperandStack::Compare(ast::Instruction::Type p_type)
+	{
+		if (Size() < 2)
+		{
+			throw EmptyStackError();
+		}
+
+		int const l_order = Order(Size() - 2, Size() - 1);
+		bool l_holds = false;
+
+		switch (p_type)
+		{
+			case ast::Instruction::Type::EQ: l_holds = l_order == 0; break;
+			case ast::Instruction::Type::NE: l_holds = l_order != 0; break;
+			case ast::Instruction::Type::LT: l_holds = l_order < 0;  break;
+			case ast::Instruction::Type::LE: l_holds = l_order <= 0; break;
+			case ast::Instruction::Type::GT: l_holds = l_order > 0;  break;
+			case ast::Instruction::Type::GE: l_holds = l_order >= 0; break;
+			default:
+				throw std::runtime_error("Unreachable!");
+		}
+
+		Drop(2);
+
+		Payload l_result;
+		l_result.m_integer = l_holds;
+		Push(eOperandType::INT8, l_result);
+	}
+
+	bool OperandStack::PopZero()
+	{
+		if (Empty())
+		{
+			throw EmptyStackError();
+		}
+
+		size_t const l_top = Size() - 1;
+		bool const l_zero = IsInteger(GetType(l_top))
+			? PayloadAt(l_top).m_integer == 0 : PayloadAt(l_top).m_real == 0.0;
+
+		Drop();
+		return l_zero;
+	}
+
+	void OperandStack::Sort(size_t p_count)
+	{
+		size_t const l_count = p_count == 0 ? Size() : p_count;
+
+		if (l_count > Size())
+		{
+			throw EmptyStackError();
+		}
+
+		size_t const l_begin = Size() - l_count;
+		Vector<SortEntry> l_entries(l_count);
+
+		for (size_t l_i = 0; l_i < l_count; l_i++)
+		{
+			eOperandType const l_type = GetType(l_begin + l_i);
+			Payload const l_payload = PayloadAt(l_begin + l_i);
+
+			l_entries[l_i] = { SortKey(IsInteger(l_type) ? static_cast<double>(l_payload.m_integer) : l_payload.m_real),
+				l_i, static_cast<uint8_t>(l_type) };
+		}
+
+		if (l_count <= s_parallelSort)
+		{
+			std::sort(l_entries.begin(), l_entries.end());
+		}
+		else
+		{
+			ParallelSort(l_entries);
+		}
+
+		Vector<Payload> l_payloads(l_count);
+		Vector<UniquePtr<IOperand const>> l_operands(l_count);
+
+		Untrack(l_begin);
+
+		for (size_t l_i = 0; l_i < l_count; l_i++)
+		{
+			l_payloads[l_i] = PayloadAt(l_begin + l_entries[l_i].m_index);
+			l_operands[l_i] = TakeOperand(l_begin + l_entries[l_i].m_index);
+		}
+		for (size_t l_i = 0; l_i < l_count; l_i++)
+		{
+			TypeAt(l_begin + l_i) = l_entries[l_i].m_type;
+			PayloadAt(l_begin + l_i) = l_payloads[l_i];
+			PutOperand(l_begin + l_i, std::move(l_operands[l_i]));
+		}
+		Track();
+		Trim(l_begin);
+	}
+
+	void OperandStack::Query(Type p_type)
+	{
+		if (p_type == Type::STACKCOUNT)
+		{
+			Payload l_count;
+
+			if (Size() > static_cast<size_t>(std::numeric_limits<int32_t>::max()))
+			{
+				throw std::overflow_error(fmt::format("Stack count > {}", std::numeric_limits<int32_t>::max()));
+			}
+			l_count.m_integer = static_cast<int64_t>(Size());
+			Push(eOperandType::INT32, l_count);
+			return;
+		}
+		if (Empty())
+		{
+			throw EmptyStackError();
+		}
+
+		TrackAggregates();
+
+		// Most precise type on the stack
+		eOperandType l_type = eOperandType::DOUBLE;
+		double l_value = 0.0;
+
+		while (m_types[static_cast<size_t>(l_type)] == 0)
+		{
+			l_type = static_cast<eOperandType>(static_cast<size_t>(l_type) - 1);
+		}
+
+		switch (p_type)
+		{
+			case Type::STACKMIN:
+			case Type::STACKMAX:
+			{
+				size_t const l_index = p_type == Type::STACKMIN ? m_minimums.back() : m_maximums.back();
+
+				l_value = IsInteger(GetType(l_index)) ? PayloadAt(l_index).m_integer : PayloadAt(l_index).m_real;
+				break;
+			}
+			case Type::STACKSUM:
+			{
+				Pair<double, double> const l_limits = GetLimits(l_type);
+				auto l_limit = [l_type] (double p_limit) {
+					return IsInteger(l_type) ? fmt::format("{}", static_cast<int64_t>(p_limit)) : fmt::format("{}", p_limit);
+				};
+
+				l_value = static_cast<double>(m_integers) + (m_reals.empty() ? 0.0 : m_reals.back());
+				if (l_value < l_limits.first)
+				{
+					throw std::underflow_error(fmt::format("Sum of the stack < {}", l_limit(l_limits.first)));
+				}
+				if (!(l_value <= l_limits.second))
+				{
+					throw std::overflow_error(fmt::format("Sum of the stack > {}", l_limit(l_limits.second)));
+				}
+				break;
+			}
+			default:
+				throw std::runtime_error("Unreachable!");
+		}
+
+		Push(UniquePtr<IOperand const>(OperandFactory::Get().CreateOperand(l_type, l_value)));
+	}
+
+	void OperandStack::TrackAggregates()
+	{
+		if (m_tracking)
+		{
+			return;
+		}
+		m_tracking = true;
+		Track();
+		Trim(0);
+	}
+
+	bool OperandStack::IsInteger(eOperandType p_type)
+	{
+		return p_type < eOperandType::FLOAT;
+	}
+
+	// Sign of lhs - rhs: integers are compared exactly, mixed types as double
+	int OperandStack::Order(size_t p_lhs, size_t p_rhs) const
+	{
+		if (IsInteger(GetType(p_lhs)) && IsInteger(GetType(p_rhs)))
+		{
+			int64_t const l_a = PayloadAt(p_lhs).m_integer;
+			int64_t const l_b = PayloadAt(p_rhs).m_integer;
+
+			return (l_a > l_b) - (l_a < l_b);
+		}
+
+		double const l_a = IsInteger(GetType(p_lhs)) ? PayloadAt(p_lhs).m_integer : PayloadAt(p_lhs).m_real;
+		double const l_b = IsInteger(GetType(p_rhs)) ? PayloadAt(p_rhs).m_integer : PayloadAt(p_rhs).m_real;
+
+		return (l_a > l_b) - (l_a < l_b);
+	}
+
+	void OperandStack::CheckCapacity(size_t p_count) const
+	{
+		if (m_capacity && p_count > *m_capacity - Size())
+		{
+			throw StackOverflowError(fmt::format("Stack overflow: capacity of {} reached", *m_capacity));
+		}
+	}
+
+	uint8_t &OperandStack::TypeAt(size_t p_index) const
+	{
+		return m_segments[p_index / s_segmentSize].m_types[p_index % s_segmentSize];
+	}
+
+	OperandStack::Payload &OperandStack::PayloadAt(size_t p_index) const
+	{
+		return m_segments[p_index / s_segmentSize].m_payloads[p_index % s_segmentSize];
+	}
+
+	UniquePtr<IOperand const> &OperandStack::OperandAt(size_t p_index) const
+	{
+		Segment const &l_segment = m_segments[p_index / s_segmentSize];
+
+		if (!l_segment.m_operands)
+		{
+			l_segment.m_operands.reset(new UniquePtr<IOperand const>[s_segmentSize]());
+		}
+		return l_segment.m_operands[p_index % s_segmentSize];
+	}
+
+	// Null when the segment has no operand objects
+	UniquePtr<IOperand const> *OperandStack::FindOperand(size_t p_index) const
+	{
+		Segment const &l_segment = m_segments[p_index / s_segmentSize];
+
+		return l_segment.m_operands ? &l_segment.m_operands[p_index % s_segmentSize] : nullptr;
+	}
+
+	UniquePtr<IOperand const> OperandStack::TakeOperand(size_t p_index)
+	{
+		UniquePtr<IOperand const> *const l_operand = FindOperand(p_index);
+
+		return l_operand ? std::move(*l_operand) : nullptr;
+	}
+
+	void OperandStack::PutOperand(size_t p_index, UniquePtr<IOperand const> p_operand)
+	{
+		if (p_operand || FindOperand(p_index))
+		{
+			OperandAt(p_index) = std::move(p_operand);
+		}
+	}
+
+	size_t OperandStack::GetRun(size_t p_index)
+	{
+		return s_segmentSize - p_index % s_segmentSize;
+	}
+
+	// Adds p_count slots on top, to be written by the caller, and returns the first one
+	size_t OperandStack::Grow(size_t p_count)
+	{
+		size_t const l_size = m_size;
+
+		while (m_segments.size() * s_segmentSize < l_size + p_count)
+		{
+			AddSegment();
+		}
+		m_size += p_count;
+		Trim(m_size);
+		return l_size;
+	}
+
+	/*
+	 * Shrinks the stack, dropping the operand objects of the slots that
+	 * leave it. One segment is kept past the top, or the reserved ones, so
+	 * a stack going up and down across a boundary does not map it again.
+	 */
+	void OperandStack::Resize(size_t p_size)
+	{
+		Untrack(p_size);
+		for (size_t l_index = p_size; l_index < m_size; l_index += GetRun(l_index))
+		{
+			Segment const &l_segment = m_segments[l_index / s_segmentSize];
+
+			if (l_segment.m_operands)
+			{
+				size_t const l_offset = l_index % s_segmentSize;
+				size_t const l_end = std::min(s_segmentSize, l_offset + (m_size - l_index));
+
+				std::fill(&l_segment.m_operands[l_offset], &l_segment.m_operands[l_end], nullptr);
+			}
+		}
+		m_size = p_size;
+
+		size_t const l_kept = std::max(m_reserved, (m_size + s_segmentSize - 1) / s_segmentSize + 1);
+
+		while (m_segments.size() > l_kept)
+		{
+			m_segments.pop_back();
+			m_blocks.Unmap();
+		}
+		m_spilled = std::min(m_spilled, GetColdSegments());
+	}
+
+	void OperandStack::AddSegment()
+	{
+		unsigned char *const l_block = m_blocks.Map();
+
+		m_segments.push_back({ reinterpret_cast<Payload *>(l_block),
+			reinterpret_cast<uint8_t *>(l_block + s_segmentSize * sizeof(Payload)), nullptr });
+	}
+
+	// Segments below the ones the resident budget keeps, at least the two top ones
+	size_t OperandStack::GetColdSegments() const
+	{
+		size_t const l_budget = m_blocks.GetStorage().m_residentBudget;
+
+		if (l_budget == 0 || m_size == 0)
+		{
+			return 0;
+		}
+
+		size_t const l_resident = std::max<size_t>(2, l_budget / s_blockSize);
+		size_t const l_used = (m_size - 1) / s_segmentSize + 1;
+
+		return l_used > l_resident ? l_used - l_resident : 0;
+	}
+
+	// Spills the cold segments, again from p_touched when slots above it were read or written
+	void OperandStack::Trim(size_t p_touched)
+	{
+		size_t const l_cold = GetColdSegments();
+
+		m_spilled = std::min(m_spilled, p_touched / s_segmentSize);
+		for (; m_spilled < l_cold; m_spilled++)
+		{
+			m_blocks.Spill(m_spilled);
+		}
+	}
+
+	// Adds the slots above the ones counted to the aggregates, when they are tracked
+	void OperandStack::Track()
+	{
+		if (!m_tracking)
+		{
+			return;
+		}
+
+		for (; m_tracked < Size(); m_tracked++)
+		{
+			size_t const l_index = m_tracked;
+			eOperandType const l_type = GetType(l_index);
+
+			// Equal values keep the lower slot, as a scan from the bottom would
+			if (m_minimums.empty() || Order(l_index, m_minimums.back()) < 0)
+			{
+				m_minimums.push_back(l_index);
+			}
+			if (m_maximums.empty() || Order(l_index, m_maximums.back()) > 0)
+			{
+				m_maximums.push_back(l_index);
+			}
+
+			// Integers are at most 32 bits wide, their sum is exact up to 2^32 values
+			if (IsInteger(l_type))
+			{
+				m_integers += PayloadAt(l_index).m_integer;
+			}
+			else
+			{
+				m_reals.push_back((m_reals.empty() ? 0.0 : m_reals.back()) + PayloadAt(l_index).m_real);
+			}
+			m_types[static_cast<size_t>(l_type)]++;
+		}
+	}
+
+	// Takes the slots from p_size up out of the aggregates, while their values are still there
+	void OperandStack::Untrack(size_t p_size)
+	{
+		for (; m_tracked > p_size; m_tracked--)
+		{
+			size_t const l_index = m_tracked - 1;
+			eOperandType const l_type = GetType(l_index);
+
+			if (m_minimums.back() == l_index)
+			{
+				m_minimums.pop_back();
+			}
+			if (m_maximums.back() == l_index)
+			{
+				m_maximums.pop_back();
+			}
+
+			if (IsInteger(l_type))
+			{
+				m_integers -= PayloadAt(l_index).m_integer;
+			}
+			else
+			{
+				m_reals.pop_back();
+			}
+			m_types[static_cast<size_t>(l_type)]--;
+		}
+	}
+
+	UniquePtr<IOperand const> OperandStack::Materialize(size_t p_index) const
+	{
+		Payload const l_payload = PayloadAt(p_index);
+		eOperandType const l_type = GetType(p_index);
+
+		return UniquePtr<IOperand const>(OperandFactory::Get().CreateOperand(l_type,
+			IsInteger(l_type) ? static_cast<double>(l_payload.m_integer) : l_payload.m_real));
+	}
+
+	void OperandStack::Copy(size_t p_index)
+	{
+		uint8_t const l_type = TypeAt(p_index);
+		Payload const l_payload = PayloadAt(p_index);
+
+		CheckCapacity(1);
+
+		size_t const l_index = Grow(1);
+
+		TypeAt(l_index) = l_type;
+		PayloadAt(l_index) = l_payload;
+		Track();
+	}
+
+	// Brings the p_count-th value from the top to the top, moving the operand objects along
+	void OperandStack::Rotate(size_t p_count)
+	{
+		if (Size() < p_count)
+		{
+			throw EmptyStackError();
+		}
+
+		size_t const l_first = Size() - p_count;
+		uint8_t const l_type = TypeAt(l_first);
+		Payload const l_payload = PayloadAt(l_first);
+		UniquePtr<IOperand const> l_operand = TakeOperand(l_first);
+
+		Untrack(l_first);
+		for (size_t l_index = l_first; l_index + 1 < Size(); l_index++)
+		{
+			TypeAt(l_index) = TypeAt(l_index + 1);
+			PayloadAt(l_index) = PayloadAt(l_index + 1);
+			PutOperand(l_index, TakeOperand(l_index + 1));
+		}
+		TypeAt(Size() - 1) = l_type;
+		PayloadAt(Size() - 1) = l_payload;
+		PutOperand(Size() - 1, std::move(l_operand));
+		Track();
+	}
+
+	UniquePtr<IOperand const> OperandStack::Fold(Type p_type, size_t p_begin) const
+	{
+		Type const l_operation = p_type == Type::SUM ? Type::ADD : Type::MUL;
+		size_t l_index = Size() - 1;
+
+		// Integer accumulator, until a floating point value shows up
+		eOperandType l_type = GetType(l_index);
+		int64_t l_integer = IsInteger(l_type) ? PayloadAt(l_index).m_integer : 0;
+		UniquePtr<IOperand const> l_operand = IsInteger(l_type) ? nullptr : Materialize(l_index);
+
+		auto l_box = [] (eOperandType p_boxType, int64_t p_value) {
+			return UniquePtr<IOperand const>(OperandFactory::Get().CreateOperand(p_boxType, static_cast<double>(p_value)));
+		};
+
+		while (l_index > p_begin)
+		{
+			if (l_operand)
+			{
+				l_index--;
+				UniquePtr<IOperand const> l_lhs = Materialize(l_index);
+				l_operand.reset(Apply(l_operation, *l_lhs, *l_operand));
+				continue;
+			}
+
+			eOperandType const l_runType = GetType(l_index - 1);
+
+			if (!IsInteger(l_runType))
+			{
+				l_operand = l_box(l_type, l_integer);
+				continue;
+			}
+
+			// Homogeneous run of integers within one segment: [l_start, l_index)
+			size_t l_start = l_index - 1;
+			while (l_start > p_begin && l_start % s_segmentSize != 0 && TypeAt(l_start - 1) == TypeAt(l_index - 1))
+			{
+				l_start--;
+			}
+
+			int64_t l_min = std::numeric_limits<int32_t>::min();
+			int64_t l_max = std::numeric_limits<int32_t>::max();
+
+			if (l_runType == eOperandType::INT8)
+			{
+				l_min = std::numeric_limits<int8_t>::min();
+				l_max = std::numeric_limits<int8_t>::max();
+			}
+			else if (l_runType == eOperandType::INT16)
+			{
+				l_min = std::numeric_limits<int16_t>::min();
+				l_max = std::numeric_limits<int16_t>::max();
+			}
+
+			if (l_operation == Type::ADD)
+			{
+				// Every partial sum lies between these bounds
+				simd::Sums const l_sums = simd::SumIntegers(&PayloadAt(l_start), l_index - l_start);
+
+				if (l_integer + l_sums.m_positive <= l_max && l_integer + l_sums.m_negative >= l_min)
+				{
+					l_integer += l_sums.m_sum;
+					l_type = std::max(l_type, l_runType);
+					l_index = l_start;
+					continue;
+				}
+			}
+
+			// Value by value, raising the fault of the first failing step
+			for (; l_index > l_start; l_index--)
+			{
+				int64_t const l_lhs = PayloadAt(l_index - 1).m_integer;
+				int64_t const l_result = l_operation == Type::ADD ? l_lhs + l_integer : l_lhs * l_integer;
+
+				if (l_result < l_min || l_result > l_max)
+				{
+					UniquePtr<IOperand const> l_faulting = Materialize(l_index - 1);
+					UniquePtr<IOperand const> l_rhs = l_box(l_type, l_integer);
+					UniquePtr<IOperand const> l_unreachable(Apply(l_operation, *l_faulting, *l_rhs));
+
+					throw std::runtime_error("Unreachable!");
+				}
+				l_integer = l_result;
+				l_type = std::max(l_type, l_runType);
+			}
+		}
+
+		return l_operand ? std::move(l_operand) : l_box(l_type, l_integer);
+	}
+
+	UniquePtr<IOperand const> OperandStack::Extreme(Type p_type, size_t p_begin) const
+	{
+		bool const l_min = p_type == Type::MIN;
+		eOperandType l_type = GetType(p_begin);
+		double l_extreme = 0.0;
+		bool l_first = true;
+		size_t l_index = p_begin;
+
+		while (l_index < Size())
+		{
+			eOperandType const l_runType = GetType(l_index);
+			size_t l_end = l_index + 1;
+
+			// Runs stop at the end of a segment
+			while (l_end < Size() && l_end % s_segmentSize != 0 && TypeAt(l_end) == TypeAt(l_index))
+			{
+				l_end++;
+			}
+
+			double l_run = 0.0;
+
+			if (IsInteger(l_runType))
+			{
+				l_run = static_cast<double>(l_min
+					? simd::MinInteger(&PayloadAt(l_index), l_end - l_index)
+					: simd::MaxInteger(&PayloadAt(l_index), l_end - l_index));
+			}
+			else
+			{
+				l_run = l_min
+					? simd::MinReal(&PayloadAt(l_index), l_end - l_index)
+					: simd::MaxReal(&PayloadAt(l_index), l_end - l_index);
+			}
+
+			if (l_first || (l_min ? l_run < l_extreme : l_run > l_extreme))
+			{
+				l_extreme = l_run;
+				l_first = false;
+			}
+			l_type = std::max(l_type, l_runType);
+			l_index = l_end;
+		}
+
+		return UniquePtr<IOperand const>(OperandFactory::Get().CreateOperand(l_type, l_extreme));
+	}
+}
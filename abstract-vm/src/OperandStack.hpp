@@ -0,0 +1,222 @@
+#pragma once
+#include "IOperand.hpp"
+#include "SegmentMap.hpp"
+#include "ast/Instruction.hpp"
+#include "simd/Kernels.hpp"
+
+namespace avm {
+
+	/*
+	 * Operand stack stored as a structure of arrays: type tags and payloads
+	 * live in separate contiguous arrays, so bulk reductions run over plain
+	 * integers and doubles. Operand objects are only built when an
+	 * instruction asks for one, and kept until the value leaves the stack.
+	 *
+	 * The arrays are cut in segments of s_segmentSize values, each in a
+	 * block of its own SegmentMap: growing maps one more segment and never
+	 * copies the others. Runs handed to the kernels stop at the end of a
+	 * segment.
+	 *
+	 * Index 0 is the bottom of the stack.
+	 */
+	class OperandStack
+	{
+	public:
+		using Payload = simd::Payload;
+
+		// One value taken off the stack, see RegisterFile
+		struct Slot
+		{
+			eOperandType m_type;
+			Payload m_payload;
+			UniquePtr<IOperand const> m_operand;
+		};
+
+	public:
+		OperandStack() = default;
+		OperandStack(const OperandStack &) = delete;
+		~OperandStack() = default;
+
+		OperandStack &operator=(const OperandStack &) = delete;
+
+		size_t Size() const;
+		bool Empty() const;
+
+		/*
+		 * Reserves room for p_capacity values, so the stack is not moved
+		 * while it stays below that depth. SetCapacity() also makes it the
+		 * limit of the stack: a push past it throws StackOverflowError
+		 * instead of growing until memory runs out. Both throw it as well
+		 * above s_maxCapacity or when the memory cannot be reserved.
+		 */
+		void Reserve(size_t p_capacity);
+		void SetCapacity(size_t p_capacity);
+		Optional<size_t> GetCapacity() const;
+
+		static constexpr size_t s_maxCapacity = size_t(1) << 30;
+		static constexpr size_t s_segmentSize = size_t(1) << 16;
+
+		/*
+		 * Where the segments live, set while the stack is empty. With a
+		 * resident budget, the segments below the top ones that fit in it
+		 * are spilled as the stack grows; at least the two top segments
+		 * stay resident, so the values next to the top are never spilled.
+		 * A directory backs the segments with a file of its own, which lets
+		 * the stack grow past RAM and swap.
+		 */
+		void SetStorage(SegmentStorage p_storage);
+
+		// Only the type and payload of the operand are kept
+		void Push(UniquePtr<IOperand const> p_operand);
+		void Push(eOperandType p_type, Payload p_payload);
+		// Pushes integers of one type, the last one ending on top
+		void Append(eOperandType p_type, Vector<int64_t> const &p_values);
+
+		/*
+		 * Pushes p_count values stored as little-endian int8_t to int32_t,
+		 * float or double, in one pass that widens them to payloads. When a
+		 * floating point value is not finite, nothing is pushed and its
+		 * index is returned.
+		 */
+		Optional<size_t> AppendRaw(eOperandType p_type, unsigned char const *p_data, size_t p_count);
+
+		// Bytes per value in the layout read by AppendRaw
+		static size_t GetRawSize(eOperandType p_type);
+		UniquePtr<IOperand const> Pop();
+		Slot PopSlot();
+		void Drop(size_t p_count = 1);
+
+		eOperandType GetType(size_t p_index) const;
+		Payload GetPayload(size_t p_index) const;
+		IOperand const &At(size_t p_index) const;
+		// Writes the value as the toString() of its operand, without building it, see Format.hpp
+		char *Format(size_t p_index, char *p_out) const;
+		IOperand const &Top() const;
+
+		/*
+		 * Replaces the top p_count values (all of them when 0) with their
+		 * sum, product, minimum, maximum or mean.
+		 *
+		 * sum and prod give the same result and faults as the matching
+		 * sequence of add or mul: the values are folded from the top, each
+		 * partial result checked against the type of the value below. min
+		 * and max keep the extreme value, mean divides the sum by the count.
+		 * Both are promoted to the most precise type of the range.
+		 *
+		 * Homogeneous runs are reduced by the kernels of simd/Kernels.hpp;
+		 * floating point values go through the operand classes, whose
+		 * arithmetic works on the printed value.
+		 */
+		void Reduce(ast::Instruction::Type p_type, size_t p_count = 0);
+
+		/*
+		 * Stack manipulation, on the slots only. A copy shares the payload of
+		 * its source and gets its own operand object only once an
+		 * instruction asks for it.
+		 */
+		void Dup();  // a -- a a
+		void Swap(); // a b -- b a
+		void Over(); // a b -- a b a
+		void Rot();  // a b c -- b c a
+
+		/*
+		 * Replaces a b with int8(1) when "a <op> b" holds, int8(0)
+		 * otherwise. Integers are compared exactly, mixed types as double.
+		 */
+		void Compare(ast::Instruction::Type p_type);
+
+		// Pops the top value, true when it is zero (jz and jnz)
+		bool PopZero();
+
+		/*
+		 * Orders the top p_count values (all of them when 0), the greatest
+		 * ending on top. Values keep their type and are compared like
+		 * Compare() does; equal values go from the least to the most precise
+		 * type, then keep their order. Only the slots move.
+		 *
+		 * Up to s_parallelSort values, the slots are ordered by std::sort;
+		 * above, chunks are radix sorted on several threads and merged.
+		 */
+		void Sort(size_t p_count = 0);
+
+		static constexpr size_t s_parallelSort = 1 << 16;
+
+		/*
+		 * Pushes the minimum, maximum or sum of the whole stack, promoted to
+		 * its most precise type, or its number of values as an int32. The
+		 * values stay below the result. Unlike sum, the values are added
+		 * exactly and only the total is checked against its type.
+		 *
+		 * The aggregates are kept up to date on every push and pop once
+		 * tracking is on: monotonic stacks of the slots holding the minimum
+		 * and maximum so far, the running sum of the integers, the prefix
+		 * sums of the floating point values and a count per type. A query,
+		 * a push or a pop then costs O(1), a bulk push, a drop or a sort of
+		 * k values O(k). The first query turns tracking on if it is not yet,
+		 * in O(N) once; a stack that is never queried pays nothing.
+		 */
+		void Query(ast::Instruction::Type p_type);
+		// Turns the aggregates of Query() on, see Interpreter::Run()
+		void TrackAggregates();
+
+	private:
+		// Payloads then type tags of s_segmentSize slots, in one block of m_blocks
+		struct Segment
+		{
+			Payload *m_payloads;
+			uint8_t *m_types;
+			// Allocated when At() first builds an operand object in the segment
+			mutable UniquePtr<UniquePtr<IOperand const>[]> m_operands;
+		};
+
+		static constexpr size_t s_blockSize = s_segmentSize * (sizeof(Payload) + sizeof(uint8_t));
+
+		static bool IsInteger(eOperandType p_type);
+		int Order(size_t p_lhs, size_t p_rhs) const;
+		void CheckCapacity(size_t p_count) const;
+
+		uint8_t &TypeAt(size_t p_index) const;
+		Payload &PayloadAt(size_t p_index) const;
+		UniquePtr<IOperand const> &OperandAt(size_t p_index) const;
+		UniquePtr<IOperand const> *FindOperand(size_t p_index) const;
+		UniquePtr<IOperand const> TakeOperand(size_t p_index);
+		void PutOperand(size_t p_index, UniquePtr<IOperand const> p_operand);
+		// Slots from p_index to the end of its segment
+		static size_t GetRun(size_t p_index);
+
+		size_t Grow(size_t p_count);
+		void Resize(size_t p_size);
+		void AddSegment();
+		size_t GetColdSegments() const;
+		void Trim(size_t p_touched);
+
+		void Track();
+		void Untrack(size_t p_size);
+		UniquePtr<IOperand const> Materialize(size_t p_index) const;
+		void Copy(size_t p_index);
+		void Rotate(size_t p_count);
+
+		UniquePtr<IOperand const> Fold(ast::Instruction::Type p_type, size_t p_begin) const;
+		UniquePtr<IOperand const> Extreme(ast::Instruction::Type p_type, size_t p_begin) const;
+
+	private:
+		SegmentMap m_blocks { s_blockSize };
+		Vector<Segment> m_segments;
+		size_t m_size = 0;
+		// Segments mapped by Reserve(), kept when the stack shrinks
+		size_t m_reserved = 0;
+		// Segments spilled and not touched since
+		size_t m_spilled = 0;
+		Optional<size_t> m_capacity;
+		bool m_tracking = false;
+		// Slots counted in the aggregates, from the bottom
+		size_t m_tracked = 0;
+		// Slots where the minimum and the maximum so far change, the one of the stack on top
+		Vector<size_t> m_minimums;
+		Vector<size_t> m_maximums;
+		int64_t m_integers = 0;
+		// Sum of the floating point values up to each of them, added in stack order
+		Vector<double> m_reals;
+		Array<size_t, 5> m_types {};
+	};
+}
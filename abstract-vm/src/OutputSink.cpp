@@ -0,0 +1,118 @@
+#include "OutputSink.hpp"
+#include <fmt/format.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+# define AVM_HAS_WRITE 1
+# include <unistd.h>
+#else
+# define AVM_HAS_WRITE 0
+#endif
+
+namespace avm {
+
+	void OutputSink::Write(StringView p_text)
+	{
+		if (m_buffer.size() + p_text.size() > s_bufferSize)
+		{
+			Flush();
+			if (p_text.size() > s_bufferSize)
+			{
+				Emit(p_text.data(), p_text.size());
+				return;
+			}
+		}
+		if (m_buffer.capacity() < s_bufferSize)
+		{
+			m_buffer.reserve(s_bufferSize);
+		}
+		m_buffer.append(p_text.data(), p_text.size());
+	}
+
+	void OutputSink::Put(char p_character)
+	{
+		Write(StringView(&p_character, 1));
+	}
+
+	void OutputSink::Flush()
+	{
+		if (m_buffer.empty())
+		{
+			return;
+		}
+
+		// Emptied first: a failing Emit() does not write the same bytes twice
+		String l_buffer;
+
+		l_buffer.swap(m_buffer);
+		Emit(l_buffer.data(), l_buffer.size());
+		l_buffer.clear();
+		m_buffer.swap(l_buffer);
+	}
+
+	FileSink::FileSink(int p_fd) : m_fd(p_fd)
+	{
+	}
+
+	void FileSink::Emit(char const *p_data, size_t p_size)
+	{
+		// What stdio holds for the same file comes first
+		std::fflush(m_fd == 2 ? stderr : stdout);
+
+#if AVM_HAS_WRITE
+		while (p_size > 0)
+		{
+			ssize_t const l_written = write(m_fd, p_data, p_size);
+
+			if (l_written < 0 && errno == EINTR)
+			{
+				continue;
+			}
+			if (l_written < 0)
+			{
+				throw std::runtime_error(fmt::format("Cannot write the output: {}", std::strerror(errno)));
+			}
+			p_data += l_written;
+			p_size -= static_cast<size_t>(l_written);
+		}
+#else
+		std::FILE *const l_file = m_fd == 2 ? stderr : stdout;
+
+		if (std::fwrite(p_data, 1, p_size, l_file) != p_size || std::fflush(l_file) != 0)
+		{
+			throw std::runtime_error(fmt::format("Cannot write the output: {}", std::strerror(errno)));
+		}
+#endif
+	}
+
+	String const &MemorySink::GetOutput() const
+	{
+		return m_output;
+	}
+
+	void MemorySink::Clear()
+	{
+		m_output.clear();
+	}
+
+	void MemorySink::Emit(char const *p_data, size_t p_size)
+	{
+		m_output.append(p_data, p_size);
+	}
+
+	void NullSink::Emit(char const *, size_t)
+	{
+	}
+
+	CallbackSink::CallbackSink(std::function<void(StringView)> p_callback) : m_callback(std::move(p_callback))
+	{
+	}
+
+	void CallbackSink::Emit(char const *p_data, size_t p_size)
+	{
+		m_callback(StringView(p_data, p_size));
+	}
+}
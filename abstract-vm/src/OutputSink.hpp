@@ -0,0 +1,81 @@
+#pragma once
+#include "abstractvm.hpp"
+#include <functional>
+
+namespace avm {
+
+	/*
+	 * Destination of the output of a program. Writes gather in a buffer
+	 * of s_bufferSize bytes, handed to Emit() when it is full or on
+	 * Flush(); a write larger than the buffer goes through on its own.
+	 */
+	class OutputSink
+	{
+	public:
+		OutputSink() = default;
+		OutputSink(const OutputSink &) = delete;
+		virtual ~OutputSink() = default;
+
+		OutputSink &operator=(const OutputSink &) = delete;
+
+		void Write(StringView p_text);
+		void Put(char p_character);
+		void Flush();
+
+		static constexpr size_t s_bufferSize = size_t(1) << 20;
+
+	protected:
+		virtual void Emit(char const *p_data, size_t p_size) = 0;
+
+	private:
+		String m_buffer;
+	};
+
+	// Writes to a file descriptor with write(2), stdout by default
+	class FileSink : public OutputSink
+	{
+	public:
+		explicit FileSink(int p_fd = 1);
+
+	protected:
+		void Emit(char const *p_data, size_t p_size) override;
+
+	private:
+		int m_fd;
+	};
+
+	// Keeps the output in memory
+	class MemorySink : public OutputSink
+	{
+	public:
+		// The output up to the last flush
+		String const &GetOutput() const;
+		void Clear();
+
+	protected:
+		void Emit(char const *p_data, size_t p_size) override;
+
+	private:
+		String m_output;
+	};
+
+	// Discards the output
+	class NullSink : public OutputSink
+	{
+	protected:
+		void Emit(char const *p_data, size_t p_size) override;
+	};
+
+	// Hands each flushed chunk to a function
+	class CallbackSink : public OutputSink
+	{
+	public:
+		explicit CallbackSink(std::function<void(StringView)> p_callback);
+
+	protected:
+		void Emit(char const *p_data, size_t p_size) override;
+
+	private:
+		std::function<void(StringView)> m_callback;
+	};
+}
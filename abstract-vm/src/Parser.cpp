@@ -1,4 +1,7 @@
 #include "Parser.hpp"
+#include "RegisterFile.hpp"
+#include "simd/Integers.hpp"
+#include <limits>
 
 namespace avm {
 
@@ -11,13 +14,24 @@ namespace avm {
 		return "Parse Error";
 	}
 
-	Parser::Parser(Lexer &p_lexer, List<Token> p_tokens) : m_lexer(p_lexer), m_tokens(p_tokens), m_current(0)
+	Parser::Parser(Lexer &p_lexer, List<Token> p_tokens, ModuleCache *p_modules)
+		: m_lexer(p_lexer), m_tokens(p_tokens), m_current(0), m_modules(p_modules)
 	{
 	}
 
 	UniquePtr<ast::Program> Parser::Run()
 	{
-		return Program();
+		auto l_program = Program();
+
+		if (!m_routine.empty())
+		{
+			m_lexer.Error(m_tokens.back(), "Expected \"end\" after routine");
+			l_program->AddInstruction(MakeUnique<ast::Instruction>(ast::Instruction::Type::END, m_tokens.back().m_line));
+			m_routine.clear();
+		}
+		ResolveLabels(*l_program);
+		l_program->SetStackCapacity(m_lexer.GetStackCapacity());
+		return l_program;
 	}
 
 	UniquePtr<ast::Program> Parser::Program()
@@ -29,8 +43,13 @@ namespace avm {
 		{
 			try
 			{
-				l_current = Instruction();
-				if (l_current != nullptr)
+				while (Match<TokenType::NEWLINE>()) {}
+
+				if (Match<TokenType::MACRO>())
+				{
+					Macro();
+				}
+				else if ((l_current = Instruction()) != nullptr)
 				{
 					l_program->AddInstruction(std::move(l_current));
 				}
@@ -67,17 +86,24 @@ namespace avm {
 		if (Match<TokenType::PUSH>() || Match<TokenType::ASSERT>())
 		{
 			Token const &l_instruction = Previous();
+
+			// Bulk push: "push int32[1, 2, 3]"
+			if (l_instruction.m_type == TokenType::PUSH && !IsAtEnd(1) && At(m_current + 1).m_type == TokenType::ARRAY)
+			{
+				return Values(l_instruction);
+			}
+
 			UniquePtr<ast::Value const> l_value = Value();
 
 			if (l_value)
 			{
 				if (l_instruction.m_type == TokenType::PUSH)
 				{
-					return MakeUnique<ast::InstructionWithValue>(ast::Instruction::Type::PUSH, std::move(l_value));
+					return MakeUnique<ast::InstructionWithValue>(ast::Instruction::Type::PUSH, std::move(l_value), l_instruction.m_line);
 				}
 				else if (l_instruction.m_type == TokenType::ASSERT)
 				{
-					return MakeUnique<ast::InstructionWithValue>(ast::Instruction::Type::ASSERT, std::move(l_value));
+					return MakeUnique<ast::InstructionWithValue>(ast::Instruction::Type::ASSERT, std::move(l_value), l_instruction.m_line);
 				}
 				else
 				{
@@ -98,7 +124,21 @@ namespace avm {
 			TokenType::DIV,
 			TokenType::MOD,
 			TokenType::PRINT,
-			TokenType::EXIT>())
+			TokenType::EXIT,
+			TokenType::DUP,
+			TokenType::SWAP,
+			TokenType::OVER,
+			TokenType::ROT,
+			TokenType::EQ,
+			TokenType::NE,
+			TokenType::LT,
+			TokenType::LE,
+			TokenType::GT,
+			TokenType::GE,
+			TokenType::STACKMIN,
+			TokenType::STACKMAX,
+			TokenType::STACKSUM,
+			TokenType::STACKCOUNT>())
 		{
 			Token const &l_instruction = Previous();
 
@@ -114,6 +154,20 @@ namespace avm {
 				{ TokenType::MOD,   ast::Instruction::Type::MOD   },
 				{ TokenType::PRINT, ast::Instruction::Type::PRINT },
 				{ TokenType::EXIT,  ast::Instruction::Type::EXIT  },
+				{ TokenType::DUP,   ast::Instruction::Type::DUP   },
+				{ TokenType::SWAP,  ast::Instruction::Type::SWAP  },
+				{ TokenType::OVER,  ast::Instruction::Type::OVER  },
+				{ TokenType::ROT,   ast::Instruction::Type::ROT   },
+				{ TokenType::EQ,    ast::Instruction::Type::EQ    },
+				{ TokenType::NE,    ast::Instruction::Type::NE    },
+				{ TokenType::LT,    ast::Instruction::Type::LT    },
+				{ TokenType::LE,    ast::Instruction::Type::LE    },
+				{ TokenType::GT,    ast::Instruction::Type::GT    },
+				{ TokenType::GE,    ast::Instruction::Type::GE    },
+				{ TokenType::STACKMIN,   ast::Instruction::Type::STACKMIN   },
+				{ TokenType::STACKMAX,   ast::Instruction::Type::STACKMAX   },
+				{ TokenType::STACKSUM,   ast::Instruction::Type::STACKSUM   },
+				{ TokenType::STACKCOUNT, ast::Instruction::Type::STACKCOUNT },
 			};
 
 			if (l_lookUpTable.find(l_instruction.m_type) != l_lookUpTable.end())
@@ -130,9 +184,147 @@ namespace avm {
 				throw std::runtime_error("Unreachable!");
 			}
 
-			return MakeUnique<ast::Instruction>(l_type);
+			return MakeUnique<ast::Instruction>(l_type, l_instruction.m_line);
+		}
+		else if (Match<
+			TokenType::SUM,
+			TokenType::PROD,
+			TokenType::MIN,
+			TokenType::MAX,
+			TokenType::MEAN,
+			TokenType::SORT>())
+		{
+			Token const &l_instruction = Previous();
+
+			static const UnorderedMap<TokenType, ast::Instruction::Type> l_lookUpTable {
+				{ TokenType::SUM,  ast::Instruction::Type::SUM  },
+				{ TokenType::PROD, ast::Instruction::Type::PROD },
+				{ TokenType::MIN,  ast::Instruction::Type::MIN  },
+				{ TokenType::MAX,  ast::Instruction::Type::MAX  },
+				{ TokenType::MEAN, ast::Instruction::Type::MEAN },
+				{ TokenType::SORT, ast::Instruction::Type::SORT },
+			};
+
+			ast::Instruction::Type const l_type = l_lookUpTable.at(l_instruction.m_type);
+
+			// Works on the top N values, or the whole stack without a count
+			if (Match<TokenType::NUMBER>())
+			{
+				return MakeUnique<ast::InstructionWithArgument>(l_type, Count(Previous()), l_instruction.m_line);
+			}
+			return MakeUnique<ast::Instruction>(l_type, l_instruction.m_line);
+		}
+		else if (Match<TokenType::STORE, TokenType::LOAD>())
+		{
+			ast::Instruction::Type const l_type = Previous().m_type == TokenType::STORE
+				? ast::Instruction::Type::STORE : ast::Instruction::Type::LOAD;
+			int const l_line = Previous().m_line;
+
+			// Bulk push of a binary file: load int16 "samples.bin"
+			if (l_type == ast::Instruction::Type::LOAD && !Check(TokenType::REGISTER))
+			{
+				return File(l_line);
+			}
+
+			Token const l_register = Consume(TokenType::REGISTER, "Expected a register");
+
+			return MakeUnique<ast::InstructionWithArgument>(l_type, Register(l_register), l_line);
+		}
+		else if (Match<TokenType::INCLUDE>())
+		{
+			return Include(Previous().m_line);
+		}
+		else if (Match<TokenType::REPEAT>())
+		{
+			int const l_line = Previous().m_line;
+			size_t const l_count = Count(Consume(TokenType::NUMBER, "Expected a positive count"));
+
+			return MakeUnique<ast::InstructionWithBlock>(ast::Instruction::Type::REPEAT, l_count, Block(), l_line);
+		}
+		else if (Match<TokenType::IDENTIFIER>())
+		{
+			Token const &l_name = Previous();
+			auto const l_macro = m_macros.find(*l_name.m_literal);
+
+			// Defined by the lexer but not here: used in its own body
+			if (l_macro == m_macros.end())
+			{
+				throw Error(l_name, "Undefined macro");
+			}
+			return MakeUnique<ast::InstructionWithBlock>(ast::Instruction::Type::REPEAT, 1, l_macro->second, l_name.m_line);
+		}
+		else if (Match<TokenType::LABEL>())
+		{
+			Token const &l_label = Previous();
+
+			if (!m_labels.emplace(*l_label.m_literal, m_routine).second)
+			{
+				throw Error(l_label, "Label already defined");
+			}
+			return MakeUnique<ast::InstructionWithLabel>(ast::Instruction::Type::LABEL, *l_label.m_literal, l_label.m_line);
+		}
+		else if (Match<TokenType::DEF>())
+		{
+			int const l_line = Previous().m_line;
+
+			if (!m_routine.empty())
+			{
+				throw Error(Previous(), "Expected \"end\" before \"def\"");
+			}
+
+			Token const l_name = Consume(TokenType::IDENTIFIER, "Expected a routine name");
+
+			if (!m_routines.insert(*l_name.m_literal).second)
+			{
+				throw Error(l_name, "Routine already defined");
+			}
+
+			Optional<ast::StackEffect> l_effect;
+
+			if (Match<TokenType::LPAREN>())
+			{
+				l_effect = Effect();
+			}
+			m_routine = *l_name.m_literal;
+			return MakeUnique<ast::InstructionWithEffect>(*l_name.m_literal, std::move(l_effect), l_line);
 		}
+		else if (Match<TokenType::END, TokenType::RET>())
+		{
+			Token const &l_instruction = Previous();
+			bool const l_end = l_instruction.m_type == TokenType::END;
 
+			if (m_routine.empty())
+			{
+				throw Error(l_instruction, "Expected a routine");
+			}
+			if (l_end)
+			{
+				m_routine.clear();
+			}
+			return MakeUnique<ast::Instruction>(l_end ? ast::Instruction::Type::END : ast::Instruction::Type::RET,
+				l_instruction.m_line);
+		}
+		else if (Match<TokenType::CALL>())
+		{
+			int const l_line = Previous().m_line;
+			Token const l_name = Consume(TokenType::IDENTIFIER, "Expected a routine name");
+
+			return MakeUnique<ast::InstructionWithLabel>(ast::Instruction::Type::CALL, *l_name.m_literal, l_line);
+		}
+		else if (Match<TokenType::JMP, TokenType::JZ, TokenType::JNZ>())
+		{
+			static const UnorderedMap<TokenType, ast::Instruction::Type> l_lookUpTable {
+				{ TokenType::JMP, ast::Instruction::Type::JMP },
+				{ TokenType::JZ,  ast::Instruction::Type::JZ  },
+				{ TokenType::JNZ, ast::Instruction::Type::JNZ },
+			};
+
+			ast::Instruction::Type const l_type = l_lookUpTable.at(Previous().m_type);
+			int const l_line = Previous().m_line;
+			Token const l_label = Consume(TokenType::IDENTIFIER, "Expected a label");
+
+			return MakeUnique<ast::InstructionWithLabel>(l_type, *l_label.m_literal, l_line);
+		}
 
 		return nullptr;
 	}
@@ -160,6 +352,265 @@ namespace avm {
 		return nullptr;
 	}
 
+	UniquePtr<ast::Instruction const> Parser::Values(Token const &p_instruction)
+	{
+		static const UnorderedMap<TokenType, Pair<int64_t, int64_t>> l_ranges {
+			{ TokenType::INT8,  { std::numeric_limits<int8_t>::min(),  std::numeric_limits<int8_t>::max()  } },
+			{ TokenType::INT16, { std::numeric_limits<int16_t>::min(), std::numeric_limits<int16_t>::max() } },
+			{ TokenType::INT32, { std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max() } },
+		};
+
+		Token const l_type = Advance();
+		Token const l_array = Consume(TokenType::ARRAY, "Expected values");
+		auto const l_range = l_ranges.find(l_type.m_type);
+
+		if (l_range == l_ranges.end())
+		{
+			throw Error(l_type, "Expected an integer type");
+		}
+		if (l_array.m_values->empty())
+		{
+			throw Error(l_array, "Expected a number");
+		}
+		for (int64_t l_value : *l_array.m_values)
+		{
+			if (l_value < l_range->second.first || l_value > l_range->second.second)
+			{
+				// A saturated value is not the one in the source, leave it out
+				if (l_value <= -simd::s_saturated || l_value >= simd::s_saturated)
+				{
+					throw Error(l_array, "Value out of range");
+				}
+				throw Error(l_array, fmt::format("Value out of range: {}", l_value));
+			}
+		}
+
+		return MakeUnique<ast::InstructionWithValues>(*OperandType(l_type.m_type), l_array.m_values, p_instruction.m_line);
+	}
+
+	UniquePtr<ast::Instruction const> Parser::File(int p_line)
+	{
+		Optional<eOperandType> const l_type = OperandType(Peek().m_type);
+
+		if (!l_type)
+		{
+			throw Error(Peek(), "Expected a register or a type");
+		}
+		Advance();
+
+		Token const l_path = Consume(TokenType::STRING, "Expected a file path");
+
+		return MakeUnique<ast::InstructionWithFile>(*l_type, *l_path.m_literal, p_line);
+	}
+
+	// include "path": the module runs in place, like a macro. Paths are relative to the including file
+	UniquePtr<ast::Instruction const> Parser::Include(int p_line)
+	{
+		Token const l_path = Consume(TokenType::STRING, "Expected a module path");
+		String l_resolved = *l_path.m_literal;
+
+		if (l_resolved.empty() || l_resolved[0] != '/')
+		{
+			l_resolved = m_lexer.GetPath().substr(0, m_lexer.GetPath().rfind('/') + 1) + l_resolved;
+		}
+		if (m_modules == nullptr)
+		{
+			m_ownModules = MakeUnique<ModuleCache>();
+			m_modules = m_ownModules.get();
+		}
+
+		try
+		{
+			return MakeUnique<ast::InstructionWithBlock>(ast::Instruction::Type::REPEAT, 1, m_modules->Get(l_resolved), p_line);
+		}
+		catch (ModuleError const &l_e)
+		{
+			throw Error(l_path, l_e.what());
+		}
+	}
+
+	/*
+	 * Labels and routines may be defined after the jumps and calls that name
+	 * them, so these are only checked once the whole program is parsed. A
+	 * jump stays in the routine it is in.
+	 */
+	void Parser::ResolveLabels(ast::Program &p_program) const
+	{
+		auto &l_instructions = p_program.GetInstructions();
+		String l_routine;
+
+		for (auto l_it = l_instructions.begin(); l_it != l_instructions.end();)
+		{
+			ast::Instruction::Type const l_type = (*l_it)->GetType();
+			Optional<String> l_error;
+
+			if (l_type == ast::Instruction::Type::DEF || l_type == ast::Instruction::Type::END)
+			{
+				l_routine = l_type == ast::Instruction::Type::DEF
+					? static_cast<ast::InstructionWithLabel const &>(**l_it).GetLabel() : "";
+			}
+			else if (ast::Instruction::IsJump(l_type))
+			{
+				auto const l_label = m_labels.find(static_cast<ast::InstructionWithLabel const &>(**l_it).GetLabel());
+
+				if (l_label == m_labels.end())
+				{
+					l_error = "Undefined label";
+				}
+				else if (l_label->second != l_routine)
+				{
+					l_error = "Expected a label of the same routine";
+				}
+			}
+			else if (l_type == ast::Instruction::Type::CALL)
+			{
+				if (m_routines.find(static_cast<ast::InstructionWithLabel const &>(**l_it).GetLabel()) == m_routines.end())
+				{
+					l_error = "Undefined routine";
+				}
+			}
+
+			if (l_error)
+			{
+				String const &l_name = static_cast<ast::InstructionWithLabel const &>(**l_it).GetLabel();
+
+				m_lexer.Report((*l_it)->GetLine(), " at '" + l_name + "'", *l_error);
+				l_it = l_instructions.erase(l_it);
+				continue;
+			}
+			++l_it;
+		}
+	}
+
+	// (TYPE* -- TYPE*), after the name of a routine
+	ast::StackEffect Parser::Effect()
+	{
+		ast::StackEffect l_effect;
+
+		while (!Match<TokenType::DASHES>())
+		{
+			Optional<eOperandType> const l_type = OperandType(Peek().m_type);
+
+			if (!l_type)
+			{
+				throw Error(Peek(), "Expected a type or \"--\"");
+			}
+			Advance();
+			l_effect.m_inputs.push_back(*l_type);
+		}
+		while (!Match<TokenType::RPAREN>())
+		{
+			Optional<eOperandType> const l_type = OperandType(Peek().m_type);
+
+			if (!l_type)
+			{
+				throw Error(Peek(), "Expected a type or \")\"");
+			}
+			Advance();
+			l_effect.m_outputs.push_back(*l_type);
+		}
+		return l_effect;
+	}
+
+	// macro NAME { ... }: later uses of NAME share the body
+	void Parser::Macro()
+	{
+		Token const l_name = Consume(TokenType::IDENTIFIER, "Expected a macro name");
+		SharedPtr<ast::Program const> l_body = Block();
+
+		if (!m_macros.emplace(*l_name.m_literal, std::move(l_body)).second)
+		{
+			throw Error(l_name, "Macro already defined");
+		}
+	}
+
+	// { ... }, on one line or several, without labels, jumps nor routines
+	SharedPtr<ast::Program const> Parser::Block()
+	{
+		Consume(TokenType::LBRACE, "Expected \"{\" before block");
+
+		auto l_body = MakeShared<ast::Program>();
+
+		for (;;)
+		{
+			while (Match<TokenType::NEWLINE>()) {}
+
+			if (Match<TokenType::RBRACE>())
+			{
+				return l_body;
+			}
+			if (IsAtEnd() || Check(TokenType::INPUT_STOP))
+			{
+				throw Error(IsAtEnd() ? Previous() : Peek(), "Expected \"}\" after block");
+			}
+
+			try
+			{
+				if (Match<TokenType::LABEL, TokenType::JMP, TokenType::JZ, TokenType::JNZ,
+					TokenType::DEF, TokenType::END, TokenType::CALL, TokenType::RET>())
+				{
+					throw Error(Previous(), "Expected no label, jump nor routine in a block");
+				}
+
+				UniquePtr<ast::Instruction const> l_instruction = Instruction();
+
+				if (l_instruction == nullptr)
+				{
+					throw Error(Peek(), "Expected an instruction");
+				}
+				l_body->AddInstruction(std::move(l_instruction));
+
+				if (!Check(TokenType::RBRACE) && !Match<TokenType::NEWLINE>())
+				{
+					throw Error(Peek(), "Expected newline");
+				}
+			}
+			catch (ParseError const &)
+			{
+				// Keep parsing the block, the lines after it are not part of it
+				Synchronize();
+			}
+		}
+	}
+
+	Optional<eOperandType> Parser::OperandType(TokenType p_type)
+	{
+		static const UnorderedMap<TokenType, eOperandType> l_lookUp {
+			{ TokenType::INT8,   eOperandType::INT8   },
+			{ TokenType::INT16,  eOperandType::INT16  },
+			{ TokenType::INT32,  eOperandType::INT32  },
+			{ TokenType::FLOAT,  eOperandType::FLOAT  },
+			{ TokenType::DOUBLE, eOperandType::DOUBLE },
+		};
+
+		auto const l_type = l_lookUp.find(p_type);
+
+		return l_type != l_lookUp.end() ? Optional<eOperandType>(l_type->second) : NullOpt;
+	}
+
+	size_t Parser::Register(Token const &p_token) const
+	{
+		String const &l_index = *p_token.m_literal;
+
+		if (l_index.size() > 2 || std::stoul(l_index) >= RegisterFile::s_count)
+		{
+			throw Error(p_token, fmt::format("Expected a register from r0 to r{}", RegisterFile::s_count - 1));
+		}
+		return std::stoul(l_index);
+	}
+
+	size_t Parser::Count(Token const &p_token) const
+	{
+		String const &l_lexeme = p_token.m_lexeme;
+
+		if (l_lexeme.empty() || l_lexeme.size() > 9 || l_lexeme.find_first_not_of("0123456789") != String::npos
+			|| std::stoul(l_lexeme) == 0)
+		{
+			throw Error(p_token, "Expected a positive count");
+		}
+		return std::stoul(l_lexeme);
+	}
+
 	bool Parser::Check(TokenType p_type) const
 	{
 		if (IsAtEnd())
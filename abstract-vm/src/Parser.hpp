@@ -1,6 +1,7 @@
 #pragma once
 #include "abstractvm.hpp"
 #include "ast/Instruction.hpp"
+#include "ModuleCache.hpp"
 
 namespace avm {
 
@@ -18,7 +19,8 @@ namespace avm {
 	{
 		public:
 			Parser() = delete;
-			Parser(Lexer &p_lexer, List<Token> p_tokens);
+			// Includes go through p_modules, or a cache of this parser without it
+			Parser(Lexer &p_lexer, List<Token> p_tokens, ModuleCache *p_modules = nullptr);
 			Parser(const Parser &) = delete;
 			~Parser() = default;
 
@@ -30,6 +32,16 @@ namespace avm {
 			UniquePtr<ast::Program> Program();
 			UniquePtr<ast::Instruction const> Instruction();
 			UniquePtr<ast::Value const> Value();
+			UniquePtr<ast::Instruction const> Values(Token const &p_instruction);
+			UniquePtr<ast::Instruction const> File(int p_line);
+			UniquePtr<ast::Instruction const> Include(int p_line);
+			void ResolveLabels(ast::Program &p_program) const;
+			void Macro();
+			ast::StackEffect Effect();
+			SharedPtr<ast::Program const> Block();
+			static Optional<eOperandType> OperandType(TokenType p_type);
+			size_t Count(Token const &p_token) const;
+			size_t Register(Token const &p_token) const;
 
 			// Compile-time array with correct values
 			// Student project, just for learning, etc...
@@ -86,5 +98,12 @@ namespace avm {
 			Lexer &m_lexer;
 			List<Token> m_tokens;
 			size_t m_current;
+			// Label names, with the routine they are defined in ("" outside)
+			UnorderedMap<String, String> m_labels;
+			UnorderedSet<String> m_routines;
+			String m_routine;
+			UnorderedMap<String, SharedPtr<ast::Program const>> m_macros;
+			ModuleCache *m_modules;
+			UniquePtr<ModuleCache> m_ownModules;
 	};
 }
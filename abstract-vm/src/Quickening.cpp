@@ -0,0 +1,187 @@
+#include "Quickening.hpp"
+#include "Arithmetic.hpp"
+#include "Operand.hpp"
+#include <limits>
+#include <type_traits>
+
+namespace avm {
+
+	using Type = ast::Instruction::Type;
+
+	template <typename T>
+	static constexpr eOperandType OperandTypeOf()
+	{
+		if constexpr (std::is_same_v<T, int8_t>) return eOperandType::INT8;
+		else if constexpr (std::is_same_v<T, int16_t>) return eOperandType::INT16;
+		else if constexpr (std::is_same_v<T, int32_t>) return eOperandType::INT32;
+		else if constexpr (std::is_same_v<T, float>) return eOperandType::FLOAT;
+		else return eOperandType::DOUBLE;
+	}
+
+	static IOperand const *Generic(Type p_type, IOperand const &p_lhs, IOperand const &p_rhs, bool p_checked)
+	{
+		return p_checked ? Apply(p_type, p_lhs, p_rhs) : ApplyUnchecked(p_type, p_lhs, p_rhs);
+	}
+
+	template <typename T>
+	static bool Fits(int64_t p_value)
+	{
+		return p_value >= std::numeric_limits<T>::min() && p_value <= std::numeric_limits<T>::max();
+	}
+
+	template <Type Op, typename L, typename R>
+	static IOperand const *Specialized(IOperand const &p_lhs, IOperand const &p_rhs, bool p_checked)
+	{
+		if constexpr (std::is_integral_v<L> && std::is_integral_v<R>)
+		{
+			using Result = std::conditional_t<(sizeof(R) > sizeof(L)), R, L>;
+
+			// The guard checked the types, no dynamic_cast needed
+			int64_t const l_lhs = static_cast<Operand<L> const &>(p_lhs).GetValue();
+			int64_t const l_rhs = static_cast<Operand<R> const &>(p_rhs).GetValue();
+			int64_t l_result = 0;
+
+			if constexpr (Op == Type::ADD || Op == Type::SUB || Op == Type::MUL)
+			{
+				l_result = Op == Type::ADD ? l_lhs + l_rhs
+					: Op == Type::SUB ? l_lhs - l_rhs : l_lhs * l_rhs;
+
+				// Operand checks the result against the left operand type
+				if (p_checked && !Fits<L>(l_result))
+				{
+					return Generic(Op, p_lhs, p_rhs, p_checked);
+				}
+			}
+			else if constexpr (Op == Type::DIV)
+			{
+				// A narrower divisor is a bad_cast in Operand::operator/
+				if (sizeof(R) < sizeof(L) || l_rhs == 0)
+				{
+					return Generic(Op, p_lhs, p_rhs, p_checked);
+				}
+				l_result = l_lhs / l_rhs;
+				if (!Fits<Result>(l_result))
+				{
+					return Generic(Op, p_lhs, p_rhs, p_checked);
+				}
+			}
+			else
+			{
+				// Modulo by zero goes through fmod and yields NaN
+				if (l_rhs == 0)
+				{
+					return Generic(Op, p_lhs, p_rhs, p_checked);
+				}
+				l_result = l_lhs % l_rhs;
+			}
+
+			return new Operand<Result>(static_cast<Result>(l_result), OperandTypeOf<Result>());
+		}
+		else
+		{
+			return Generic(Op, p_lhs, p_rhs, p_checked);
+		}
+	}
+
+	template <Type Op, typename L>
+	static QuickHandler SpecializeRhs(eOperandType p_rhs)
+	{
+		switch (p_rhs)
+		{
+			case eOperandType::INT8:   return &Specialized<Op, L, int8_t>;
+			case eOperandType::INT16:  return &Specialized<Op, L, int16_t>;
+			case eOperandType::INT32:  return &Specialized<Op, L, int32_t>;
+			case eOperandType::FLOAT:  return &Specialized<Op, L, float>;
+			case eOperandType::DOUBLE: return &Specialized<Op, L, double>;
+		}
+		throw std::runtime_error("Unreachable!");
+	}
+
+	template <Type Op>
+	static QuickHandler SpecializeLhs(eOperandType p_lhs, eOperandType p_rhs)
+	{
+		switch (p_lhs)
+		{
+			case eOperandType::INT8:   return SpecializeRhs<Op, int8_t>(p_rhs);
+			case eOperandType::INT16:  return SpecializeRhs<Op, int16_t>(p_rhs);
+			case eOperandType::INT32:  return SpecializeRhs<Op, int32_t>(p_rhs);
+			case eOperandType::FLOAT:  return SpecializeRhs<Op, float>(p_rhs);
+			case eOperandType::DOUBLE: return SpecializeRhs<Op, double>(p_rhs);
+		}
+		throw std::runtime_error("Unreachable!");
+	}
+
+	QuickHandler Specialize(Type p_type, eOperandType p_lhs, eOperandType p_rhs)
+	{
+		switch (p_type)
+		{
+			case Type::ADD: return SpecializeLhs<Type::ADD>(p_lhs, p_rhs);
+			case Type::SUB: return SpecializeLhs<Type::SUB>(p_lhs, p_rhs);
+			case Type::MUL: return SpecializeLhs<Type::MUL>(p_lhs, p_rhs);
+			case Type::DIV: return SpecializeLhs<Type::DIV>(p_lhs, p_rhs);
+			case Type::MOD: return SpecializeLhs<Type::MOD>(p_lhs, p_rhs);
+			default:
+				throw std::runtime_error("Unreachable!");
+		}
+	}
+
+	IOperand const *Quicken(QuickSite &p_site, ast::Instruction const &p_instruction, IOperand const &p_lhs,
+		IOperand const &p_rhs, bool p_checked)
+	{
+		if (p_site.m_operation != p_instruction.GetType())
+		{
+			// Left by an instruction that was at the same address
+			p_site = QuickSite();
+			p_site.m_operation = p_instruction.GetType();
+		}
+
+		if (p_site.m_handler != nullptr)
+		{
+			if (p_lhs.getType() == p_site.m_lhs && p_rhs.getType() == p_site.m_rhs)
+			{
+				return p_site.m_handler(p_lhs, p_rhs, p_checked);
+			}
+
+			// Guard failed: this site sees several types, keep it generic
+			p_site.m_handler = nullptr;
+			p_site.m_polymorphic = true;
+		}
+		else if (!p_site.m_polymorphic)
+		{
+			IOperand const *const l_result = Generic(p_instruction.GetType(), p_lhs, p_rhs, p_checked);
+
+			p_site.m_handler = Specialize(p_instruction.GetType(), p_lhs.getType(), p_rhs.getType());
+			p_site.m_lhs = p_lhs.getType();
+			p_site.m_rhs = p_rhs.getType();
+			return l_result;
+		}
+
+		return Generic(p_instruction.GetType(), p_lhs, p_rhs, p_checked);
+	}
+
+	String QuickenedName(QuickSite const &p_site, ast::Instruction const &p_instruction)
+	{
+		static const UnorderedMap<Type, char const *> l_operations {
+			{ Type::ADD, "add" },
+			{ Type::SUB, "sub" },
+			{ Type::MUL, "mul" },
+			{ Type::DIV, "div" },
+			{ Type::MOD, "mod" },
+		};
+		static const UnorderedMap<eOperandType, char const *> l_types {
+			{ eOperandType::INT8,   "i8"  },
+			{ eOperandType::INT16,  "i16" },
+			{ eOperandType::INT32,  "i32" },
+			{ eOperandType::FLOAT,  "f32" },
+			{ eOperandType::DOUBLE, "f64" },
+		};
+
+		String l_name = l_operations.at(p_instruction.GetType());
+
+		if (p_site.m_handler != nullptr && p_site.m_operation == p_instruction.GetType())
+		{
+			l_name += fmt::format("_{}_{}", l_types.at(p_site.m_lhs), l_types.at(p_site.m_rhs));
+		}
+		return l_name;
+	}
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include "IOperand.hpp"
+#include "ast/Instruction.hpp"
+
+namespace avm {
+
+	/*
+	 * Quickening
+	 * ==========
+	 *
+	 * After its first execution, the interpreter rewrites an arithmetic site
+	 * into a variant specialized for the operand types it saw, such as
+	 * add_i32_i32 or mul_f64_i8. The variant is guarded by those types: when
+	 * they differ, the site goes back to the generic path for good.
+	 *
+	 * The sites are kept by each interpreter, found by the address of their
+	 * instruction, and the program itself is never written: several
+	 * interpreters may run the same program at once. A later program may
+	 * reuse the address of an instruction, so the operation is part of the
+	 * guard.
+	 *
+	 * Integer variants compute on the native values and only fall back to
+	 * the operand classes to raise a fault. Variants involving a float or a
+	 * double skip the dispatch but keep the operand classes arithmetic,
+	 * which works on the printed value.
+	 */
+
+	// Arithmetic specialized for one pair of operand types
+	using QuickHandler = IOperand const *(*)(IOperand const &p_lhs, IOperand const &p_rhs, bool p_checked);
+
+	// State of an arithmetic site, generic until its first run
+	struct QuickSite
+	{
+		QuickHandler m_handler = nullptr;
+		ast::Instruction::Type m_operation = ast::Instruction::Type::ADD;
+		eOperandType m_lhs = eOperandType::INT8;
+		eOperandType m_rhs = eOperandType::INT8;
+		bool m_polymorphic = false;
+	};
+
+	// Handler for an arithmetic instruction on the given operand types
+	QuickHandler Specialize(ast::Instruction::Type p_type, eOperandType p_lhs, eOperandType p_rhs);
+
+	// Runs an arithmetic instruction through its site, quickening it on first use
+	IOperand const *Quicken(QuickSite &p_site, ast::Instruction const &p_instruction, IOperand const &p_lhs,
+		IOperand const &p_rhs, bool p_checked);
+
+	// Name of the variant a site runs, e.g. "add_i32_i8", or "add" when generic
+	String QuickenedName(QuickSite const &p_site, ast::Instruction const &p_instruction);
+}
@@ -0,0 +1,26 @@
+#include "RegisterFile.hpp"
+#include "Interpreter.hpp"
+
+namespace avm {
+
+	void RegisterFile::Store(size_t p_index, OperandStack &p_stack)
+	{
+		m_slots.at(p_index) = p_stack.PopSlot();
+	}
+
+	void RegisterFile::Load(size_t p_index, OperandStack &p_stack) const
+	{
+		Optional<OperandStack::Slot> const &l_slot = m_slots.at(p_index);
+
+		if (!l_slot)
+		{
+			throw EmptyRegisterError();
+		}
+		p_stack.Push(l_slot->m_type, l_slot->m_payload);
+	}
+
+	bool RegisterFile::IsSet(size_t p_index) const
+	{
+		return m_slots.at(p_index).has_value();
+	}
+}
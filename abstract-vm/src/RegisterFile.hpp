@@ -0,0 +1,35 @@
+#pragma once
+#include "OperandStack.hpp"
+
+namespace avm {
+
+	/*
+	 * Fixed set of registers r0 to r15, each holding one value or nothing.
+	 * Values move between the stack and a register as slots: a type tag and
+	 * a payload, with the operand object when one was built. Nothing is
+	 * formatted, converted or allocated on the way.
+	 */
+	class RegisterFile
+	{
+	public:
+		static constexpr size_t s_count = 16;
+
+	public:
+		RegisterFile() = default;
+		RegisterFile(const RegisterFile &) = delete;
+		~RegisterFile() = default;
+
+		RegisterFile &operator=(const RegisterFile &) = delete;
+
+		// Pops the top of the stack into the register
+		void Store(size_t p_index, OperandStack &p_stack);
+
+		// Pushes a copy of the register, which keeps its value
+		void Load(size_t p_index, OperandStack &p_stack) const;
+
+		bool IsSet(size_t p_index) const;
+
+	private:
+		Array<Optional<OperandStack::Slot>, s_count> m_slots;
+	};
+}
@@ -0,0 +1,136 @@
+#include "SegmentMap.hpp"
+#include "Interpreter.hpp"
+#include <cerrno>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+# define AVM_HAS_MMAP 1
+# include <stdlib.h>
+# include <sys/mman.h>
+# include <unistd.h>
+#else
+# define AVM_HAS_MMAP 0
+#endif
+
+namespace avm {
+
+	SegmentMap::SegmentMap(size_t p_blockSize) : m_blockSize(p_blockSize)
+	{
+	}
+
+	SegmentMap::~SegmentMap()
+	{
+		while (!m_blocks.empty())
+		{
+			Unmap();
+		}
+#if AVM_HAS_MMAP
+		if (m_file >= 0)
+		{
+			close(m_file);
+		}
+#endif
+	}
+
+	void SegmentMap::SetStorage(SegmentStorage p_storage)
+	{
+		if (!m_blocks.empty())
+		{
+			throw std::runtime_error("The storage of a segment map is set before its first block");
+		}
+
+#if AVM_HAS_MMAP
+		if (m_file >= 0)
+		{
+			close(m_file);
+			m_file = -1;
+		}
+		if (!p_storage.m_directory.empty())
+		{
+			String l_path = p_storage.m_directory + "/avm-stack-XXXXXX";
+
+			m_file = mkstemp(&l_path[0]);
+			if (m_file < 0)
+			{
+				throw StackOverflowError(fmt::format("Cannot create a stack file in \"{}\": {}",
+					p_storage.m_directory, std::strerror(errno)));
+			}
+			// Only the mappings keep it
+			unlink(l_path.c_str());
+		}
+#endif
+		m_storage = std::move(p_storage);
+	}
+
+	SegmentStorage const &SegmentMap::GetStorage() const
+	{
+		return m_storage;
+	}
+
+	unsigned char *SegmentMap::Map()
+	{
+#if AVM_HAS_MMAP
+		void *l_block = MAP_FAILED;
+		off_t const l_offset = static_cast<off_t>(m_blocks.size() * m_blockSize);
+
+		if (m_file < 0)
+		{
+			l_block = mmap(nullptr, m_blockSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		}
+		else if (ftruncate(m_file, l_offset + static_cast<off_t>(m_blockSize)) == 0)
+		{
+			l_block = mmap(nullptr, m_blockSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_file, l_offset);
+		}
+		if (l_block == MAP_FAILED)
+		{
+			throw StackOverflowError(fmt::format("Cannot map {} more bytes of stack: {}", m_blockSize, std::strerror(errno)));
+		}
+		m_blocks.push_back(static_cast<unsigned char *>(l_block));
+#else
+		m_blocks.push_back(new unsigned char[m_blockSize]);
+#endif
+		return m_blocks.back();
+	}
+
+	void SegmentMap::Unmap()
+	{
+#if AVM_HAS_MMAP
+		munmap(m_blocks.back(), m_blockSize);
+		m_blocks.pop_back();
+		// Gives the disk space back
+		if (m_file >= 0)
+		{
+			(void)ftruncate(m_file, static_cast<off_t>(m_blocks.size() * m_blockSize));
+		}
+#else
+		delete[] m_blocks.back();
+		m_blocks.pop_back();
+#endif
+	}
+
+	// Only advice: the block stays mapped whether the system follows it or not
+	void SegmentMap::Spill(size_t p_block)
+	{
+#if AVM_HAS_MMAP && defined(MADV_PAGEOUT)
+		madvise(m_blocks[p_block], m_blockSize, MADV_PAGEOUT);
+#elif AVM_HAS_MMAP
+		// Anonymous pages would be lost, the pages of a file are written back
+		if (m_file >= 0)
+		{
+			madvise(m_blocks[p_block], m_blockSize, MADV_DONTNEED);
+		}
+#else
+		(void)p_block;
+#endif
+	}
+
+	size_t SegmentMap::GetCount() const
+	{
+		return m_blocks.size();
+	}
+
+	size_t SegmentMap::GetBlockSize() const
+	{
+		return m_blockSize;
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include "abstractvm.hpp"
+
+namespace avm {
+
+	// Where the blocks of a SegmentMap live
+	struct SegmentStorage
+	{
+		// Bytes of blocks to keep resident, see OperandStack::SetStorage(); 0 keeps them all
+		size_t m_residentBudget = 0;
+		// Directory of the file backing the blocks, anonymous memory when empty
+		String m_directory;
+	};
+
+	/*
+	 * Blocks of memory of one size, each mapped on its own: mapping one
+	 * more never moves the others. Blocks are anonymous memory, or pages of
+	 * an unlinked file of the storage directory so they can outgrow RAM and
+	 * swap. Platforms without mmap() allocate them on the heap.
+	 *
+	 * Spill() gives the pages of a block back to the system: an anonymous
+	 * block is paged out to swap, a file-backed one written back to its
+	 * file. Its contents are read back on their next access.
+	 *
+	 * Throws StackOverflowError when a block cannot be mapped.
+	 */
+	class SegmentMap
+	{
+	public:
+		SegmentMap() = delete;
+		explicit SegmentMap(size_t p_blockSize);
+		SegmentMap(const SegmentMap &) = delete;
+		~SegmentMap();
+
+		SegmentMap &operator=(const SegmentMap &) = delete;
+
+		// Only while no block is mapped
+		void SetStorage(SegmentStorage p_storage);
+		SegmentStorage const &GetStorage() const;
+
+		// Maps one more block after the others
+		unsigned char *Map();
+		// Unmaps the last block
+		void Unmap();
+		void Spill(size_t p_block);
+
+		size_t GetCount() const;
+		size_t GetBlockSize() const;
+
+	private:
+		size_t m_blockSize;
+		SegmentStorage m_storage;
+		Vector<unsigned char *> m_blocks;
+		int m_file = -1;
+	};
+}
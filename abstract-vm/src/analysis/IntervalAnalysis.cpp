@@ -0,0 +1,666 @@
+#include "IntervalAnalysis.hpp"
+#include "../Arithmetic.hpp"
+#include "../Interpreter.hpp"
+#include "../OperandFactory.hpp"
+#include <algorithm>
+#include <typeinfo>
+
+namespace avm {
+namespace analysis {
+
+	namespace {
+
+		struct Range
+		{
+			double m_lo;
+			double m_hi;
+		};
+
+		enum class eCheck
+		{
+			PASS,
+			FAIL,
+			MAYBE,
+		};
+
+		// Same limits as Operand<T>::MinLimit() and Operand<T>::MaxLimit()
+		double MinLimit(eOperandType p_type)
+		{
+			switch (p_type)
+			{
+				case eOperandType::INT8:   return std::numeric_limits<int8_t>::min();
+				case eOperandType::INT16:  return std::numeric_limits<int16_t>::min();
+				case eOperandType::INT32:  return std::numeric_limits<int32_t>::min();
+				case eOperandType::FLOAT:  return std::numeric_limits<float>::min();
+				case eOperandType::DOUBLE: return std::numeric_limits<double>::min();
+			}
+			throw std::runtime_error("Unreachable!");
+		}
+
+		double MaxLimit(eOperandType p_type)
+		{
+			switch (p_type)
+			{
+				case eOperandType::INT8:   return std::numeric_limits<int8_t>::max();
+				case eOperandType::INT16:  return std::numeric_limits<int16_t>::max();
+				case eOperandType::INT32:  return std::numeric_limits<int32_t>::max();
+				case eOperandType::FLOAT:  return std::numeric_limits<float>::max();
+				case eOperandType::DOUBLE: return std::numeric_limits<double>::max();
+			}
+			throw std::runtime_error("Unreachable!");
+		}
+
+		UniquePtr<IOperand const> Materialize(eOperandType p_type, double p_value)
+		{
+			return UniquePtr<IOperand const>(OperandFactory::Get().CreateOperand(p_type, p_value));
+		}
+
+		// The arithmetic operators read their operands back from toString()
+		double Effective(eOperandType p_type, double p_value)
+		{
+			return std::stod(Materialize(p_type, p_value)->toString());
+		}
+
+		double Store(eOperandType p_type, double p_value)
+		{
+			return dynamic_cast<OperandBase const &>(*Materialize(p_type, p_value)).ToDouble();
+		}
+
+		template <typename Fn>
+		Range Corners(Range const &p_a, Range const &p_b, Fn p_fn)
+		{
+			Array<double, 4> l_values {
+				p_fn(p_a.m_lo, p_b.m_lo), p_fn(p_a.m_lo, p_b.m_hi),
+				p_fn(p_a.m_hi, p_b.m_lo), p_fn(p_a.m_hi, p_b.m_hi),
+			};
+
+			return { *std::min_element(l_values.begin(), l_values.end()),
+				*std::max_element(l_values.begin(), l_values.end()) };
+		}
+
+		// fmod() keeps the sign of the dividend and stays below the divisor
+		Range Fmod(Range const &p_a, Range const &p_b)
+		{
+			double l_bound = std::max(std::fabs(p_b.m_lo), std::fabs(p_b.m_hi));
+
+			if (p_a.m_lo >= 0)
+				return { 0, std::min(p_a.m_hi, l_bound) };
+			if (p_a.m_hi <= 0)
+				return { std::max(p_a.m_lo, -l_bound), 0 };
+			return { std::max(p_a.m_lo, -l_bound), std::min(p_a.m_hi, l_bound) };
+		}
+
+		bool ContainsZero(double p_lo, double p_hi)
+		{
+			return p_lo <= 0 && p_hi >= 0;
+		}
+
+		eCheck Check(Range const &p_range, eOperandType p_type)
+		{
+			if (p_range.m_lo >= MinLimit(p_type) && p_range.m_hi <= MaxLimit(p_type))
+				return eCheck::PASS;
+			if (p_range.m_hi < MinLimit(p_type) || p_range.m_lo > MaxLimit(p_type))
+				return eCheck::FAIL;
+			return eCheck::MAYBE;
+		}
+
+		Interval Whole(eOperandType p_type)
+		{
+			return { p_type, Store(p_type, MinLimit(p_type)), Store(p_type, MaxLimit(p_type)) };
+		}
+	}
+
+	bool Interval::IsPoint() const
+	{
+		return m_lo == m_hi;
+	}
+
+	void IntervalAnalysis::Run(ast::Program const &p_program)
+	{
+		m_stack.clear();
+		m_registers.fill(NullOpt);
+		m_verdicts.clear();
+		m_fault = NullOpt;
+		m_done = false;
+		m_routines.clear();
+		m_maxDepth = 0;
+		m_exited = false;
+		m_bounded = true;
+
+		auto const &l_instructions = p_program.GetInstructions();
+
+		// Calls may come before the routine they call
+		for (auto l_it = l_instructions.begin(); l_it != l_instructions.end(); ++l_it)
+		{
+			if ((*l_it)->GetType() == ast::Instruction::Type::DEF)
+			{
+				Routine(static_cast<ast::InstructionWithEffect const &>(**l_it), std::next(l_it), l_instructions.end());
+			}
+		}
+
+		bool l_inRoutine = false;
+
+		for (auto const &l_instruction : l_instructions)
+		{
+			ast::Instruction::Type const l_type = l_instruction->GetType();
+
+			if (m_done)
+			{
+				break;
+			}
+			// Straight-line code skips the routines
+			if (l_type == ast::Instruction::Type::DEF || l_type == ast::Instruction::Type::END)
+			{
+				l_inRoutine = l_type == ast::Instruction::Type::DEF;
+				continue;
+			}
+			if (!l_inRoutine)
+			{
+				l_instruction->Accept(*this);
+				m_maxDepth = std::max(m_maxDepth, m_stack.size());
+			}
+		}
+
+		// Stopped at an instruction that is not modelled
+		if (m_done && !m_exited && !m_fault)
+		{
+			m_bounded = false;
+		}
+	}
+
+	Verdict IntervalAnalysis::GetVerdict(ast::Instruction const &p_instruction) const
+	{
+		auto l_verdict = m_verdicts.find(&p_instruction);
+
+		return l_verdict != m_verdicts.end() ? l_verdict->second : Verdict::UNKNOWN;
+	}
+
+	UnorderedSet<ast::Instruction const *> IntervalAnalysis::GetProvenSafe() const
+	{
+		UnorderedSet<ast::Instruction const *> l_safe;
+
+		for (auto const &l_verdict : m_verdicts)
+		{
+			if (l_verdict.second == Verdict::SAFE)
+			{
+				l_safe.insert(l_verdict.first);
+			}
+		}
+		return l_safe;
+	}
+
+	Optional<Fault> const &IntervalAnalysis::GetFault() const
+	{
+		return m_fault;
+	}
+
+	Optional<size_t> IntervalAnalysis::GetMaxDepth() const
+	{
+		return m_bounded ? Optional<size_t>(m_maxDepth) : NullOpt;
+	}
+
+	void IntervalAnalysis::VisitInstruction(ast::Instruction const &p_instruction)
+	{
+		ast::Instruction::Type const l_type = p_instruction.GetType();
+
+		if (IsArithmetic(l_type))
+		{
+			if (m_stack.size() < 2)
+			{
+				SetFault(p_instruction, EmptyStackError().what());
+				return;
+			}
+
+			Interval l_rhs = m_stack.back();
+			m_stack.pop_back();
+			Interval l_lhs = m_stack.back();
+			m_stack.pop_back();
+
+			Interval l_result = l_lhs;
+			String l_message;
+			Verdict l_verdict = Arithmetic(l_type, l_lhs, l_rhs, l_result, l_message);
+
+			m_verdicts[&p_instruction] = l_verdict;
+			if (l_verdict == Verdict::FAULT)
+			{
+				SetFault(p_instruction, l_message);
+				return;
+			}
+			m_stack.push_back(l_result);
+			return;
+		}
+
+		if (ast::Instruction::IsComparison(l_type))
+		{
+			if (m_stack.size() < 2)
+			{
+				SetFault(p_instruction, EmptyStackError().what());
+				return;
+			}
+			m_stack.resize(m_stack.size() - 2);
+			m_stack.push_back({ eOperandType::INT8, 0, 1 });
+			return;
+		}
+
+		switch (l_type)
+		{
+			case ast::Instruction::Type::POP:
+				if (m_stack.empty())
+				{
+					SetFault(p_instruction, EmptyStackError().what());
+					return;
+				}
+				m_stack.pop_back();
+				break;
+			case ast::Instruction::Type::PRINT:
+				if (m_stack.empty())
+				{
+					SetFault(p_instruction, EmptyStackError().what());
+				}
+				else if (m_stack.back().m_type != eOperandType::INT8)
+				{
+					SetFault(p_instruction, PrintError().what());
+				}
+				break;
+			case ast::Instruction::Type::EXIT:
+				m_exited = true;
+				m_done = true;
+				break;
+			case ast::Instruction::Type::DUMP:
+				break;
+			case ast::Instruction::Type::DUP:
+			case ast::Instruction::Type::OVER:
+			{
+				size_t const l_depth = l_type == ast::Instruction::Type::DUP ? 1 : 2;
+
+				if (m_stack.size() < l_depth)
+				{
+					SetFault(p_instruction, EmptyStackError().what());
+					return;
+				}
+				m_stack.push_back(m_stack[m_stack.size() - l_depth]);
+				break;
+			}
+			case ast::Instruction::Type::SWAP:
+			case ast::Instruction::Type::ROT:
+			{
+				size_t const l_depth = l_type == ast::Instruction::Type::SWAP ? 2 : 3;
+
+				if (m_stack.size() < l_depth)
+				{
+					SetFault(p_instruction, EmptyStackError().what());
+					return;
+				}
+				std::rotate(m_stack.end() - l_depth, m_stack.end() - l_depth + 1, m_stack.end());
+				break;
+			}
+			case ast::Instruction::Type::SORT:
+				Sort(p_instruction, m_stack.size());
+				break;
+			case ast::Instruction::Type::STACKMIN:
+			case ast::Instruction::Type::STACKMAX:
+			{
+				bool const l_min = l_type == ast::Instruction::Type::STACKMIN;
+
+				if (m_stack.empty())
+				{
+					SetFault(p_instruction, EmptyStackError().what());
+					return;
+				}
+
+				Interval l_extreme = m_stack.front();
+
+				for (Interval const &l_slot : m_stack)
+				{
+					l_extreme.m_type = std::max(l_extreme.m_type, l_slot.m_type);
+					l_extreme.m_lo = l_min ? std::min(l_extreme.m_lo, l_slot.m_lo) : std::max(l_extreme.m_lo, l_slot.m_lo);
+					l_extreme.m_hi = l_min ? std::min(l_extreme.m_hi, l_slot.m_hi) : std::max(l_extreme.m_hi, l_slot.m_hi);
+				}
+				m_stack.push_back(l_extreme);
+				break;
+			}
+			case ast::Instruction::Type::STACKCOUNT:
+			{
+				double const l_count = static_cast<double>(m_stack.size());
+
+				m_stack.push_back({ eOperandType::INT32, l_count, l_count });
+				break;
+			}
+			case ast::Instruction::Type::LABEL:
+			case ast::Instruction::Type::JMP:
+			case ast::Instruction::Type::JZ:
+			case ast::Instruction::Type::JNZ:
+				// A label may be reached with any stack: only straight-line code before the first one is proven
+				m_done = true;
+				break;
+			default:
+				// Not modelled: stop here, the sites that follow stay checked
+				m_done = true;
+				break;
+		}
+	}
+
+	void IntervalAnalysis::VisitInstructionWithValue(ast::InstructionWithValue const &p_instruction)
+	{
+		ast::Value const &l_value = *p_instruction.GetValue();
+
+		switch (p_instruction.GetType())
+		{
+			case ast::Instruction::Type::PUSH:
+				try
+				{
+					eOperandType l_type = l_value.GetOperandType();
+					UniquePtr<IOperand const> l_operand(OperandFactory::Get().CreateOperand(
+						l_type, *l_value.GetToken().m_literal));
+					double l_stored = dynamic_cast<OperandBase const &>(*l_operand).ToDouble();
+
+					m_stack.push_back({ l_type, l_stored, l_stored });
+				}
+				catch (std::exception const &e)
+				{
+					SetFault(p_instruction, e.what());
+				}
+				break;
+			case ast::Instruction::Type::ASSERT:
+				if (m_stack.empty())
+				{
+					SetFault(p_instruction, EmptyStackError().what());
+				}
+				break;
+			default:
+				break;
+		}
+	}
+
+	void IntervalAnalysis::VisitInstructionWithArgument(ast::InstructionWithArgument const &p_instruction)
+	{
+		size_t const l_index = p_instruction.GetArgument();
+
+		switch (p_instruction.GetType())
+		{
+			case ast::Instruction::Type::STORE:
+				if (m_stack.empty())
+				{
+					SetFault(p_instruction, EmptyStackError().what());
+					return;
+				}
+				m_registers.at(l_index) = m_stack.back();
+				m_stack.pop_back();
+				break;
+			case ast::Instruction::Type::LOAD:
+				if (!m_registers.at(l_index))
+				{
+					SetFault(p_instruction, EmptyRegisterError().what());
+					return;
+				}
+				m_stack.push_back(*m_registers.at(l_index));
+				break;
+			case ast::Instruction::Type::SORT:
+				Sort(p_instruction, l_index);
+				break;
+			default:
+				// Reductions are not modelled
+				m_done = true;
+				break;
+		}
+	}
+
+	void IntervalAnalysis::VisitInstructionWithValues(ast::InstructionWithValues const &p_instruction)
+	{
+		eOperandType const l_type = p_instruction.GetOperandType();
+
+		for (int64_t l_value : p_instruction.GetValues())
+		{
+			m_stack.push_back({ l_type, static_cast<double>(l_value), static_cast<double>(l_value) });
+		}
+	}
+
+	void IntervalAnalysis::VisitInstructionWithLabel(ast::InstructionWithLabel const &p_instruction)
+	{
+		if (p_instruction.GetType() != ast::Instruction::Type::CALL)
+		{
+			VisitInstruction(p_instruction);
+			return;
+		}
+
+		auto const l_routine = m_routines.find(p_instruction.GetLabel());
+
+		// The body may push more than its outputs
+		m_bounded = false;
+
+		// Without a stack effect that its body matches, a routine may do anything
+		if (l_routine == m_routines.end())
+		{
+			m_done = true;
+			return;
+		}
+
+		ast::StackEffect const &l_effect = *l_routine->second->GetEffect();
+		size_t const l_count = l_effect.m_inputs.size();
+		bool l_matches = m_stack.size() >= l_count;
+
+		for (size_t l_index = 0; l_matches && l_index < l_count; l_index++)
+		{
+			l_matches = m_stack[m_stack.size() - l_count + l_index].m_type == l_effect.m_inputs[l_index];
+		}
+		if (!l_matches)
+		{
+			SetFault(p_instruction, CallError(*l_routine->second, false).what());
+			return;
+		}
+
+		m_stack.resize(m_stack.size() - l_count);
+		for (eOperandType l_type : l_effect.m_outputs)
+		{
+			m_stack.push_back(Whole(l_type));
+		}
+	}
+
+	/*
+	 * Calls check the input types and the outputs of a declared stack
+	 * effect, so a body that only touches its inputs and proves its outputs
+	 * from any such inputs holds for every call. Its verdicts are kept.
+	 */
+	void IntervalAnalysis::Routine(ast::InstructionWithEffect const &p_routine, Iterator p_begin, Iterator p_end)
+	{
+		Optional<ast::StackEffect> const &l_effect = p_routine.GetEffect();
+		IntervalAnalysis l_body;
+
+		if (!l_effect)
+		{
+			return;
+		}
+		for (eOperandType l_type : l_effect->m_inputs)
+		{
+			l_body.m_stack.push_back(Whole(l_type));
+		}
+
+		for (auto l_it = p_begin; l_it != p_end; ++l_it)
+		{
+			ast::Instruction::Type const l_type = (*l_it)->GetType();
+
+			if (l_type == ast::Instruction::Type::RET || l_type == ast::Instruction::Type::END)
+			{
+				if (l_body.m_stack.size() != l_effect->m_outputs.size())
+				{
+					return;
+				}
+				for (size_t l_index = 0; l_index < l_body.m_stack.size(); l_index++)
+				{
+					if (l_body.m_stack[l_index].m_type != l_effect->m_outputs[l_index])
+					{
+						return;
+					}
+				}
+				m_verdicts.insert(l_body.m_verdicts.begin(), l_body.m_verdicts.end());
+				m_routines[p_routine.GetLabel()] = &p_routine;
+				return;
+			}
+
+			// Registers outlive the call. Reading below the inputs faults here.
+			if (l_type == ast::Instruction::Type::STORE)
+			{
+				return;
+			}
+			(*l_it)->Accept(l_body);
+			if (l_body.m_done)
+			{
+				return;
+			}
+		}
+	}
+
+	Verdict IntervalAnalysis::Arithmetic(ast::Instruction::Type p_type, Interval const &p_lhs, Interval const &p_rhs,
+		Interval &p_result, String &p_message)
+	{
+		if (p_lhs.IsPoint() && p_rhs.IsPoint())
+		{
+			return Evaluate(p_type, p_lhs, p_rhs, p_result, p_message);
+		}
+
+		// Follows the promotion rules of Operand<T>: the lhs type is checked
+		// first, then the promoted type when the rhs is more precise.
+		bool const l_promoted = p_rhs.m_type > p_lhs.m_type;
+		eOperandType const l_resultType = l_promoted ? p_rhs.m_type : p_lhs.m_type;
+
+		if (p_type == ast::Instruction::Type::DIV && p_lhs.m_type > p_rhs.m_type)
+		{
+			p_message = std::bad_cast().what();
+			return Verdict::FAULT;
+		}
+
+		Range const l_a { Effective(p_lhs.m_type, p_lhs.m_lo), Effective(p_lhs.m_type, p_lhs.m_hi) };
+		Range const l_b { Effective(p_rhs.m_type, p_rhs.m_lo), Effective(p_rhs.m_type, p_rhs.m_hi) };
+		Range const l_promotedA = l_promoted
+			? Range { Effective(p_rhs.m_type, l_a.m_lo), Effective(p_rhs.m_type, l_a.m_hi) }
+			: l_a;
+
+		Vector<Pair<Range, eOperandType>> l_checks;
+		Range l_raw { 0, 0 };
+
+		switch (p_type)
+		{
+			case ast::Instruction::Type::ADD:
+				l_raw = { l_a.m_lo + l_b.m_lo, l_a.m_hi + l_b.m_hi };
+				l_checks.emplace_back(l_raw, p_lhs.m_type);
+				break;
+			case ast::Instruction::Type::SUB:
+				l_checks.emplace_back(Range { l_a.m_lo - l_b.m_hi, l_a.m_hi - l_b.m_lo }, p_lhs.m_type);
+				l_raw = { l_promotedA.m_lo - l_b.m_hi, l_promotedA.m_hi - l_b.m_lo };
+				break;
+			case ast::Instruction::Type::MUL:
+				l_raw = Corners(l_a, l_b, [] (double p_x, double p_y) { return p_x * p_y; });
+				l_checks.emplace_back(l_raw, p_lhs.m_type);
+				break;
+			case ast::Instruction::Type::DIV:
+				if (ContainsZero(p_rhs.m_lo, p_rhs.m_hi) || ContainsZero(l_b.m_lo, l_b.m_hi))
+				{
+					if (p_rhs.m_lo == 0 && p_rhs.m_hi == 0)
+					{
+						p_message = DivisionByZero().what();
+						return Verdict::FAULT;
+					}
+					p_result = Whole(l_resultType);
+					return Verdict::UNKNOWN;
+				}
+				l_raw = Corners(l_promotedA, l_b, [] (double p_x, double p_y) { return p_x / p_y; });
+				break;
+			case ast::Instruction::Type::MOD:
+				if (ContainsZero(l_b.m_lo, l_b.m_hi))
+				{
+					p_result = Whole(l_resultType);
+					return Verdict::UNKNOWN;
+				}
+				l_checks.emplace_back(Fmod(l_a, l_b), p_lhs.m_type);
+				l_raw = Fmod(l_promotedA, l_b);
+				break;
+			default:
+				throw std::runtime_error("Unreachable!");
+		}
+
+		if (l_promoted || p_type == ast::Instruction::Type::DIV)
+		{
+			l_checks.emplace_back(l_raw, l_resultType);
+		}
+
+		bool l_safe = true;
+		for (auto const &l_check : l_checks)
+		{
+			eCheck l_status = Check(l_check.first, l_check.second);
+
+			if (l_status == eCheck::FAIL)
+			{
+				p_message = fmt::format("result in [{}, {}] is always out of range", l_check.first.m_lo, l_check.first.m_hi);
+				return Verdict::FAULT;
+			}
+			l_safe = l_safe && l_status == eCheck::PASS;
+		}
+
+		// Whatever does not fault fits the result type
+		double l_lo = std::max(l_raw.m_lo, MinLimit(l_resultType));
+		double l_hi = std::min(l_raw.m_hi, MaxLimit(l_resultType));
+		p_result = { l_resultType, Store(l_resultType, l_lo), Store(l_resultType, l_hi) };
+
+		return l_safe ? Verdict::SAFE : Verdict::UNKNOWN;
+	}
+
+	/*
+	 * Both operands are known exactly: run the checked operator itself, so the
+	 * verdict and the fault message are the ones the interpreter would produce.
+	 */
+	Verdict IntervalAnalysis::Evaluate(ast::Instruction::Type p_type, Interval const &p_lhs, Interval const &p_rhs,
+		Interval &p_result, String &p_message)
+	{
+		try
+		{
+			UniquePtr<IOperand const> l_lhs = Materialize(p_lhs.m_type, p_lhs.m_lo);
+			UniquePtr<IOperand const> l_rhs = Materialize(p_rhs.m_type, p_rhs.m_lo);
+			UniquePtr<IOperand const> l_result(Apply(p_type, *l_lhs, *l_rhs));
+			double l_value = dynamic_cast<OperandBase const &>(*l_result).ToDouble();
+
+			p_result = { l_result->getType(), l_value, l_value };
+			return Verdict::SAFE;
+		}
+		catch (std::exception const &e)
+		{
+			p_message = e.what();
+			return Verdict::FAULT;
+		}
+	}
+
+	// Any of the values may end in any sorted slot, whose type is only known when they all share it
+	void IntervalAnalysis::Sort(ast::Instruction const &p_instruction, size_t p_count)
+	{
+		if (p_count > m_stack.size())
+		{
+			SetFault(p_instruction, EmptyStackError().what());
+			return;
+		}
+		if (p_count == 0)
+		{
+			return;
+		}
+
+		auto const l_begin = m_stack.end() - p_count;
+		Interval l_hull = *l_begin;
+
+		for (auto l_it = l_begin; l_it != m_stack.end(); ++l_it)
+		{
+			if (l_it->m_type != l_hull.m_type)
+			{
+				m_done = true;
+				return;
+			}
+			l_hull.m_lo = std::min(l_hull.m_lo, l_it->m_lo);
+			l_hull.m_hi = std::max(l_hull.m_hi, l_it->m_hi);
+		}
+		std::fill(l_begin, m_stack.end(), l_hull);
+	}
+
+	void IntervalAnalysis::SetFault(ast::Instruction const &p_instruction, String p_message)
+	{
+		m_fault = Fault { p_instruction.GetLine(), std::move(p_message) };
+		m_done = true;
+	}
+}
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include "../abstractvm.hpp"
+#include "../IOperand.hpp"
+#include "../ast/Instruction.hpp"
+#include "../RegisterFile.hpp"
+
+namespace avm {
+namespace analysis {
+
+	/*
+	 * Range of the values a stack slot may hold. Bounds are stored values
+	 * (what Operand<T>::GetValue() returns), not their string form.
+	 */
+	struct Interval
+	{
+		eOperandType m_type;
+		double m_lo;
+		double m_hi;
+
+		bool IsPoint() const;
+	};
+
+	enum class Verdict
+	{
+		UNKNOWN,
+		SAFE,
+		FAULT,
+	};
+
+	struct Fault
+	{
+		int m_line;
+		String m_message;
+	};
+
+	/*
+	 * Load-time abstract interpretation of a program: every stack slot and
+	 * register is an Interval and every arithmetic instruction gets a
+	 * Verdict. Proven-safe
+	 * instructions may run without the overflow checks, the first proven
+	 * fault is kept so it can be reported before the program runs.
+	 *
+	 * A routine with a declared stack effect is analysed on its own, from
+	 * any values of its input types; the calls then only apply the effect.
+	 */
+	class IntervalAnalysis : public ast::InstructionVisitor
+	{
+	public:
+		IntervalAnalysis() = default;
+		IntervalAnalysis(const IntervalAnalysis &) = delete;
+		virtual ~IntervalAnalysis() = default;
+
+		IntervalAnalysis &operator=(const IntervalAnalysis &) = delete;
+
+		void Run(ast::Program const &p_program);
+
+		Verdict GetVerdict(ast::Instruction const &p_instruction) const;
+		UnorderedSet<ast::Instruction const *> GetProvenSafe() const;
+		Optional<Fault> const &GetFault() const;
+
+		/*
+		 * Deepest the stack gets, known when the analysis followed every
+		 * instruction that runs: up to the end of the program, an exit or
+		 * the first fault, without calls.
+		 */
+		Optional<size_t> GetMaxDepth() const;
+
+		void VisitInstruction(ast::Instruction const &p_instruction) override;
+		void VisitInstructionWithValue(ast::InstructionWithValue const &p_instruction) override;
+		void VisitInstructionWithArgument(ast::InstructionWithArgument const &p_instruction) override;
+		void VisitInstructionWithValues(ast::InstructionWithValues const &p_instruction) override;
+		void VisitInstructionWithLabel(ast::InstructionWithLabel const &p_instruction) override;
+
+		// Transfer function of one arithmetic instruction
+		static Verdict Arithmetic(ast::Instruction::Type p_type, Interval const &p_lhs, Interval const &p_rhs,
+			Interval &p_result, String &p_message);
+
+	private:
+		using Iterator = List<UniquePtr<ast::Instruction const>>::const_iterator;
+
+		void Routine(ast::InstructionWithEffect const &p_routine, Iterator p_begin, Iterator p_end);
+		static Verdict Evaluate(ast::Instruction::Type p_type, Interval const &p_lhs, Interval const &p_rhs,
+			Interval &p_result, String &p_message);
+		void SetFault(ast::Instruction const &p_instruction, String p_message);
+		void Sort(ast::Instruction const &p_instruction, size_t p_count);
+
+	private:
+		Vector<Interval> m_stack;
+		Array<Optional<Interval>, RegisterFile::s_count> m_registers;
+		UnorderedMap<ast::Instruction const *, Verdict> m_verdicts;
+		Optional<Fault> m_fault;
+		size_t m_maxDepth = 0;
+		bool m_exited = false;
+		bool m_bounded = true;
+		// Routines whose body matches their stack effect
+		UnorderedMap<String, ast::InstructionWithEffect const *> m_routines;
+		bool m_done = false;
+	};
+}
+}
@@ -0,0 +1,83 @@
+#include "Code.hpp"
+
+namespace avm {
+namespace ast {
+
+	Code::Code(Program const &p_program)
+	{
+		UnorderedMap<StringView, size_t> l_labels;
+		UnorderedMap<StringView, size_t> l_routines;
+		Optional<size_t> l_routine;
+
+		m_instructions.reserve(p_program.GetInstructions().size());
+		m_targets.resize(p_program.GetInstructions().size());
+		for (auto const &l_instruction : p_program.GetInstructions())
+		{
+			switch (l_instruction->GetType())
+			{
+				case Instruction::Type::LABEL:
+					l_labels.emplace(static_cast<InstructionWithLabel const &>(*l_instruction).GetLabel(),
+						m_instructions.size());
+					break;
+				case Instruction::Type::DEF:
+					l_routines.emplace(static_cast<InstructionWithLabel const &>(*l_instruction).GetLabel(),
+						m_instructions.size());
+					l_routine = m_instructions.size();
+					break;
+				case Instruction::Type::END:
+					if (l_routine)
+					{
+						m_targets[*l_routine] = m_instructions.size() + 1;
+						l_routine = NullOpt;
+					}
+					break;
+				default:
+					break;
+			}
+			m_instructions.push_back(l_instruction.get());
+		}
+
+		// The parser rejects these, programs built by hand may not
+		if (l_routine)
+		{
+			throw std::runtime_error(fmt::format("[line {}] Routine without \"end\"", At(*l_routine).GetLine()));
+		}
+
+		for (size_t l_index = 0; l_index < m_instructions.size(); l_index++)
+		{
+			Instruction::Type const l_type = m_instructions[l_index]->GetType();
+
+			if (!Instruction::IsJump(l_type) && l_type != Instruction::Type::CALL)
+			{
+				continue;
+			}
+
+			auto const &l_jump = static_cast<InstructionWithLabel const &>(*m_instructions[l_index]);
+			auto const &l_names = l_type == Instruction::Type::CALL ? l_routines : l_labels;
+			auto const l_target = l_names.find(l_jump.GetLabel());
+
+			if (l_target == l_names.end())
+			{
+				throw std::runtime_error(fmt::format("[line {}] Undefined {} '{}'", l_jump.GetLine(),
+					l_type == Instruction::Type::CALL ? "routine" : "label", l_jump.GetLabel()));
+			}
+			m_targets[l_index] = l_target->second;
+		}
+	}
+
+	size_t Code::GetSize() const
+	{
+		return m_instructions.size();
+	}
+
+	Instruction const &Code::At(size_t p_index) const
+	{
+		return *m_instructions[p_index];
+	}
+
+	size_t Code::GetTarget(size_t p_index) const
+	{
+		return m_targets[p_index];
+	}
+}
+}
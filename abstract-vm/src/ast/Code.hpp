@@ -0,0 +1,35 @@
+#pragma once
+#include "Instruction.hpp"
+
+namespace avm {
+namespace ast {
+
+	/*
+	 * The instructions of a program in an array, for the random access that
+	 * jumps need, with the targets resolved to indices: the label of a jump,
+	 * the "def" of a call, and the instruction after the matching "end" for
+	 * a "def", which straight-line code skips. The program must outlive the
+	 * Code and not change meanwhile.
+	 */
+	class Code
+	{
+	public:
+		Code() = delete;
+		explicit Code(Program const &p_program);
+		Code(const Code &) = delete;
+		~Code() = default;
+
+		Code &operator=(const Code &) = delete;
+
+		size_t GetSize() const;
+		Instruction const &At(size_t p_index) const;
+
+		// Index the jump, call or def at p_index goes to
+		size_t GetTarget(size_t p_index) const;
+
+	private:
+		Vector<Instruction const *> m_instructions;
+		Vector<size_t> m_targets;
+	};
+}
+}
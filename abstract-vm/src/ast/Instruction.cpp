@@ -1,16 +1,103 @@
 #include "Instruction.hpp"
+#include <algorithm>
 
 namespace avm {
 namespace ast {
 
+	// InstructionVisitor
+	// ==================
+
+	void InstructionVisitor::VisitInstructionWithArgument(InstructionWithArgument const &p_instruction)
+	{
+		VisitInstruction(p_instruction);
+	}
+
+	void InstructionVisitor::VisitInstructionWithValues(InstructionWithValues const &p_instruction)
+	{
+		VisitInstruction(p_instruction);
+	}
+
+	void InstructionVisitor::VisitInstructionWithFile(InstructionWithFile const &p_instruction)
+	{
+		VisitInstruction(p_instruction);
+	}
+
+	void InstructionVisitor::VisitInstructionWithLabel(InstructionWithLabel const &p_instruction)
+	{
+		VisitInstruction(p_instruction);
+	}
+
+	void InstructionVisitor::VisitInstructionWithBlock(InstructionWithBlock const &p_instruction)
+	{
+		VisitInstruction(p_instruction);
+	}
+
+	void InstructionVisitor::VisitInstructionWithEffect(InstructionWithEffect const &p_instruction)
+	{
+		VisitInstructionWithLabel(p_instruction);
+	}
+
 	// Instruction
 	// ===========
 
-	Instruction::Instruction(Type p_type) : m_type(p_type)
+	Instruction::Instruction(Type p_type, int p_line) : m_type(p_type), m_line(p_line)
 	{
 	}
 
 	Instruction::Type Instruction::GetType() const { return m_type; }
+	int Instruction::GetLine() const { return m_line; }
+
+	char const *Instruction::GetName() const
+	{
+		static const UnorderedMap<Type, char const *> l_names {
+			{ Type::PUSH,   "push"   },
+			{ Type::POP,    "pop"    },
+			{ Type::DUMP,   "dump"   },
+			{ Type::ASSERT, "assert" },
+			{ Type::ADD,    "add"    },
+			{ Type::SUB,    "sub"    },
+			{ Type::MUL,    "mul"    },
+			{ Type::DIV,    "div"    },
+			{ Type::MOD,    "mod"    },
+			{ Type::PRINT,  "print"  },
+			{ Type::EXIT,   "exit"   },
+			{ Type::SUM,    "sum"    },
+			{ Type::PROD,   "prod"   },
+			{ Type::MIN,    "min"    },
+			{ Type::MAX,    "max"    },
+			{ Type::MEAN,   "mean"   },
+			{ Type::DUP,    "dup"    },
+			{ Type::SWAP,   "swap"   },
+			{ Type::OVER,   "over"   },
+			{ Type::ROT,    "rot"    },
+			{ Type::STORE,  "store"  },
+			{ Type::LOAD,   "load"   },
+			{ Type::PUSH_ARRAY, "push" },
+			{ Type::LOAD_FILE,  "load" },
+			{ Type::LABEL,  "label"  },
+			{ Type::JMP,    "jmp"    },
+			{ Type::JZ,     "jz"     },
+			{ Type::JNZ,    "jnz"    },
+			{ Type::EQ,     "eq"     },
+			{ Type::NE,     "ne"     },
+			{ Type::LT,     "lt"     },
+			{ Type::LE,     "le"     },
+			{ Type::GT,     "gt"     },
+			{ Type::GE,     "ge"     },
+			{ Type::REPEAT, "repeat" },
+			{ Type::DEF,    "def"    },
+			{ Type::END,    "end"    },
+			{ Type::CALL,   "call"   },
+			{ Type::RET,    "ret"    },
+			{ Type::SORT,   "sort"   },
+			{ Type::STACKMIN,   "stackmin"   },
+			{ Type::STACKMAX,   "stackmax"   },
+			{ Type::STACKSUM,   "stacksum"   },
+			{ Type::STACKCOUNT, "stackcount" },
+		};
+
+		return l_names.at(m_type);
+	}
 
 
 	void Instruction::Print() const
@@ -26,8 +113,8 @@ namespace ast {
 	// InstructionWithValue
 	// ====================
 
-	InstructionWithValue::InstructionWithValue(Instruction::Type p_type, UniquePtr<Value const> p_value)
-		: Instruction(p_type), m_value(std::move(p_value))
+	InstructionWithValue::InstructionWithValue(Instruction::Type p_type, UniquePtr<Value const> p_value, int p_line)
+		: Instruction(p_type, p_line), m_value(std::move(p_value))
 	{
 	}
 
@@ -45,6 +132,114 @@ namespace ast {
 	}
 
 
+	// InstructionWithArgument
+	// =======================
+
+	InstructionWithArgument::InstructionWithArgument(Instruction::Type p_type, size_t p_argument, int p_line)
+		: Instruction(p_type, p_line), m_argument(p_argument)
+	{
+	}
+
+	size_t InstructionWithArgument::GetArgument() const { return m_argument; }
+
+	void InstructionWithArgument::Print() const
+	{
+		fmt::print("{} {}\n", m_type, m_argument);
+	}
+
+	void InstructionWithArgument::Accept(InstructionVisitor &p_visitor) const
+	{
+		p_visitor.VisitInstructionWithArgument(*this);
+	}
+
+	// InstructionWithValues
+	// =====================
+
+	InstructionWithValues::InstructionWithValues(eOperandType p_operandType, SharedPtr<Vector<int64_t> const> p_values,
+		int p_line)
+		: Instruction(Type::PUSH_ARRAY, p_line), m_operandType(p_operandType), m_values(std::move(p_values))
+	{
+	}
+
+	eOperandType InstructionWithValues::GetOperandType() const { return m_operandType; }
+	Vector<int64_t> const &InstructionWithValues::GetValues() const { return *m_values; }
+
+	void InstructionWithValues::Print() const
+	{
+		fmt::print("{} [{} values]\n", m_type, m_values->size());
+	}
+
+	void InstructionWithValues::Accept(InstructionVisitor &p_visitor) const
+	{
+		p_visitor.VisitInstructionWithValues(*this);
+	}
+
+	// InstructionWithFile
+	// ===================
+
+	InstructionWithFile::InstructionWithFile(eOperandType p_operandType, String p_path, int p_line)
+		: Instruction(Type::LOAD_FILE, p_line), m_operandType(p_operandType), m_path(std::move(p_path))
+	{
+	}
+
+	eOperandType InstructionWithFile::GetOperandType() const { return m_operandType; }
+	String const &InstructionWithFile::GetPath() const { return m_path; }
+
+	void InstructionWithFile::Print() const
+	{
+		fmt::print("{} \"{}\"\n", m_type, m_path);
+	}
+
+	void InstructionWithFile::Accept(InstructionVisitor &p_visitor) const
+	{
+		p_visitor.VisitInstructionWithFile(*this);
+	}
+
+	// InstructionWithLabel
+	// ====================
+
+	InstructionWithLabel::InstructionWithLabel(Instruction::Type p_type, String p_label, int p_line)
+		: Instruction(p_type, p_line), m_label(std::move(p_label))
+	{
+	}
+
+	String const &InstructionWithLabel::GetLabel() const { return m_label; }
+
+	void InstructionWithLabel::Print() const
+	{
+		fmt::print("{} {}\n", m_type, m_label);
+	}
+
+	void InstructionWithLabel::Accept(InstructionVisitor &p_visitor) const
+	{
+		p_visitor.VisitInstructionWithLabel(*this);
+	}
+
+	// InstructionWithEffect
+	// =====================
+
+	InstructionWithEffect::InstructionWithEffect(String p_name, Optional<StackEffect> p_effect, int p_line)
+		: InstructionWithLabel(Instruction::Type::DEF, std::move(p_name), p_line), m_effect(std::move(p_effect))
+	{
+	}
+
+	Optional<StackEffect> const &InstructionWithEffect::GetEffect() const { return m_effect; }
+
+	void InstructionWithEffect::Print() const
+	{
+		if (m_effect)
+		{
+			fmt::print("{} {} [{} -- {}]\n", m_type, m_label, m_effect->m_inputs.size(), m_effect->m_outputs.size());
+			return;
+		}
+		InstructionWithLabel::Print();
+	}
+
+	void InstructionWithEffect::Accept(InstructionVisitor &p_visitor) const
+	{
+		p_visitor.VisitInstructionWithEffect(*this);
+	}
+
 	// Program
 	// =======
 
@@ -69,6 +264,44 @@ namespace ast {
 		}
 	}
 
+	List<UniquePtr<Instruction const>> const &Program::GetInstructions() const
+	{
+		return m_instructions;
+	}
+
+	List<UniquePtr<Instruction const>> &Program::GetInstructions()
+	{
+		return m_instructions;
+	}
+
+	bool Program::HasOnlyBaseInstructions() const
+	{
+		return std::all_of(m_instructions.begin(), m_instructions.end(),
+			[] (UniquePtr<Instruction const> const &p_instruction) {
+				return Instruction::IsBase(p_instruction->GetType());
+			});
+	}
+
+	bool Program::HasQuery() const
+	{
+		return std::any_of(m_instructions.begin(), m_instructions.end(),
+			[] (UniquePtr<Instruction const> const &p_instruction) {
+				auto const *l_block = dynamic_cast<InstructionWithBlock const *>(p_instruction.get());
+
+				return Instruction::IsQuery(p_instruction->GetType()) || (l_block && l_block->GetBody().HasQuery());
+			});
+	}
+
+	void Program::SetStackCapacity(Optional<size_t> p_capacity)
+	{
+		m_stackCapacity = p_capacity;
+	}
+
+	Optional<size_t> Program::GetStackCapacity() const
+	{
+		return m_stackCapacity;
+	}
+
 	void Program::Print() const
 	{
 		for (auto const &l_i : m_instructions)
@@ -77,5 +310,27 @@ namespace ast {
 			l_i->Print();
 		}
 	}
+
+	// InstructionWithBlock
+	// ====================
+
+	InstructionWithBlock::InstructionWithBlock(Instruction::Type p_type, size_t p_count, SharedPtr<Program const> p_body,
+		int p_line)
+		: Instruction(p_type, p_line), m_count(p_count), m_body(std::move(p_body))
+	{
+	}
+
+	size_t InstructionWithBlock::GetCount() const { return m_count; }
+	Program const &InstructionWithBlock::GetBody() const { return *m_body; }
+
+	void InstructionWithBlock::Print() const
+	{
+		fmt::print("{} {} [{} instructions]\n", m_type, m_count, m_body->GetInstructions().size());
+	}
+
+	void InstructionWithBlock::Accept(InstructionVisitor &p_visitor) const
+	{
+		p_visitor.VisitInstructionWithBlock(*this);
+	}
 }
 }
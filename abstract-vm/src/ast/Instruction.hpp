@@ -8,6 +8,13 @@ namespace ast {
 
 	class Instruction;
 	class InstructionWithValue;
+	class InstructionWithArgument;
+	class InstructionWithValues;
+	class InstructionWithFile;
+	class InstructionWithLabel;
+	class InstructionWithBlock;
+	class InstructionWithEffect;
+	class Program;
 
 	class InstructionVisitor
 	{
@@ -16,6 +23,14 @@ namespace ast {
 
 		virtual void VisitInstruction(Instruction const &) {}
 		virtual void VisitInstructionWithValue(InstructionWithValue const &) {}
+
+		// Visitors that do not know the argument see a plain instruction
+		virtual void VisitInstructionWithArgument(InstructionWithArgument const &p_instruction);
+		virtual void VisitInstructionWithValues(InstructionWithValues const &p_instruction);
+		virtual void VisitInstructionWithFile(InstructionWithFile const &p_instruction);
+		virtual void VisitInstructionWithLabel(InstructionWithLabel const &p_instruction);
+		virtual void VisitInstructionWithBlock(InstructionWithBlock const &p_instruction);
+		virtual void VisitInstructionWithEffect(InstructionWithEffect const &p_instruction);
 	};
 
 	class InstructionVisitee
@@ -42,17 +57,98 @@ namespace ast {
 			MOD,
 			PRINT,
 			EXIT,
+			SUM,
+			PROD,
+			MIN,
+			MAX,
+			MEAN,
+			DUP,
+			SWAP,
+			OVER,
+			ROT,
+			STORE,
+			LOAD,
+			PUSH_ARRAY,
+			LOAD_FILE,
+			LABEL,
+			JMP,
+			JZ,
+			JNZ,
+			EQ,
+			NE,
+			LT,
+			LE,
+			GT,
+			GE,
+			REPEAT,
+			DEF,
+			END,
+			CALL,
+			RET,
+			SORT,
+			STACKMIN,
+			STACKMAX,
+			STACKSUM,
+			STACKCOUNT,
 		};
 
 	public:
 		Instruction() = delete;
-		Instruction(Type p_type);
+		Instruction(Type p_type, int p_line = 0);
 		Instruction(const Instruction &) = delete;
 		virtual ~Instruction() = default;
 
 		Instruction &operator=(const Instruction &) = delete;
 
 		Type GetType() const;
+		int GetLine() const;
+		char const *GetName() const;
+
+		/*
+		 * Instructions of the original language, which every engine runs.
+		 * Engines other than the Interpreter throw UnsupportedInstruction on
+		 * the others.
+		 */
+		static constexpr bool IsBase(Type p_type)
+		{
+			return p_type <= Type::EXIT;
+		}
+
+		// Bulk reductions, which take an optional count
+		static constexpr bool IsReduction(Type p_type)
+		{
+			return p_type >= Type::SUM && p_type <= Type::MEAN;
+		}
+
+		// store and load, whose argument is a register index
+		static constexpr bool IsRegisterAccess(Type p_type)
+		{
+			return p_type == Type::STORE || p_type == Type::LOAD;
+		}
+
+		// jmp, jz and jnz, which name a label
+		static constexpr bool IsJump(Type p_type)
+		{
+			return p_type == Type::JMP || p_type == Type::JZ || p_type == Type::JNZ;
+		}
+
+		// eq to ge, which replace two values with int8(1) or int8(0)
+		static constexpr bool IsComparison(Type p_type)
+		{
+			return p_type >= Type::EQ && p_type <= Type::GE;
+		}
+
+		// def, end, call and ret
+		static constexpr bool IsRoutine(Type p_type)
+		{
+			return p_type >= Type::DEF && p_type <= Type::RET;
+		}
+
+		// stackmin to stackcount, which push a figure of the whole stack
+		static constexpr bool IsQuery(Type p_type)
+		{
+			return p_type >= Type::STACKMIN && p_type <= Type::STACKCOUNT;
+		}
 
 		virtual void Print() const;
 
@@ -60,13 +156,14 @@ namespace ast {
 
 	protected:
 		Type const m_type;
+		int const m_line;
 	};
 
 	class InstructionWithValue : public Instruction
 	{
 	public:
 		InstructionWithValue() = delete;
-		InstructionWithValue(Instruction::Type p_type, UniquePtr<Value const> p_value);
+		InstructionWithValue(Instruction::Type p_type, UniquePtr<Value const> p_value, int p_line = 0);
 		InstructionWithValue(const InstructionWithValue &) = delete;
 
 		InstructionWithValue &operator=(const InstructionWithValue &) = delete;
@@ -83,6 +180,113 @@ namespace ast {
 		UniquePtr<Value const> m_value;
 	};
 
+	/*
+	 * Instruction followed by a count, like "sum 3", or by a register, like
+	 * "store r1". Without the count, the parser builds a plain Instruction.
+	 */
+	class InstructionWithArgument : public Instruction
+	{
+	public:
+		InstructionWithArgument() = delete;
+		InstructionWithArgument(Instruction::Type p_type, size_t p_argument, int p_line = 0);
+		InstructionWithArgument(const InstructionWithArgument &) = delete;
+
+		InstructionWithArgument &operator=(const InstructionWithArgument &) = delete;
+
+		virtual ~InstructionWithArgument() = default;
+
+		size_t GetArgument() const;
+
+		void Print() const override;
+
+		void Accept(InstructionVisitor &p_visitor) const override;
+
+	protected:
+		size_t m_argument;
+	};
+
+	/*
+	 * Bulk push of integers, like "push int32[1, 2, 3]". The parser checks
+	 * the values against the range of the type. Copies of a program share
+	 * the values.
+	 */
+	class InstructionWithValues : public Instruction
+	{
+	public:
+		InstructionWithValues() = delete;
+		InstructionWithValues(eOperandType p_operandType, SharedPtr<Vector<int64_t> const> p_values, int p_line = 0);
+		InstructionWithValues(const InstructionWithValues &) = delete;
+
+		InstructionWithValues &operator=(const InstructionWithValues &) = delete;
+
+		virtual ~InstructionWithValues() = default;
+
+		eOperandType GetOperandType() const;
+		Vector<int64_t> const &GetValues() const;
+
+		void Print() const override;
+
+		void Accept(InstructionVisitor &p_visitor) const override;
+
+	protected:
+		eOperandType m_operandType;
+		SharedPtr<Vector<int64_t> const> m_values;
+	};
+
+	/*
+	 * Bulk push of a binary file, like load int16 "samples.bin". The file
+	 * holds the raw little-endian values and is read when the instruction
+	 * runs.
+	 */
+	class InstructionWithFile : public Instruction
+	{
+	public:
+		InstructionWithFile() = delete;
+		InstructionWithFile(eOperandType p_operandType, String p_path, int p_line = 0);
+		InstructionWithFile(const InstructionWithFile &) = delete;
+
+		InstructionWithFile &operator=(const InstructionWithFile &) = delete;
+
+		virtual ~InstructionWithFile() = default;
+
+		eOperandType GetOperandType() const;
+		String const &GetPath() const;
+
+		void Print() const override;
+
+		void Accept(InstructionVisitor &p_visitor) const override;
+
+	protected:
+		eOperandType m_operandType;
+		String m_path;
+	};
+
+	/*
+	 * Label definition, like "loop:", or jump to a label, like "jnz loop".
+	 * The parser checks that every jump has a target and that no label is
+	 * defined twice.
+	 */
+	class InstructionWithLabel : public Instruction
+	{
+	public:
+		InstructionWithLabel() = delete;
+		InstructionWithLabel(Instruction::Type p_type, String p_label, int p_line = 0);
+		InstructionWithLabel(const InstructionWithLabel &) = delete;
+
+		InstructionWithLabel &operator=(const InstructionWithLabel &) = delete;
+
+		virtual ~InstructionWithLabel() = default;
+
+		String const &GetLabel() const;
+
+		void Print() const override;
+
+		void Accept(InstructionVisitor &p_visitor) const override;
+
+	protected:
+		String m_label;
+	};
+
 	class Program
 	{
 	public:
@@ -95,11 +299,85 @@ namespace ast {
 		void AddInstruction(UniquePtr<Instruction const> p_instruction);
 
 		UniquePtr<Instruction const> GetNextInstruction();
+		List<UniquePtr<Instruction const>> const &GetInstructions() const;
+		List<UniquePtr<Instruction const>> &GetInstructions();
+
+		// False when an instruction is not in the base set, see Instruction::IsBase()
+		bool HasOnlyBaseInstructions() const;
+		// True when a query, see Instruction::IsQuery(), is in the program or one of its blocks
+		bool HasQuery() const;
+
+		// Values to reserve on the stack, from a ";@stack N" pragma
+		void SetStackCapacity(Optional<size_t> p_capacity);
+		Optional<size_t> GetStackCapacity() const;
 
 		void Print() const;
 
 	private:
 		List<UniquePtr<Instruction const>> m_instructions;
+		Optional<size_t> m_stackCapacity;
+	};
+
+	// Types a routine takes from the top of the stack and leaves there, last on top
+	struct StackEffect
+	{
+		Vector<eOperandType> m_inputs;
+		Vector<eOperandType> m_outputs;
+	};
+
+	/*
+	 * Start of a routine, "def name" or "def name (int32 int32 -- int32)".
+	 * Its body runs until "ret" or the matching "end". Calls check a
+	 * declared stack effect when they enter and leave the routine, so the
+	 * static analysis may rely on it instead of following the call.
+	 */
+	class InstructionWithEffect : public InstructionWithLabel
+	{
+	public:
+		InstructionWithEffect() = delete;
+		InstructionWithEffect(String p_name, Optional<StackEffect> p_effect, int p_line = 0);
+		InstructionWithEffect(const InstructionWithEffect &) = delete;
+
+		InstructionWithEffect &operator=(const InstructionWithEffect &) = delete;
+
+		virtual ~InstructionWithEffect() = default;
+
+		Optional<StackEffect> const &GetEffect() const;
+
+		void Print() const override;
+
+		void Accept(InstructionVisitor &p_visitor) const override;
+
+	protected:
+		Optional<StackEffect> m_effect;
+	};
+
+	/*
+	 * Body run p_count times, for "repeat N { ... }" and macro uses (once).
+	 * The body is shared, neither the parser nor the engines copy it, and
+	 * it holds neither labels, jumps nor routines.
+	 */
+	class InstructionWithBlock : public Instruction
+	{
+	public:
+		InstructionWithBlock() = delete;
+		InstructionWithBlock(Instruction::Type p_type, size_t p_count, SharedPtr<Program const> p_body, int p_line = 0);
+		InstructionWithBlock(const InstructionWithBlock &) = delete;
+
+		InstructionWithBlock &operator=(const InstructionWithBlock &) = delete;
+
+		virtual ~InstructionWithBlock() = default;
+
+		size_t GetCount() const;
+		Program const &GetBody() const;
+
+		void Print() const override;
+
+		void Accept(InstructionVisitor &p_visitor) const override;
+
+	protected:
+		size_t m_count;
+		SharedPtr<Program const> m_body;
 	};
 }
 }
@@ -18,6 +18,19 @@ namespace ast {
 		Token const &Value::GetType() const { return m_type; }
 		Token const &Value::GetToken() const { return m_number; }
 
+		eOperandType Value::GetOperandType() const
+		{
+			static const UnorderedMap<TokenType, eOperandType> l_lookUp {
+				{ TokenType::INT8,   eOperandType::INT8   },
+				{ TokenType::INT16,  eOperandType::INT16  },
+				{ TokenType::INT32,  eOperandType::INT32  },
+				{ TokenType::FLOAT,  eOperandType::FLOAT  },
+				{ TokenType::DOUBLE, eOperandType::DOUBLE },
+			};
+
+			return l_lookUp.at(m_type.m_type);
+		}
+
 		void Value::Print() const
 		{
 			fmt::print("VALUE {} {}\n", m_type.m_lexeme, *m_number.m_literal);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../Lexer.hpp"
+#include "../IOperand.hpp"
 
 namespace avm {
 namespace ast {
@@ -17,6 +18,7 @@ namespace ast {
 
 		Token const &GetType() const;
 		Token const &GetToken() const;
+		eOperandType GetOperandType() const;
 
 		void Print() const;
 
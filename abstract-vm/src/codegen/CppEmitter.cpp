@@ -0,0 +1,255 @@
+#include <limits>
+#include "CppEmitter.hpp"
+#include "../Operand.hpp"
+#include "../OperandFactory.hpp"
+
+namespace avm {
+namespace codegen {
+
+	String CppEmitter::Run(ir::Function const &p_function, StringView p_origin)
+	{
+		m_function = &p_function;
+		m_out.clear();
+
+		m_out += fmt::format("// Generated by avm --emit-cpp from {}\n", p_origin);
+		m_out += "#include \"src/codegen/Runtime.hpp\"\n\n";
+		m_out += "static bool Program()\n{\n";
+
+		bool l_reachable = true;
+
+		for (ir::Inst const &l_inst : p_function.m_code)
+		{
+			if (!(l_reachable = EmitInstruction(l_inst)))
+			{
+				break;
+			}
+		}
+
+		if (l_reachable)
+		{
+			Line("return false;");
+		}
+
+		m_out += "}\n\nint main()\n{\n\treturn avm::codegen::Main(&Program);\n}\n";
+		m_function = nullptr;
+
+		return std::move(m_out);
+	}
+
+	bool CppEmitter::EmitInstruction(ir::Inst const &p_inst)
+	{
+		ir::Function const &l_function = *m_function;
+
+		switch (p_inst.m_opcode)
+		{
+			case ir::Opcode::CONST:
+			{
+				ir::Constant const &l_constant = l_function.m_constants[p_inst.m_index];
+				String const l_call = fmt::format("avm::codegen::Constant({}, \"{}\")",
+					TypeName(l_constant.m_type), l_constant.m_value);
+
+				if (!IsNative(p_inst.m_dst))
+				{
+					Line(fmt::format("avm::codegen::Value r{} = {};", p_inst.m_dst, l_call));
+					return true;
+				}
+
+				try
+				{
+					UniquePtr<IOperand const> l_value(OperandFactory::Get().CreateOperand(l_constant.m_type, l_constant.m_value));
+					Line(fmt::format("[[maybe_unused]] std::int64_t const r{} = {};", p_inst.m_dst,
+						static_cast<int64_t>(dynamic_cast<OperandBase const &>(*l_value).ToDouble())));
+					return true;
+				}
+				catch (std::exception const &)
+				{
+					Line(l_call + ";");
+					Line("return false;");
+					return false;
+				}
+			}
+			case ir::Opcode::ADD:
+			case ir::Opcode::SUB:
+			case ir::Opcode::MUL:
+			case ir::Opcode::DIV:
+			case ir::Opcode::MOD:
+				// Operand::operator/ casts the divisor to the dividend type
+				if (p_inst.m_opcode == ir::Opcode::DIV && IsNative(p_inst.m_lhs) && IsNative(p_inst.m_rhs)
+					&& l_function.m_types[p_inst.m_rhs] < l_function.m_types[p_inst.m_lhs])
+				{
+					Line(fmt::format("avm::codegen::Fault({}, {}, r{}, {}, r{});", OperationName(p_inst.m_opcode),
+						TypeName(l_function.m_types[p_inst.m_lhs]), p_inst.m_lhs,
+						TypeName(l_function.m_types[p_inst.m_rhs]), p_inst.m_rhs));
+					return false;
+				}
+				EmitArithmetic(p_inst);
+				return true;
+			case ir::Opcode::DROP:
+				if (!IsNative(p_inst.m_lhs))
+				{
+					Line(fmt::format("r{}.reset();", p_inst.m_lhs));
+				}
+				return true;
+			case ir::Opcode::DUMP:
+				for (size_t l_i = 0; l_i < p_inst.m_count; l_i++)
+				{
+					ir::Reg const l_reg = l_function.m_operands[p_inst.m_index + l_i];
+					Line(fmt::format("avm::codegen::Dump({}r{});", IsNative(l_reg) ? "" : "*", l_reg));
+				}
+				return true;
+			case ir::Opcode::PRINT:
+				if (l_function.m_types[p_inst.m_lhs] != eOperandType::INT8)
+				{
+					Line("throw avm::PrintError();");
+					return false;
+				}
+				Line(fmt::format("avm::codegen::Print(r{});", p_inst.m_lhs));
+				return true;
+			case ir::Opcode::ASSERT:
+			{
+				ir::Constant const &l_constant = l_function.m_constants[p_inst.m_index];
+				Line(fmt::format("avm::codegen::Assert({}, {}, \"{}\");",
+					AsOperand(p_inst.m_lhs), TypeName(l_constant.m_type), l_constant.m_value));
+				return true;
+			}
+			case ir::Opcode::EXIT:
+				Line("return true;");
+				return false;
+			case ir::Opcode::UNDERFLOW:
+				Line("throw avm::EmptyStackError();");
+				return false;
+		}
+		throw std::runtime_error("Unreachable!");
+	}
+
+	void CppEmitter::EmitArithmetic(ir::Inst const &p_inst)
+	{
+		ir::Function const &l_function = *m_function;
+		eOperandType const l_lhsType = l_function.m_types[p_inst.m_lhs];
+		eOperandType const l_rhsType = l_function.m_types[p_inst.m_rhs];
+		String const l_operation = OperationName(p_inst.m_opcode);
+		String const l_lhs = fmt::format("r{}", p_inst.m_lhs);
+		String const l_rhs = fmt::format("r{}", p_inst.m_rhs);
+		String const l_dst = fmt::format("r{}", p_inst.m_dst);
+
+		if (!IsNative(p_inst.m_dst))
+		{
+			Line(fmt::format("avm::codegen::Value {} = avm::codegen::Apply({}, {}, {}, {});", l_dst, l_operation,
+				p_inst.m_checked ? "true" : "false", AsOperand(p_inst.m_lhs), AsOperand(p_inst.m_rhs)));
+
+			for (ir::Reg l_reg : { p_inst.m_lhs, p_inst.m_rhs })
+			{
+				if (!IsNative(l_reg))
+				{
+					Line(fmt::format("r{}.reset();", l_reg));
+				}
+			}
+			return;
+		}
+
+		String const l_fault = fmt::format("avm::codegen::Fault({}, {}, {}, {}, {});",
+			l_operation, TypeName(l_lhsType), l_lhs, TypeName(l_rhsType), l_rhs);
+		int64_t l_min = 0;
+		int64_t l_max = 0;
+
+		switch (l_lhsType)
+		{
+			case eOperandType::INT8:
+				l_min = std::numeric_limits<int8_t>::min();
+				l_max = std::numeric_limits<int8_t>::max();
+				break;
+			case eOperandType::INT16:
+				l_min = std::numeric_limits<int16_t>::min();
+				l_max = std::numeric_limits<int16_t>::max();
+				break;
+			default:
+				l_min = std::numeric_limits<int32_t>::min();
+				l_max = std::numeric_limits<int32_t>::max();
+				break;
+		}
+
+		switch (p_inst.m_opcode)
+		{
+			case ir::Opcode::DIV:
+				if (p_inst.m_checked && l_rhsType == l_lhsType)
+				{
+					Line(fmt::format("if ({} == 0 || ({} == INT64_C({}) && {} == -1)) {}", l_rhs, l_lhs, l_min, l_rhs, l_fault));
+				}
+				else
+				{
+					Line(fmt::format("if ({} == 0) {}", l_rhs, l_fault));
+				}
+				// The guard is redundant at run time but keeps constant operands from tripping -Wdiv-by-zero
+				Line(fmt::format("[[maybe_unused]] std::int64_t const {} = {} != 0 ? {} / {} : 0;", l_dst, l_rhs, l_lhs, l_rhs));
+				break;
+			case ir::Opcode::MOD:
+				// Modulo by zero yields NaN in the operand classes
+				Line(fmt::format("[[maybe_unused]] std::int64_t const {} = {} != 0 ? {} % {} : avm::codegen::Slow({}, {}, {}, {}, {}, {});",
+					l_dst, l_rhs, l_lhs, l_rhs, l_operation, p_inst.m_checked ? "true" : "false",
+					TypeName(l_lhsType), l_lhs, TypeName(l_rhsType), l_rhs));
+				break;
+			default:
+			{
+				char const *const l_symbol = p_inst.m_opcode == ir::Opcode::ADD ? "+"
+					: p_inst.m_opcode == ir::Opcode::SUB ? "-" : "*";
+
+				Line(fmt::format("[[maybe_unused]] std::int64_t const {} = {} {} {};", l_dst, l_lhs, l_symbol, l_rhs));
+				// Operand checks the result against the left operand type
+				if (p_inst.m_checked)
+				{
+					Line(fmt::format("if ({} < INT64_C({}) || {} > INT64_C({})) {}", l_dst, l_min, l_dst, l_max, l_fault));
+				}
+				break;
+			}
+		}
+	}
+
+	void CppEmitter::Line(String const &p_code)
+	{
+		m_out += "\t" + p_code + "\n";
+	}
+
+	bool CppEmitter::IsNative(ir::Reg p_reg) const
+	{
+		eOperandType const l_type = m_function->m_types[p_reg];
+
+		return l_type != eOperandType::FLOAT && l_type != eOperandType::DOUBLE;
+	}
+
+	// The register as an IOperand expression
+	String CppEmitter::AsOperand(ir::Reg p_reg) const
+	{
+		if (IsNative(p_reg))
+		{
+			return fmt::format("*avm::codegen::Box({}, r{})", TypeName(m_function->m_types[p_reg]), p_reg);
+		}
+		return fmt::format("*r{}", p_reg);
+	}
+
+	String CppEmitter::TypeName(eOperandType p_type)
+	{
+		static const UnorderedMap<eOperandType, char const *> l_lookUp {
+			{ eOperandType::INT8,   "avm::eOperandType::INT8"   },
+			{ eOperandType::INT16,  "avm::eOperandType::INT16"  },
+			{ eOperandType::INT32,  "avm::eOperandType::INT32"  },
+			{ eOperandType::FLOAT,  "avm::eOperandType::FLOAT"  },
+			{ eOperandType::DOUBLE, "avm::eOperandType::DOUBLE" },
+		};
+
+		return l_lookUp.at(p_type);
+	}
+
+	String CppEmitter::OperationName(ir::Opcode p_opcode)
+	{
+		static const UnorderedMap<ir::Opcode, char const *> l_lookUp {
+			{ ir::Opcode::ADD, "avm::ast::Instruction::Type::ADD" },
+			{ ir::Opcode::SUB, "avm::ast::Instruction::Type::SUB" },
+			{ ir::Opcode::MUL, "avm::ast::Instruction::Type::MUL" },
+			{ ir::Opcode::DIV, "avm::ast::Instruction::Type::DIV" },
+			{ ir::Opcode::MOD, "avm::ast::Instruction::Type::MOD" },
+		};
+
+		return l_lookUp.at(p_opcode);
+	}
+}
+}
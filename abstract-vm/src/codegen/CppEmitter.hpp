@@ -0,0 +1,40 @@
+#pragma once
+#include "../ir/IR.hpp"
+
+namespace avm {
+namespace codegen {
+
+	/*
+	 * Translates an ir::Function into a standalone C++17 program built
+	 * against codegen/Runtime.hpp. Integer registers become int64_t locals
+	 * with the overflow checks inlined, other values stay operands.
+	 */
+	class CppEmitter
+	{
+	public:
+		CppEmitter() = default;
+		CppEmitter(const CppEmitter &) = delete;
+		~CppEmitter() = default;
+
+		CppEmitter &operator=(const CppEmitter &) = delete;
+
+		String Run(ir::Function const &p_function, StringView p_origin);
+
+	private:
+		// Returns false once the rest of the function cannot run
+		bool EmitInstruction(ir::Inst const &p_inst);
+		void EmitArithmetic(ir::Inst const &p_inst);
+		void Line(String const &p_code);
+
+		bool IsNative(ir::Reg p_reg) const;
+		String AsOperand(ir::Reg p_reg) const;
+
+		static String TypeName(eOperandType p_type);
+		static String OperationName(ir::Opcode p_opcode);
+
+	private:
+		ir::Function const *m_function = nullptr;
+		String m_out;
+	};
+}
+}
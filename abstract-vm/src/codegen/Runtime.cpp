@@ -0,0 +1,82 @@
+#include "Runtime.hpp"
+#include "../Arithmetic.hpp"
+
+namespace avm {
+namespace codegen {
+
+	Value Constant(eOperandType p_type, char const *p_literal)
+	{
+		return Value(OperandFactory::Get().CreateOperand(p_type, p_literal));
+	}
+
+	Value Box(eOperandType p_type, int64_t p_value)
+	{
+		return Value(OperandFactory::Get().CreateOperand(p_type, static_cast<double>(p_value)));
+	}
+
+	Value Apply(ast::Instruction::Type p_operation, bool p_checked, IOperand const &p_lhs, IOperand const &p_rhs)
+	{
+		return Value(p_checked
+			? avm::Apply(p_operation, p_lhs, p_rhs)
+			: ApplyUnchecked(p_operation, p_lhs, p_rhs));
+	}
+
+	void Fault(ast::Instruction::Type p_operation,
+		eOperandType p_lhsType, int64_t p_lhs, eOperandType p_rhsType, int64_t p_rhs)
+	{
+		Apply(p_operation, true, *Box(p_lhsType, p_lhs), *Box(p_rhsType, p_rhs));
+		throw std::runtime_error("Unreachable!");
+	}
+
+	int64_t Slow(ast::Instruction::Type p_operation, bool p_checked,
+		eOperandType p_lhsType, int64_t p_lhs, eOperandType p_rhsType, int64_t p_rhs)
+	{
+		Value l_result = Apply(p_operation, p_checked, *Box(p_lhsType, p_lhs), *Box(p_rhsType, p_rhs));
+
+		return static_cast<int64_t>(dynamic_cast<OperandBase const &>(*l_result).ToDouble());
+	}
+
+	void Dump(int64_t p_value)
+	{
+		fmt::print("{}\n", p_value);
+	}
+
+	void Dump(IOperand const &p_value)
+	{
+		fmt::print("{}\n", p_value.toString());
+	}
+
+	void Print(int64_t p_value)
+	{
+		fmt::print("{}", (char)p_value);
+	}
+
+	void Assert(IOperand const &p_value, eOperandType p_type, char const *p_expected)
+	{
+		if (p_type != p_value.getType())
+		{
+			throw AssertError();
+		}
+
+		Value l_expected(OperandFactory::Get().CreateOperand(p_type, p_expected));
+
+		if (p_value != *l_expected)
+		{
+			throw AssertError();
+		}
+	}
+
+	int Main(bool (*p_program)())
+	{
+		try
+		{
+			p_program();
+		}
+		catch (std::exception const &e)
+		{
+			fmt::print("Fatal Error: {}\n", e.what());
+		}
+		return 0;
+	}
+}
+}
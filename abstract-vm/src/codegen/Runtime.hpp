@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+#include "../Interpreter.hpp"
+#include "../Operand.hpp"
+#include "../OperandFactory.hpp"
+
+/*
+ * Support library of the C++ translation units produced by CppEmitter.
+ * Integer values are plain int64_t in generated code, everything else
+ * goes through the operand classes so results and faults match
+ * Interpreter exactly.
+ */
+namespace avm {
+namespace codegen {
+
+	using Value = UniquePtr<IOperand const>;
+
+	// The value of a push, or the exception it raises
+	Value Constant(eOperandType p_type, char const *p_literal);
+
+	Value Box(eOperandType p_type, int64_t p_value);
+
+	Value Apply(ast::Instruction::Type p_operation, bool p_checked, IOperand const &p_lhs, IOperand const &p_rhs);
+
+	// Rebuilds the exception of an integer operation the generated code
+	// found out of range
+	[[noreturn]] void Fault(ast::Instruction::Type p_operation,
+		eOperandType p_lhsType, int64_t p_lhs, eOperandType p_rhsType, int64_t p_rhs);
+
+	// Integer operation left to the operand classes, such as modulo by zero
+	int64_t Slow(ast::Instruction::Type p_operation, bool p_checked,
+		eOperandType p_lhsType, int64_t p_lhs, eOperandType p_rhsType, int64_t p_rhs);
+
+	void Dump(int64_t p_value);
+	void Dump(IOperand const &p_value);
+	void Print(int64_t p_value);
+	void Assert(IOperand const &p_value, eOperandType p_type, char const *p_expected);
+
+	// Runs a generated program the way avm runs a file
+	int Main(bool (*p_program)());
+}
+}
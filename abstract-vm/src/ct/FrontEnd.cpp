@@ -0,0 +1,78 @@
+#include "FrontEnd.hpp"
+#include "../simd/Integers.hpp"
+
+namespace avm {
+namespace ct {
+
+	CompileError::CompileError(char const *p_message, int p_line)
+		: std::runtime_error(fmt::format("[line {}] Error: {}", p_line, p_message)), m_line(p_line)
+	{
+	}
+
+	int CompileError::GetLine() const
+	{
+		return m_line;
+	}
+
+	UniquePtr<ast::Program> Load(Instruction const *p_instructions, std::size_t p_size)
+	{
+		static const UnorderedMap<eOperandType, Pair<TokenType, char const *>> l_lookUp {
+			{ eOperandType::INT8,   { TokenType::INT8,   "int8"   } },
+			{ eOperandType::INT16,  { TokenType::INT16,  "int16"  } },
+			{ eOperandType::INT32,  { TokenType::INT32,  "int32"  } },
+			{ eOperandType::FLOAT,  { TokenType::FLOAT,  "float"  } },
+			{ eOperandType::DOUBLE, { TokenType::DOUBLE, "double" } },
+		};
+
+		auto l_program = MakeUnique<ast::Program>();
+
+		for (std::size_t l_idx = 0; l_idx < p_size; l_idx++)
+		{
+			Instruction const &l_instruction = p_instructions[l_idx];
+
+			if (l_instruction.m_type == ast::Instruction::Type::PUSH_ARRAY)
+			{
+				auto l_values = MakeShared<Vector<int64_t>>();
+
+				simd::ParseIntegers(l_instruction.m_literal, *l_values);
+				l_program->AddInstruction(MakeUnique<ast::InstructionWithValues>(l_instruction.m_operandType,
+					std::move(l_values), l_instruction.m_line));
+				continue;
+			}
+			if (l_instruction.m_type == ast::Instruction::Type::LOAD_FILE)
+			{
+				l_program->AddInstruction(MakeUnique<ast::InstructionWithFile>(l_instruction.m_operandType,
+					String(l_instruction.m_literal), l_instruction.m_line));
+				continue;
+			}
+			if (l_instruction.m_type == ast::Instruction::Type::LABEL || ast::Instruction::IsJump(l_instruction.m_type))
+			{
+				l_program->AddInstruction(MakeUnique<ast::InstructionWithLabel>(l_instruction.m_type,
+					String(l_instruction.m_literal), l_instruction.m_line));
+				continue;
+			}
+			if (l_instruction.m_argument > 0 || ast::Instruction::IsRegisterAccess(l_instruction.m_type))
+			{
+				l_program->AddInstruction(MakeUnique<ast::InstructionWithArgument>(l_instruction.m_type,
+					l_instruction.m_argument, l_instruction.m_line));
+				continue;
+			}
+			if (!l_instruction.HasValue())
+			{
+				l_program->AddInstruction(MakeUnique<ast::Instruction>(l_instruction.m_type, l_instruction.m_line));
+				continue;
+			}
+
+			auto const &l_type = l_lookUp.at(l_instruction.m_operandType);
+			String const l_literal(l_instruction.m_literal);
+
+			l_program->AddInstruction(MakeUnique<ast::InstructionWithValue>(l_instruction.m_type,
+				MakeUnique<ast::Value>(
+					Token(l_type.first, l_type.second, NullOpt, l_instruction.m_line),
+					Token(TokenType::NUMBER, l_literal, l_literal, l_instruction.m_line)),
+				l_instruction.m_line));
+		}
+		return l_program;
+	}
+}
+}
@@ -0,0 +1,557 @@
+#pragma once
+#include "../abstractvm.hpp"
+#include "../IOperand.hpp"
+#include "../ast/Instruction.hpp"
+#include "../RegisterFile.hpp"
+#include <limits>
+#include <stdexcept>
+
+/*
+ * Compile-time front-end
+ * ======================
+ *
+ * A constexpr lexer, parser and type checker for programs embedded as string
+ * literals. The program is lowered to a fixed-size Image while the host is
+ * being compiled:
+ *
+ *     constexpr auto l_image = AVM_CT_COMPILE("push int32(42)\ndump\n");
+ *     auto l_program = avm::ct::Load(l_image);
+ *
+ * A malformed program throws a CompileError, which is not a constant
+ * expression, so the host fails to build and the diagnostic points at the
+ * throw below that rejected it. Called at run time, the same functions throw
+ * the CompileError as usual.
+ *
+ * The accepted language is the one of Lexer and Parser, with the values
+ * checked against the range of their type like OperandFactory does and the
+ * labels resolved like Parser does. Blocks, macros and routines are not
+ * supported: an image is flat.
+ */
+
+namespace avm {
+namespace ct {
+
+	class CompileError : public std::runtime_error
+	{
+	public:
+		CompileError(char const *p_message, int p_line);
+
+		int GetLine() const;
+
+	private:
+		int m_line;
+	};
+
+	struct Instruction
+	{
+		ast::Instruction::Type m_type = ast::Instruction::Type::POP;
+		eOperandType m_operandType = eOperandType::INT8;
+		StringView m_literal;
+		std::size_t m_argument = 0;
+		int m_line = 0;
+
+		constexpr bool HasValue() const
+		{
+			return m_type == ast::Instruction::Type::PUSH || m_type == ast::Instruction::Type::ASSERT;
+		}
+	};
+
+	template <std::size_t N>
+	struct Image
+	{
+		Array<Instruction, N> m_instructions{};
+		std::size_t m_size = 0;
+
+		constexpr std::size_t GetSize() const { return m_size; }
+		constexpr Instruction const &operator[](std::size_t p_idx) const { return m_instructions[p_idx]; }
+	};
+
+	inline constexpr Pair<StringView, ast::Instruction::Type> s_instructions[] = {
+		{   "push", ast::Instruction::Type::PUSH },
+		{    "pop", ast::Instruction::Type::POP },
+		{   "dump", ast::Instruction::Type::DUMP },
+		{ "assert", ast::Instruction::Type::ASSERT },
+		{    "add", ast::Instruction::Type::ADD },
+		{    "sub", ast::Instruction::Type::SUB },
+		{    "mul", ast::Instruction::Type::MUL },
+		{    "div", ast::Instruction::Type::DIV },
+		{    "mod", ast::Instruction::Type::MOD },
+		{  "print", ast::Instruction::Type::PRINT },
+		{   "exit", ast::Instruction::Type::EXIT },
+		{    "sum", ast::Instruction::Type::SUM },
+		{   "prod", ast::Instruction::Type::PROD },
+		{    "min", ast::Instruction::Type::MIN },
+		{    "max", ast::Instruction::Type::MAX },
+		{   "mean", ast::Instruction::Type::MEAN },
+		{   "sort", ast::Instruction::Type::SORT },
+		{   "stackmin", ast::Instruction::Type::STACKMIN },
+		{   "stackmax", ast::Instruction::Type::STACKMAX },
+		{   "stacksum", ast::Instruction::Type::STACKSUM },
+		{ "stackcount", ast::Instruction::Type::STACKCOUNT },
+		{    "dup", ast::Instruction::Type::DUP },
+		{   "swap", ast::Instruction::Type::SWAP },
+		{   "over", ast::Instruction::Type::OVER },
+		{    "rot", ast::Instruction::Type::ROT },
+		{  "store", ast::Instruction::Type::STORE },
+		{   "load", ast::Instruction::Type::LOAD },
+		{    "jmp", ast::Instruction::Type::JMP },
+		{     "jz", ast::Instruction::Type::JZ },
+		{    "jnz", ast::Instruction::Type::JNZ },
+		{     "eq", ast::Instruction::Type::EQ },
+		{     "ne", ast::Instruction::Type::NE },
+		{     "lt", ast::Instruction::Type::LT },
+		{     "le", ast::Instruction::Type::LE },
+		{     "gt", ast::Instruction::Type::GT },
+		{     "ge", ast::Instruction::Type::GE },
+	};
+
+	inline constexpr Pair<StringView, eOperandType> s_types[] = {
+		{   "int8", eOperandType::INT8 },
+		{  "int16", eOperandType::INT16 },
+		{  "int32", eOperandType::INT32 },
+		{  "float", eOperandType::FLOAT },
+		{ "double", eOperandType::DOUBLE },
+	};
+
+	/*
+	 * Reads one instruction per call. Lexing and parsing are fused since
+	 * every instruction fits on a single line.
+	 */
+	class Reader
+	{
+	public:
+		constexpr explicit Reader(StringView p_source) : m_source(p_source) {}
+
+		constexpr bool Next(Instruction &p_instruction)
+		{
+			while (SkipBlank(), !IsAtEnd() && Peek() == '\n')
+			{
+				m_current++;
+				m_line++;
+			}
+			if (IsAtEnd())
+			{
+				return false;
+			}
+
+			p_instruction = Instruction();
+			p_instruction.m_line = m_line;
+
+			StringView const l_name = Word();
+
+			// Label definition: "loop:", the literal is its name
+			if (Peek() == ':')
+			{
+				m_current++;
+				p_instruction.m_type = ast::Instruction::Type::LABEL;
+				p_instruction.m_literal = l_name;
+			}
+			else
+			{
+				p_instruction.m_type = InstructionType(l_name);
+			}
+
+			if (ast::Instruction::IsJump(p_instruction.m_type))
+			{
+				SkipBlank();
+				if (!IsAlpha(Peek()))
+				{
+					throw CompileError("Expected a label", m_line);
+				}
+				p_instruction.m_literal = Word();
+			}
+			else if (p_instruction.HasValue())
+			{
+				SkipBlank();
+				p_instruction.m_operandType = OperandType(Word());
+				SkipBlank();
+				if (p_instruction.m_type == ast::Instruction::Type::PUSH && Peek() == '[')
+				{
+					p_instruction.m_type = ast::Instruction::Type::PUSH_ARRAY;
+					p_instruction.m_literal = Values(p_instruction.m_operandType);
+				}
+				else
+				{
+					Expect('(', "Expected \"(\" after type");
+					p_instruction.m_literal = Number();
+					Expect(')', "Expected \")\" after number.");
+					Check(p_instruction);
+				}
+			}
+			else if (ast::Instruction::IsRegisterAccess(p_instruction.m_type))
+			{
+				SkipBlank();
+
+				StringView const l_word = Word();
+
+				// Bulk push of a binary file: load int16 "samples.bin"
+				if (p_instruction.m_type == ast::Instruction::Type::LOAD && l_word[0] != 'r')
+				{
+					p_instruction.m_type = ast::Instruction::Type::LOAD_FILE;
+					p_instruction.m_operandType = OperandType(l_word);
+					p_instruction.m_literal = Path();
+				}
+				else
+				{
+					p_instruction.m_argument = Register(l_word);
+				}
+			}
+			else if (ast::Instruction::IsReduction(p_instruction.m_type) || p_instruction.m_type == ast::Instruction::Type::SORT)
+			{
+				// Optional count of the bulk reductions and of sort
+				SkipBlank();
+				if (IsDigit(Peek()) || Peek() == '-')
+				{
+					p_instruction.m_argument = Count();
+				}
+			}
+
+			SkipBlank();
+			if (!IsAtEnd() && Peek() != '\n')
+			{
+				throw CompileError("Expected newline", m_line);
+			}
+			return true;
+		}
+
+	private:
+		constexpr bool IsAtEnd() const { return m_current >= m_source.length(); }
+		constexpr char Peek() const { return IsAtEnd() ? '\0' : m_source[m_current]; }
+
+		static constexpr bool IsAlpha(char p_char)
+		{
+			return (p_char >= 'A' && p_char <= 'Z') || (p_char >= 'a' && p_char <= 'z');
+		}
+
+		static constexpr bool IsDigit(char p_char)
+		{
+			return p_char >= '0' && p_char <= '9';
+		}
+
+		constexpr void SkipBlank()
+		{
+			while (!IsAtEnd())
+			{
+				char const l_ch = Peek();
+
+				if (l_ch == ';')
+				{
+					// Comment: skip until new line
+					while (!IsAtEnd() && Peek() != '\n') m_current++;
+				}
+				else if (l_ch == ' ' || l_ch == '\t' || l_ch == '\r')
+				{
+					m_current++;
+				}
+				else
+				{
+					break;
+				}
+			}
+		}
+
+		constexpr StringView Word()
+		{
+			std::size_t const l_start = m_current;
+
+			if (!IsAlpha(Peek()))
+			{
+				throw CompileError("Unexpected Character", m_line);
+			}
+			while (IsAlpha(Peek()) || IsDigit(Peek()))
+			{
+				m_current++;
+			}
+			return m_source.substr(l_start, m_current - l_start);
+		}
+
+		constexpr StringView Number()
+		{
+			SkipBlank();
+
+			std::size_t const l_start = m_current;
+
+			if (Peek() == '-')
+			{
+				m_current++;
+			}
+			if (!IsDigit(Peek()))
+			{
+				throw CompileError("Expected a number", m_line);
+			}
+			while (IsDigit(Peek()))
+			{
+				m_current++;
+			}
+			if (Peek() == '.' && m_current + 1 < m_source.length() && IsDigit(m_source[m_current + 1]))
+			{
+				m_current++;
+				while (IsDigit(Peek()))
+				{
+					m_current++;
+				}
+			}
+			return m_source.substr(l_start, m_current - l_start);
+		}
+
+		constexpr std::size_t Count()
+		{
+			StringView const l_number = Number();
+			std::size_t l_count = 0;
+
+			if (l_number[0] == '-' || l_number.length() > 9 || l_number.find('.') != StringView::npos)
+			{
+				throw CompileError("Expected a positive count", m_line);
+			}
+			for (char l_digit : l_number)
+			{
+				l_count = l_count * 10 + static_cast<std::size_t>(l_digit - '0');
+			}
+			if (l_count == 0)
+			{
+				throw CompileError("Expected a positive count", m_line);
+			}
+			return l_count;
+		}
+
+		// Body of a bulk push, every value checked like the one of a push
+		constexpr StringView Values(eOperandType p_type)
+		{
+			if (p_type == eOperandType::FLOAT || p_type == eOperandType::DOUBLE)
+			{
+				throw CompileError("Expected an integer type", m_line);
+			}
+
+			Instruction l_value;
+			std::size_t const l_start = ++m_current;
+
+			l_value.m_operandType = p_type;
+			for (;;)
+			{
+				l_value.m_literal = Number();
+				if (l_value.m_literal.find('.') != StringView::npos)
+				{
+					throw CompileError("Expected integers separated by \",\"", m_line);
+				}
+				Check(l_value);
+				SkipBlank();
+				if (Peek() != ',')
+				{
+					break;
+				}
+				m_current++;
+			}
+
+			if (Peek() != ']')
+			{
+				throw CompileError("Expected \"]\" after values", m_line);
+			}
+			return m_source.substr(l_start, m_current++ - l_start);
+		}
+
+		constexpr StringView Path()
+		{
+			Expect('"', "Expected a file path");
+
+			std::size_t const l_start = m_current;
+
+			while (!IsAtEnd() && Peek() != '"' && Peek() != '\n')
+			{
+				m_current++;
+			}
+			if (Peek() != '"')
+			{
+				throw CompileError("Unterminated string", m_line);
+			}
+			return m_source.substr(l_start, m_current++ - l_start);
+		}
+
+		// r0 to r15, see RegisterFile
+		constexpr std::size_t Register(StringView p_word) const
+		{
+			std::size_t l_index = 0;
+
+			if (p_word.length() < 2 || p_word.length() > 3 || p_word[0] != 'r')
+			{
+				throw CompileError("Expected a register", m_line);
+			}
+			for (char l_digit : p_word.substr(1))
+			{
+				if (!IsDigit(l_digit))
+				{
+					throw CompileError("Expected a register", m_line);
+				}
+				l_index = l_index * 10 + static_cast<std::size_t>(l_digit - '0');
+			}
+			if (l_index >= RegisterFile::s_count)
+			{
+				throw CompileError("Expected a register from r0 to r15", m_line);
+			}
+			return l_index;
+		}
+
+		constexpr void Expect(char p_expected, char const *p_message)
+		{
+			SkipBlank();
+			if (Peek() != p_expected)
+			{
+				throw CompileError(p_message, m_line);
+			}
+			m_current++;
+		}
+
+		constexpr ast::Instruction::Type InstructionType(StringView p_word) const
+		{
+			for (auto const &l_entry : s_instructions)
+			{
+				if (l_entry.first == p_word)
+				{
+					return l_entry.second;
+				}
+			}
+			throw CompileError("Unexpected Identifier", m_line);
+		}
+
+		constexpr eOperandType OperandType(StringView p_word) const
+		{
+			for (auto const &l_entry : s_types)
+			{
+				if (l_entry.first == p_word)
+				{
+					return l_entry.second;
+				}
+			}
+			throw CompileError("Expected a number", m_line);
+		}
+
+		/*
+		 * Same ranges as OperandFactory. Integer types only read the integral
+		 * part of the literal, like std::stoi.
+		 */
+		constexpr void Check(Instruction const &p_instruction) const
+		{
+			StringView const l_literal = p_instruction.m_literal;
+			bool const l_negative = l_literal[0] == '-';
+			std::size_t l_idx = l_negative ? 1 : 0;
+
+			if (p_instruction.m_operandType == eOperandType::FLOAT
+				|| p_instruction.m_operandType == eOperandType::DOUBLE)
+			{
+				double const l_max = p_instruction.m_operandType == eOperandType::FLOAT
+					? std::numeric_limits<float>::max() : std::numeric_limits<double>::max();
+				double l_value = 0.0;
+
+				for (; l_idx < l_literal.length() && IsDigit(l_literal[l_idx]); l_idx++)
+				{
+					double const l_digit = l_literal[l_idx] - '0';
+
+					if (l_value > (l_max - l_digit) / 10.0)
+					{
+						throw CompileError("Value out of range", m_line);
+					}
+					l_value = l_value * 10.0 + l_digit;
+				}
+				return;
+			}
+
+			int64_t l_min = std::numeric_limits<int32_t>::min();
+			int64_t l_max = std::numeric_limits<int32_t>::max();
+			int64_t l_value = 0;
+
+			if (p_instruction.m_operandType == eOperandType::INT8)
+			{
+				l_min = std::numeric_limits<int8_t>::min();
+				l_max = std::numeric_limits<int8_t>::max();
+			}
+			else if (p_instruction.m_operandType == eOperandType::INT16)
+			{
+				l_min = std::numeric_limits<int16_t>::min();
+				l_max = std::numeric_limits<int16_t>::max();
+			}
+
+			for (; l_idx < l_literal.length() && IsDigit(l_literal[l_idx]); l_idx++)
+			{
+				l_value = l_value * 10 + (l_literal[l_idx] - '0');
+				if ((l_negative ? -l_value : l_value) < l_min || (l_negative ? -l_value : l_value) > l_max)
+				{
+					throw CompileError("Value out of range", m_line);
+				}
+			}
+		}
+
+	private:
+		StringView m_source;
+		std::size_t m_current = 0;
+		int m_line = 1;
+	};
+
+	constexpr std::size_t Count(StringView p_source)
+	{
+		Reader l_reader(p_source);
+		Instruction l_instruction;
+		std::size_t l_count = 0;
+
+		while (l_reader.Next(l_instruction))
+		{
+			l_count++;
+		}
+		return l_count;
+	}
+
+	template <std::size_t N>
+	constexpr Image<N> Compile(StringView p_source)
+	{
+		Image<N> l_image;
+		Reader l_reader(p_source);
+		Instruction l_instruction;
+
+		while (l_reader.Next(l_instruction))
+		{
+			if (l_image.m_size == N)
+			{
+				throw CompileError("Program does not fit the image", l_instruction.m_line);
+			}
+			l_image.m_instructions[l_image.m_size++] = l_instruction;
+		}
+
+		// Every label defined once, every jump to a defined label
+		for (std::size_t l_idx = 0; l_idx < l_image.m_size; l_idx++)
+		{
+			Instruction const &l_current = l_image.m_instructions[l_idx];
+			bool const l_isLabel = l_current.m_type == ast::Instruction::Type::LABEL;
+			bool l_defined = false;
+
+			if (!l_isLabel && !ast::Instruction::IsJump(l_current.m_type))
+			{
+				continue;
+			}
+			for (std::size_t l_other = 0; l_other < (l_isLabel ? l_idx : l_image.m_size); l_other++)
+			{
+				l_defined = l_defined || (l_image.m_instructions[l_other].m_type == ast::Instruction::Type::LABEL
+					&& l_image.m_instructions[l_other].m_literal == l_current.m_literal);
+			}
+			if (l_isLabel && l_defined)
+			{
+				throw CompileError("Label already defined", l_current.m_line);
+			}
+			if (!l_isLabel && !l_defined)
+			{
+				throw CompileError("Undefined label", l_current.m_line);
+			}
+		}
+		return l_image;
+	}
+
+	// Builds the instructions of an image, nothing is lexed nor parsed
+	UniquePtr<ast::Program> Load(Instruction const *p_instructions, std::size_t p_size);
+
+	template <std::size_t N>
+	UniquePtr<ast::Program> Load(Image<N> const &p_image)
+	{
+		return Load(p_image.m_instructions.data(), p_image.m_size);
+	}
+}
+}
+
+// Sizes the image to the program, p_source must be a constant expression
+#define AVM_CT_COMPILE(p_source) avm::ct::Compile<avm::ct::Count(p_source)>(p_source)
@@ -0,0 +1,287 @@
+#include "DataflowInterpreter.hpp"
+#include "WorkStealingPool.hpp"
+#include "../Arithmetic.hpp"
+#include "../Interpreter.hpp"
+
+namespace avm {
+namespace dataflow {
+
+	DataflowInterpreter::DataflowInterpreter(size_t p_threads, size_t p_threshold, size_t p_grain)
+		: m_threads(p_threads), m_threshold(p_threshold), m_grain(p_grain > 0 ? p_grain : 1)
+	{
+	}
+
+	void DataflowInterpreter::Run(ast::Program const &p_program)
+	{
+		m_tasks = 0;
+
+		// The graph only models the base instructions
+		if (!p_program.HasOnlyBaseInstructions())
+		{
+			RunSequential(p_program);
+			return;
+		}
+
+		m_graph.Build(p_program);
+
+		if (m_threads <= 1 || m_graph.GetNodes().size() < m_threshold)
+		{
+			RunSequential(p_program);
+			return;
+		}
+
+		size_t const l_count = m_graph.GetNodes().size();
+
+		m_values.clear();
+		m_values.resize(l_count);
+		m_errors.assign(l_count, nullptr);
+
+		Schedule();
+		Replay();
+
+		m_values.clear();
+		m_errors.clear();
+	}
+
+	bool DataflowInterpreter::HasExited() const
+	{
+		return m_shouldExit;
+	}
+
+	size_t DataflowInterpreter::GetTaskCount() const
+	{
+		return m_tasks;
+	}
+
+	void DataflowInterpreter::RunSequential(ast::Program const &p_program)
+	{
+		Interpreter l_interpreter;
+
+		l_interpreter.Run(p_program);
+		m_shouldExit = l_interpreter.HasExited();
+	}
+
+	/*
+	 * Cuts the forest into tasks: a node starts a new task when it is a
+	 * root or when the part of its subtree not yet cut reaches the grain.
+	 * A task waits for the tasks computing its inputs, and since a value has
+	 * one consumer, each task unblocks at most one other.
+	 */
+	void DataflowInterpreter::Schedule()
+	{
+		Vector<Node> const &l_nodes = m_graph.GetNodes();
+		size_t const l_count = l_nodes.size();
+		Vector<size_t> l_weight(l_count);
+		Vector<size_t> l_task(l_count, Node::NONE);
+
+		for (size_t l_i = 0; l_i < l_count; l_i++)
+		{
+			Node const &l_node = l_nodes[l_i];
+			size_t l_sum = 1;
+
+			for (size_t l_input : { l_node.m_lhs, l_node.m_rhs })
+			{
+				if (l_input != Node::NONE && l_task[l_input] == Node::NONE)
+				{
+					l_sum += l_weight[l_input];
+				}
+			}
+
+			l_weight[l_i] = l_sum;
+			if (l_node.m_consumer == Node::NONE || l_sum >= m_grain)
+			{
+				l_task[l_i] = m_tasks++;
+			}
+		}
+
+		Vector<Vector<size_t>> l_members(m_tasks);
+		Vector<size_t> l_dependent(m_tasks, Node::NONE);
+		UniquePtr<std::atomic<size_t>[]> l_pending(new std::atomic<size_t>[m_tasks]());
+
+		for (size_t l_i = l_count; l_i-- > 0;)
+		{
+			if (l_task[l_i] == Node::NONE)
+			{
+				l_task[l_i] = l_task[l_nodes[l_i].m_consumer];
+			}
+			else if (l_nodes[l_i].m_consumer != Node::NONE)
+			{
+				size_t const l_next = l_task[l_nodes[l_i].m_consumer];
+
+				l_dependent[l_task[l_i]] = l_next;
+				l_pending[l_next]++;
+			}
+		}
+		for (size_t l_i = 0; l_i < l_count; l_i++)
+		{
+			l_members[l_task[l_i]].push_back(l_i);
+		}
+
+		// Collected up front: once tasks run, counters reach zero on their own
+		Vector<size_t> l_ready;
+
+		for (size_t l_i = 0; l_i < m_tasks; l_i++)
+		{
+			if (l_pending[l_i] == 0)
+			{
+				l_ready.push_back(l_i);
+			}
+		}
+
+		WorkStealingPool l_pool(m_threads);
+		std::function<void(size_t)> l_run = [&](size_t p_task)
+		{
+			for (size_t l_node : l_members[p_task])
+			{
+				Compute(l_node);
+			}
+
+			size_t const l_next = l_dependent[p_task];
+
+			if (l_next != Node::NONE && l_pending[l_next].fetch_sub(1) == 1)
+			{
+				l_pool.Submit([&l_run, l_next] { l_run(l_next); });
+			}
+		};
+
+		for (size_t l_i : l_ready)
+		{
+			l_pool.Submit([&l_run, l_i] { l_run(l_i); });
+		}
+		l_pool.Wait();
+	}
+
+	/*
+	 * A node whose input faulted stays empty: the replay stops before it.
+	 * Inputs are released once their only consumer is computed, unless the
+	 * replay still reads them, so like Interpreter the values alive at once
+	 * are bounded by the depth of the stack rather than by the program.
+	 */
+	void DataflowInterpreter::Compute(size_t p_node)
+	{
+		Node const &l_node = m_graph.GetNodes()[p_node];
+
+		try
+		{
+			if (l_node.m_instruction->GetType() == ast::Instruction::Type::PUSH)
+			{
+				ast::Value const &l_value =
+					*static_cast<ast::InstructionWithValue const *>(l_node.m_instruction)->GetValue();
+
+				m_values[p_node].reset(OperandFactory::Get().CreateOperand(
+					l_value.GetOperandType(), *l_value.GetToken().m_literal));
+			}
+			else if (m_values[l_node.m_lhs] && m_values[l_node.m_rhs])
+			{
+				m_values[p_node].reset(Apply(l_node.m_instruction->GetType(),
+					*m_values[l_node.m_lhs], *m_values[l_node.m_rhs]));
+			}
+		}
+		catch (...)
+		{
+			m_errors[p_node] = std::current_exception();
+		}
+
+		for (size_t l_input : { l_node.m_lhs, l_node.m_rhs })
+		{
+			if (l_input != Node::NONE && !m_graph.GetNodes()[l_input].m_observed)
+			{
+				m_values[l_input].reset();
+			}
+		}
+	}
+
+	void DataflowInterpreter::Raise(size_t p_node) const
+	{
+		if (m_errors[p_node])
+		{
+			std::rethrow_exception(m_errors[p_node]);
+		}
+	}
+
+	void DataflowInterpreter::Replay()
+	{
+		Vector<size_t> l_stack;
+		size_t l_node = 0;
+
+		for (ast::Instruction const *l_instruction : m_graph.GetSteps())
+		{
+			ast::Instruction::Type const l_type = l_instruction->GetType();
+
+			if (IsArithmetic(l_type))
+			{
+				if (l_stack.size() < 2)
+				{
+					throw EmptyStackError();
+				}
+				l_stack.resize(l_stack.size() - 2);
+				Raise(l_node);
+				l_stack.push_back(l_node++);
+				continue;
+			}
+
+			if (l_type != ast::Instruction::Type::PUSH
+				&& l_type != ast::Instruction::Type::DUMP
+				&& l_type != ast::Instruction::Type::EXIT
+				&& l_stack.empty())
+			{
+				throw EmptyStackError();
+			}
+
+			switch (l_type)
+			{
+				case ast::Instruction::Type::PUSH:
+					Raise(l_node);
+					l_stack.push_back(l_node++);
+					break;
+				case ast::Instruction::Type::POP:
+					l_stack.pop_back();
+					break;
+				case ast::Instruction::Type::DUMP:
+					for (auto l_stackVal = l_stack.rbegin(); l_stackVal != l_stack.rend(); l_stackVal++)
+					{
+						fmt::print("{}\n", m_values[*l_stackVal]->toString());
+					}
+					break;
+				case ast::Instruction::Type::PRINT:
+				{
+					Operand<int8_t> const *l_operand =
+						dynamic_cast<Operand<int8_t> const *>(m_values[l_stack.back()].get());
+
+					if (l_operand == nullptr)
+					{
+						throw PrintError();
+					}
+					fmt::print("{}", (char)l_operand->GetValue());
+					break;
+				}
+				case ast::Instruction::Type::ASSERT:
+				{
+					IOperand const &l_assertion = *m_values[l_stack.back()];
+					ast::Value const &l_value =
+						*static_cast<ast::InstructionWithValue const *>(l_instruction)->GetValue();
+
+					if (l_value.GetOperandType() != l_assertion.getType())
+					{
+						throw AssertError();
+					}
+
+					UniquePtr<IOperand const> l_expected(OperandFactory::Get().CreateOperand(
+						l_value.GetOperandType(), l_value.GetToken().m_lexeme));
+
+					if (l_assertion != *l_expected)
+					{
+						throw AssertError();
+					}
+					break;
+				}
+				case ast::Instruction::Type::EXIT:
+					m_shouldExit = true;
+					return;
+				default:
+					throw std::runtime_error("Unreachable!");
+			}
+		}
+	}
+}
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <exception>
+#include <thread>
+#include "Graph.hpp"
+#include "../Operand.hpp"
+
+namespace avm {
+namespace dataflow {
+
+	/*
+	 * Runs a whole program by computing its dataflow graph on a
+	 * WorkStealingPool, then replaying the instructions in order against the
+	 * computed values. Faults are recorded per node and raised during the
+	 * replay, so output and the reported error match Interpreter exactly.
+	 * Programs with fewer nodes than the threshold run on Interpreter.
+	 */
+	class DataflowInterpreter
+	{
+	public:
+		explicit DataflowInterpreter(size_t p_threads = std::thread::hardware_concurrency(),
+			size_t p_threshold = 4096, size_t p_grain = 256);
+		DataflowInterpreter(const DataflowInterpreter &) = delete;
+		~DataflowInterpreter() = default;
+
+		DataflowInterpreter &operator=(const DataflowInterpreter &) = delete;
+
+		void Run(ast::Program const &p_program);
+
+		bool HasExited() const;
+
+		// Number of tasks the last run was split into, 0 if it ran sequentially
+		size_t GetTaskCount() const;
+
+	private:
+		void RunSequential(ast::Program const &p_program);
+		void Schedule();
+		void Compute(size_t p_node);
+		void Raise(size_t p_node) const;
+		void Replay();
+
+	private:
+		size_t const m_threads;
+		size_t const m_threshold;
+		size_t const m_grain;
+
+		Graph m_graph;
+		Vector<UniquePtr<IOperand const>> m_values;
+		Vector<std::exception_ptr> m_errors;
+		size_t m_tasks = 0;
+		bool m_shouldExit = false;
+	};
+}
+}
@@ -0,0 +1,87 @@
+#include "Graph.hpp"
+#include "../Arithmetic.hpp"
+#include "../Interpreter.hpp"
+
+namespace avm {
+namespace dataflow {
+
+	void Graph::Build(ast::Program const &p_program)
+	{
+		Vector<size_t> l_stack;
+
+		m_nodes.clear();
+		m_steps.clear();
+
+		for (auto const &l_instruction : p_program.GetInstructions())
+		{
+			ast::Instruction::Type const l_type = l_instruction->GetType();
+
+			m_steps.push_back(l_instruction.get());
+
+			if (IsArithmetic(l_type))
+			{
+				if (l_stack.size() < 2)
+				{
+					return;
+				}
+
+				Node l_node { l_instruction.get() };
+				l_node.m_rhs = l_stack.back();
+				l_stack.pop_back();
+				l_node.m_lhs = l_stack.back();
+				l_stack.pop_back();
+
+				m_nodes[l_node.m_lhs].m_consumer = m_nodes.size();
+				m_nodes[l_node.m_rhs].m_consumer = m_nodes.size();
+				l_stack.push_back(m_nodes.size());
+				m_nodes.push_back(l_node);
+				continue;
+			}
+
+			switch (l_type)
+			{
+				case ast::Instruction::Type::PUSH:
+					l_stack.push_back(m_nodes.size());
+					m_nodes.push_back(Node { l_instruction.get() });
+					break;
+				case ast::Instruction::Type::POP:
+				case ast::Instruction::Type::PRINT:
+				case ast::Instruction::Type::ASSERT:
+					if (l_stack.empty())
+					{
+						return;
+					}
+					if (l_type == ast::Instruction::Type::POP)
+					{
+						l_stack.pop_back();
+					}
+					else
+					{
+						m_nodes[l_stack.back()].m_observed = true;
+					}
+					break;
+				case ast::Instruction::Type::DUMP:
+					for (size_t l_node : l_stack)
+					{
+						m_nodes[l_node].m_observed = true;
+					}
+					break;
+				case ast::Instruction::Type::EXIT:
+					return;
+				default:
+					throw UnsupportedInstruction(*l_instruction);
+			}
+		}
+	}
+
+	Vector<Node> const &Graph::GetNodes() const
+	{
+		return m_nodes;
+	}
+
+	Vector<ast::Instruction const *> const &Graph::GetSteps() const
+	{
+		return m_steps;
+	}
+}
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include "../abstractvm.hpp"
+#include "../ast/Instruction.hpp"
+
+namespace avm {
+namespace dataflow {
+
+	/*
+	 * A value produced by the program: a push, or an arithmetic instruction
+	 * applied to two earlier nodes. Nodes are numbered in program order,
+	 * which is also a valid evaluation order. A node is observed when a
+	 * dump, print or assert reads it while it is on the stack.
+	 */
+	struct Node
+	{
+		static constexpr size_t NONE = static_cast<size_t>(-1);
+
+		ast::Instruction const *m_instruction;
+		size_t m_lhs = NONE;
+		size_t m_rhs = NONE;
+		size_t m_consumer = NONE;
+		bool m_observed = false;
+	};
+
+	/*
+	 * Dataflow graph of a program without control flow. Every value is
+	 * consumed at most once, so the graph is a forest whose roots are the
+	 * values that are popped, observed or left on the stack.
+	 */
+	class Graph
+	{
+	public:
+		Graph() = default;
+		Graph(const Graph &) = delete;
+		~Graph() = default;
+
+		Graph &operator=(const Graph &) = delete;
+
+		void Build(ast::Program const &p_program);
+
+		Vector<Node> const &GetNodes() const;
+
+		// Instructions a sequential run reaches, up to exit or the first
+		// stack error; the n-th push or arithmetic one produces node n
+		Vector<ast::Instruction const *> const &GetSteps() const;
+
+	private:
+		Vector<Node> m_nodes;
+		Vector<ast::Instruction const *> m_steps;
+	};
+}
+}
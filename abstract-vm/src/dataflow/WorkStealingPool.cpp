@@ -0,0 +1,154 @@
+#include "WorkStealingPool.hpp"
+
+namespace avm {
+namespace dataflow {
+
+	namespace {
+		thread_local WorkStealingPool const *s_pool = nullptr;
+		thread_local size_t s_index = 0;
+	}
+
+	WorkStealingPool::WorkStealingPool(size_t p_threads)
+		: m_queued(0), m_pending(0), m_next(0)
+	{
+		size_t const l_threads = p_threads > 0 ? p_threads : 1;
+
+		for (size_t l_i = 0; l_i < l_threads; l_i++)
+		{
+			m_workers.push_back(MakeUnique<Worker>());
+		}
+		for (size_t l_i = 0; l_i < l_threads; l_i++)
+		{
+			m_threads.emplace_back(&WorkStealingPool::Loop, this, l_i);
+		}
+	}
+
+	WorkStealingPool::~WorkStealingPool()
+	{
+		{
+			std::lock_guard<std::mutex> l_lock(m_mutex);
+			m_stopping = true;
+		}
+		m_wake.notify_all();
+
+		for (auto &l_thread : m_threads)
+		{
+			l_thread.join();
+		}
+	}
+
+	void WorkStealingPool::Submit(Task p_task)
+	{
+		size_t const l_index = s_pool == this
+			? s_index
+			: m_next.fetch_add(1, std::memory_order_relaxed) % m_workers.size();
+
+		m_pending.fetch_add(1);
+		{
+			// Under the lock so a worker about to sleep cannot miss it
+			std::lock_guard<std::mutex> l_lock(m_mutex);
+			m_queued.fetch_add(1);
+		}
+		{
+			Worker &l_worker = *m_workers[l_index];
+			std::lock_guard<std::mutex> l_lock(l_worker.m_mutex);
+			l_worker.m_tasks.push_back(std::move(p_task));
+		}
+		m_wake.notify_one();
+	}
+
+	void WorkStealingPool::Wait()
+	{
+		std::unique_lock<std::mutex> l_lock(m_mutex);
+		m_done.wait(l_lock, [this] { return m_pending.load() == 0; });
+
+		if (m_error)
+		{
+			std::exception_ptr l_error = m_error;
+			m_error = nullptr;
+			std::rethrow_exception(l_error);
+		}
+	}
+
+	size_t WorkStealingPool::GetThreadCount() const
+	{
+		return m_threads.size();
+	}
+
+	void WorkStealingPool::Loop(size_t p_index)
+	{
+		s_pool = this;
+		s_index = p_index;
+
+		while (42)
+		{
+			Task l_task;
+
+			if (Pop(p_index, l_task) || Steal(p_index, l_task))
+			{
+				try
+				{
+					l_task();
+				}
+				catch (...)
+				{
+					std::lock_guard<std::mutex> l_lock(m_mutex);
+					if (!m_error)
+					{
+						m_error = std::current_exception();
+					}
+				}
+
+				if (m_pending.fetch_sub(1) == 1)
+				{
+					std::lock_guard<std::mutex> l_lock(m_mutex);
+					m_done.notify_all();
+				}
+				continue;
+			}
+
+			std::unique_lock<std::mutex> l_lock(m_mutex);
+			m_wake.wait(l_lock, [this] { return m_stopping || m_queued.load() > 0; });
+
+			if (m_stopping)
+			{
+				return;
+			}
+		}
+	}
+
+	bool WorkStealingPool::Pop(size_t p_index, Task &p_task)
+	{
+		Worker &l_worker = *m_workers[p_index];
+		std::lock_guard<std::mutex> l_lock(l_worker.m_mutex);
+
+		if (l_worker.m_tasks.empty())
+		{
+			return false;
+		}
+
+		p_task = std::move(l_worker.m_tasks.back());
+		l_worker.m_tasks.pop_back();
+		m_queued.fetch_sub(1);
+		return true;
+	}
+
+	bool WorkStealingPool::Steal(size_t p_index, Task &p_task)
+	{
+		for (size_t l_i = 1; l_i < m_workers.size(); l_i++)
+		{
+			Worker &l_victim = *m_workers[(p_index + l_i) % m_workers.size()];
+			std::lock_guard<std::mutex> l_lock(l_victim.m_mutex);
+
+			if (!l_victim.m_tasks.empty())
+			{
+				p_task = std::move(l_victim.m_tasks.front());
+				l_victim.m_tasks.pop_front();
+				m_queued.fetch_sub(1);
+				return true;
+			}
+		}
+		return false;
+	}
+}
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "../abstractvm.hpp"
+
+namespace avm {
+namespace dataflow {
+
+	/*
+	 * Fixed set of worker threads, each owning a deque of tasks. A worker
+	 * takes its newest task first and, once its own deque is empty, steals
+	 * the oldest task of another worker.
+	 */
+	class WorkStealingPool
+	{
+	public:
+		using Task = std::function<void()>;
+
+		explicit WorkStealingPool(size_t p_threads);
+		WorkStealingPool(const WorkStealingPool &) = delete;
+		~WorkStealingPool();
+
+		WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+		// From a worker the task goes to that worker's own deque
+		void Submit(Task p_task);
+
+		// Blocks until every submitted task, and the ones they submitted, ran.
+		// Rethrows the first exception that escaped a task.
+		void Wait();
+
+		size_t GetThreadCount() const;
+
+	private:
+		struct Worker
+		{
+			std::mutex m_mutex;
+			std::deque<Task> m_tasks;
+		};
+
+		void Loop(size_t p_index);
+		bool Pop(size_t p_index, Task &p_task);
+		bool Steal(size_t p_index, Task &p_task);
+
+	private:
+		Vector<UniquePtr<Worker>> m_workers;
+		Vector<std::thread> m_threads;
+
+		std::mutex m_mutex;
+		std::condition_variable m_wake;
+		std::condition_variable m_done;
+		std::atomic<size_t> m_queued;
+		std::atomic<size_t> m_pending;
+		std::atomic<size_t> m_next;
+		std::exception_ptr m_error;
+		bool m_stopping = false;
+	};
+}
+}
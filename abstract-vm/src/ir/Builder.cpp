@@ -0,0 +1,138 @@
+#include <algorithm>
+#include "Builder.hpp"
+#include "../Interpreter.hpp"
+
+namespace avm {
+namespace ir {
+
+	Function Builder::Run(ast::Program const &p_program, UnorderedSet<ast::Instruction const *> const &p_unchecked)
+	{
+		m_function = Function();
+		m_stack.clear();
+		m_unchecked = &p_unchecked;
+		m_done = false;
+
+		for (auto const &l_instruction : p_program.GetInstructions())
+		{
+			if (m_done)
+			{
+				break;
+			}
+			l_instruction->Accept(*this);
+		}
+
+		m_unchecked = nullptr;
+		return std::move(m_function);
+	}
+
+	void Builder::VisitInstruction(ast::Instruction const &p_instruction)
+	{
+		static const UnorderedMap<ast::Instruction::Type, Opcode> l_arithmetic {
+			{ ast::Instruction::Type::ADD, Opcode::ADD },
+			{ ast::Instruction::Type::SUB, Opcode::SUB },
+			{ ast::Instruction::Type::MUL, Opcode::MUL },
+			{ ast::Instruction::Type::DIV, Opcode::DIV },
+			{ ast::Instruction::Type::MOD, Opcode::MOD },
+		};
+
+		ast::Instruction::Type const l_type = p_instruction.GetType();
+		size_t const l_needed = l_arithmetic.count(l_type) ? 2
+			: (l_type == ast::Instruction::Type::POP || l_type == ast::Instruction::Type::PRINT) ? 1 : 0;
+
+		// Whatever follows a stack error never runs
+		if (m_stack.size() < l_needed)
+		{
+			Emit(Opcode::UNDERFLOW, p_instruction);
+			m_done = true;
+			return;
+		}
+
+		if (l_needed == 2)
+		{
+			Inst &l_inst = Emit(l_arithmetic.at(l_type), p_instruction);
+
+			l_inst.m_rhs = m_stack.back();
+			m_stack.pop_back();
+			l_inst.m_lhs = m_stack.back();
+			m_stack.pop_back();
+
+			// Same promotion as Operand: the most precise type wins
+			eOperandType const l_result = std::max(m_function.m_types[l_inst.m_lhs], m_function.m_types[l_inst.m_rhs]);
+			l_inst.m_dst = m_function.NewRegister(l_result);
+			l_inst.m_checked = m_unchecked->find(&p_instruction) == m_unchecked->end();
+			m_stack.push_back(l_inst.m_dst);
+			return;
+		}
+
+		switch (l_type)
+		{
+			case ast::Instruction::Type::POP:
+				Emit(Opcode::DROP, p_instruction).m_lhs = m_stack.back();
+				m_stack.pop_back();
+				break;
+			case ast::Instruction::Type::DUMP:
+			{
+				Inst &l_inst = Emit(Opcode::DUMP, p_instruction);
+
+				l_inst.m_index = m_function.m_operands.size();
+				l_inst.m_count = m_stack.size();
+				m_function.m_operands.insert(m_function.m_operands.end(), m_stack.rbegin(), m_stack.rend());
+				break;
+			}
+			case ast::Instruction::Type::PRINT:
+				Emit(Opcode::PRINT, p_instruction).m_lhs = m_stack.back();
+				break;
+			case ast::Instruction::Type::EXIT:
+				Emit(Opcode::EXIT, p_instruction);
+				m_done = true;
+				break;
+			default:
+				throw UnsupportedInstruction(p_instruction);
+		}
+	}
+
+	void Builder::VisitInstructionWithValue(ast::InstructionWithValue const &p_instruction)
+	{
+		ast::Value const &l_value = *p_instruction.GetValue();
+
+		switch (p_instruction.GetType())
+		{
+			case ast::Instruction::Type::PUSH:
+			{
+				Inst &l_inst = Emit(Opcode::CONST, p_instruction);
+
+				l_inst.m_index = m_function.AddConstant(l_value.GetOperandType(), *l_value.GetToken().m_literal);
+				l_inst.m_dst = m_function.NewRegister(l_value.GetOperandType());
+				m_stack.push_back(l_inst.m_dst);
+				break;
+			}
+			case ast::Instruction::Type::ASSERT:
+			{
+				if (m_stack.empty())
+				{
+					Emit(Opcode::UNDERFLOW, p_instruction);
+					m_done = true;
+					return;
+				}
+
+				Inst &l_inst = Emit(Opcode::ASSERT, p_instruction);
+
+				l_inst.m_lhs = m_stack.back();
+				l_inst.m_index = m_function.AddConstant(l_value.GetOperandType(), l_value.GetToken().m_lexeme);
+				break;
+			}
+			default:
+				throw std::runtime_error("Unreachable!");
+		};
+	}
+
+	Inst &Builder::Emit(Opcode p_opcode, ast::Instruction const &p_instruction)
+	{
+		Inst l_inst { p_opcode };
+
+		l_inst.m_line = p_instruction.GetLine();
+		m_function.m_code.push_back(l_inst);
+		return m_function.m_code.back();
+	}
+}
+}
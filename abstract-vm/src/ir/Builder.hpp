@@ -0,0 +1,38 @@
+#pragma once
+#include "IR.hpp"
+
+namespace avm {
+namespace ir {
+
+	/*
+	 * Lowers a program to register form by simulating its stack with
+	 * registers: a push or an arithmetic instruction defines a new register
+	 * and the stack only exists at translation time. Instructions listed as
+	 * unchecked (see analysis::IntervalAnalysis) skip the overflow checks.
+	 */
+	class Builder : public ast::InstructionVisitor
+	{
+	public:
+		Builder() = default;
+		Builder(const Builder &) = delete;
+		virtual ~Builder() = default;
+
+		Builder &operator=(const Builder &) = delete;
+
+		Function Run(ast::Program const &p_program,
+			UnorderedSet<ast::Instruction const *> const &p_unchecked = {});
+
+		void VisitInstruction(ast::Instruction const &p_instruction) override;
+		void VisitInstructionWithValue(ast::InstructionWithValue const &p_instruction) override;
+
+	private:
+		Inst &Emit(Opcode p_opcode, ast::Instruction const &p_instruction);
+
+	private:
+		Function m_function;
+		Vector<Reg> m_stack;
+		UnorderedSet<ast::Instruction const *> const *m_unchecked = nullptr;
+		bool m_done = false;
+	};
+}
+}
@@ -0,0 +1,126 @@
+#include "IR.hpp"
+
+namespace avm {
+namespace ir {
+
+	bool IsArithmetic(Opcode p_opcode)
+	{
+		switch (p_opcode)
+		{
+			case Opcode::ADD:
+			case Opcode::SUB:
+			case Opcode::MUL:
+			case Opcode::DIV:
+			case Opcode::MOD:
+				return true;
+			default:
+				return false;
+		}
+	}
+
+	ast::Instruction::Type ToInstructionType(Opcode p_opcode)
+	{
+		switch (p_opcode)
+		{
+			case Opcode::ADD: return ast::Instruction::Type::ADD;
+			case Opcode::SUB: return ast::Instruction::Type::SUB;
+			case Opcode::MUL: return ast::Instruction::Type::MUL;
+			case Opcode::DIV: return ast::Instruction::Type::DIV;
+			case Opcode::MOD: return ast::Instruction::Type::MOD;
+			default:
+				throw std::runtime_error("Unreachable!");
+		}
+	}
+
+	char const *OpcodeName(Opcode p_opcode)
+	{
+		static const UnorderedMap<Opcode, char const *> l_lookUp {
+			{ Opcode::CONST,     "const"     },
+			{ Opcode::ADD,       "add"       },
+			{ Opcode::SUB,       "sub"       },
+			{ Opcode::MUL,       "mul"       },
+			{ Opcode::DIV,       "div"       },
+			{ Opcode::MOD,       "mod"       },
+			{ Opcode::DROP,      "drop"      },
+			{ Opcode::DUMP,      "dump"      },
+			{ Opcode::PRINT,     "print"     },
+			{ Opcode::ASSERT,    "assert"    },
+			{ Opcode::EXIT,      "exit"      },
+			{ Opcode::UNDERFLOW, "underflow" },
+		};
+
+		return l_lookUp.at(p_opcode);
+	}
+
+	char const *TypeName(eOperandType p_type)
+	{
+		static const UnorderedMap<eOperandType, char const *> l_lookUp {
+			{ eOperandType::INT8,   "int8"   },
+			{ eOperandType::INT16,  "int16"  },
+			{ eOperandType::INT32,  "int32"  },
+			{ eOperandType::FLOAT,  "float"  },
+			{ eOperandType::DOUBLE, "double" },
+		};
+
+		return l_lookUp.at(p_type);
+	}
+
+	Reg Function::NewRegister(eOperandType p_type)
+	{
+		m_types.push_back(p_type);
+		return static_cast<Reg>(m_types.size() - 1);
+	}
+
+	size_t Function::AddConstant(eOperandType p_type, String p_value)
+	{
+		m_constants.push_back(Constant { p_type, std::move(p_value) });
+		return m_constants.size() - 1;
+	}
+
+	void Function::Print() const
+	{
+		for (auto const &l_inst : m_code)
+		{
+			char const *const l_name = OpcodeName(l_inst.m_opcode);
+
+			if (IsArithmetic(l_inst.m_opcode))
+			{
+				fmt::print("%{} = {} {} %{}, %{}{}\n", l_inst.m_dst, l_name, TypeName(m_types[l_inst.m_dst]),
+					l_inst.m_lhs, l_inst.m_rhs, l_inst.m_checked ? "" : " unchecked");
+				continue;
+			}
+
+			switch (l_inst.m_opcode)
+			{
+				case Opcode::CONST:
+				{
+					Constant const &l_constant = m_constants[l_inst.m_index];
+					fmt::print("%{} = {} {}({})\n", l_inst.m_dst, l_name, TypeName(l_constant.m_type), l_constant.m_value);
+					break;
+				}
+				case Opcode::ASSERT:
+				{
+					Constant const &l_constant = m_constants[l_inst.m_index];
+					fmt::print("{} %{} {}({})\n", l_name, l_inst.m_lhs, TypeName(l_constant.m_type), l_constant.m_value);
+					break;
+				}
+				case Opcode::DROP:
+				case Opcode::PRINT:
+					fmt::print("{} %{}\n", l_name, l_inst.m_lhs);
+					break;
+				case Opcode::DUMP:
+					fmt::print("{}", l_name);
+					for (size_t l_i = 0; l_i < l_inst.m_count; l_i++)
+					{
+						fmt::print("{} %{}", l_i ? "," : "", m_operands[l_inst.m_index + l_i]);
+					}
+					fmt::print("\n");
+					break;
+				default:
+					fmt::print("{}\n", l_name);
+					break;
+			}
+		}
+	}
+}
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdint>
+#include "../abstractvm.hpp"
+#include "../IOperand.hpp"
+#include "../ast/Instruction.hpp"
+
+namespace avm {
+namespace ir {
+
+	using Reg = uint32_t;
+
+	static constexpr Reg NO_REG = static_cast<Reg>(-1);
+
+	enum class Opcode
+	{
+		CONST,
+		ADD,
+		SUB,
+		MUL,
+		DIV,
+		MOD,
+		DROP,
+		DUMP,
+		PRINT,
+		ASSERT,
+		EXIT,
+		UNDERFLOW,
+	};
+
+	bool IsArithmetic(Opcode p_opcode);
+	ast::Instruction::Type ToInstructionType(Opcode p_opcode);
+	char const *OpcodeName(Opcode p_opcode);
+	char const *TypeName(eOperandType p_type);
+
+	/*
+	 * Three-address instruction. Arithmetic defines m_dst from m_lhs and
+	 * m_rhs, CONST defines m_dst from constant m_index. PRINT and ASSERT
+	 * read m_lhs, ASSERT against constant m_index. DUMP lists m_count
+	 * registers starting at operand m_index, top of the stack first.
+	 */
+	struct Inst
+	{
+		Opcode m_opcode;
+		Reg m_dst = NO_REG;
+		Reg m_lhs = NO_REG;
+		Reg m_rhs = NO_REG;
+		size_t m_index = 0;
+		size_t m_count = 0;
+		bool m_checked = true;
+		int m_line = 0;
+	};
+
+	struct Constant
+	{
+		eOperandType m_type;
+		String m_value;
+	};
+
+	/*
+	 * Register form of a program. Every register is assigned once and its
+	 * type is known statically; a register consumed by arithmetic or DROP
+	 * is never read again. Execution ends at EXIT, UNDERFLOW or the last
+	 * instruction.
+	 */
+	struct Function
+	{
+		Vector<Inst> m_code;
+		Vector<eOperandType> m_types;
+		Vector<Constant> m_constants;
+		Vector<Reg> m_operands;
+
+		Reg NewRegister(eOperandType p_type);
+		size_t AddConstant(eOperandType p_type, String p_value);
+
+		void Print() const;
+	};
+}
+}
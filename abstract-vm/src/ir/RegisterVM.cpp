@@ -0,0 +1,100 @@
+#include "RegisterVM.hpp"
+#include "../Arithmetic.hpp"
+#include "../Interpreter.hpp"
+
+namespace avm {
+namespace ir {
+
+	void RegisterVM::Run(Function const &p_function)
+	{
+		m_registers.clear();
+		m_registers.resize(p_function.m_types.size());
+
+		for (Inst const &l_inst : p_function.m_code)
+		{
+			switch (l_inst.m_opcode)
+			{
+				case Opcode::CONST:
+				{
+					Constant const &l_constant = p_function.m_constants[l_inst.m_index];
+					m_registers[l_inst.m_dst].reset(
+						OperandFactory::Get().CreateOperand(l_constant.m_type, l_constant.m_value));
+					break;
+				}
+				case Opcode::ADD:
+				case Opcode::SUB:
+				case Opcode::MUL:
+				case Opcode::DIV:
+				case Opcode::MOD:
+				{
+					UniquePtr<IOperand const> l_lhs = std::move(m_registers[l_inst.m_lhs]);
+					UniquePtr<IOperand const> l_rhs = std::move(m_registers[l_inst.m_rhs]);
+					ast::Instruction::Type const l_type = ToInstructionType(l_inst.m_opcode);
+
+					m_registers[l_inst.m_dst].reset(l_inst.m_checked
+						? Apply(l_type, *l_lhs, *l_rhs)
+						: ApplyUnchecked(l_type, *l_lhs, *l_rhs));
+					break;
+				}
+				case Opcode::DROP:
+					m_registers[l_inst.m_lhs].reset();
+					break;
+				case Opcode::DUMP:
+					for (size_t l_i = 0; l_i < l_inst.m_count; l_i++)
+					{
+						fmt::print("{}\n", m_registers[p_function.m_operands[l_inst.m_index + l_i]]->toString());
+					}
+					break;
+				case Opcode::PRINT:
+					Print(*m_registers[l_inst.m_lhs]);
+					break;
+				case Opcode::ASSERT:
+					Assert(*m_registers[l_inst.m_lhs], p_function.m_constants[l_inst.m_index]);
+					break;
+				case Opcode::EXIT:
+					m_shouldExit = true;
+					m_registers.clear();
+					return;
+				case Opcode::UNDERFLOW:
+					m_registers.clear();
+					throw EmptyStackError();
+			}
+		}
+		m_registers.clear();
+	}
+
+	bool RegisterVM::HasExited() const
+	{
+		return m_shouldExit;
+	}
+
+	void RegisterVM::Print(IOperand const &p_operand) const
+	{
+		Operand<int8_t> const *l_operand = dynamic_cast<Operand<int8_t> const *>(&p_operand);
+
+		if (l_operand != nullptr)
+		{
+			fmt::print("{}", (char)l_operand->GetValue());
+		}
+		else
+		{
+			throw PrintError();
+		}
+	}
+
+	void RegisterVM::Assert(IOperand const &p_operand, Constant const &p_constant) const
+	{
+		if (p_constant.m_type != p_operand.getType())
+		{
+			throw AssertError();
+		}
+
+		UniquePtr<IOperand const> l_value(OperandFactory::Get().CreateOperand(p_constant.m_type, p_constant.m_value));
+
+		if (p_operand != *l_value)
+		{
+			throw AssertError();
+		}
+	}
+}
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include "IR.hpp"
+#include "../Operand.hpp"
+
+namespace avm {
+namespace ir {
+
+	/*
+	 * Executes a Function over a register file instead of a stack. Values
+	 * are freed as soon as an instruction consumes them; faults are the
+	 * same exceptions Interpreter throws.
+	 */
+	class RegisterVM
+	{
+	public:
+		RegisterVM() = default;
+		RegisterVM(const RegisterVM &) = delete;
+		~RegisterVM() = default;
+
+		RegisterVM &operator=(const RegisterVM &) = delete;
+
+		void Run(Function const &p_function);
+
+		bool HasExited() const;
+
+	private:
+		void Print(IOperand const &p_operand) const;
+		void Assert(IOperand const &p_operand, Constant const &p_constant) const;
+
+	private:
+		Vector<UniquePtr<IOperand const>> m_registers;
+		bool m_shouldExit = false;
+	};
+}
+}
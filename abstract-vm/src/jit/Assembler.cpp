@@ -0,0 +1,235 @@
+#include "Assembler.hpp"
+
+namespace avm {
+namespace jit {
+
+	static constexpr size_t UNBOUND = static_cast<size_t>(-1);
+
+	static uint8_t Low(Register p_reg)
+	{
+		return static_cast<uint8_t>(p_reg) & 7;
+	}
+
+	static bool Extended(Register p_reg)
+	{
+		return static_cast<uint8_t>(p_reg) >= 8;
+	}
+
+	Assembler::Label Assembler::NewLabel()
+	{
+		m_labels.push_back(UNBOUND);
+		return m_labels.size() - 1;
+	}
+
+	void Assembler::Bind(Label p_label)
+	{
+		m_labels[p_label] = m_code.size();
+	}
+
+	void Assembler::Push(Register p_reg)
+	{
+		if (Extended(p_reg)) Byte(0x41);
+		Byte(0x50 + Low(p_reg));
+	}
+
+	void Assembler::Pop(Register p_reg)
+	{
+		if (Extended(p_reg)) Byte(0x41);
+		Byte(0x58 + Low(p_reg));
+	}
+
+	void Assembler::Ret()
+	{
+		Byte(0xC3);
+	}
+
+	void Assembler::Call(Register p_reg)
+	{
+		if (Extended(p_reg)) Byte(0x41);
+		Byte(0xFF);
+		ModRM(3, 2, p_reg);
+	}
+
+	void Assembler::Jump(Label p_label)
+	{
+		Byte(0xE9);
+		m_fixups.push_back(Fixup { m_code.size(), p_label });
+		Int32(0);
+	}
+
+	void Assembler::Jump(Condition p_condition, Label p_label)
+	{
+		Byte(0x0F);
+		Byte(0x80 + static_cast<uint8_t>(p_condition));
+		m_fixups.push_back(Fixup { m_code.size(), p_label });
+		Int32(0);
+	}
+
+	void Assembler::Move(Register p_dst, Register p_src)
+	{
+		Rex(p_src, p_dst);
+		Byte(0x89);
+		ModRM(3, Low(p_src), p_dst);
+	}
+
+	void Assembler::MoveImm32(Register p_dst, uint32_t p_value)
+	{
+		if (Extended(p_dst)) Byte(0x41);
+		Byte(0xB8 + Low(p_dst));
+		Int32(static_cast<int32_t>(p_value));
+	}
+
+	void Assembler::MoveImm64(Register p_dst, uint64_t p_value)
+	{
+		Rex(Register::RAX, p_dst);
+		Byte(0xB8 + Low(p_dst));
+		for (int l_i = 0; l_i < 8; l_i++)
+		{
+			Byte(static_cast<uint8_t>(p_value >> (8 * l_i)));
+		}
+	}
+
+	void Assembler::Load(Register p_dst, Register p_base, int32_t p_offset)
+	{
+		Rex(p_dst, p_base);
+		Byte(0x8B);
+		Memory(Low(p_dst), p_base, p_offset);
+	}
+
+	void Assembler::Store(Register p_base, int32_t p_offset, Register p_src)
+	{
+		Rex(p_src, p_base);
+		Byte(0x89);
+		Memory(Low(p_src), p_base, p_offset);
+	}
+
+	void Assembler::StoreImm(Register p_base, int32_t p_offset, int32_t p_value)
+	{
+		Rex(Register::RAX, p_base);
+		Byte(0xC7);
+		Memory(0, p_base, p_offset);
+		Int32(p_value);
+	}
+
+	void Assembler::LoadAddress(Register p_dst, Register p_base, int32_t p_offset)
+	{
+		Rex(p_dst, p_base);
+		Byte(0x8D);
+		Memory(Low(p_dst), p_base, p_offset);
+	}
+
+	void Assembler::Add(Register p_dst, Register p_src)
+	{
+		Rex(p_src, p_dst);
+		Byte(0x01);
+		ModRM(3, Low(p_src), p_dst);
+	}
+
+	void Assembler::Sub(Register p_dst, Register p_src)
+	{
+		Rex(p_src, p_dst);
+		Byte(0x29);
+		ModRM(3, Low(p_src), p_dst);
+	}
+
+	void Assembler::Imul(Register p_dst, Register p_src)
+	{
+		Rex(p_dst, p_src);
+		Byte(0x0F);
+		Byte(0xAF);
+		ModRM(3, Low(p_dst), p_src);
+	}
+
+	void Assembler::SubImm(Register p_dst, int32_t p_value)
+	{
+		Rex(Register::RAX, p_dst);
+		Byte(0x81);
+		ModRM(3, 5, p_dst);
+		Int32(p_value);
+	}
+
+	void Assembler::CompareImm(Register p_reg, int32_t p_value)
+	{
+		Rex(Register::RAX, p_reg);
+		Byte(0x81);
+		ModRM(3, 7, p_reg);
+		Int32(p_value);
+	}
+
+	void Assembler::Test(Register p_lhs, Register p_rhs)
+	{
+		Rex(p_rhs, p_lhs);
+		Byte(0x85);
+		ModRM(3, Low(p_rhs), p_lhs);
+	}
+
+	void Assembler::Cqo()
+	{
+		Byte(0x48);
+		Byte(0x99);
+	}
+
+	void Assembler::Idiv(Register p_divisor)
+	{
+		Rex(Register::RAX, p_divisor);
+		Byte(0xF7);
+		ModRM(3, 7, p_divisor);
+	}
+
+	Vector<uint8_t> const &Assembler::Finish()
+	{
+		for (auto const &l_fixup : m_fixups)
+		{
+			if (m_labels[l_fixup.m_label] == UNBOUND)
+			{
+				throw std::runtime_error("Unreachable!");
+			}
+
+			int32_t const l_relative = static_cast<int32_t>(m_labels[l_fixup.m_label] - (l_fixup.m_position + 4));
+
+			for (int l_i = 0; l_i < 4; l_i++)
+			{
+				m_code[l_fixup.m_position + l_i] = static_cast<uint8_t>(static_cast<uint32_t>(l_relative) >> (8 * l_i));
+			}
+		}
+		m_fixups.clear();
+
+		return m_code;
+	}
+
+	void Assembler::Byte(uint8_t p_byte)
+	{
+		m_code.push_back(p_byte);
+	}
+
+	void Assembler::Int32(int32_t p_value)
+	{
+		for (int l_i = 0; l_i < 4; l_i++)
+		{
+			Byte(static_cast<uint8_t>(static_cast<uint32_t>(p_value) >> (8 * l_i)));
+		}
+	}
+
+	// REX.W with the extension bits of the ModRM reg and rm fields
+	void Assembler::Rex(Register p_reg, Register p_rm)
+	{
+		Byte(0x48 | (Extended(p_reg) ? 0x4 : 0) | (Extended(p_rm) ? 0x1 : 0));
+	}
+
+	void Assembler::ModRM(uint8_t p_mod, uint8_t p_reg, Register p_rm)
+	{
+		Byte(static_cast<uint8_t>(p_mod << 6 | (p_reg & 7) << 3 | Low(p_rm)));
+	}
+
+	// [base + disp32]; rsp and r12 as a base need a SIB byte
+	void Assembler::Memory(uint8_t p_reg, Register p_base, int32_t p_offset)
+	{
+		ModRM(2, p_reg, p_base);
+		if (Low(p_base) == 4)
+		{
+			Byte(0x24);
+		}
+		Int32(p_offset);
+	}
+}
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include <cstdint>
+#include <stdexcept>
+#include "../abstractvm.hpp"
+
+namespace avm {
+namespace jit {
+
+	enum class Register : uint8_t
+	{
+		RAX = 0,
+		RCX = 1,
+		RDX = 2,
+		RBX = 3,
+		RSP = 4,
+		RBP = 5,
+		RSI = 6,
+		RDI = 7,
+		R12 = 12,
+	};
+
+	enum class Condition : uint8_t
+	{
+		EQUAL     = 0x4,
+		NOT_EQUAL = 0x5,
+		LESS      = 0xC,
+		GREATER   = 0xF,
+	};
+
+	/*
+	 * Minimal x86-64 encoder: only the instructions the compiler emits,
+	 * all on 64-bit registers. Jumps target labels and are patched by
+	 * Finish().
+	 */
+	class Assembler
+	{
+	public:
+		using Label = size_t;
+
+		Assembler() = default;
+		Assembler(const Assembler &) = delete;
+		~Assembler() = default;
+
+		Assembler &operator=(const Assembler &) = delete;
+
+		Label NewLabel();
+		void Bind(Label p_label);
+
+		void Push(Register p_reg);
+		void Pop(Register p_reg);
+		void Ret();
+		void Call(Register p_reg);
+		void Jump(Label p_label);
+		void Jump(Condition p_condition, Label p_label);
+
+		void Move(Register p_dst, Register p_src);
+		void MoveImm32(Register p_dst, uint32_t p_value);
+		void MoveImm64(Register p_dst, uint64_t p_value);
+		void Load(Register p_dst, Register p_base, int32_t p_offset);
+		void Store(Register p_base, int32_t p_offset, Register p_src);
+		void StoreImm(Register p_base, int32_t p_offset, int32_t p_value);
+		void LoadAddress(Register p_dst, Register p_base, int32_t p_offset);
+
+		void Add(Register p_dst, Register p_src);
+		void Sub(Register p_dst, Register p_src);
+		void Imul(Register p_dst, Register p_src);
+		void SubImm(Register p_dst, int32_t p_value);
+		void CompareImm(Register p_reg, int32_t p_value);
+		void Test(Register p_lhs, Register p_rhs);
+		void Cqo();
+		void Idiv(Register p_divisor);
+
+		// Resolves the jumps and returns the machine code
+		Vector<uint8_t> const &Finish();
+
+	private:
+		void Byte(uint8_t p_byte);
+		void Int32(int32_t p_value);
+		void Rex(Register p_reg, Register p_rm);
+		void ModRM(uint8_t p_mod, uint8_t p_reg, Register p_rm);
+		void Memory(uint8_t p_reg, Register p_base, int32_t p_offset);
+
+	private:
+		struct Fixup
+		{
+			size_t m_position;
+			Label m_label;
+		};
+
+		Vector<uint8_t> m_code;
+		Vector<size_t> m_labels;
+		Vector<Fixup> m_fixups;
+	};
+}
+}
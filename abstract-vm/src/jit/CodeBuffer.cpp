@@ -0,0 +1,56 @@
+#include <cstring>
+#include "CodeBuffer.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+# include <sys/mman.h>
+# define AVM_HAS_MMAP 1
+#else
+# define AVM_HAS_MMAP 0
+#endif
+
+namespace avm {
+namespace jit {
+
+	CodeBuffer::CodeBuffer(void *p_memory, size_t p_size) : m_memory(p_memory), m_size(p_size)
+	{
+	}
+
+	CodeBuffer::~CodeBuffer()
+	{
+#if AVM_HAS_MMAP
+		munmap(m_memory, m_size);
+#endif
+	}
+
+	UniquePtr<CodeBuffer> CodeBuffer::Create(Vector<uint8_t> const &p_code)
+	{
+#if AVM_HAS_MMAP
+		size_t const l_size = p_code.empty() ? 1 : p_code.size();
+		void *l_memory = mmap(nullptr, l_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+		if (l_memory == MAP_FAILED)
+		{
+			return nullptr;
+		}
+
+		std::memcpy(l_memory, p_code.data(), p_code.size());
+
+		if (mprotect(l_memory, l_size, PROT_READ | PROT_EXEC) != 0)
+		{
+			munmap(l_memory, l_size);
+			return nullptr;
+		}
+
+		return UniquePtr<CodeBuffer>(new CodeBuffer(l_memory, l_size));
+#else
+		(void)p_code;
+		return nullptr;
+#endif
+	}
+
+	void const *CodeBuffer::GetEntry() const
+	{
+		return m_memory;
+	}
+}
+}
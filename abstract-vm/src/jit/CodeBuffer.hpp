@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+#include "../abstractvm.hpp"
+
+namespace avm {
+namespace jit {
+
+	/*
+	 * Executable copy of some machine code. Pages are mapped writable,
+	 * filled, then switched to read + execute, never both at once.
+	 */
+	class CodeBuffer
+	{
+	public:
+		CodeBuffer(const CodeBuffer &) = delete;
+		~CodeBuffer();
+
+		CodeBuffer &operator=(const CodeBuffer &) = delete;
+
+		// nullptr when the host refuses executable mappings
+		static UniquePtr<CodeBuffer> Create(Vector<uint8_t> const &p_code);
+
+		void const *GetEntry() const;
+
+	private:
+		CodeBuffer(void *p_memory, size_t p_size);
+
+	private:
+		void *m_memory;
+		size_t m_size;
+	};
+}
+}
@@ -0,0 +1,420 @@
+#include <algorithm>
+#include <limits>
+#include "Compiler.hpp"
+#include "Assembler.hpp"
+#include "../Arithmetic.hpp"
+#include "../Interpreter.hpp"
+#include "../OperandFactory.hpp"
+
+namespace avm {
+namespace jit {
+
+	enum ReturnCode : int64_t
+	{
+		FINISHED = 0,
+		EXITED = 1,
+		FAILED = 2,
+	};
+
+	static Pair<int32_t, int32_t> Limits(eOperandType p_type)
+	{
+		switch (p_type)
+		{
+			case eOperandType::INT8:
+				return { std::numeric_limits<int8_t>::min(), std::numeric_limits<int8_t>::max() };
+			case eOperandType::INT16:
+				return { std::numeric_limits<int16_t>::min(), std::numeric_limits<int16_t>::max() };
+			case eOperandType::INT32:
+				return { std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max() };
+			default:
+				throw std::runtime_error("Unreachable!");
+		}
+	}
+
+	// CompiledFunction
+	// ================
+
+	CompiledFunction::CompiledFunction(ir::Function const &p_function, Vector<int32_t> p_slots, UniquePtr<CodeBuffer> p_code)
+		: m_function(p_function), m_slots(std::move(p_slots)), m_code(std::move(p_code))
+	{
+	}
+
+	bool CompiledFunction::Run() const
+	{
+		using Entry = int64_t (*)(Context *);
+
+		Context l_context { this, nullptr };
+		Entry const l_entry = reinterpret_cast<Entry>(const_cast<void *>(m_code->GetEntry()));
+
+		int64_t const l_result = l_entry(&l_context);
+
+		if (l_result == FAILED)
+		{
+			std::rethrow_exception(l_context.m_error);
+		}
+		return l_result == EXITED;
+	}
+
+	// Runs the checked operation again on the real operands: it throws the
+	// exception the interpreter would
+	int64_t CompiledFunction::Fault(Context *p_context, uint32_t p_index, int64_t *p_frame)
+	{
+		CompiledFunction const &l_self = *p_context->m_self;
+		ir::Inst const &l_inst = l_self.m_function.m_code[p_index];
+
+		try
+		{
+			if (l_inst.m_opcode == ir::Opcode::CONST)
+			{
+				ir::Constant const &l_constant = l_self.m_function.m_constants[l_inst.m_index];
+				delete OperandFactory::Get().CreateOperand(l_constant.m_type, l_constant.m_value);
+			}
+			else if (ir::IsArithmetic(l_inst.m_opcode))
+			{
+				UniquePtr<IOperand const> l_lhs(l_self.Materialize(l_inst.m_lhs, p_frame));
+				UniquePtr<IOperand const> l_rhs(l_self.Materialize(l_inst.m_rhs, p_frame));
+
+				delete Apply(ir::ToInstructionType(l_inst.m_opcode), *l_lhs, *l_rhs);
+			}
+			else if (l_inst.m_opcode == ir::Opcode::UNDERFLOW)
+			{
+				throw EmptyStackError();
+			}
+			throw std::runtime_error("Unreachable!");
+		}
+		catch (...)
+		{
+			p_context->m_error = std::current_exception();
+		}
+		return FAILED;
+	}
+
+	int64_t CompiledFunction::Effect(Context *p_context, uint32_t p_index, int64_t *p_frame)
+	{
+		CompiledFunction const &l_self = *p_context->m_self;
+		ir::Function const &l_function = l_self.m_function;
+		ir::Inst const &l_inst = l_function.m_code[p_index];
+
+		try
+		{
+			switch (l_inst.m_opcode)
+			{
+				case ir::Opcode::DUMP:
+					for (size_t l_i = 0; l_i < l_inst.m_count; l_i++)
+					{
+						fmt::print("{}\n", p_frame[l_self.m_slots[l_function.m_operands[l_inst.m_index + l_i]]]);
+					}
+					break;
+				case ir::Opcode::PRINT:
+					if (l_function.m_types[l_inst.m_lhs] != eOperandType::INT8)
+					{
+						throw PrintError();
+					}
+					fmt::print("{}", (char)p_frame[l_self.m_slots[l_inst.m_lhs]]);
+					break;
+				case ir::Opcode::ASSERT:
+				{
+					ir::Constant const &l_constant = l_function.m_constants[l_inst.m_index];
+					UniquePtr<IOperand const> l_operand(l_self.Materialize(l_inst.m_lhs, p_frame));
+
+					if (l_constant.m_type != l_operand->getType())
+					{
+						throw AssertError();
+					}
+
+					UniquePtr<IOperand const> l_value(OperandFactory::Get().CreateOperand(l_constant.m_type, l_constant.m_value));
+
+					if (*l_operand != *l_value)
+					{
+						throw AssertError();
+					}
+					break;
+				}
+				default:
+					throw std::runtime_error("Unreachable!");
+			}
+		}
+		catch (...)
+		{
+			p_context->m_error = std::current_exception();
+			return FAILED;
+		}
+		return FINISHED;
+	}
+
+	// Arithmetic the generated code leaves to the operand classes
+	int64_t CompiledFunction::Slow(Context *p_context, uint32_t p_index, int64_t *p_frame)
+	{
+		CompiledFunction const &l_self = *p_context->m_self;
+		ir::Inst const &l_inst = l_self.m_function.m_code[p_index];
+
+		try
+		{
+			UniquePtr<IOperand const> l_lhs(l_self.Materialize(l_inst.m_lhs, p_frame));
+			UniquePtr<IOperand const> l_rhs(l_self.Materialize(l_inst.m_rhs, p_frame));
+			ast::Instruction::Type const l_type = ir::ToInstructionType(l_inst.m_opcode);
+			UniquePtr<IOperand const> l_result(l_inst.m_checked
+				? Apply(l_type, *l_lhs, *l_rhs)
+				: ApplyUnchecked(l_type, *l_lhs, *l_rhs));
+
+			p_frame[l_self.m_slots[l_inst.m_dst]] =
+				static_cast<int64_t>(dynamic_cast<OperandBase const &>(*l_result).ToDouble());
+		}
+		catch (...)
+		{
+			p_context->m_error = std::current_exception();
+			return FAILED;
+		}
+		return FINISHED;
+	}
+
+	IOperand const *CompiledFunction::Materialize(ir::Reg p_reg, int64_t const *p_frame) const
+	{
+		return OperandFactory::Get().CreateOperand(m_function.m_types[p_reg],
+			static_cast<double>(p_frame[m_slots[p_reg]]));
+	}
+
+	// Compiler
+	// ========
+
+	bool Compiler::IsHostSupported()
+	{
+#if defined(__x86_64__) && (defined(__linux__) || defined(__APPLE__) || defined(__FreeBSD__))
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	UniquePtr<CompiledFunction> Compiler::Compile(ir::Function const &p_function)
+	{
+		if (!IsHostSupported())
+		{
+			return nullptr;
+		}
+
+		for (eOperandType l_type : p_function.m_types)
+		{
+			if (l_type == eOperandType::FLOAT || l_type == eOperandType::DOUBLE)
+			{
+				return nullptr;
+			}
+		}
+
+		// A register lives in the slot of the stack depth it was pushed at
+		Vector<int32_t> l_slots(p_function.m_types.size(), -1);
+		int32_t l_depth = 0;
+		int32_t l_maxDepth = 0;
+
+		for (ir::Inst const &l_inst : p_function.m_code)
+		{
+			if (ir::IsArithmetic(l_inst.m_opcode))
+			{
+				l_depth -= 2;
+			}
+			if (l_inst.m_opcode == ir::Opcode::DROP)
+			{
+				l_depth -= 1;
+			}
+			if (l_inst.m_dst != ir::NO_REG)
+			{
+				l_slots[l_inst.m_dst] = l_depth++;
+			}
+			l_maxDepth = std::max(l_maxDepth, l_depth);
+		}
+
+		if (static_cast<size_t>(l_maxDepth) > MAX_SLOTS)
+		{
+			return nullptr;
+		}
+
+		Assembler l_asm;
+		Assembler::Label const l_epilogue = l_asm.NewLabel();
+		Assembler::Label const l_failed = l_asm.NewLabel();
+		UnorderedMap<uint32_t, Assembler::Label> l_stubs;
+
+		auto l_slot = [&l_slots] (ir::Reg p_reg) { return 8 * l_slots[p_reg]; };
+		auto l_stub = [&l_asm, &l_stubs] (uint32_t p_index) {
+			if (l_stubs.find(p_index) == l_stubs.end())
+			{
+				l_stubs[p_index] = l_asm.NewLabel();
+			}
+			return l_stubs[p_index];
+		};
+		auto l_call = [&l_asm] (int64_t (*p_helper)(CompiledFunction::Context *, uint32_t, int64_t *), uint32_t p_index) {
+			l_asm.Move(Register::RDI, Register::R12);
+			l_asm.MoveImm32(Register::RSI, p_index);
+			l_asm.Move(Register::RDX, Register::RBX);
+			l_asm.MoveImm64(Register::RAX, reinterpret_cast<uint64_t>(p_helper));
+			l_asm.Call(Register::RAX);
+		};
+
+		// Frame below the saved registers, rbx points at slot 0 and r12 at
+		// the context. Both are callee-saved so helper calls keep them.
+		int32_t const l_frame = (8 * l_maxDepth + 15) & ~15;
+
+		l_asm.Push(Register::RBP);
+		l_asm.Move(Register::RBP, Register::RSP);
+		l_asm.Push(Register::RBX);
+		l_asm.Push(Register::R12);
+		l_asm.SubImm(Register::RSP, l_frame);
+		l_asm.Move(Register::RBX, Register::RSP);
+		l_asm.Move(Register::R12, Register::RDI);
+
+		bool l_reachable = true;
+
+		for (uint32_t l_index = 0; l_index < p_function.m_code.size() && l_reachable; l_index++)
+		{
+			ir::Inst const &l_inst = p_function.m_code[l_index];
+
+			switch (l_inst.m_opcode)
+			{
+				case ir::Opcode::CONST:
+				{
+					ir::Constant const &l_constant = p_function.m_constants[l_inst.m_index];
+
+					try
+					{
+						UniquePtr<IOperand const> l_value(OperandFactory::Get().CreateOperand(l_constant.m_type, l_constant.m_value));
+						l_asm.StoreImm(Register::RBX, l_slot(l_inst.m_dst),
+							static_cast<int32_t>(dynamic_cast<OperandBase const &>(*l_value).ToDouble()));
+					}
+					catch (std::exception const &)
+					{
+						l_asm.Jump(l_stub(l_index));
+						l_reachable = false;
+					}
+					break;
+				}
+				case ir::Opcode::ADD:
+				case ir::Opcode::SUB:
+				case ir::Opcode::MUL:
+				case ir::Opcode::DIV:
+				case ir::Opcode::MOD:
+				{
+					eOperandType const l_lhsType = p_function.m_types[l_inst.m_lhs];
+					eOperandType const l_rhsType = p_function.m_types[l_inst.m_rhs];
+					Pair<int32_t, int32_t> const l_limits = Limits(l_lhsType);
+
+					// Operand::operator/ casts the divisor to the dividend type
+					if (l_inst.m_opcode == ir::Opcode::DIV && l_rhsType < l_lhsType)
+					{
+						l_asm.Jump(l_stub(l_index));
+						l_reachable = false;
+						break;
+					}
+
+					l_asm.Load(Register::RAX, Register::RBX, l_slot(l_inst.m_lhs));
+					l_asm.Load(Register::RCX, Register::RBX, l_slot(l_inst.m_rhs));
+
+					if (l_inst.m_opcode == ir::Opcode::DIV)
+					{
+						l_asm.Test(Register::RCX, Register::RCX);
+						l_asm.Jump(Condition::EQUAL, l_stub(l_index));
+
+						if (l_inst.m_checked && l_rhsType == l_lhsType)
+						{
+							Assembler::Label const l_safe = l_asm.NewLabel();
+
+							l_asm.CompareImm(Register::RAX, l_limits.first);
+							l_asm.Jump(Condition::NOT_EQUAL, l_safe);
+							l_asm.CompareImm(Register::RCX, -1);
+							l_asm.Jump(Condition::EQUAL, l_stub(l_index));
+							l_asm.Bind(l_safe);
+						}
+						l_asm.Cqo();
+						l_asm.Idiv(Register::RCX);
+					}
+					else if (l_inst.m_opcode == ir::Opcode::MOD)
+					{
+						// Modulo by zero yields NaN in the operand classes
+						Assembler::Label const l_fast = l_asm.NewLabel();
+						Assembler::Label const l_done = l_asm.NewLabel();
+
+						l_asm.Test(Register::RCX, Register::RCX);
+						l_asm.Jump(Condition::NOT_EQUAL, l_fast);
+						l_call(&CompiledFunction::Slow, l_index);
+						l_asm.Test(Register::RAX, Register::RAX);
+						l_asm.Jump(Condition::NOT_EQUAL, l_failed);
+						l_asm.Load(Register::RAX, Register::RBX, l_slot(l_inst.m_dst));
+						l_asm.Jump(l_done);
+						l_asm.Bind(l_fast);
+						l_asm.Cqo();
+						l_asm.Idiv(Register::RCX);
+						l_asm.Move(Register::RAX, Register::RDX);
+						l_asm.Bind(l_done);
+					}
+					else
+					{
+						if (l_inst.m_opcode == ir::Opcode::ADD) l_asm.Add(Register::RAX, Register::RCX);
+						if (l_inst.m_opcode == ir::Opcode::SUB) l_asm.Sub(Register::RAX, Register::RCX);
+						if (l_inst.m_opcode == ir::Opcode::MUL) l_asm.Imul(Register::RAX, Register::RCX);
+
+						// Operand checks the result against the left operand type
+						if (l_inst.m_checked)
+						{
+							l_asm.CompareImm(Register::RAX, l_limits.first);
+							l_asm.Jump(Condition::LESS, l_stub(l_index));
+							l_asm.CompareImm(Register::RAX, l_limits.second);
+							l_asm.Jump(Condition::GREATER, l_stub(l_index));
+						}
+					}
+
+					l_asm.Store(Register::RBX, l_slot(l_inst.m_dst), Register::RAX);
+					break;
+				}
+				case ir::Opcode::DROP:
+					break;
+				case ir::Opcode::DUMP:
+				case ir::Opcode::PRINT:
+				case ir::Opcode::ASSERT:
+					l_call(&CompiledFunction::Effect, l_index);
+					l_asm.Test(Register::RAX, Register::RAX);
+					l_asm.Jump(Condition::NOT_EQUAL, l_failed);
+					break;
+				case ir::Opcode::EXIT:
+					l_asm.MoveImm32(Register::RAX, EXITED);
+					l_asm.Jump(l_epilogue);
+					l_reachable = false;
+					break;
+				case ir::Opcode::UNDERFLOW:
+					l_asm.Jump(l_stub(l_index));
+					l_reachable = false;
+					break;
+			}
+		}
+
+		if (l_reachable)
+		{
+			l_asm.MoveImm32(Register::RAX, FINISHED);
+			l_asm.Jump(l_epilogue);
+		}
+
+		for (auto const &l_stubLabel : l_stubs)
+		{
+			l_asm.Bind(l_stubLabel.second);
+			l_call(&CompiledFunction::Fault, l_stubLabel.first);
+			l_asm.Jump(l_epilogue);
+		}
+
+		l_asm.Bind(l_failed);
+		l_asm.MoveImm32(Register::RAX, FAILED);
+
+		l_asm.Bind(l_epilogue);
+		l_asm.LoadAddress(Register::RSP, Register::RBP, -16);
+		l_asm.Pop(Register::R12);
+		l_asm.Pop(Register::RBX);
+		l_asm.Pop(Register::RBP);
+		l_asm.Ret();
+
+		UniquePtr<CodeBuffer> l_code = CodeBuffer::Create(l_asm.Finish());
+
+		if (!l_code)
+		{
+			return nullptr;
+		}
+
+		return UniquePtr<CompiledFunction>(new CompiledFunction(p_function, std::move(l_slots), std::move(l_code)));
+	}
+}
+}
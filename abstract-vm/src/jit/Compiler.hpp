@@ -0,0 +1,64 @@
+#pragma once
+#include <exception>
+#include "CodeBuffer.hpp"
+#include "../ir/IR.hpp"
+
+namespace avm {
+namespace jit {
+
+	/*
+	 * Native code of an ir::Function, which must outlive it. Integer values
+	 * live in 64-bit slots of the native stack frame, one per stack depth.
+	 * Checks are inline branches to per-instruction fault stubs, and the
+	 * stubs call back into C++ to rebuild the exact exception.
+	 */
+	class CompiledFunction
+	{
+	public:
+		CompiledFunction(const CompiledFunction &) = delete;
+		~CompiledFunction() = default;
+
+		CompiledFunction &operator=(const CompiledFunction &) = delete;
+
+		// Returns whether the program exited, throws what Interpreter throws
+		bool Run() const;
+
+	private:
+		friend class Compiler;
+
+		struct Context
+		{
+			CompiledFunction const *m_self;
+			std::exception_ptr m_error;
+		};
+
+		CompiledFunction(ir::Function const &p_function, Vector<int32_t> p_slots, UniquePtr<CodeBuffer> p_code);
+
+		// Called from the generated code, they never throw: a non-zero
+		// result means the exception is stored in the context
+		static int64_t Fault(Context *p_context, uint32_t p_index, int64_t *p_frame);
+		static int64_t Effect(Context *p_context, uint32_t p_index, int64_t *p_frame);
+		static int64_t Slow(Context *p_context, uint32_t p_index, int64_t *p_frame);
+
+		IOperand const *Materialize(ir::Reg p_reg, int64_t const *p_frame) const;
+
+	private:
+		ir::Function const &m_function;
+		Vector<int32_t> m_slots;
+		UniquePtr<CodeBuffer> m_code;
+	};
+
+	class Compiler
+	{
+	public:
+		// Deepest stack the native frame is sized for
+		static constexpr size_t MAX_SLOTS = 8192;
+
+		static bool IsHostSupported();
+
+		// nullptr when the host or the function is not supported: floating
+		// point values, stacks deeper than MAX_SLOTS
+		static UniquePtr<CompiledFunction> Compile(ir::Function const &p_function);
+	};
+}
+}
@@ -0,0 +1,34 @@
+#include "JitEngine.hpp"
+
+namespace avm {
+namespace jit {
+
+	JitEngine::JitEngine(ir::Function p_function)
+		: m_function(std::move(p_function)), m_compiled(Compiler::Compile(m_function))
+	{
+	}
+
+	void JitEngine::Run()
+	{
+		if (m_compiled)
+		{
+			m_shouldExit = m_compiled->Run();
+		}
+		else
+		{
+			m_fallback.Run(m_function);
+			m_shouldExit = m_fallback.HasExited();
+		}
+	}
+
+	bool JitEngine::HasExited() const
+	{
+		return m_shouldExit;
+	}
+
+	bool JitEngine::IsNative() const
+	{
+		return m_compiled != nullptr;
+	}
+}
+}
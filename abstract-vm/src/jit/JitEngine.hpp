@@ -0,0 +1,34 @@
+#pragma once
+#include "Compiler.hpp"
+#include "../ir/RegisterVM.hpp"
+
+namespace avm {
+namespace jit {
+
+	/*
+	 * Compiles a program once and runs it as often as needed. Functions the
+	 * compiler does not support, or any function on an unsupported host,
+	 * run on the RegisterVM instead with the same results.
+	 */
+	class JitEngine
+	{
+	public:
+		explicit JitEngine(ir::Function p_function);
+		JitEngine(const JitEngine &) = delete;
+		~JitEngine() = default;
+
+		JitEngine &operator=(const JitEngine &) = delete;
+
+		void Run();
+
+		bool HasExited() const;
+		bool IsNative() const;
+
+	private:
+		ir::Function const m_function;
+		UniquePtr<CompiledFunction> m_compiled;
+		ir::RegisterVM m_fallback;
+		bool m_shouldExit = false;
+	};
+}
+}
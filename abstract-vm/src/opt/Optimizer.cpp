@@ -0,0 +1,336 @@
+#include "Optimizer.hpp"
+#include "../Arithmetic.hpp"
+#include "../Operand.hpp"
+#include "../OperandFactory.hpp"
+#include "../analysis/IntervalAnalysis.hpp"
+
+namespace avm {
+namespace opt {
+
+	namespace {
+
+		ast::InstructionWithValue const *AsPush(ast::Instruction const &p_instruction)
+		{
+			if (p_instruction.GetType() != ast::Instruction::Type::PUSH)
+			{
+				return nullptr;
+			}
+			return dynamic_cast<ast::InstructionWithValue const *>(&p_instruction);
+		}
+
+		// Same conversion as Interpreter::PushValueToStack(), throws the same way
+		UniquePtr<IOperand const> CreatePushed(ast::InstructionWithValue const &p_push)
+		{
+			ast::Value const &l_value = *p_push.GetValue();
+
+			return UniquePtr<IOperand const>(OperandFactory::Get().CreateOperand(
+				l_value.GetOperandType(), *l_value.GetToken().m_literal));
+		}
+
+		bool IsRemovablePush(ast::Instruction const &p_instruction)
+		{
+			ast::InstructionWithValue const *l_push = AsPush(p_instruction);
+
+			if (l_push == nullptr)
+			{
+				return false;
+			}
+
+			try
+			{
+				CreatePushed(*l_push);
+			}
+			catch (std::exception const &)
+			{
+				return false;
+			}
+			return true;
+		}
+
+		/*
+		 * Builds `push <p_operand>`, or nothing when the literal would not give
+		 * back the exact same operand. Floating point values use the shortest
+		 * representation that round-trips instead of the 2-digit toString().
+		 */
+		UniquePtr<ast::Instruction const> MakePush(IOperand const &p_operand, int p_line)
+		{
+			static const Array<Pair<TokenType, char const *>, 5> l_types {{
+				{ TokenType::INT8,   "int8"   },
+				{ TokenType::INT16,  "int16"  },
+				{ TokenType::INT32,  "int32"  },
+				{ TokenType::FLOAT,  "float"  },
+				{ TokenType::DOUBLE, "double" },
+			}};
+
+			double l_value = dynamic_cast<OperandBase const &>(p_operand).ToDouble();
+			String l_literal;
+
+			switch (p_operand.getType())
+			{
+				case eOperandType::FLOAT:
+					l_literal = fmt::format("{}", static_cast<float>(l_value));
+					break;
+				case eOperandType::DOUBLE:
+					l_literal = fmt::format("{}", l_value);
+					break;
+				default:
+					l_literal = p_operand.toString();
+					break;
+			}
+
+			try
+			{
+				UniquePtr<IOperand const> l_check(OperandFactory::Get().CreateOperand(p_operand.getType(), l_literal));
+
+				if (dynamic_cast<OperandBase const &>(*l_check).ToDouble() != l_value
+					|| l_check->toString() != p_operand.toString())
+				{
+					return nullptr;
+				}
+			}
+			catch (std::exception const &)
+			{
+				return nullptr;
+			}
+
+			auto const &l_type = l_types[static_cast<size_t>(p_operand.getType())];
+
+			return MakeUnique<ast::InstructionWithValue>(ast::Instruction::Type::PUSH,
+				MakeUnique<ast::Value>(
+					Token(l_type.first, l_type.second, NullOpt, p_line),
+					Token(TokenType::NUMBER, l_literal, l_literal, p_line)),
+				p_line);
+		}
+
+		UniquePtr<ast::Instruction const> Fold(ast::Instruction const &p_first, ast::Instruction const &p_second,
+			ast::Instruction const &p_operation)
+		{
+			ast::InstructionWithValue const *l_lhsPush = AsPush(p_first);
+			ast::InstructionWithValue const *l_rhsPush = AsPush(p_second);
+
+			if (l_lhsPush == nullptr || l_rhsPush == nullptr || !IsArithmetic(p_operation.GetType()))
+			{
+				return nullptr;
+			}
+
+			try
+			{
+				UniquePtr<IOperand const> l_lhs = CreatePushed(*l_lhsPush);
+				UniquePtr<IOperand const> l_rhs = CreatePushed(*l_rhsPush);
+
+				// A zero modulo converts NaN to the result type, leave it to the interpreter
+				if (p_operation.GetType() == ast::Instruction::Type::MOD && std::stod(l_rhs->toString()) == 0)
+				{
+					return nullptr;
+				}
+
+				UniquePtr<IOperand const> l_result(Apply(p_operation.GetType(), *l_lhs, *l_rhs));
+
+				return MakePush(*l_result, p_operation.GetLine());
+			}
+			catch (std::exception const &)
+			{
+				// Faulting operations stay where they are
+				return nullptr;
+			}
+		}
+	}
+
+	// ExitTruncation
+	// ==============
+
+	char const *ExitTruncation::GetName() const
+	{
+		return "exit-truncation";
+	}
+
+	size_t ExitTruncation::Run(ast::Program &p_program)
+	{
+		auto &l_instructions = p_program.GetInstructions();
+		size_t l_before = l_instructions.size();
+
+		auto const l_isBoundary = [] (UniquePtr<ast::Instruction const> const &p_instruction) {
+			return p_instruction->GetType() == ast::Instruction::Type::LABEL
+				|| p_instruction->GetType() == ast::Instruction::Type::DEF
+				|| p_instruction->GetType() == ast::Instruction::Type::END;
+		};
+
+		// Code after an exit is only reachable through a jump to a label, or a call
+		for (auto l_it = l_instructions.begin(); l_it != l_instructions.end(); ++l_it)
+		{
+			if ((*l_it)->GetType() == ast::Instruction::Type::EXIT)
+			{
+				auto const l_label = std::find_if(std::next(l_it), l_instructions.end(), l_isBoundary);
+
+				l_it = std::prev(l_instructions.erase(std::next(l_it), l_label));
+			}
+		}
+
+		return l_before - l_instructions.size();
+	}
+
+	// ConstantFolding
+	// ===============
+
+	char const *ConstantFolding::GetName() const
+	{
+		return "constant-folding";
+	}
+
+	size_t ConstantFolding::Run(ast::Program &p_program)
+	{
+		auto &l_instructions = p_program.GetInstructions();
+		size_t l_before = l_instructions.size();
+
+		auto l_it = l_instructions.begin();
+		while (l_it != l_instructions.end())
+		{
+			auto l_second = std::next(l_it);
+			if (l_second == l_instructions.end())
+				break;
+			auto l_third = std::next(l_second);
+			if (l_third == l_instructions.end())
+				break;
+
+			UniquePtr<ast::Instruction const> l_folded = Fold(**l_it, **l_second, **l_third);
+
+			if (l_folded)
+			{
+				l_it = l_instructions.erase(l_it, std::next(l_third));
+				l_it = l_instructions.insert(l_it, std::move(l_folded));
+
+				// The new push may complete a window that starts up to two instructions before
+				for (int l_i = 0; l_i < 2 && l_it != l_instructions.begin(); l_i++)
+				{
+					--l_it;
+				}
+			}
+			else
+			{
+				++l_it;
+			}
+		}
+
+		return l_before - l_instructions.size();
+	}
+
+	// DeadCodeElimination
+	// ===================
+
+	char const *DeadCodeElimination::GetName() const
+	{
+		return "dead-code-elimination";
+	}
+
+	size_t DeadCodeElimination::Run(ast::Program &p_program)
+	{
+		analysis::IntervalAnalysis l_analysis;
+		l_analysis.Run(p_program);
+
+		auto &l_instructions = p_program.GetInstructions();
+		size_t l_before = l_instructions.size();
+		List<UniquePtr<ast::Instruction const>> l_result;
+
+		for (auto &l_instruction : l_instructions)
+		{
+			if (l_instruction->GetType() != ast::Instruction::Type::POP)
+			{
+				l_result.push_back(std::move(l_instruction));
+				continue;
+			}
+
+			// Walk back over what only produced the popped value
+			size_t l_pops = 1;
+			while (l_pops > 0 && !l_result.empty())
+			{
+				ast::Instruction const &l_last = *l_result.back();
+
+				if (IsRemovablePush(l_last))
+				{
+					l_pops--;
+				}
+				else if (IsArithmetic(l_last.GetType())
+					&& l_analysis.GetVerdict(l_last) == analysis::Verdict::SAFE)
+				{
+					// Popping the result of a binary operation pops both operands
+					l_pops++;
+				}
+				else
+				{
+					break;
+				}
+				l_result.pop_back();
+			}
+
+			for (size_t l_i = 0; l_i < l_pops; l_i++)
+			{
+				l_result.push_back(MakeUnique<ast::Instruction>(ast::Instruction::Type::POP, l_instruction->GetLine()));
+			}
+		}
+
+		l_instructions = std::move(l_result);
+
+		return l_before - l_instructions.size();
+	}
+
+	// Optimizer
+	// =========
+
+	Optimizer::Optimizer()
+	{
+		m_passes.emplace_back(MakeUnique<ExitTruncation>(), true);
+		m_passes.emplace_back(MakeUnique<ConstantFolding>(), true);
+		m_passes.emplace_back(MakeUnique<DeadCodeElimination>(), true);
+	}
+
+	void Optimizer::Enable(StringView p_name, bool p_enabled)
+	{
+		for (auto &l_pass : m_passes)
+		{
+			if (l_pass.first->GetName() == p_name)
+			{
+				l_pass.second = p_enabled;
+				return;
+			}
+		}
+		throw std::invalid_argument(fmt::format("Unknown optimizer pass: {}", p_name));
+	}
+
+	bool Optimizer::IsEnabled(StringView p_name) const
+	{
+		for (auto const &l_pass : m_passes)
+		{
+			if (l_pass.first->GetName() == p_name)
+			{
+				return l_pass.second;
+			}
+		}
+		return false;
+	}
+
+	Vector<String> Optimizer::GetPassNames() const
+	{
+		Vector<String> l_names;
+
+		for (auto const &l_pass : m_passes)
+		{
+			l_names.emplace_back(l_pass.first->GetName());
+		}
+		return l_names;
+	}
+
+	Vector<PassReport> Optimizer::Run(ast::Program &p_program)
+	{
+		Vector<PassReport> l_reports;
+
+		for (auto &l_pass : m_passes)
+		{
+			if (l_pass.second)
+			{
+				l_reports.push_back({ l_pass.first->GetName(), l_pass.first->Run(p_program) });
+			}
+		}
+		return l_reports;
+	}
+}
+}
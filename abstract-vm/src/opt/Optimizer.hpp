@@ -0,0 +1,74 @@
+#pragma once
+#include "../abstractvm.hpp"
+#include "../ast/Instruction.hpp"
+
+namespace avm {
+namespace opt {
+
+	/*
+	 * A rewrite of the parsed program that keeps its output and the faults it
+	 * raises. Run() returns how many instructions the pass removed.
+	 */
+	class Pass
+	{
+	public:
+		virtual ~Pass() = default;
+
+		virtual char const *GetName() const = 0;
+		virtual size_t Run(ast::Program &p_program) = 0;
+	};
+
+	// Drops the instructions after each `exit`, up to the next label or routine boundary
+	class ExitTruncation : public Pass
+	{
+	public:
+		char const *GetName() const override;
+		size_t Run(ast::Program &p_program) override;
+	};
+
+	// Replaces `push a; push b; <op>` by `push (a <op> b)` when <op> does not fault
+	class ConstantFolding : public Pass
+	{
+	public:
+		char const *GetName() const override;
+		size_t Run(ast::Program &p_program) override;
+	};
+
+	/*
+	 * Removes values that are popped without being observed: `push x; pop`
+	 * pairs, and proven-safe arithmetic whose result is popped (its operands
+	 * are popped instead, which may cascade).
+	 */
+	class DeadCodeElimination : public Pass
+	{
+	public:
+		char const *GetName() const override;
+		size_t Run(ast::Program &p_program) override;
+	};
+
+	struct PassReport
+	{
+		String m_name;
+		size_t m_removed;
+	};
+
+	class Optimizer
+	{
+	public:
+		Optimizer();
+		Optimizer(const Optimizer &) = delete;
+		virtual ~Optimizer() = default;
+
+		Optimizer &operator=(const Optimizer &) = delete;
+
+		void Enable(StringView p_name, bool p_enabled);
+		bool IsEnabled(StringView p_name) const;
+		Vector<String> GetPassNames() const;
+
+		Vector<PassReport> Run(ast::Program &p_program);
+
+	private:
+		Vector<Pair<UniquePtr<Pass>, bool>> m_passes;
+	};
+}
+}
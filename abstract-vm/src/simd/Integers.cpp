@@ -0,0 +1,136 @@
+#include "Integers.hpp"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ && (defined(__GNUC__) || defined(__clang__))
+# define AVM_HAS_SWAR 1
+#else
+# define AVM_HAS_SWAR 0
+#endif
+
+namespace avm {
+namespace simd {
+
+	namespace {
+
+		constexpr int64_t s_powers[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000 };
+
+#if AVM_HAS_SWAR
+		// Next eight characters, padded with zeros (not digits) at the end of the text
+		uint64_t Load(StringView p_text, size_t p_position)
+		{
+			uint64_t l_chunk = 0;
+
+			std::memcpy(&l_chunk, p_text.data() + p_position, std::min<size_t>(8, p_text.size() - p_position));
+			return l_chunk;
+		}
+
+		// Number of leading digits of the chunk, the first character in the low byte
+		size_t CountDigits(uint64_t p_chunk)
+		{
+			uint64_t const l_notDigits = ((p_chunk + 0x4646464646464646) | (p_chunk - 0x3030303030303030))
+				& 0x8080808080808080;
+
+			return l_notDigits == 0 ? 8 : static_cast<size_t>(__builtin_ctzll(l_notDigits)) / 8;
+		}
+
+		// Value of the first p_count (1 to 8) digits of the chunk
+		int64_t Convert(uint64_t p_chunk, size_t p_count)
+		{
+			// Left pad to eight digits with '0'
+			if (p_count < 8)
+			{
+				p_chunk = (p_chunk << (8 * (8 - p_count))) | (0x3030303030303030 >> (8 * p_count));
+			}
+
+			p_chunk -= 0x3030303030303030;
+			p_chunk = (p_chunk * 10) + (p_chunk >> 8);
+			p_chunk = (((p_chunk & 0x000000FF000000FF) * (100 + (1000000ULL << 32)))
+				+ (((p_chunk >> 16) & 0x000000FF000000FF) * (1 + (10000ULL << 32)))) >> 32;
+
+			return static_cast<int64_t>(p_chunk);
+		}
+#endif
+
+		bool IsDigit(char p_char)
+		{
+			return p_char >= '0' && p_char <= '9';
+		}
+
+		size_t SkipBlank(StringView p_text, size_t p_position)
+		{
+			while (p_position < p_text.size() && (p_text[p_position] == ' ' || p_text[p_position] == '\t'))
+			{
+				p_position++;
+			}
+			return p_position;
+		}
+
+		// Reads the digits at p_position, returns the position after them
+		size_t Digits(StringView p_text, size_t p_position, int64_t &p_value)
+		{
+			p_value = 0;
+
+#if AVM_HAS_SWAR
+			while (p_position < p_text.size())
+			{
+				uint64_t const l_chunk = Load(p_text, p_position);
+				size_t const l_count = CountDigits(l_chunk);
+
+				if (l_count == 0)
+				{
+					break;
+				}
+				p_value = p_value >= s_saturated ? s_saturated : p_value * s_powers[l_count] + Convert(l_chunk, l_count);
+				p_position += l_count;
+			}
+#else
+			for (; p_position < p_text.size() && IsDigit(p_text[p_position]); p_position++)
+			{
+				p_value = p_value >= s_saturated ? s_saturated : p_value * s_powers[1] + (p_text[p_position] - '0');
+			}
+#endif
+			return p_position;
+		}
+	}
+
+	size_t ParseIntegers(StringView p_text, Vector<int64_t> &p_values)
+	{
+		size_t l_position = SkipBlank(p_text, 0);
+
+		// Two characters per value at least
+		p_values.reserve(p_values.size() + p_text.size() / 2 + 1);
+
+		while (l_position < p_text.size())
+		{
+			bool const l_negative = p_text[l_position] == '-';
+			size_t const l_start = l_position + (l_negative ? 1 : 0);
+			int64_t l_value = 0;
+
+			if (l_start >= p_text.size() || !IsDigit(p_text[l_start]))
+			{
+				return l_position;
+			}
+
+			l_position = SkipBlank(p_text, Digits(p_text, l_start, l_value));
+			p_values.push_back(l_negative ? -l_value : l_value);
+
+			if (l_position < p_text.size())
+			{
+				if (p_text[l_position] != ',')
+				{
+					return l_position;
+				}
+				l_position = SkipBlank(p_text, l_position + 1);
+
+				// No trailing comma
+				if (l_position == p_text.size())
+				{
+					return l_position - 1;
+				}
+			}
+		}
+		return l_position;
+	}
+}
+}
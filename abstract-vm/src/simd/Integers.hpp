@@ -0,0 +1,23 @@
+#pragma once
+#include <cstdint>
+#include "../abstractvm.hpp"
+
+namespace avm {
+namespace simd {
+
+	// Past this, a value is out of range of every operand type
+	constexpr int64_t s_saturated = 10000000000;
+
+	/*
+	 * Reads a comma separated list of decimal integers, the body of a bulk
+	 * push like "push int32[1, -2, 3]", and appends the values. Digits are
+	 * converted eight at a time within a 64-bit word (SWAR).
+	 *
+	 * Values of more than ten digits may saturate to s_saturated, so a
+	 * value that reaches it no longer is the one written. Returns how many
+	 * characters were read: less than the size of p_text when it is not a
+	 * well-formed list.
+	 */
+	size_t ParseIntegers(StringView p_text, Vector<int64_t> &p_values);
+}
+}
@@ -0,0 +1,445 @@
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+#include "Kernels.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+# include <immintrin.h>
+# define AVM_HAS_X86_DISPATCH 1
+#else
+# define AVM_HAS_X86_DISPATCH 0
+#endif
+
+namespace avm {
+namespace simd {
+
+	struct Kernels
+	{
+		Sums (*m_sumIntegers)(Payload const *, size_t);
+		int64_t (*m_minInteger)(Payload const *, size_t);
+		int64_t (*m_maxInteger)(Payload const *, size_t);
+		double (*m_minReal)(Payload const *, size_t);
+		double (*m_maxReal)(Payload const *, size_t);
+	};
+
+	// Scalar
+	// ======
+
+	// The wider kernels finish their ranges with these
+
+	static Sums SumScalar(Payload const *p_values, size_t p_count, Sums p_sums)
+	{
+		for (size_t l_i = 0; l_i < p_count; l_i++)
+		{
+			int64_t const l_value = p_values[l_i].m_integer;
+
+			p_sums.m_sum += l_value;
+			p_sums.m_positive += l_value > 0 ? l_value : 0;
+			p_sums.m_negative += l_value < 0 ? l_value : 0;
+		}
+		return p_sums;
+	}
+
+	static Sums SumScalar(Payload const *p_values, size_t p_count)
+	{
+		return SumScalar(p_values, p_count, Sums());
+	}
+
+	template <bool Min>
+	static int64_t ExtremeIntegerScalar(Payload const *p_values, size_t p_count, int64_t p_start)
+	{
+		for (size_t l_i = 0; l_i < p_count; l_i++)
+		{
+			int64_t const l_value = p_values[l_i].m_integer;
+
+			p_start = (Min ? l_value < p_start : l_value > p_start) ? l_value : p_start;
+		}
+		return p_start;
+	}
+
+	template <bool Min>
+	static int64_t ExtremeIntegerScalar(Payload const *p_values, size_t p_count)
+	{
+		return ExtremeIntegerScalar<Min>(p_values + 1, p_count - 1, p_values[0].m_integer);
+	}
+
+	// Same comparison as minpd/maxpd, so that every level agrees
+	template <bool Min>
+	static double ExtremeRealScalar(Payload const *p_values, size_t p_count, double p_start)
+	{
+		for (size_t l_i = 0; l_i < p_count; l_i++)
+		{
+			double const l_value = p_values[l_i].m_real;
+
+			p_start = (Min ? l_value < p_start : l_value > p_start) ? l_value : p_start;
+		}
+		return p_start;
+	}
+
+	template <bool Min>
+	static double ExtremeRealScalar(Payload const *p_values, size_t p_count)
+	{
+		return ExtremeRealScalar<Min>(p_values + 1, p_count - 1, p_values[0].m_real);
+	}
+
+	static Kernels const s_scalar {
+		&SumScalar,
+		&ExtremeIntegerScalar<true>,
+		&ExtremeIntegerScalar<false>,
+		&ExtremeRealScalar<true>,
+		&ExtremeRealScalar<false>,
+	};
+
+#if AVM_HAS_X86_DISPATCH
+
+	// AVX2
+	// ====
+
+	__attribute__((target("avx2")))
+	static Sums SumAvx2(Payload const *p_values, size_t p_count)
+	{
+		__m256i const l_zero = _mm256_setzero_si256();
+		__m256i l_sum = l_zero;
+		__m256i l_positive = l_zero;
+		__m256i l_negative = l_zero;
+		size_t l_i = 0;
+
+		for (; l_i + 4 <= p_count; l_i += 4)
+		{
+			__m256i const l_values = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(p_values + l_i));
+			__m256i const l_isPositive = _mm256_cmpgt_epi64(l_values, l_zero);
+
+			l_sum = _mm256_add_epi64(l_sum, l_values);
+			l_positive = _mm256_add_epi64(l_positive, _mm256_and_si256(l_values, l_isPositive));
+			l_negative = _mm256_add_epi64(l_negative, _mm256_andnot_si256(l_isPositive, l_values));
+		}
+
+		alignas(32) int64_t l_lanes[3][4];
+		_mm256_store_si256(reinterpret_cast<__m256i *>(l_lanes[0]), l_sum);
+		_mm256_store_si256(reinterpret_cast<__m256i *>(l_lanes[1]), l_positive);
+		_mm256_store_si256(reinterpret_cast<__m256i *>(l_lanes[2]), l_negative);
+
+		Sums l_sums;
+		for (size_t l_lane = 0; l_lane < 4; l_lane++)
+		{
+			l_sums.m_sum += l_lanes[0][l_lane];
+			l_sums.m_positive += l_lanes[1][l_lane];
+			l_sums.m_negative += l_lanes[2][l_lane];
+		}
+		return SumScalar(p_values + l_i, p_count - l_i, l_sums);
+	}
+
+	template <bool Min>
+	__attribute__((target("avx2")))
+	static int64_t ExtremeIntegerAvx2(Payload const *p_values, size_t p_count)
+	{
+		if (p_count < 4)
+		{
+			return ExtremeIntegerScalar<Min>(p_values, p_count);
+		}
+
+		__m256i l_extreme = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(p_values));
+		size_t l_i = 4;
+
+		// AVX2 has no 64-bit min or max: compare and blend
+		for (; l_i + 4 <= p_count; l_i += 4)
+		{
+			__m256i const l_values = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(p_values + l_i));
+			__m256i const l_take = Min ? _mm256_cmpgt_epi64(l_extreme, l_values) : _mm256_cmpgt_epi64(l_values, l_extreme);
+
+			l_extreme = _mm256_blendv_epi8(l_extreme, l_values, l_take);
+		}
+
+		alignas(32) int64_t l_lanes[4];
+		_mm256_store_si256(reinterpret_cast<__m256i *>(l_lanes), l_extreme);
+
+		int64_t l_result = l_lanes[0];
+		for (size_t l_lane = 1; l_lane < 4; l_lane++)
+		{
+			l_result = (Min ? l_lanes[l_lane] < l_result : l_lanes[l_lane] > l_result) ? l_lanes[l_lane] : l_result;
+		}
+		return ExtremeIntegerScalar<Min>(p_values + l_i, p_count - l_i, l_result);
+	}
+
+	template <bool Min>
+	__attribute__((target("avx2")))
+	static double ExtremeRealAvx2(Payload const *p_values, size_t p_count)
+	{
+		if (p_count < 4)
+		{
+			return ExtremeRealScalar<Min>(p_values, p_count);
+		}
+
+		__m256d l_extreme = _mm256_loadu_pd(&p_values[0].m_real);
+		size_t l_i = 4;
+
+		for (; l_i + 4 <= p_count; l_i += 4)
+		{
+			__m256d const l_values = _mm256_loadu_pd(&p_values[l_i].m_real);
+
+			l_extreme = Min ? _mm256_min_pd(l_values, l_extreme) : _mm256_max_pd(l_values, l_extreme);
+		}
+
+		alignas(32) double l_lanes[4];
+		_mm256_store_pd(l_lanes, l_extreme);
+
+		double l_result = l_lanes[0];
+		for (size_t l_lane = 1; l_lane < 4; l_lane++)
+		{
+			l_result = (Min ? l_lanes[l_lane] < l_result : l_lanes[l_lane] > l_result) ? l_lanes[l_lane] : l_result;
+		}
+		return ExtremeRealScalar<Min>(p_values + l_i, p_count - l_i, l_result);
+	}
+
+	static Kernels const s_avx2 {
+		&SumAvx2,
+		&ExtremeIntegerAvx2<true>,
+		&ExtremeIntegerAvx2<false>,
+		&ExtremeRealAvx2<true>,
+		&ExtremeRealAvx2<false>,
+	};
+
+	// AVX-512
+	// =======
+
+	__attribute__((target("avx512f")))
+	static Sums SumAvx512(Payload const *p_values, size_t p_count)
+	{
+		__m512i const l_zero = _mm512_setzero_si512();
+		__m512i l_sum = l_zero;
+		__m512i l_positive = l_zero;
+		__m512i l_negative = l_zero;
+		size_t l_i = 0;
+
+		for (; l_i + 8 <= p_count; l_i += 8)
+		{
+			__m512i const l_values = _mm512_loadu_si512(p_values + l_i);
+
+			l_sum = _mm512_add_epi64(l_sum, l_values);
+			l_positive = _mm512_mask_add_epi64(l_positive, _mm512_cmpgt_epi64_mask(l_values, l_zero), l_positive, l_values);
+			l_negative = _mm512_mask_add_epi64(l_negative, _mm512_cmplt_epi64_mask(l_values, l_zero), l_negative, l_values);
+		}
+
+		// Reduce the lanes by hand: GCC's _mm512_reduce_* helpers start from an
+		// undefined vector and trip -Werror=maybe-uninitialized at -O2
+		alignas(64) int64_t l_lanes[3][8];
+		_mm512_store_si512(l_lanes[0], l_sum);
+		_mm512_store_si512(l_lanes[1], l_positive);
+		_mm512_store_si512(l_lanes[2], l_negative);
+
+		Sums l_sums;
+		for (size_t l_lane = 0; l_lane < 8; l_lane++)
+		{
+			l_sums.m_sum += l_lanes[0][l_lane];
+			l_sums.m_positive += l_lanes[1][l_lane];
+			l_sums.m_negative += l_lanes[2][l_lane];
+		}
+		return SumScalar(p_values + l_i, p_count - l_i, l_sums);
+	}
+
+	template <bool Min>
+	__attribute__((target("avx512f")))
+	static int64_t ExtremeIntegerAvx512(Payload const *p_values, size_t p_count)
+	{
+		if (p_count < 8)
+		{
+			return ExtremeIntegerScalar<Min>(p_values, p_count);
+		}
+
+		__m512i l_extreme = _mm512_loadu_si512(p_values);
+		size_t l_i = 8;
+
+		// The unmasked min and max forms also expand from an undefined vector:
+		// use the masked forms with every lane selected
+		for (; l_i + 8 <= p_count; l_i += 8)
+		{
+			__m512i const l_values = _mm512_loadu_si512(p_values + l_i);
+
+			l_extreme = Min ? _mm512_mask_min_epi64(l_extreme, 0xFF, l_extreme, l_values)
+				: _mm512_mask_max_epi64(l_extreme, 0xFF, l_extreme, l_values);
+		}
+
+		alignas(64) int64_t l_lanes[8];
+		_mm512_store_si512(l_lanes, l_extreme);
+
+		int64_t l_result = l_lanes[0];
+		for (size_t l_lane = 1; l_lane < 8; l_lane++)
+		{
+			l_result = (Min ? l_lanes[l_lane] < l_result : l_lanes[l_lane] > l_result) ? l_lanes[l_lane] : l_result;
+		}
+		return ExtremeIntegerScalar<Min>(p_values + l_i, p_count - l_i, l_result);
+	}
+
+	template <bool Min>
+	__attribute__((target("avx512f")))
+	static double ExtremeRealAvx512(Payload const *p_values, size_t p_count)
+	{
+		if (p_count < 8)
+		{
+			return ExtremeRealScalar<Min>(p_values, p_count);
+		}
+
+		__m512d l_extreme = _mm512_loadu_pd(&p_values[0].m_real);
+		size_t l_i = 8;
+
+		for (; l_i + 8 <= p_count; l_i += 8)
+		{
+			__m512d const l_values = _mm512_loadu_pd(&p_values[l_i].m_real);
+
+			l_extreme = Min ? _mm512_mask_min_pd(l_extreme, 0xFF, l_values, l_extreme)
+				: _mm512_mask_max_pd(l_extreme, 0xFF, l_values, l_extreme);
+		}
+
+		alignas(64) double l_lanes[8];
+		_mm512_store_pd(l_lanes, l_extreme);
+
+		double l_result = l_lanes[0];
+		for (size_t l_lane = 1; l_lane < 8; l_lane++)
+		{
+			l_result = (Min ? l_lanes[l_lane] < l_result : l_lanes[l_lane] > l_result) ? l_lanes[l_lane] : l_result;
+		}
+		return ExtremeRealScalar<Min>(p_values + l_i, p_count - l_i, l_result);
+	}
+
+	static Kernels const s_avx512 {
+		&SumAvx512,
+		&ExtremeIntegerAvx512<true>,
+		&ExtremeIntegerAvx512<false>,
+		&ExtremeRealAvx512<true>,
+		&ExtremeRealAvx512<false>,
+	};
+
+#endif
+
+	// Dispatch
+	// ========
+
+	static Kernels const &KernelsFor(Level p_level)
+	{
+#if AVM_HAS_X86_DISPATCH
+		switch (p_level)
+		{
+			case Level::AVX512: return s_avx512;
+			case Level::AVX2:   return s_avx2;
+			case Level::SCALAR: return s_scalar;
+		}
+#else
+		(void)p_level;
+#endif
+		return s_scalar;
+	}
+
+	static Level SelectLevel()
+	{
+		char const *const l_forced = std::getenv("AVM_SIMD");
+		Level const l_detected = DetectLevel();
+
+		if (l_forced != nullptr)
+		{
+			Optional<Level> const l_level = ParseLevel(l_forced);
+
+			if (l_level)
+			{
+				return std::min(*l_level, l_detected);
+			}
+		}
+		return l_detected;
+	}
+
+	struct Selection
+	{
+		Level m_level;
+		Kernels const *m_kernels;
+	};
+
+	// Selected once, on first use
+	static Selection &Selected()
+	{
+		static Selection l_selection { SelectLevel(), nullptr };
+
+		if (l_selection.m_kernels == nullptr)
+		{
+			l_selection.m_kernels = &KernelsFor(l_selection.m_level);
+		}
+		return l_selection;
+	}
+
+	Level DetectLevel()
+	{
+#if AVM_HAS_X86_DISPATCH
+		__builtin_cpu_init();
+
+		if (__builtin_cpu_supports("avx512f"))
+		{
+			return Level::AVX512;
+		}
+		if (__builtin_cpu_supports("avx2"))
+		{
+			return Level::AVX2;
+		}
+#endif
+		return Level::SCALAR;
+	}
+
+	Level GetLevel()
+	{
+		return Selected().m_level;
+	}
+
+	void SetLevel(Level p_level)
+	{
+		Selection &l_selection = Selected();
+
+		l_selection.m_level = std::min(p_level, DetectLevel());
+		l_selection.m_kernels = &KernelsFor(l_selection.m_level);
+	}
+
+	char const *GetLevelName(Level p_level)
+	{
+		switch (p_level)
+		{
+			case Level::SCALAR: return "scalar";
+			case Level::AVX2:   return "avx2";
+			case Level::AVX512: return "avx512";
+		}
+		throw std::runtime_error("Unreachable!");
+	}
+
+	Optional<Level> ParseLevel(StringView p_name)
+	{
+		for (Level l_level : { Level::SCALAR, Level::AVX2, Level::AVX512 })
+		{
+			if (p_name == GetLevelName(l_level))
+			{
+				return l_level;
+			}
+		}
+		return NullOpt;
+	}
+
+	Sums SumIntegers(Payload const *p_values, size_t p_count)
+	{
+		return Selected().m_kernels->m_sumIntegers(p_values, p_count);
+	}
+
+	int64_t MinInteger(Payload const *p_values, size_t p_count)
+	{
+		return Selected().m_kernels->m_minInteger(p_values, p_count);
+	}
+
+	int64_t MaxInteger(Payload const *p_values, size_t p_count)
+	{
+		return Selected().m_kernels->m_maxInteger(p_values, p_count);
+	}
+
+	double MinReal(Payload const *p_values, size_t p_count)
+	{
+		return Selected().m_kernels->m_minReal(p_values, p_count);
+	}
+
+	double MaxReal(Payload const *p_values, size_t p_count)
+	{
+		return Selected().m_kernels->m_maxReal(p_values, p_count);
+	}
+}
+}
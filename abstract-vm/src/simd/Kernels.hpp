@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+#include "../abstractvm.hpp"
+
+namespace avm {
+namespace simd {
+
+	/*
+	 * Vectorized kernels, compiled for several instruction sets and picked
+	 * once at startup from what the CPU supports. The AVM_SIMD environment
+	 * variable forces a level ("scalar", "avx2" or "avx512"), capped to what
+	 * the host can run. Every level returns the same results.
+	 */
+
+	union Payload
+	{
+		int64_t m_integer;
+		double m_real;
+	};
+
+	enum class Level
+	{
+		SCALAR,
+		AVX2,
+		AVX512,
+	};
+
+	// Sum of the values, and separately of the positive and negative ones
+	struct Sums
+	{
+		int64_t m_sum = 0;
+		int64_t m_positive = 0;
+		int64_t m_negative = 0;
+	};
+
+	// Best level the host supports
+	Level DetectLevel();
+
+	Level GetLevel();
+	void SetLevel(Level p_level);
+
+	char const *GetLevelName(Level p_level);
+	Optional<Level> ParseLevel(StringView p_name);
+
+	// The ranges below are never empty
+	Sums SumIntegers(Payload const *p_values, size_t p_count);
+	int64_t MinInteger(Payload const *p_values, size_t p_count);
+	int64_t MaxInteger(Payload const *p_values, size_t p_count);
+	double MinReal(Payload const *p_values, size_t p_count);
+	double MaxReal(Payload const *p_values, size_t p_count);
+}
+}
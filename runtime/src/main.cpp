@@ -1,9 +1,38 @@
 #include <unistd.h>
 #include <iostream>
+#include <algorithm>
 #include "avm.hpp"
 #include "src/Lexer.hpp"
 #include "src/Parser.hpp"
+#include "src/ModuleCache.hpp"
 #include "src/Interpreter.hpp"
+#include "src/LazyInterpreter.hpp"
+#include "src/dataflow/DataflowInterpreter.hpp"
+#include "src/ir/Builder.hpp"
+#include "src/ir/RegisterVM.hpp"
+#include "src/jit/JitEngine.hpp"
+#include "src/codegen/CppEmitter.hpp"
+#include "src/analysis/IntervalAnalysis.hpp"
+#include "src/opt/Optimizer.hpp"
+
+static avm::Vector<avm::StringView> const s_engines { "tree", "lazy", "dataflow", "register", "jit" };
+
+struct Options
+{
+	// Programs of the batch, run in turn
+	avm::Vector<char const *> m_paths;
+	char const *m_moduleCache = nullptr;
+	// Stack capacity of the tree engine, in place of the ";@stack" pragmas
+	avm::Optional<size_t> m_stackCapacity;
+	// Where the tree engine keeps its stack
+	avm::SegmentStorage m_stackStorage;
+	bool m_optimize = false;
+	bool m_optimizerReport = false;
+	bool m_emitIR = false;
+	bool m_emitCpp = false;
+	avm::String m_engine = "tree";
+	avm::Vector<avm::String> m_disabledPasses;
+};
 
 int readline(std::string &p_result)
 {
@@ -19,6 +48,7 @@ int RunRepl()
 {
 	avm::Lexer l_lexer;
 	avm::Interpreter l_interpreter;
+	avm::ModuleCache l_modules;
 
 	while (!l_interpreter.HasExited())
 	{
@@ -35,9 +65,21 @@ int RunRepl()
 
 		l_lexer.Run(l_line + "\n");
 
-		avm::Parser l_parser(l_lexer, l_lexer.GetTokens());
+		avm::Parser l_parser(l_lexer, l_lexer.GetTokens(), &l_modules);
 		avm::UniquePtr<avm::ast::Program> l_program = l_parser.Run();
 		avm::UniquePtr<const avm::ast::Instruction> l_instruction = l_program->GetNextInstruction();
+
+		if (l_program->GetStackCapacity())
+		{
+			try
+			{
+				l_interpreter.SetStackCapacity(*l_program->GetStackCapacity());
+			}
+			catch (std::exception const &e)
+			{
+				fmt::print("Error: {}\n", e.what());
+			}
+		}
 		while (l_instruction && !l_interpreter.HasExited())
 		{
 			try
@@ -57,36 +99,169 @@ int RunRepl()
 	return 0;
 }
 
-int RunFromFile(char const *const path)
+void Optimize(avm::ast::Program &p_program, Options const &p_options)
+{
+	avm::opt::Optimizer l_optimizer;
+
+	for (auto const &l_pass : p_options.m_disabledPasses)
+	{
+		l_optimizer.Enable(l_pass, false);
+	}
+
+	for (auto const &l_report : l_optimizer.Run(p_program))
+	{
+		if (p_options.m_optimizerReport)
+		{
+			fmt::print(stderr, "{}: removed {} instructions\n", l_report.m_name, l_report.m_removed);
+		}
+	}
+}
+
+template <typename Engine>
+void Execute(avm::ast::Program &p_program, Engine &p_engine)
+{
+	auto l_instruction = p_program.GetNextInstruction();
+	while (l_instruction)
+	{
+		try
+		{
+			if (p_engine.Evaluate(*l_instruction))
+			{
+				break;
+			}
+		}
+		catch (std::exception const &e)
+		{
+			fmt::print("Fatal Error: {}\n", e.what());
+			break ;
+		}
+		l_instruction = p_program.GetNextInstruction();
+	}
+}
+
+int RunFromFile(char const *p_path, Options const &p_options, avm::ModuleCache &p_modules)
 {
 	avm::Lexer l_lexer;
 
-	l_lexer.RunFile(path);
+	l_lexer.RunFile(p_path);
 
 	if (!l_lexer.HadError())
 	{
-		avm::Parser l_parser(l_lexer, l_lexer.GetTokens());
+		avm::Parser l_parser(l_lexer, l_lexer.GetTokens(), &p_modules);
 
 		auto l_program = l_parser.Run();
 
-		avm::Interpreter l_interpreter;
+		if (p_options.m_optimize)
+		{
+			Optimize(*l_program, p_options);
+		}
+
+		avm::analysis::IntervalAnalysis l_analysis;
+		l_analysis.Run(*l_program);
+
+		bool const l_emit = p_options.m_emitIR || p_options.m_emitCpp;
+		avm::String l_engine = p_options.m_engine;
 
-		auto l_instruction = l_program->GetNextInstruction();
-		while (l_instruction)
+		// Only the tree and dataflow engines run instructions outside the base set, see Instruction::IsBase()
+		if (!l_program->HasOnlyBaseInstructions())
+		{
+			if (l_emit)
+			{
+				fmt::print(stderr, "Error: the program uses instructions that have no register form\n");
+				return 1;
+			}
+			if (l_engine != "tree" && l_engine != "dataflow")
+			{
+				fmt::print(stderr, "Note: running on the tree engine, the program uses instructions that {} does not support\n",
+					l_engine);
+				l_engine = "tree";
+			}
+		}
+
+		// A load-time diagnostic, not output of the program
+		if (l_analysis.GetFault())
+		{
+			fmt::print(stderr, "[line {}] Warning: always fails: {}\n",
+				l_analysis.GetFault()->m_line, l_analysis.GetFault()->m_message);
+		}
+
+		if (p_options.m_emitIR)
+		{
+			avm::ir::Builder().Run(*l_program, l_analysis.GetProvenSafe()).Print();
+		}
+		else if (p_options.m_emitCpp)
 		{
+			avm::ir::Function const l_function = avm::ir::Builder().Run(*l_program, l_analysis.GetProvenSafe());
+			fmt::print("{}", avm::codegen::CppEmitter().Run(l_function, p_path));
+		}
+		else if (l_engine == "jit")
+		{
+			avm::jit::JitEngine l_jit(avm::ir::Builder().Run(*l_program, l_analysis.GetProvenSafe()));
+
 			try
 			{
-				if (l_interpreter.Evaluate(*l_instruction))
+				l_jit.Run();
+			}
+			catch (std::exception const &e)
+			{
+				fmt::print("Fatal Error: {}\n", e.what());
+			}
+		}
+		else if (l_engine == "register")
+		{
+			avm::ir::Function const l_function = avm::ir::Builder().Run(*l_program, l_analysis.GetProvenSafe());
+			avm::ir::RegisterVM l_vm;
+
+			try
+			{
+				l_vm.Run(l_function);
+			}
+			catch (std::exception const &e)
+			{
+				fmt::print("Fatal Error: {}\n", e.what());
+			}
+		}
+		else if (l_engine == "dataflow")
+		{
+			avm::dataflow::DataflowInterpreter l_interpreter;
+
+			try
+			{
+				l_interpreter.Run(*l_program);
+			}
+			catch (std::exception const &e)
+			{
+				fmt::print("Fatal Error: {}\n", e.what());
+			}
+		}
+		else if (l_engine == "lazy")
+		{
+			avm::LazyInterpreter l_interpreter;
+			Execute(*l_program, l_interpreter);
+		}
+		else
+		{
+			avm::Interpreter l_interpreter;
+			l_interpreter.SetUncheckedSites(l_analysis.GetProvenSafe());
+
+			try
+			{
+				l_interpreter.SetStackStorage(p_options.m_stackStorage);
+				// Without a capacity, reserve the depth the analysis found
+				if (p_options.m_stackCapacity)
 				{
-					break;
+					l_interpreter.SetStackCapacity(*p_options.m_stackCapacity);
 				}
+				else if (!l_program->GetStackCapacity() && l_analysis.GetMaxDepth())
+				{
+					l_interpreter.ReserveStack(*l_analysis.GetMaxDepth());
+				}
+				l_interpreter.Run(*l_program);
 			}
 			catch (std::exception const &e)
 			{
 				fmt::print("Fatal Error: {}\n", e.what());
-				break ;
 			}
-			l_instruction = l_program->GetNextInstruction();
 		}
 
 		return 0;
@@ -95,14 +270,106 @@ int RunFromFile(char const *const path)
 	return 1;
 }
 
+int Usage(char const *p_name)
+{
+	fmt::print(stderr, "usage: {} [-O] [--no-<pass>] [--opt-report] [--engine=tree|lazy|dataflow|register|jit] [--emit-ir] [--emit-cpp] [--module-cache=<dir>] [--stack=<values>] [--stack-budget=<MiB>] [--stack-dir=<dir>] [file...]\n", p_name);
+	fmt::print(stderr, "passes:");
+	for (auto const &l_pass : avm::opt::Optimizer().GetPassNames())
+	{
+		fmt::print(stderr, " {}", l_pass);
+	}
+	fmt::print(stderr, "\n");
+	return 2;
+}
+
+bool ParseOptions(int ac, char *av[], Options &p_options)
+{
+	avm::Vector<avm::String> const l_passes = avm::opt::Optimizer().GetPassNames();
+
+	for (int l_i = 1; l_i < ac; l_i++)
+	{
+		avm::StringView l_arg(av[l_i]);
+
+		if (l_arg == "-O")
+		{
+			p_options.m_optimize = true;
+		}
+		else if (l_arg == "--opt-report")
+		{
+			p_options.m_optimizerReport = true;
+		}
+		else if (l_arg == "--emit-ir")
+		{
+			p_options.m_emitIR = true;
+		}
+		else if (l_arg == "--emit-cpp")
+		{
+			p_options.m_emitCpp = true;
+		}
+		else if (l_arg.substr(0, 9) == "--engine="
+			&& std::find(s_engines.begin(), s_engines.end(), l_arg.substr(9)) != s_engines.end())
+		{
+			p_options.m_engine = avm::String(l_arg.substr(9));
+		}
+		else if (l_arg.substr(0, 5) == "--no-"
+			&& std::find(l_passes.begin(), l_passes.end(), l_arg.substr(5)) != l_passes.end())
+		{
+			p_options.m_disabledPasses.emplace_back(l_arg.substr(5));
+		}
+		else if (l_arg.substr(0, 15) == "--module-cache=" && l_arg.size() > 15)
+		{
+			p_options.m_moduleCache = av[l_i] + 15;
+		}
+		else if (l_arg.substr(0, 8) == "--stack=" && l_arg.size() > 8 && l_arg.size() <= 26
+			&& l_arg.find_first_not_of("0123456789", 8) == avm::StringView::npos
+			&& l_arg.find_first_not_of('0', 8) != avm::StringView::npos)
+		{
+			p_options.m_stackCapacity = std::stoull(av[l_i] + 8);
+		}
+		else if (l_arg.substr(0, 15) == "--stack-budget=" && l_arg.size() > 15 && l_arg.size() <= 22
+			&& l_arg.find_first_not_of("0123456789", 15) == avm::StringView::npos
+			&& l_arg.find_first_not_of('0', 15) != avm::StringView::npos)
+		{
+			p_options.m_stackStorage.m_residentBudget = std::stoull(av[l_i] + 15) << 20;
+		}
+		else if (l_arg.substr(0, 12) == "--stack-dir=" && l_arg.size() > 12)
+		{
+			p_options.m_stackStorage.m_directory = av[l_i] + 12;
+		}
+		else if (l_arg.size() > 1 && l_arg[0] == '-')
+		{
+			return false;
+		}
+		else
+		{
+			p_options.m_paths.push_back(av[l_i]);
+		}
+	}
+	return true;
+}
+
 int main(int ac, char *av[])
 {
-	if (ac <= 1)
+	Options l_options;
+
+	if (!ParseOptions(ac, av, l_options))
+	{
+		return Usage(av[0]);
+	}
+
+	if (l_options.m_paths.empty())
 	{
 		return RunRepl();
 	}
-	else
+
+	// Modules included by several programs are only compiled once
+	avm::ModuleCache l_modules = l_options.m_moduleCache
+		? avm::ModuleCache(l_options.m_moduleCache) : avm::ModuleCache();
+	int l_status = 0;
+
+	for (char const *l_path : l_options.m_paths)
 	{
-		return RunFromFile(av[1]);
+		l_status = std::max(l_status, RunFromFile(l_path, l_options, l_modules));
 	}
+	return l_status;
 }
@@ -0,0 +1,15 @@
+#!/usr/bin/env python3
+# Runs a program generated by avm --emit-cpp and compares its output
+import subprocess
+import sys
+
+program, expected = sys.argv[1], sys.argv[2]
+
+with open(expected) as f:
+    want = f.read()
+
+got = subprocess.run([program], stdout=subprocess.PIPE, check=True).stdout.decode()
+
+if got != want:
+    sys.stderr.write('expected:\n{}\ngot:\n{}\n'.format(want, got))
+    sys.exit(1)
@@ -0,0 +1,97 @@
+#pragma once
+#include <gtest/gtest.h>
+#include "avm.hpp"
+#include "src/Lexer.hpp"
+#include "src/Parser.hpp"
+#include "src/Interpreter.hpp"
+
+namespace avm {
+namespace test {
+
+	// p_path is the file the source is read from: includes are relative to it
+	inline UniquePtr<ast::Program> Parse(String const &p_source, ModuleCache *p_modules = nullptr,
+		String const &p_path = String())
+	{
+		Lexer l_lexer;
+		l_lexer.Run(p_source, p_path);
+
+		Parser l_parser(l_lexer, l_lexer.GetTokens(), p_modules);
+		return l_parser.Run();
+	}
+
+	template <typename T = ast::Instruction>
+	T const &At(ast::Program const &p_program, size_t p_idx)
+	{
+		return dynamic_cast<T const &>(**std::next(p_program.GetInstructions().begin(), p_idx));
+	}
+
+	// Evaluates the instructions one at a time up to exit, without consuming
+	// the program so it can run again
+	template <typename Engine>
+	void Evaluate(Engine &p_engine, ast::Program const &p_program)
+	{
+		for (auto const &l_instruction : p_program.GetInstructions())
+		{
+			if (p_engine.Evaluate(*l_instruction))
+			{
+				break;
+			}
+		}
+	}
+
+	// Output of a run, with the error that stopped it
+	template <typename Function>
+	String Capture(Function p_run)
+	{
+		testing::internal::CaptureStdout();
+		try
+		{
+			p_run();
+		}
+		catch (std::exception const &l_e)
+		{
+			fmt::print("Fatal Error: {}\n", l_e.what());
+		}
+		return testing::internal::GetCapturedStdout();
+	}
+
+	// Output of a run and the message of the error that stopped it, if any
+	template <typename Function>
+	Pair<String, String> Observe(Function p_run)
+	{
+		String l_error;
+
+		testing::internal::CaptureStdout();
+		try
+		{
+			p_run();
+		}
+		catch (std::exception const &l_e)
+		{
+			l_error = l_e.what();
+		}
+		return { testing::internal::GetCapturedStdout(), l_error };
+	}
+
+	inline String Execute(ast::Program const &p_program)
+	{
+		Interpreter l_interpreter;
+
+		return Capture([&] { l_interpreter.Run(p_program); });
+	}
+
+	inline String Output(String const &p_source, ModuleCache *p_modules = nullptr, String const &p_path = String())
+	{
+		return Execute(*Parse(p_source, p_modules, p_path));
+	}
+
+	// Reference run on the tree-walking interpreter, for the other engines
+	inline Pair<String, String> Interpret(String const &p_source)
+	{
+		auto l_program = Parse(p_source);
+		Interpreter l_interpreter;
+
+		return Observe([&] { Evaluate(l_interpreter, *l_program); });
+	}
+}
+}
@@ -0,0 +1,63 @@
+#include "Helpers.hpp"
+
+using namespace avm;
+using namespace avm::test;
+
+TEST(Blocks, Parse)
+{
+	auto l_program = Parse("repeat 3 {\npush int8(1)\n\npop\n}\nrepeat 2 { dump }\n");
+
+	ASSERT_EQ(l_program->GetInstructions().size(), 2u);
+	ASSERT_EQ(At<ast::InstructionWithBlock>(*l_program, 0).GetType(), ast::Instruction::Type::REPEAT);
+	ASSERT_EQ(At<ast::InstructionWithBlock>(*l_program, 0).GetCount(), 3u);
+	ASSERT_EQ(At<ast::InstructionWithBlock>(*l_program, 0).GetBody().GetInstructions().size(), 2u);
+	ASSERT_EQ(At<ast::InstructionWithBlock>(*l_program, 1).GetBody().GetInstructions().size(), 1u);
+
+	// Every use of a macro shares its body
+	auto l_macros = Parse("macro twice {\ndup\nadd\n}\npush int8(1)\ntwice\ntwice\n");
+
+	ASSERT_EQ(l_macros->GetInstructions().size(), 3u);
+	ASSERT_EQ(At<ast::InstructionWithBlock>(*l_macros, 1).GetCount(), 1u);
+	ASSERT_EQ(&At<ast::InstructionWithBlock>(*l_macros, 1).GetBody(), &At<ast::InstructionWithBlock>(*l_macros, 2).GetBody());
+}
+
+TEST(Blocks, SizeDoesNotGrowWithTheCount)
+{
+	auto l_program = Parse("push int32(0)\nrepeat 100000 {\npush int32(1)\nadd\n}\ndump\n");
+
+	ASSERT_EQ(l_program->GetInstructions().size(), 3u);
+	ASSERT_EQ(At<ast::InstructionWithBlock>(*l_program, 1).GetBody().GetInstructions().size(), 2u);
+	ASSERT_EQ(Output("push int32(0)\nrepeat 100000 {\npush int32(1)\nadd\n}\ndump\n"), "100000\n");
+}
+
+TEST(Blocks, Programs)
+{
+	ASSERT_EQ(Output("repeat 3 {\npush int8(65)\nprint\npop\n}\n"), "AAA");
+	ASSERT_EQ(Output("push int16(0)\nrepeat 4 {\nrepeat 5 { push int16(1) }\nsum 5\nadd\n}\ndump\n"), "20\n");
+	ASSERT_EQ(Output("macro inc {\npush int32(1)\nadd\n}\npush int32(40)\ninc\ninc\nrepeat 3 { inc }\ndump\n"), "45\n");
+
+	// Blocks inside loops, exit and faults inside blocks
+	ASSERT_EQ(Output("push int8(3)\nloop:\nrepeat 2 { push int8(66)\nprint\npop }\npush int8(1)\nsub\ndup\njnz loop\n"),
+		"BBBBBB");
+	ASSERT_EQ(Output("repeat 5 {\npush int8(67)\nprint\nexit\n}\ndump\n"), "C");
+	ASSERT_EQ(Output("push int8(1)\nrepeat 10 {\ndup\nadd\n}\n"), "Fatal Error: (64 + 64) > 127\n");
+	ASSERT_EQ(Output("repeat 2 { pop }\n"), "Fatal Error: Stack is empty\n");
+}
+
+TEST(Blocks, Errors)
+{
+	testing::internal::CaptureStdout();
+	ASSERT_EQ(Parse("repeat 0 { pop }\nrepeat 2 {\nl:\njmp l\n}\nmacro m { pop }\nmacro m { dump }\nm\n")
+		->GetInstructions().size(), 2u);
+	ASSERT_EQ(testing::internal::GetCapturedStdout(),
+		"[line 1] Error  at '0': Expected a positive count\n"
+		"[line 3] Error  at 'l:': Expected no label, jump nor routine in a block\n"
+		"[line 4] Error  at 'jmp': Expected no label, jump nor routine in a block\n"
+		"[line 7] Error  at 'm': Macro already defined\n");
+
+	testing::internal::CaptureStdout();
+	ASSERT_EQ(Parse("macro self {\nself\n}\nrepeat 2 {\npop\n")->GetInstructions().size(), 0u);
+	ASSERT_EQ(testing::internal::GetCapturedStdout(),
+		"[line 2] Error  at 'self': Undefined macro\n"
+		"[line 6] Error at end: Expected \"}\" after block\n");
+}
@@ -0,0 +1,144 @@
+#include "Helpers.hpp"
+#include "src/analysis/IntervalAnalysis.hpp"
+#include "src/ct/FrontEnd.hpp"
+#include "src/simd/Integers.hpp"
+#include <random>
+
+using namespace avm;
+using namespace avm::test;
+
+TEST(BulkPush, ParseIntegers)
+{
+	std::mt19937 l_random(3);
+
+	for (int l_round = 0; l_round < 200; l_round++)
+	{
+		Vector<int64_t> l_expected;
+		String l_text;
+
+		for (int l_i = std::uniform_int_distribution<int>(1, 40)(l_random); l_i > 0; l_i--)
+		{
+			// Every digit count, so that values straddle the eight digit chunks
+			int const l_digits = std::uniform_int_distribution<int>(1, 16)(l_random);
+			int64_t l_value = std::uniform_int_distribution<int64_t>(1, 9)(l_random);
+
+			for (int l_d = 1; l_d < l_digits; l_d++)
+			{
+				l_value = l_value * 10 + std::uniform_int_distribution<int64_t>(0, 9)(l_random);
+			}
+			if (std::bernoulli_distribution(0.5)(l_random))
+			{
+				l_value = -l_value;
+			}
+
+			l_expected.push_back(l_value);
+			l_text += fmt::format("{}{}{}", l_text.empty() ? "" : ",", String(l_round % 3, ' '), l_value);
+		}
+
+		Vector<int64_t> l_values;
+		ASSERT_EQ(simd::ParseIntegers(l_text, l_values), l_text.size()) << l_text;
+		ASSERT_EQ(l_values, l_expected) << l_text;
+	}
+
+	Vector<int64_t> l_values;
+	ASSERT_EQ(simd::ParseIntegers("007, -0", l_values), 7u);
+	ASSERT_EQ(l_values, (Vector<int64_t> { 7, 0 }));
+
+	// Saturated far outside the operand ranges
+	l_values.clear();
+	simd::ParseIntegers("123456789012345678901234567890", l_values);
+	ASSERT_GT(l_values[0], std::numeric_limits<int32_t>::max());
+
+	ASSERT_EQ(simd::ParseIntegers("1, 2,", l_values), 4u);
+	ASSERT_EQ(simd::ParseIntegers("1 2", l_values), 2u);
+	ASSERT_EQ(simd::ParseIntegers("1, x", l_values), 3u);
+	ASSERT_EQ(simd::ParseIntegers("1.5", l_values), 1u);
+	ASSERT_EQ(simd::ParseIntegers("--1", l_values), 0u);
+}
+
+TEST(BulkPush, Parse)
+{
+	auto l_program = Parse("push int16[1, -2, 300]\npush int8 [ 5 ]\n");
+	auto const &l_push = dynamic_cast<ast::InstructionWithValues const &>(At(*l_program, 0));
+
+	ASSERT_EQ(l_push.GetType(), ast::Instruction::Type::PUSH_ARRAY);
+	ASSERT_EQ(l_push.GetOperandType(), eOperandType::INT16);
+	ASSERT_EQ(l_push.GetValues(), (Vector<int64_t> { 1, -2, 300 }));
+	ASSERT_EQ(dynamic_cast<ast::InstructionWithValues const &>(At(*l_program, 1)).GetValues(), Vector<int64_t> { 5 });
+
+	testing::internal::CaptureStdout();
+	ASSERT_EQ(Parse("push int8[1, 200]\npush float[1]\npush int32[]\nassert int32[1]\n"
+		"push int32[99999999999999999999999]\npush int32[-10000000000]\n")->GetInstructions().size(), 0u);
+	ASSERT_EQ(testing::internal::GetCapturedStdout(),
+		"[line 1] Error  at '[': Value out of range: 200\n"
+		"[line 2] Error  at 'float': Expected an integer type\n"
+		"[line 3] Error  at '[': Expected a number\n"
+		"[line 4] Error  at 'assert': Expected a number\n"
+		"[line 5] Error  at '[': Value out of range\n"
+		"[line 6] Error  at '[': Value out of range\n");
+
+	Lexer l_lexer;
+	testing::internal::CaptureStdout();
+	l_lexer.Run("push int32[1, 2\npush int32[1; 2]\n");
+	ASSERT_TRUE(l_lexer.HadError());
+	ASSERT_EQ(testing::internal::GetCapturedStdout(),
+		"[line 1] Error : Expected \"]\" after values\n"
+		"[line 2] Error : Expected integers separated by \",\"\n");
+}
+
+TEST(BulkPush, SameAsSinglePushes)
+{
+	std::mt19937 l_random(11);
+	String l_bulk = "push int32[";
+	String l_single;
+
+	for (int l_i = 0; l_i < 500; l_i++)
+	{
+		int32_t const l_value = std::uniform_int_distribution<int32_t>()(l_random);
+
+		l_bulk += fmt::format("{}{}", l_i ? ", " : "", l_value);
+		l_single += fmt::format("push int32({})\n", l_value);
+	}
+
+	String const l_tail = "push int8(7)\nswap\ndump\nmax 300\ndump\n";
+	ASSERT_EQ(Output(l_bulk + "]\n" + l_tail), Output(l_single + l_tail));
+}
+
+TEST(BulkPush, LargeDataset)
+{
+	String l_source = "push int32[";
+
+	for (int l_i = 0; l_i < 1000000; l_i++)
+	{
+		l_source += l_i ? ", " : "";
+		l_source += std::to_string(l_i % 1000 - 500);
+	}
+	ASSERT_EQ(Output(l_source + "]\nsum\ndump\n"), "-500000\n");
+}
+
+TEST(BulkPush, Analysis)
+{
+	auto l_program = Parse("push int8[100, 27, 1]\nadd\nadd\n");
+	analysis::IntervalAnalysis l_analysis;
+
+	l_analysis.Run(*l_program);
+	ASSERT_EQ(l_analysis.GetVerdict(At(*l_program, 1)), analysis::Verdict::SAFE);
+	ASSERT_EQ(l_analysis.GetVerdict(At(*l_program, 2)), analysis::Verdict::FAULT);
+}
+
+TEST(BulkPush, CompileTime)
+{
+	constexpr auto l_image = AVM_CT_COMPILE("push int16[ -3, 1000 ,7]\nsum\ndump\n");
+	static_assert(l_image[0].m_type == ast::Instruction::Type::PUSH_ARRAY);
+
+	auto l_program = ct::Load(l_image);
+	auto const &l_push = dynamic_cast<ast::InstructionWithValues const &>(At(*l_program, 0));
+
+	ASSERT_EQ(l_push.GetOperandType(), eOperandType::INT16);
+	ASSERT_EQ(l_push.GetValues(), (Vector<int64_t> { -3, 1000, 7 }));
+	ASSERT_THROW(ct::Count("push int8[1, 128]"), ct::CompileError);
+	ASSERT_THROW(ct::Count("push double[1]"), ct::CompileError);
+	ASSERT_THROW(ct::Count("push int8[1.5]"), ct::CompileError);
+	ASSERT_THROW(ct::Count("push int8[1, 2"), ct::CompileError);
+	ASSERT_THROW(ct::Count("assert int8[1]"), ct::CompileError);
+}
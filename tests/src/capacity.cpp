@@ -0,0 +1,116 @@
+#include "Helpers.hpp"
+#include "src/OperandStack.hpp"
+#include "src/analysis/IntervalAnalysis.hpp"
+
+using namespace avm;
+using namespace avm::test;
+using analysis::IntervalAnalysis;
+
+static String const s_three = "push int8(1)\npush int8(2)\npush int8(3)\ndump\n";
+
+TEST(Capacity, Pragma)
+{
+	ASSERT_EQ(Parse(";@stack 10000000\npush int8(1)\n")->GetStackCapacity(), Optional<size_t>(10000000));
+	ASSERT_EQ(Parse("push int8(1) ;@stack 5\n")->GetStackCapacity(), Optional<size_t>(5));
+	ASSERT_FALSE(Parse("; @stack 5\npush int8(1)\n")->GetStackCapacity());
+
+	testing::internal::CaptureStdout();
+	ASSERT_FALSE(Parse(";@stack\n;@stack 0\n;@stack 3 4\n;@stack 1234567890123456789\n")->GetStackCapacity());
+	ASSERT_EQ(testing::internal::GetCapturedStdout(),
+		"[line 1] Error : Expected a positive stack capacity\n"
+		"[line 2] Error : Expected a positive stack capacity\n"
+		"[line 3] Error : Expected a positive stack capacity\n"
+		"[line 4] Error : Expected a positive stack capacity\n");
+}
+
+TEST(Capacity, OtherAnnotationsAreComments)
+{
+	testing::internal::CaptureStdout();
+	ASSERT_FALSE(Parse(";@stak 2\n;@stacks 2\n;@\npush int8(1)\n")->GetStackCapacity());
+	ASSERT_EQ(testing::internal::GetCapturedStdout(), "");
+
+	ASSERT_EQ(Output("push int32(1) ;@author me\ndump\n"), "1\n");
+}
+
+TEST(Capacity, Programs)
+{
+	ASSERT_EQ(Output(";@stack 3\n" + s_three), "3\n2\n1\n");
+	ASSERT_EQ(Output(";@stack 2\n" + s_three), "Fatal Error: Stack overflow: capacity of 2 reached\n");
+	ASSERT_EQ(Output(";@stack 2\npush int8[1, 2, 3]\n"), "Fatal Error: Stack overflow: capacity of 2 reached\n");
+	ASSERT_EQ(Output(";@stack 2\npush int8(1)\ndup\nover\n"), "Fatal Error: Stack overflow: capacity of 2 reached\n");
+
+	// The capacity set by the caller takes the place of the pragma
+	auto const l_limited = [] (String const &p_source, size_t p_capacity)
+	{
+		Interpreter l_interpreter;
+
+		return Capture([&] {
+			l_interpreter.SetStackCapacity(p_capacity);
+			l_interpreter.Run(*Parse(p_source));
+		});
+	};
+
+	ASSERT_EQ(l_limited(";@stack 2\n" + s_three, 3), "3\n2\n1\n");
+	ASSERT_EQ(l_limited(s_three, 2), "Fatal Error: Stack overflow: capacity of 2 reached\n");
+	ASSERT_EQ(Output(";@stack 1073741825\n" + s_three), "Fatal Error: Stack capacity above 1073741824 values\n");
+}
+
+TEST(Capacity, Stack)
+{
+	OperandStack l_stack;
+	OperandStack::Payload l_payload;
+
+	l_payload.m_integer = 7;
+	l_stack.Reserve(1000);
+	ASSERT_FALSE(l_stack.GetCapacity());
+	for (size_t l_i = 0; l_i < 2000; l_i++)
+	{
+		l_stack.Push(eOperandType::INT16, l_payload);
+	}
+
+	// A capacity below the values already there is refused
+	ASSERT_THROW(l_stack.SetCapacity(1999), StackOverflowError);
+	l_stack.SetCapacity(2001);
+	l_stack.Push(eOperandType::INT16, l_payload);
+	ASSERT_THROW(l_stack.Push(eOperandType::INT16, l_payload), StackOverflowError);
+	ASSERT_EQ(l_stack.Size(), 2001u);
+
+	l_stack.Drop();
+	l_stack.Dup();
+	ASSERT_THROW(l_stack.Dup(), StackOverflowError);
+	ASSERT_THROW(l_stack.Reserve(OperandStack::s_maxCapacity + 1), StackOverflowError);
+}
+
+TEST(Capacity, MaxDepth)
+{
+	IntervalAnalysis l_analysis;
+
+	auto l_program = Parse("push int8(1)\ndup\ndup\nadd\npush int32[1, 2, 3]\npop\nsort 2\n");
+
+	l_analysis.Run(*l_program);
+	ASSERT_EQ(l_analysis.GetMaxDepth(), Optional<size_t>(5));
+
+	// Up to an exit or a fault, the rest does not run
+	auto l_exit = Parse("push int8(1)\nexit\npush int8[1, 2, 3]\n");
+
+	l_analysis.Run(*l_exit);
+	ASSERT_EQ(l_analysis.GetMaxDepth(), Optional<size_t>(1));
+
+	auto l_fault = Parse("push int8(100)\npush int8(100)\nadd\npush int8[1, 2, 3]\n");
+
+	l_analysis.Run(*l_fault);
+	ASSERT_EQ(l_analysis.GetMaxDepth(), Optional<size_t>(2));
+
+	// Loops, calls and unknown files leave it open
+	for (char const *l_source : {
+		"push int8(1)\nloop:\ndup\njmp loop\n",
+		"def f\npush int8(1)\nend\ncall f\n",
+		"load int8 \"values.bin\"\n",
+		"repeat 3 { push int8(1) }\n" })
+	{
+		auto l_open = Parse(l_source);
+
+		l_analysis.Run(*l_open);
+		ASSERT_FALSE(l_analysis.GetMaxDepth()) << l_source;
+	}
+}
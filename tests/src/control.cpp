@@ -0,0 +1,143 @@
+#include "Helpers.hpp"
+#include "src/analysis/IntervalAnalysis.hpp"
+#include "src/opt/Optimizer.hpp"
+#include "src/ct/FrontEnd.hpp"
+
+using namespace avm;
+using namespace avm::test;
+using analysis::IntervalAnalysis;
+using analysis::Verdict;
+
+// Sum of 1 to 10, r0 counts down and r1 accumulates
+static constexpr char const s_sum[] =
+	"push int32(10)\nstore r0\npush int32(0)\nstore r1\n"
+	"loop:\n"
+	"load r1\nload r0\nadd\nstore r1\n"
+	"load r0\npush int32(1)\nsub\ndup\nstore r0\n"
+	"jnz loop\n"
+	"load r1\ndump\n";
+
+TEST(Control, Parse)
+{
+	auto l_program = Parse("top:\njmp top\njz end\njnz top\nend:\n");
+
+	ASSERT_EQ(l_program->GetInstructions().size(), 5u);
+	ASSERT_EQ(At(*l_program, 0).GetType(), ast::Instruction::Type::LABEL);
+	ASSERT_EQ(At(*l_program, 1).GetType(), ast::Instruction::Type::JMP);
+	ASSERT_EQ(At(*l_program, 2).GetType(), ast::Instruction::Type::JZ);
+	ASSERT_EQ(At(*l_program, 3).GetType(), ast::Instruction::Type::JNZ);
+	ASSERT_EQ(dynamic_cast<ast::InstructionWithLabel const &>(At(*l_program, 2)).GetLabel(), "end");
+
+	// Any name goes after a jump, keywords included
+	ASSERT_EQ(Parse("push:\njmp push\n")->GetInstructions().size(), 2u);
+
+	testing::internal::CaptureStdout();
+	ASSERT_EQ(Parse("a:\na:\njmp b\njz\n")->GetInstructions().size(), 1u);
+	ASSERT_EQ(testing::internal::GetCapturedStdout(),
+		"[line 2] Error  at 'a:': Label already defined\n"
+		"[line 5] Error  at '\n': Expected a label\n"
+		"[line 3] Error  at 'b': Undefined label\n");
+}
+
+TEST(Control, Loops)
+{
+	ASSERT_EQ(Output(s_sum), "55\n");
+
+	// Forward jump over code, exit out of a loop
+	ASSERT_EQ(Output("push int8(1)\njmp skip\npush int8(2)\nskip:\ndump\n"), "1\n");
+	ASSERT_EQ(Output("top:\npush int8(3)\nexit\njmp top\n"), "");
+	ASSERT_EQ(Output("push int8(0)\njz zero\npush int8(1)\nzero:\ndump\n"), "");
+	ASSERT_EQ(Output("push float(0.5)\njz zero\npush int8(1)\nzero:\ndump\n"), "1\n");
+
+	// Faults inside a loop stop it like anywhere else
+	ASSERT_EQ(Output("push int8(1)\nloop:\ndup\nadd\njmp loop\n"), "Fatal Error: (64 + 64) > 127\n");
+	ASSERT_EQ(Output("jz end\nend:\n"), "Fatal Error: Stack is empty\n");
+}
+
+TEST(Control, StraightLineProgramsRunUnchanged)
+{
+	char const *l_sources[] = {
+		"push int8(100)\npush int8(27)\nadd\ndump\nexit\npush int8(1)\ndump\n",
+		"push int8(100)\npush int8(100)\nadd\ndump\n",
+		"push int32(1)\npop\npop\n",
+		"push int8(72)\nprint\npush int16(2)\nassert int16(2)\nassert int8(2)\n",
+	};
+
+	for (char const *l_source : l_sources)
+	{
+		auto l_program = Parse(l_source);
+		Interpreter l_interpreter;
+
+		testing::internal::CaptureStdout();
+		try
+		{
+			for (auto const &l_instruction : l_program->GetInstructions())
+			{
+				if (l_interpreter.Evaluate(*l_instruction))
+				{
+					break;
+				}
+			}
+		}
+		catch (std::exception const &l_e)
+		{
+			fmt::print("Fatal Error: {}\n", l_e.what());
+		}
+
+		String const l_expected = testing::internal::GetCapturedStdout();
+
+		ASSERT_EQ(Execute(*l_program), l_expected) << l_source;
+	}
+}
+
+TEST(Control, Comparisons)
+{
+	ASSERT_EQ(Output("push int8(1)\npush int8(2)\nlt\ndump\n"), "1\n");
+	ASSERT_EQ(Output("push int8(1)\npush int8(2)\nge\ndump\n"), "0\n");
+	ASSERT_EQ(Output("push int32(2)\npush double(2.0)\neq\ndump\n"), "1\n");
+	ASSERT_EQ(Output("push int16(3)\npush float(2.5)\ngt\ndump\n"), "1\n");
+	ASSERT_EQ(Output("push int32(-5)\npush int32(-5)\nle\npush int32(-5)\npush int32(4)\nne\ndump\n"), "1\n1\n");
+
+	// The result is an int8 that the other instructions take as usual
+	ASSERT_EQ(Output("push int32(7)\npush int32(7)\neq\nassert int8(1)\npush int8(64)\nadd\nprint\n"), "A");
+	ASSERT_EQ(Output("push int8(1)\neq\n"), "Fatal Error: Stack is empty\n");
+}
+
+TEST(Control, Analysis)
+{
+	// Only the straight-line code before the first label is proven
+	auto l_before = Parse("push int8(100)\npush int8(100)\nadd\nloop:\n");
+	auto l_after = Parse("loop:\npush int8(100)\npush int8(100)\nadd\n");
+	IntervalAnalysis l_analysis;
+
+	l_analysis.Run(*l_before);
+	ASSERT_TRUE(l_analysis.GetFault());
+	l_analysis.Run(*l_after);
+	ASSERT_FALSE(l_analysis.GetFault());
+	ASSERT_EQ(l_analysis.GetVerdict(At(*l_after, 3)), Verdict::UNKNOWN);
+
+	// A comparison gives 0 or 1, which an int8 addition cannot overflow
+	auto l_compare = Parse("push int32(1)\npush int32(2)\nlt\npush int8(126)\nadd\n");
+
+	l_analysis.Run(*l_compare);
+	ASSERT_EQ(l_analysis.GetVerdict(At(*l_compare, 4)), Verdict::SAFE);
+}
+
+TEST(Control, ExitTruncationKeepsLabels)
+{
+	auto l_program = Parse("jmp start\nexit\npush int8(1)\nstart:\npush int8(2)\ndump\nexit\ndump\n");
+
+	ASSERT_EQ(opt::ExitTruncation().Run(*l_program), 2u);
+	ASSERT_EQ(l_program->GetInstructions().size(), 6u);
+	ASSERT_EQ(Execute(*l_program), "2\n");
+}
+
+TEST(Control, CompileTime)
+{
+	constexpr auto l_image = AVM_CT_COMPILE(s_sum);
+
+	ASSERT_EQ(Execute(*ct::Load(l_image)), "55\n");
+	ASSERT_THROW(ct::Compile<2>("a:\na:\n"), ct::CompileError);
+	ASSERT_THROW(ct::Compile<1>("jmp a\n"), ct::CompileError);
+	ASSERT_THROW(ct::Count("jz\n"), ct::CompileError);
+}
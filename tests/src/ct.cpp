@@ -0,0 +1,77 @@
+#include "Helpers.hpp"
+#include "src/ct/FrontEnd.hpp"
+
+using namespace avm;
+using namespace avm::test;
+using Type = ast::Instruction::Type;
+
+#define SOURCE \
+	"; Embedded program\n" \
+	"push int32(42)\n" \
+	"push int32(33)\n" \
+	"\n" \
+	"add ; 75\n" \
+	"push float(44.55)\n" \
+	"mul\n" \
+	"push double ( -42.42 )\n" \
+	"dump\n" \
+	"assert double(-42.42)\n" \
+	"push int8(72)\n" \
+	"print\n" \
+	"exit\n"
+
+constexpr auto s_image = AVM_CT_COMPILE(SOURCE);
+
+static_assert(s_image.GetSize() == 11);
+static_assert(s_image[0].m_type == Type::PUSH && s_image[0].m_line == 2);
+static_assert(s_image[2].m_type == Type::ADD && s_image[2].m_line == 5);
+static_assert(s_image[5].m_operandType == eOperandType::DOUBLE && s_image[5].m_literal == "-42.42");
+static_assert(ct::Count("\n\n; nothing\n") == 0);
+static_assert(ct::Compile<4>("pop\npop\n").GetSize() == 2);
+static_assert(ct::Compile<2>("sum 3\nmax\n")[0].m_argument == 3 && ct::Compile<2>("sum 3\nmax\n")[1].m_argument == 0);
+
+TEST(CompileTime, LoadedImageRunsLikeParsedProgram)
+{
+	auto l_program = ct::Load(s_image);
+	auto l_expected = Parse(SOURCE);
+
+	ASSERT_EQ(l_program->GetInstructions().size(), l_expected->GetInstructions().size());
+	ASSERT_EQ(Execute(*l_program), Execute(*l_expected));
+}
+
+TEST(CompileTime, MalformedProgramsAreRejected)
+{
+	ASSERT_THROW(ct::Count("push int32(42"), ct::CompileError);
+	ASSERT_THROW(ct::Count("push int64(42)"), ct::CompileError);
+	ASSERT_THROW(ct::Count("push int8()"), ct::CompileError);
+	ASSERT_THROW(ct::Count("pop pop"), ct::CompileError);
+	ASSERT_THROW(ct::Count("jump"), ct::CompileError);
+	ASSERT_THROW(ct::Count("int8(1)"), ct::CompileError);
+	ASSERT_THROW(ct::Count("pop\n#"), ct::CompileError);
+	ASSERT_THROW(ct::Count("sum 0"), ct::CompileError);
+	ASSERT_THROW(ct::Count("mean -2"), ct::CompileError);
+	ASSERT_THROW(ct::Compile<1>("pop\npop\n"), ct::CompileError);
+
+	try
+	{
+		ct::Count("pop\n\ndump\npush int8(128)\n");
+		FAIL();
+	}
+	catch (ct::CompileError const &l_e)
+	{
+		ASSERT_EQ(l_e.GetLine(), 4);
+		ASSERT_STREQ(l_e.what(), "[line 4] Error: Value out of range");
+	}
+}
+
+TEST(CompileTime, ValuesAreCheckedAgainstTheirType)
+{
+	ASSERT_EQ(ct::Count("push int8(-128)\npush int8(127)\n"), 2U);
+	ASSERT_THROW(ct::Count("push int8(-129)"), ct::CompileError);
+	ASSERT_EQ(ct::Count("push int16(32767)\npush int32(-2147483648)\n"), 2U);
+	ASSERT_THROW(ct::Count("push int16(32768)"), ct::CompileError);
+	ASSERT_THROW(ct::Count("push int32(99999999999999999999)"), ct::CompileError);
+	ASSERT_EQ(ct::Count("push float(340282346638528859811704183484516925440.0)"), 1U);
+	ASSERT_THROW(ct::Count("push float(999999999999999999999999999999999999999999.5)"), ct::CompileError);
+	ASSERT_EQ(ct::Count("push double(999999999999999999999999999999999999999999.5)"), 1U);
+}
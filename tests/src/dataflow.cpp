@@ -0,0 +1,123 @@
+#include "Helpers.hpp"
+#include <atomic>
+#include "src/dataflow/DataflowInterpreter.hpp"
+#include "src/dataflow/WorkStealingPool.hpp"
+
+using namespace avm;
+using namespace avm::test;
+
+static String Chain(char const *p_type, int p_length)
+{
+	String l_source = fmt::format("push {}(10)\n", p_type);
+
+	for (int l_i = 0; l_i < p_length; l_i++)
+	{
+		l_source += fmt::format("push {}({})\n{}\n", p_type, l_i % 5 + 1, l_i % 3 ? "add" : "sub");
+	}
+	return l_source;
+}
+
+TEST(Dataflow, SameOutputAsInterpreter)
+{
+	String const l_source =
+		Chain("int32", 200) + "dump\n" +
+		Chain("double", 200) + Chain("int16", 100) + "add\n" +
+		"push int8(2)\npush int8(3)\nmul\npop\n" +
+		"mul\ndump\nexit\npush int8(0)\n";
+	auto l_program = Parse(l_source);
+	dataflow::DataflowInterpreter l_dataflow(4, 0, 8);
+
+	auto l_result = Observe([&] { l_dataflow.Run(*l_program); });
+
+	ASSERT_EQ(l_result, Interpret(l_source));
+	ASSERT_EQ(l_result.second, "");
+	ASSERT_GT(l_dataflow.GetTaskCount(), 1U);
+	ASSERT_TRUE(l_dataflow.HasExited());
+}
+
+TEST(Dataflow, FirstFaultInProgramOrder)
+{
+	String const l_source =
+		Chain("int32", 100) + "dump\n" +
+		"push int8(127)\npush int8(1)\nadd\n" +
+		Chain("int32", 100) + "push int32(0)\ndiv\ndump\n";
+	auto l_program = Parse(l_source);
+	dataflow::DataflowInterpreter l_dataflow(4, 0, 4);
+
+	auto l_result = Observe([&] { l_dataflow.Run(*l_program); });
+
+	ASSERT_EQ(l_result, Interpret(l_source));
+	ASSERT_NE(l_result.second, "");
+}
+
+TEST(Dataflow, ObservedValues)
+{
+	// Values read by the replay are kept after their consumer runs
+	String const l_source =
+		"push int8(72)\nprint\npush int8(1)\nassert int8(1)\nadd\n" +
+		Chain("int32", 50) + "dump\n" + Chain("int16", 50) + "add\nadd\ndump\n";
+	auto l_program = Parse(l_source);
+	dataflow::Graph l_graph;
+
+	l_graph.Build(*l_program);
+	ASSERT_TRUE(l_graph.GetNodes()[0].m_observed);
+	ASSERT_TRUE(l_graph.GetNodes()[1].m_observed);
+	ASSERT_TRUE(l_graph.GetNodes()[2].m_observed);
+	ASSERT_FALSE(l_graph.GetNodes()[3].m_observed);
+	ASSERT_TRUE(l_graph.GetNodes().back().m_observed);
+
+	dataflow::DataflowInterpreter l_dataflow(4, 0, 4);
+
+	ASSERT_EQ(Observe([&] { l_dataflow.Run(*l_program); }), Interpret(l_source));
+}
+
+TEST(Dataflow, StackErrors)
+{
+	String const l_source = Chain("int32", 20) + "add\n";
+	auto l_program = Parse(l_source);
+	dataflow::DataflowInterpreter l_dataflow(2, 0, 4);
+
+	ASSERT_THROW(l_dataflow.Run(*l_program), EmptyStackError);
+}
+
+TEST(Dataflow, SmallProgramsRunSequentially)
+{
+	String const l_source = Chain("float", 20) + "dump\n";
+	auto l_program = Parse(l_source);
+	dataflow::DataflowInterpreter l_dataflow(4);
+
+	auto l_result = Observe([&] { l_dataflow.Run(*l_program); });
+
+	ASSERT_EQ(l_result, Interpret(l_source));
+	ASSERT_EQ(l_dataflow.GetTaskCount(), 0U);
+}
+
+TEST(WorkStealingPool, NestedTasks)
+{
+	dataflow::WorkStealingPool l_pool(4);
+	std::atomic<int> l_count(0);
+
+	for (int l_i = 0; l_i < 100; l_i++)
+	{
+		l_pool.Submit([&] {
+			for (int l_j = 0; l_j < 10; l_j++)
+			{
+				l_pool.Submit([&] { l_count++; });
+			}
+			l_count++;
+		});
+	}
+	l_pool.Wait();
+
+	ASSERT_EQ(l_count.load(), 1100);
+	ASSERT_EQ(l_pool.GetThreadCount(), 4U);
+}
+
+TEST(WorkStealingPool, Exceptions)
+{
+	dataflow::WorkStealingPool l_pool(2);
+
+	l_pool.Submit([] { throw std::runtime_error("task"); });
+	ASSERT_THROW(l_pool.Wait(), std::runtime_error);
+	ASSERT_NO_THROW(l_pool.Wait());
+}
@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+#include "avm.hpp"
+#include "src/Format.hpp"
+#include "src/Lexer.hpp"
+#include "src/Parser.hpp"
+#include "src/Interpreter.hpp"
+#include "src/OperandStack.hpp"
+#include <cstring>
+#include <random>
+
+using namespace avm;
+
+template <typename T>
+static T FromBits(uint64_t p_bits)
+{
+	T l_value;
+
+	std::memcpy(&l_value, &p_bits, sizeof(T));
+	return l_value;
+}
+
+static String Integer(int64_t p_value)
+{
+	char l_buffer[s_formatSize];
+
+	return String(l_buffer, FormatInteger(p_value, l_buffer));
+}
+
+static String Float(float p_value)
+{
+	char l_buffer[s_formatSize];
+
+	return String(l_buffer, FormatFloat(p_value, l_buffer));
+}
+
+static String Double(double p_value)
+{
+	char l_buffer[s_formatSize];
+
+	return String(l_buffer, FormatDouble(p_value, l_buffer));
+}
+
+TEST(Format, Integers)
+{
+	for (int64_t l_value = std::numeric_limits<int16_t>::min(); l_value <= std::numeric_limits<int16_t>::max(); l_value++)
+	{
+		ASSERT_EQ(Integer(l_value), fmt::format("{}", l_value));
+	}
+
+	std::mt19937_64 l_random(7);
+
+	for (size_t l_i = 0; l_i < 200000; l_i++)
+	{
+		int64_t const l_value = static_cast<int64_t>(l_random()) >> (l_random() % 64);
+
+		ASSERT_EQ(Integer(l_value), fmt::format("{}", l_value));
+	}
+	for (int64_t l_value : { std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max(),
+		int64_t(std::numeric_limits<int32_t>::min()), int64_t(std::numeric_limits<int32_t>::max()), int64_t(1000000000) })
+	{
+		ASSERT_EQ(Integer(l_value), fmt::format("{}", l_value));
+	}
+}
+
+TEST(Format, Floats)
+{
+	std::mt19937_64 l_random(7);
+
+	// Every exponent, then values near the hundredths, ties among them
+	for (size_t l_i = 0; l_i < 500000; l_i++)
+	{
+		float const l_value = FromBits<float>(l_random() & 0xffffffff);
+
+		if (std::isfinite(l_value))
+		{
+			ASSERT_EQ(Float(l_value), fmt::format("{:.2f}", l_value)) << l_value;
+		}
+	}
+	for (int l_i = -100000; l_i <= 100000; l_i++)
+	{
+		for (float const l_value : { l_i / 8.0f, l_i / 200.0f, l_i * 0.01f, std::nextafter(l_i * 0.005f, 1e9f) })
+		{
+			ASSERT_EQ(Float(l_value), fmt::format("{:.2f}", l_value)) << l_value;
+		}
+	}
+	for (float const l_value : { 0.0f, -0.0f, -0.001f, 0.125f, 0.375f, std::numeric_limits<float>::max(),
+		std::numeric_limits<float>::lowest(), std::numeric_limits<float>::denorm_min(), 1e10f, 5e18f })
+	{
+		ASSERT_EQ(Float(l_value), fmt::format("{:.2f}", l_value)) << l_value;
+	}
+}
+
+TEST(Format, Doubles)
+{
+	std::mt19937_64 l_random(7);
+
+	for (size_t l_i = 0; l_i < 500000; l_i++)
+	{
+		double const l_value = FromBits<double>(l_random());
+
+		if (std::isfinite(l_value))
+		{
+			ASSERT_EQ(Double(l_value), fmt::format("{:.2}", l_value)) << l_value;
+		}
+	}
+
+	// Around the powers of ten, where the digits and the form change
+	for (int l_exponent = -8; l_exponent <= 17; l_exponent++)
+	{
+		double const l_power = std::pow(10.0, l_exponent);
+
+		for (int l_i = 1; l_i < 1000; l_i++)
+		{
+			for (double const l_value : { l_power * l_i / 100.0, l_power * (l_i + 0.5) / 100.0, -l_power * l_i / 1000.0,
+				std::nextafter(l_power * (l_i + 0.5) / 100.0, 0.0), l_power * (1.0 - l_i * 1e-6) })
+			{
+				ASSERT_EQ(Double(l_value), fmt::format("{:.2}", l_value)) << l_value;
+			}
+		}
+	}
+	for (double const l_value : { 0.0, -0.0, 1.25, 12.5, 13.5, 0.125, 0.0001, 9.96e-5, 99.5, 1e100, 1.5e-300,
+		std::numeric_limits<double>::max(), std::numeric_limits<double>::denorm_min() })
+	{
+		ASSERT_EQ(Double(l_value), fmt::format("{:.2}", l_value)) << l_value;
+	}
+}
+
+// The stack writes what the operands of its values print
+TEST(Format, Stack)
+{
+	OperandStack l_stack;
+	std::mt19937_64 l_random(7);
+
+	for (size_t l_i = 0; l_i < 20000; l_i++)
+	{
+		eOperandType const l_type = static_cast<eOperandType>(l_random() % 5);
+		double const l_value = std::ldexp(static_cast<double>(l_random() % 2000000) - 1000000.0, static_cast<int>(l_random() % 40) - 30);
+
+		l_stack.Push(UniquePtr<IOperand const>(OperandFactory::Get().CreateOperand(l_type,
+			l_type < eOperandType::FLOAT ? std::fmod(std::trunc(l_value), 100.0) : l_value)));
+	}
+	for (size_t l_i = 0; l_i < l_stack.Size(); l_i++)
+	{
+		char l_buffer[s_formatSize];
+
+		ASSERT_EQ(String(l_buffer, l_stack.Format(l_i, l_buffer)), l_stack.At(l_i).toString()) << l_i;
+	}
+}
@@ -0,0 +1,126 @@
+#include "Helpers.hpp"
+#include "src/analysis/IntervalAnalysis.hpp"
+
+using namespace avm;
+using namespace avm::test;
+using analysis::Interval;
+using analysis::IntervalAnalysis;
+using analysis::Verdict;
+
+TEST(IntervalAnalysis, SafeArithmetic)
+{
+	auto l_program = Parse(
+		"push int8(10)\n"
+		"push int8(20)\n"
+		"add\n"
+		"push int32(3)\n"
+		"mul\n"
+		"assert int32(90)\n"
+		"exit\n");
+
+	IntervalAnalysis l_analysis;
+	l_analysis.Run(*l_program);
+
+	ASSERT_FALSE(l_analysis.GetFault());
+	ASSERT_EQ(l_analysis.GetVerdict(At(*l_program, 2)), Verdict::SAFE);
+	ASSERT_EQ(l_analysis.GetVerdict(At(*l_program, 4)), Verdict::SAFE);
+	ASSERT_EQ(l_analysis.GetProvenSafe().size(), 2U);
+
+	Interpreter l_interpreter;
+	l_interpreter.SetUncheckedSites(l_analysis.GetProvenSafe());
+
+	auto l_instruction = l_program->GetNextInstruction();
+	while (l_instruction)
+	{
+		l_interpreter.Evaluate(*l_instruction);
+		l_instruction = l_program->GetNextInstruction();
+	}
+	ASSERT_TRUE(l_interpreter.HasExited());
+}
+
+TEST(IntervalAnalysis, OverflowReportedWithLine)
+{
+	auto l_program = Parse(
+		"push int8(127)\n"
+		"push int8(127)\n"
+		"add\n"
+		"dump\n");
+
+	IntervalAnalysis l_analysis;
+	l_analysis.Run(*l_program);
+
+	ASSERT_TRUE(l_analysis.GetFault());
+	ASSERT_EQ(l_analysis.GetFault()->m_line, 3);
+	ASSERT_EQ(l_analysis.GetFault()->m_message, "(127 + 127) > 127");
+	ASSERT_EQ(l_analysis.GetVerdict(At(*l_program, 2)), Verdict::FAULT);
+}
+
+TEST(IntervalAnalysis, DivisionByZero)
+{
+	auto l_program = Parse(
+		"push int32(1)\n"
+		"push int32(0)\n"
+		"div\n");
+
+	IntervalAnalysis l_analysis;
+	l_analysis.Run(*l_program);
+
+	ASSERT_TRUE(l_analysis.GetFault());
+	ASSERT_EQ(l_analysis.GetFault()->m_line, 3);
+	ASSERT_EQ(l_analysis.GetFault()->m_message, "Division by zero");
+}
+
+TEST(IntervalAnalysis, EmptyStack)
+{
+	auto l_program = Parse(
+		"push int32(1)\n"
+		"pop\n"
+		"pop\n");
+
+	IntervalAnalysis l_analysis;
+	l_analysis.Run(*l_program);
+
+	ASSERT_TRUE(l_analysis.GetFault());
+	ASSERT_EQ(l_analysis.GetFault()->m_line, 3);
+}
+
+TEST(IntervalAnalysis, NothingAfterExit)
+{
+	auto l_program = Parse(
+		"exit\n"
+		"push int8(127)\n"
+		"push int8(127)\n"
+		"add\n");
+
+	IntervalAnalysis l_analysis;
+	l_analysis.Run(*l_program);
+
+	ASSERT_FALSE(l_analysis.GetFault());
+	ASSERT_EQ(l_analysis.GetVerdict(At(*l_program, 3)), Verdict::UNKNOWN);
+}
+
+TEST(IntervalAnalysis, Ranges)
+{
+	Interval l_result { eOperandType::INT8, 0, 0 };
+	String l_message;
+
+	ASSERT_EQ(IntervalAnalysis::Arithmetic(ast::Instruction::Type::ADD,
+		{ eOperandType::INT8, 0, 10 }, { eOperandType::INT8, 0, 10 }, l_result, l_message), Verdict::SAFE);
+	ASSERT_EQ(l_result.m_lo, 0);
+	ASSERT_EQ(l_result.m_hi, 20);
+
+	ASSERT_EQ(IntervalAnalysis::Arithmetic(ast::Instruction::Type::ADD,
+		{ eOperandType::INT8, 100, 120 }, { eOperandType::INT8, 10, 20 }, l_result, l_message), Verdict::UNKNOWN);
+	ASSERT_EQ(l_result.m_hi, 127);
+
+	ASSERT_EQ(IntervalAnalysis::Arithmetic(ast::Instruction::Type::MUL,
+		{ eOperandType::INT8, 100, 120 }, { eOperandType::INT8, 2, 3 }, l_result, l_message), Verdict::FAULT);
+
+	ASSERT_EQ(IntervalAnalysis::Arithmetic(ast::Instruction::Type::DIV,
+		{ eOperandType::INT16, 0, 1000 }, { eOperandType::INT16, -1, 1 }, l_result, l_message), Verdict::UNKNOWN);
+
+	ASSERT_EQ(IntervalAnalysis::Arithmetic(ast::Instruction::Type::MOD,
+		{ eOperandType::INT32, -50, 50 }, { eOperandType::INT32, 7, 7 }, l_result, l_message), Verdict::SAFE);
+	ASSERT_EQ(l_result.m_lo, -7);
+	ASSERT_EQ(l_result.m_hi, 7);
+}
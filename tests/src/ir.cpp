@@ -0,0 +1,97 @@
+#include "Helpers.hpp"
+#include "src/analysis/IntervalAnalysis.hpp"
+#include "src/ir/Builder.hpp"
+#include "src/ir/RegisterVM.hpp"
+
+using namespace avm;
+using namespace avm::test;
+using ir::Opcode;
+
+static Vector<Opcode> Opcodes(ir::Function const &p_function)
+{
+	Vector<Opcode> l_opcodes;
+
+	for (auto const &l_inst : p_function.m_code)
+	{
+		l_opcodes.push_back(l_inst.m_opcode);
+	}
+	return l_opcodes;
+}
+
+static void ExpectSameAsInterpreter(String const &p_source)
+{
+	auto l_program = Parse(p_source);
+	analysis::IntervalAnalysis l_analysis;
+	l_analysis.Run(*l_program);
+
+	ir::Function const l_function = ir::Builder().Run(*l_program, l_analysis.GetProvenSafe());
+	ir::RegisterVM l_vm;
+	Interpreter l_interpreter;
+
+	auto l_actual = Observe([&] { l_vm.Run(l_function); });
+	auto l_expected = Observe([&] { Evaluate(l_interpreter, *l_program); });
+
+	EXPECT_EQ(l_actual, l_expected) << p_source;
+	EXPECT_EQ(l_vm.HasExited(), l_interpreter.HasExited()) << p_source;
+}
+
+TEST(IR, Lowering)
+{
+	auto l_program = Parse(
+		"push int8(2)\n"
+		"push float(1.5)\n"
+		"mul\n"
+		"push int32(7)\n"
+		"dump\n"
+		"pop\n"
+		"assert float(3.00)\n"
+		"exit\n"
+		"dump\n");
+	ir::Function const l_function = ir::Builder().Run(*l_program);
+
+	ASSERT_EQ(Opcodes(l_function), Vector<Opcode>({
+		Opcode::CONST, Opcode::CONST, Opcode::MUL, Opcode::CONST,
+		Opcode::DUMP, Opcode::DROP, Opcode::ASSERT, Opcode::EXIT }));
+	ASSERT_EQ(l_function.m_types, Vector<eOperandType>({
+		eOperandType::INT8, eOperandType::FLOAT, eOperandType::FLOAT, eOperandType::INT32 }));
+	ASSERT_EQ(l_function.m_code[2].m_lhs, 0U);
+	ASSERT_EQ(l_function.m_code[2].m_rhs, 1U);
+	ASSERT_EQ(l_function.m_code[4].m_count, 2U);
+	ASSERT_EQ(l_function.m_operands, Vector<ir::Reg>({ 3, 2 }));
+	ASSERT_EQ(l_function.m_code[6].m_lhs, 2U);
+}
+
+TEST(IR, Print)
+{
+	auto l_program = Parse("push int8(2)\npush int16(3)\nadd\ndump\nprint\npop\nadd\n");
+	analysis::IntervalAnalysis l_analysis;
+	l_analysis.Run(*l_program);
+
+	ir::Function const l_function = ir::Builder().Run(*l_program, l_analysis.GetProvenSafe());
+
+	testing::internal::CaptureStdout();
+	l_function.Print();
+	ASSERT_EQ(testing::internal::GetCapturedStdout(),
+		"%0 = const int8(2)\n"
+		"%1 = const int16(3)\n"
+		"%2 = add int16 %0, %1 unchecked\n"
+		"dump %2\n"
+		"print %2\n"
+		"drop %2\n"
+		"underflow\n");
+}
+
+TEST(RegisterVM, SameAsInterpreter)
+{
+	ExpectSameAsInterpreter(
+		"push int32(42)\npush int32(33)\nadd\npush float(44.55)\nmul\n"
+		"push double(42.42)\npush int32(42)\ndump\npop\nassert double(42.42)\n"
+		"push int8(72)\nprint\nexit\n");
+	ExpectSameAsInterpreter("push int16(7)\npush int8(3)\nmod\npush double(2.5)\ndiv\ndump\n");
+	ExpectSameAsInterpreter("push int8(127)\npush int8(1)\ndump\nadd\ndump\n");
+	ExpectSameAsInterpreter("push int32(1)\npush int32(0)\ndiv\n");
+	ExpectSameAsInterpreter("push int8(300)\ndump\n");
+	ExpectSameAsInterpreter("push int32(1)\nassert int16(1)\n");
+	ExpectSameAsInterpreter("push int32(1)\nprint\n");
+	ExpectSameAsInterpreter("push int32(1)\ndump\npop\npop\ndump\n");
+}
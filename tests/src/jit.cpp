@@ -0,0 +1,79 @@
+#include "Helpers.hpp"
+#include "src/analysis/IntervalAnalysis.hpp"
+#include "src/ir/Builder.hpp"
+#include "src/jit/JitEngine.hpp"
+
+using namespace avm;
+using namespace avm::test;
+
+static void ExpectNativeSameAsInterpreter(String const &p_source, bool p_analyze = false)
+{
+	auto l_program = Parse(p_source);
+	analysis::IntervalAnalysis l_analysis;
+
+	if (p_analyze)
+	{
+		l_analysis.Run(*l_program);
+	}
+
+	jit::JitEngine l_jit(ir::Builder().Run(*l_program, l_analysis.GetProvenSafe()));
+
+	if (!jit::Compiler::IsHostSupported())
+	{
+		GTEST_SKIP();
+	}
+	ASSERT_TRUE(l_jit.IsNative()) << p_source;
+	EXPECT_EQ(Observe([&] { l_jit.Run(); }), Interpret(p_source)) << p_source;
+}
+
+TEST(Jit, Arithmetic)
+{
+	ExpectNativeSameAsInterpreter(
+		"push int32(42)\npush int32(33)\nadd\npush int16(-7)\nmul\npush int8(5)\nsub\n"
+		"push int32(6)\ndiv\npush int32(-4)\nmod\ndump\nassert int32(-3)\n"
+		"push int8(72)\nprint\npush int8(105)\nprint\nexit\n");
+	ExpectNativeSameAsInterpreter("push int8(7)\npush int16(-2)\ndiv\npush int32(3)\nmod\ndump\n", true);
+	ExpectNativeSameAsInterpreter("push int16(1)\npush int32(2)\npush int8(3)\ndump\npop\nadd\ndump\n");
+}
+
+TEST(Jit, Faults)
+{
+	ExpectNativeSameAsInterpreter("push int8(100)\npush int8(100)\ndump\nadd\ndump\n");
+	ExpectNativeSameAsInterpreter("push int8(100)\npush int32(100)\nadd\n");
+	ExpectNativeSameAsInterpreter("push int32(100)\npush int8(100)\nadd\ndump\n");
+	ExpectNativeSameAsInterpreter("push int16(-32768)\npush int16(1)\nsub\n");
+	ExpectNativeSameAsInterpreter("push int32(65536)\npush int32(65536)\nmul\n");
+	ExpectNativeSameAsInterpreter("push int32(-2147483648)\npush int32(-1)\ndiv\n");
+	ExpectNativeSameAsInterpreter("push int16(1)\npush int16(0)\ndiv\n");
+	ExpectNativeSameAsInterpreter("push int32(1)\npush int8(1)\ndiv\n");
+	ExpectNativeSameAsInterpreter("push int32(9)\npush int32(0)\nmod\ndump\n");
+	ExpectNativeSameAsInterpreter("push int32(1)\ndump\npush int8(300)\n");
+	ExpectNativeSameAsInterpreter("push int32(1)\nadd\n");
+	ExpectNativeSameAsInterpreter("push int32(1)\npop\npop\n");
+	ExpectNativeSameAsInterpreter("push int32(1)\nassert int32(2)\n");
+	ExpectNativeSameAsInterpreter("push int32(1)\nassert int16(1)\n");
+	ExpectNativeSameAsInterpreter("push int32(72)\nprint\n");
+}
+
+TEST(Jit, Reruns)
+{
+	auto l_program = Parse("push int32(2)\npush int32(3)\nmul\ndump\n");
+	jit::JitEngine l_jit(ir::Builder().Run(*l_program));
+
+	auto l_result = Observe([&] { l_jit.Run(); l_jit.Run(); });
+
+	ASSERT_EQ(l_result.first, "6\n6\n");
+	ASSERT_EQ(l_result.second, "");
+	ASSERT_FALSE(l_jit.HasExited());
+}
+
+TEST(Jit, Fallback)
+{
+	char const *const l_source = "push float(1.5)\npush int32(2)\nmul\ndump\nexit\n";
+	auto l_program = Parse(l_source);
+	jit::JitEngine l_jit(ir::Builder().Run(*l_program));
+
+	ASSERT_FALSE(l_jit.IsNative());
+	ASSERT_EQ(Observe([&] { l_jit.Run(); }), Interpret(l_source));
+	ASSERT_TRUE(l_jit.HasExited());
+}
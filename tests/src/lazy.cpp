@@ -0,0 +1,104 @@
+#include "Helpers.hpp"
+#include "src/LazyInterpreter.hpp"
+
+using namespace avm;
+using namespace avm::test;
+
+TEST(Lazy, SameOutputAsInterpreter)
+{
+	char const *const l_source =
+		"push int32(42)\n"
+		"push int32(33)\n"
+		"add\n"
+		"push float(44.55)\n"
+		"mul\n"
+		"push double(42.42)\n"
+		"push int32(42)\n"
+		"dump\n"
+		"pop\n"
+		"assert double(42.42)\n"
+		"push int8(72)\n"
+		"print\n"
+		"exit\n";
+	auto l_program = Parse(l_source);
+	auto l_expected = Parse(l_source);
+	Interpreter l_interpreter;
+	LazyInterpreter l_lazy;
+
+	ASSERT_EQ(Capture([&] { Evaluate(l_lazy, *l_program); }), Capture([&] { Evaluate(l_interpreter, *l_expected); }));
+	ASSERT_EQ(l_lazy.GetForcedCount(), 2U);
+	ASSERT_TRUE(l_lazy.HasExited());
+}
+
+TEST(Lazy, PoppedValuesAreNotComputed)
+{
+	auto l_program = Parse(
+		"push int8(127)\n"
+		"push int8(127)\n"
+		"add\n"
+		"push int32(1)\n"
+		"push int32(0)\n"
+		"div\n"
+		"pop\n"
+		"pop\n"
+		"exit\n");
+	LazyInterpreter l_lazy;
+
+	ASSERT_NO_THROW(Evaluate(l_lazy, *l_program));
+	ASSERT_EQ(l_lazy.GetForcedCount(), 0U);
+}
+
+TEST(Lazy, ForcedFaultsInProgramOrder)
+{
+	auto l_program = Parse(
+		"push int32(1)\n"
+		"push int32(0)\n"
+		"div\n"
+		"push int8(127)\n"
+		"push int8(127)\n"
+		"add\n"
+		"dump\n");
+	LazyInterpreter l_lazy;
+
+	for (int l_i = 0; l_i < 6; l_i++)
+	{
+		ASSERT_NO_THROW(l_lazy.Evaluate(*l_program->GetNextInstruction()));
+	}
+	ASSERT_THROW(l_lazy.Evaluate(*l_program->GetNextInstruction()), DivisionByZero);
+}
+
+TEST(Lazy, StackErrorsAreImmediate)
+{
+	auto l_program = Parse("push int32(1)\nadd\n");
+	LazyInterpreter l_lazy;
+
+	ASSERT_NO_THROW(l_lazy.Evaluate(*l_program->GetNextInstruction()));
+	ASSERT_THROW(l_lazy.Evaluate(*l_program->GetNextInstruction()), EmptyStackError);
+}
+
+TEST(Lazy, DeepExpressions)
+{
+	auto l_program = Parse("push int32(0)\npush int32(1)\nadd\nassert int32(200000)\n");
+	auto l_zero = l_program->GetNextInstruction();
+	auto l_one = l_program->GetNextInstruction();
+	auto l_add = l_program->GetNextInstruction();
+	auto l_assert = l_program->GetNextInstruction();
+	LazyInterpreter l_lazy;
+
+	l_lazy.Evaluate(*l_zero);
+	for (int l_i = 0; l_i < 200000; l_i++)
+	{
+		l_lazy.Evaluate(*l_one);
+		l_lazy.Evaluate(*l_add);
+	}
+	ASSERT_EQ(l_lazy.GetForcedCount(), 0U);
+	ASSERT_NO_THROW(l_lazy.Evaluate(*l_assert));
+	ASSERT_EQ(l_lazy.GetForcedCount(), 200000U);
+
+	// Left unforced on purpose: destroying it must not recurse either
+	for (int l_i = 0; l_i < 200000; l_i++)
+	{
+		l_lazy.Evaluate(*l_one);
+		l_lazy.Evaluate(*l_add);
+	}
+}
@@ -0,0 +1,132 @@
+#include "Helpers.hpp"
+#include "src/ct/FrontEnd.hpp"
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+using namespace avm;
+using namespace avm::test;
+
+// Writes the values as raw little-endian data, returns the path
+template <typename T>
+static String Write(String const &p_name, Vector<T> const &p_values)
+{
+	String const l_path = testing::TempDir() + p_name;
+	std::ofstream l_file(l_path, std::ios::binary | std::ios::trunc);
+
+	for (T l_value : p_values)
+	{
+		unsigned char l_bytes[sizeof(T)];
+
+		std::memcpy(l_bytes, &l_value, sizeof(T));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+		std::reverse(l_bytes, l_bytes + sizeof(T));
+#endif
+		l_file.write(reinterpret_cast<char const *>(l_bytes), sizeof(T));
+	}
+	return l_path;
+}
+
+TEST(LoadFile, Parse)
+{
+	auto l_program = Parse("load int16 \"data/samples.bin\"\nload r2\n");
+	auto const &l_load = dynamic_cast<ast::InstructionWithFile const &>(*l_program->GetInstructions().front());
+
+	ASSERT_EQ(l_load.GetType(), ast::Instruction::Type::LOAD_FILE);
+	ASSERT_EQ(l_load.GetOperandType(), eOperandType::INT16);
+	ASSERT_EQ(l_load.GetPath(), "data/samples.bin");
+	ASSERT_EQ(l_program->GetInstructions().back()->GetType(), ast::Instruction::Type::LOAD);
+
+	testing::internal::CaptureStdout();
+	ASSERT_EQ(Parse("load \"a.bin\"\nload int8 r1\n")->GetInstructions().size(), 0u);
+	ASSERT_EQ(testing::internal::GetCapturedStdout(),
+		"[line 1] Error  at '\"a.bin\"': Expected a register or a type\n"
+		"[line 2] Error  at 'r1': Expected a file path\n");
+
+	Lexer l_lexer;
+	testing::internal::CaptureStdout();
+	l_lexer.Run("load int8 \"a.bin\n");
+	ASSERT_TRUE(l_lexer.HadError());
+	ASSERT_EQ(testing::internal::GetCapturedStdout(), "[line 1] Error : Unterminated string\n");
+}
+
+TEST(LoadFile, EveryType)
+{
+	String const l_int8 = Write<int8_t>("int8.bin", { -128, 0, 127 });
+	String const l_int16 = Write<int16_t>("int16.bin", { -32768, 258, 32767 });
+	String const l_int32 = Write<int32_t>("int32.bin", { -2147483647 - 1, 65536, 2147483647 });
+	String const l_float = Write<float>("float.bin", { -1.5f, 0.25f, 3.0f });
+	String const l_double = Write<double>("double.bin", { -0.5, 42.0 });
+
+	ASSERT_EQ(Output(fmt::format("load int8 \"{}\"\ndump\n", l_int8)),
+		Output("push int8(-128)\npush int8(0)\npush int8(127)\ndump\n"));
+	ASSERT_EQ(Output(fmt::format("load int16 \"{}\"\ndump\n", l_int16)),
+		Output("push int16(-32768)\npush int16(258)\npush int16(32767)\ndump\n"));
+	ASSERT_EQ(Output(fmt::format("load int32 \"{}\"\ndump\n", l_int32)),
+		Output("push int32(-2147483648)\npush int32(65536)\npush int32(2147483647)\ndump\n"));
+	ASSERT_EQ(Output(fmt::format("load float \"{}\"\nadd\nadd\ndump\n", l_float)), "1.75\n");
+	ASSERT_EQ(Output(fmt::format("load double \"{}\"\ndump\n", l_double)),
+		Output("push double(-0.5)\npush double(42.0)\ndump\n"));
+
+	// Values keep their type
+	ASSERT_EQ(Output(fmt::format("load int8 \"{}\"\npop\npop\ndup\nadd\n", l_int8)),
+		Output("push int8(-128)\ndup\nadd\n"));
+}
+
+TEST(LoadFile, Invalid)
+{
+	String const l_odd = Write<int8_t>("odd.bin", { 1, 2, 3 });
+	String const l_empty = Write<int8_t>("empty.bin", {});
+	String const l_nan = Write<double>("nan.bin", { 1.0, std::nan(""), 2.0 });
+
+	ASSERT_EQ(Output(fmt::format("load int16 \"{}\"\n", l_odd)),
+		fmt::format("Fatal Error: \"{}\" holds 3 bytes, not a whole number of 2-byte values\n", l_odd));
+	ASSERT_EQ(Output(fmt::format("load int8 \"{}\"\ndump\n", l_odd)), "3\n2\n1\n");
+	ASSERT_EQ(Output(fmt::format("push int8(5)\nload int32 \"{}\"\ndump\n", l_empty)), "5\n");
+	ASSERT_EQ(Output(fmt::format("load double \"{}\"\n", l_nan)),
+		fmt::format("Fatal Error: \"{}\": value 1 is not a finite number\n", l_nan));
+	ASSERT_EQ(Output("load int8 \"/nonexistent/avm.bin\"\n"),
+		"Fatal Error: Cannot open \"/nonexistent/avm.bin\": No such file or directory\n");
+	ASSERT_EQ(Output(fmt::format("load int8 \"{}\"\n", testing::TempDir())),
+		fmt::format("Fatal Error: \"{}\" is not a regular file\n", testing::TempDir()));
+}
+
+TEST(LoadFile, NothingPushedOnFailure)
+{
+	String const l_nan = Write<float>("nan32.bin", { 1.0f, INFINITY });
+	Interpreter l_interpreter;
+	auto l_program = Parse(fmt::format("push int8(1)\nload float \"{}\"\n", l_nan));
+
+	l_interpreter.Evaluate(*l_program->GetInstructions().front());
+	ASSERT_THROW(l_interpreter.Evaluate(*l_program->GetInstructions().back()), FileError);
+
+	testing::internal::CaptureStdout();
+	l_interpreter.Evaluate(*Parse("dump\n")->GetInstructions().front());
+	ASSERT_EQ(testing::internal::GetCapturedStdout(), "1\n");
+}
+
+TEST(LoadFile, LargeFile)
+{
+	Vector<int16_t> l_values(1000000);
+
+	for (size_t l_i = 0; l_i < l_values.size(); l_i++)
+	{
+		l_values[l_i] = static_cast<int16_t>(l_i % 7 - 3);
+	}
+
+	String const l_path = Write<int16_t>("large.bin", l_values);
+	ASSERT_EQ(Output(fmt::format("load int16 \"{}\"\nmin\ndump\n", l_path)), "-3\n");
+	ASSERT_EQ(Output(fmt::format("load int16 \"{}\"\nsum 999999\ndump\n", l_path)), "0\n-3\n");
+}
+
+TEST(LoadFile, CompileTime)
+{
+	auto l_program = ct::Load(AVM_CT_COMPILE("load int32 \"a b.bin\"\nload r3\n"));
+	auto const &l_load = dynamic_cast<ast::InstructionWithFile const &>(*l_program->GetInstructions().front());
+
+	ASSERT_EQ(l_load.GetOperandType(), eOperandType::INT32);
+	ASSERT_EQ(l_load.GetPath(), "a b.bin");
+	ASSERT_THROW(ct::Count("load int8 a.bin"), ct::CompileError);
+	ASSERT_THROW(ct::Count("load int8 \"a.bin"), ct::CompileError);
+	ASSERT_THROW(ct::Count("load int64 \"a.bin\""), ct::CompileError);
+}
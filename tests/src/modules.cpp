@@ -0,0 +1,129 @@
+#include "Helpers.hpp"
+#include "src/ModuleCache.hpp"
+#include <cstdio>
+#include <fstream>
+
+using namespace avm;
+using namespace avm::test;
+
+// Programs are parsed as if read from a file of the temporary directory
+static String const s_main = testing::TempDir() + "main.avm";
+
+// Writes a module next to the parsed programs, returns its path
+static String Write(String const &p_name, String const &p_source)
+{
+	String const l_path = testing::TempDir() + p_name;
+	std::ofstream l_file(l_path, std::ios::trunc);
+
+	l_file << p_source;
+	return l_path;
+}
+
+// Removes what a cache in the temporary directory stored for the module
+static void Forget(String const &p_source)
+{
+	uint64_t const l_key = ModuleCache::Hash(p_source, ModuleCache::Hash(testing::TempDir()));
+
+	std::remove(fmt::format("{}/{:016x}.avmc", testing::TempDir(), l_key).c_str());
+}
+
+TEST(Modules, Parse)
+{
+	Write("avm-answer.avm", "push int32(40)\npush int32(2)\nadd\n");
+
+	auto l_program = Parse("include \"avm-answer.avm\"\ndump\ninclude \"avm-answer.avm\"\n", nullptr, s_main);
+
+	ASSERT_EQ(l_program->GetInstructions().size(), 3u);
+	ASSERT_EQ(At<ast::InstructionWithBlock>(*l_program, 0).GetCount(), 1u);
+	ASSERT_EQ(At<ast::InstructionWithBlock>(*l_program, 0).GetBody().GetInstructions().size(), 3u);
+
+	// Every include of a module shares its body
+	ASSERT_EQ(&At<ast::InstructionWithBlock>(*l_program, 0).GetBody(), &At<ast::InstructionWithBlock>(*l_program, 2).GetBody());
+}
+
+TEST(Modules, Programs)
+{
+	Write("avm-answer.avm", "push int32(40)\npush int32(2)\nadd\n");
+	Write("avm-double.avm", "macro twice {\ndup\nadd\n}\ninclude \"avm-answer.avm\"\ntwice\n");
+
+	ASSERT_EQ(Output("include \"avm-answer.avm\"\ndump\n", nullptr, s_main), "42\n");
+	ASSERT_EQ(Output("include \"avm-double.avm\"\ndump\n", nullptr, s_main), "84\n");
+	ASSERT_EQ(Output("repeat 3 { include \"avm-answer.avm\" }\nsum\ndump\n", nullptr, s_main), "126\n");
+	ASSERT_EQ(Output(fmt::format("include \"{}avm-answer.avm\"\ndump\n", testing::TempDir()), nullptr, s_main), "42\n");
+}
+
+TEST(Modules, Errors)
+{
+	Write("avm-self.avm", "push int8(1)\ninclude \"avm-self.avm\"\n");
+	Write("avm-label.avm", "push int8(1)\nl:\n");
+
+	testing::internal::CaptureStdout();
+	ASSERT_EQ(Parse("include \"avm-missing.avm\"\ninclude\ninclude \"avm-self.avm\"\ninclude \"avm-label.avm\"\n", nullptr, s_main)
+		->GetInstructions().size(), 0u);
+	ASSERT_EQ(testing::internal::GetCapturedStdout(), fmt::format(
+		"[line 1] Error  at '\"avm-missing.avm\"': Cannot open \"{}avm-missing.avm\": No such file or directory\n"
+		"[line 3] Error  at '\n': Expected a module path\n"
+		"[line 2] Error  at '\"avm-self.avm\"': Module includes itself\n"
+		"[line 3] Error  at '\"avm-self.avm\"': Module has errors\n"
+		"[line 2] Error  at 'label': Expected no label, jump nor routine in a module\n"
+		"[line 4] Error  at '\"avm-label.avm\"': Module has errors\n", testing::TempDir()));
+
+	// Macros of a module stay private
+	Write("avm-macro.avm", "macro one { push int8(1) }\n");
+
+	testing::internal::CaptureStdout();
+	ASSERT_EQ(Parse("include \"avm-macro.avm\"\none\n", nullptr, s_main)->GetInstructions().size(), 1u);
+	ASSERT_EQ(testing::internal::GetCapturedStdout(), "[line 2] Error : Unexpected Identifier: 'one'\n");
+}
+
+TEST(Modules, CompiledOnce)
+{
+	ModuleCache l_modules;
+
+	Write("avm-answer.avm", "push int32(40)\npush int32(2)\nadd\n");
+	Write("avm-double.avm", "include \"avm-answer.avm\"\ndup\nadd\n");
+
+	ASSERT_EQ(Output("include \"avm-double.avm\"\ndump\n", &l_modules, s_main), "84\n");
+	ASSERT_EQ(Output("include \"avm-answer.avm\"\ninclude \"avm-double.avm\"\nadd\ndump\n", &l_modules, s_main), "126\n");
+	ASSERT_EQ(l_modules.GetCompiledCount(), 2u);
+
+	// A module that changed is compiled again
+	Write("avm-answer.avm", "push int32(20)\n");
+	ASSERT_EQ(Output("include \"avm-answer.avm\"\ndump\n", &l_modules, s_main), "20\n");
+	ASSERT_EQ(l_modules.GetCompiledCount(), 3u);
+}
+
+TEST(Modules, StoredModules)
+{
+	String const l_leaf = "macro inc {\npush int16(1)\nadd\n}\npush int16[1, 2, 3]\ninc\ninc\n";
+	String const l_module = "include \"avm-stored-leaf.avm\"\nrepeat 2 {\npush int16(1)\nadd\n}\nsum 3\n";
+
+	Forget(l_leaf);
+	Forget(l_module);
+	Write("avm-stored-leaf.avm", l_leaf);
+	Write("avm-stored.avm", l_module);
+
+	String const l_source = "include \"avm-stored.avm\"\ndump\n";
+	ModuleCache l_first(testing::TempDir());
+
+	ASSERT_EQ(Output(l_source, &l_first, s_main), "10\n");
+	ASSERT_EQ(l_first.GetCompiledCount(), 2u);
+
+	// A later run loads them back
+	ModuleCache l_second(testing::TempDir());
+
+	ASSERT_EQ(Output(l_source, &l_second, s_main), "10\n");
+	ASSERT_EQ(l_second.GetCompiledCount(), 0u);
+
+	// Until a module they include changes
+	Write("avm-stored-leaf.avm", "push int16(5)\n");
+
+	ModuleCache l_third(testing::TempDir());
+
+	ASSERT_EQ(Output(l_source, &l_third, s_main), "Fatal Error: Stack is empty\n");
+	ASSERT_EQ(l_third.GetCompiledCount(), 2u);
+
+	Forget(l_leaf);
+	Forget(l_module);
+	Forget("push int16(5)\n");
+}
@@ -0,0 +1,119 @@
+#include "Helpers.hpp"
+#include "src/opt/Optimizer.hpp"
+
+using namespace avm;
+using namespace avm::test;
+using Type = ast::Instruction::Type;
+
+static Vector<Type> Types(ast::Program const &p_program)
+{
+	Vector<Type> l_types;
+
+	for (auto const &l_instruction : p_program.GetInstructions())
+	{
+		l_types.push_back(l_instruction->GetType());
+	}
+	return l_types;
+}
+
+TEST(Optimizer, ConstantFolding)
+{
+	char const *const l_source =
+		"push int32(2)\n"
+		"push int32(3)\n"
+		"mul\n"
+		"push float(4.25)\n"
+		"add\n"
+		"dump\n";
+	auto l_program = Parse(l_source);
+	auto l_expected = Parse(l_source);
+
+	ASSERT_EQ(opt::ConstantFolding().Run(*l_program), 4U);
+	ASSERT_EQ(Types(*l_program), Vector<Type>({ Type::PUSH, Type::DUMP }));
+	ASSERT_EQ(Execute(*l_program), Execute(*l_expected));
+}
+
+TEST(Optimizer, FoldingKeepsFaults)
+{
+	auto l_program = Parse(
+		"push int8(127)\n"
+		"push int8(1)\n"
+		"add\n"
+		"push int32(1)\n"
+		"push int32(0)\n"
+		"div\n");
+
+	ASSERT_EQ(opt::ConstantFolding().Run(*l_program), 0U);
+	ASSERT_EQ(l_program->GetInstructions().size(), 6U);
+}
+
+TEST(Optimizer, DeadCodeElimination)
+{
+	char const *const l_source =
+		"push int32(1)\n"
+		"dump\n"
+		"push int32(2)\n"
+		"add\n"
+		"pop\n"
+		"push int8(3)\n"
+		"pop\n"
+		"push int8(4)\n";
+	auto l_program = Parse(l_source);
+	auto l_expected = Parse(l_source);
+
+	ASSERT_EQ(opt::DeadCodeElimination().Run(*l_program), 4U);
+	ASSERT_EQ(Types(*l_program), Vector<Type>({ Type::PUSH, Type::DUMP, Type::POP, Type::PUSH }));
+	ASSERT_EQ(Execute(*l_program), Execute(*l_expected));
+}
+
+TEST(Optimizer, DeadCodeKeepsFaults)
+{
+	auto l_program = Parse(
+		"push int8(100)\n"
+		"push int8(100)\n"
+		"add\n"
+		"pop\n"
+		"pop\n");
+
+	ASSERT_EQ(opt::DeadCodeElimination().Run(*l_program), 0U);
+}
+
+TEST(Optimizer, ExitTruncation)
+{
+	auto l_program = Parse(
+		"push int8(1)\n"
+		"exit\n"
+		"push int8(2)\n"
+		"dump\n");
+
+	ASSERT_EQ(opt::ExitTruncation().Run(*l_program), 2U);
+	ASSERT_EQ(Types(*l_program), Vector<Type>({ Type::PUSH, Type::EXIT }));
+}
+
+TEST(Optimizer, Pipeline)
+{
+	auto l_program = Parse(
+		"push int32(2)\n"
+		"push int32(3)\n"
+		"add\n"
+		"pop\n"
+		"push double(1.5)\n"
+		"dump\n"
+		"exit\n"
+		"dump\n");
+
+	opt::Optimizer l_optimizer;
+	l_optimizer.Enable("dead-code-elimination", false);
+	ASSERT_FALSE(l_optimizer.IsEnabled("dead-code-elimination"));
+	ASSERT_THROW(l_optimizer.Enable("unknown", false), std::invalid_argument);
+
+	Vector<opt::PassReport> l_reports = l_optimizer.Run(*l_program);
+	ASSERT_EQ(l_reports.size(), 2U);
+	ASSERT_EQ(l_reports[0].m_removed, 1U);
+	ASSERT_EQ(l_reports[1].m_removed, 2U);
+
+	l_optimizer.Enable("dead-code-elimination", true);
+	l_reports = l_optimizer.Run(*l_program);
+	ASSERT_EQ(l_reports[2].m_removed, 2U);
+	ASSERT_EQ(Types(*l_program), Vector<Type>({ Type::PUSH, Type::DUMP, Type::EXIT }));
+}
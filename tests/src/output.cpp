@@ -0,0 +1,116 @@
+#include "Helpers.hpp"
+#include "src/OutputSink.hpp"
+#include <fcntl.h>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+using namespace avm;
+using namespace avm::test;
+
+TEST(Output, Memory)
+{
+	Interpreter l_interpreter;
+	auto l_output = MakeShared<MemorySink>();
+
+	l_interpreter.SetOutput(l_output);
+	testing::internal::CaptureStdout();
+	l_interpreter.Run(*Parse("push int8(72)\nprint\npush int8(105)\nprint\npush int8(10)\nprint\ndump\n"));
+	ASSERT_EQ(testing::internal::GetCapturedStdout(), "");
+	ASSERT_EQ(l_output->GetOutput(), "Hi\n10\n105\n72\n");
+
+	// Flushed on error, up to the faulting instruction
+	l_output->Clear();
+	ASSERT_THROW(l_interpreter.Run(*Parse("dump\npop\npop\npop\npop\ndump\n")), EmptyStackError);
+	ASSERT_EQ(l_output->GetOutput(), "10\n105\n72\n");
+
+	// And by each evaluated instruction
+	l_output->Clear();
+	l_interpreter.Evaluate(*Parse("push int32(7)\n")->GetNextInstruction());
+	l_interpreter.Evaluate(*Parse("dump\n")->GetNextInstruction());
+	ASSERT_EQ(l_output->GetOutput(), "7\n");
+}
+
+TEST(Output, Null)
+{
+	Interpreter l_interpreter;
+
+	l_interpreter.SetOutput(MakeShared<NullSink>());
+	testing::internal::CaptureStdout();
+	l_interpreter.Run(*Parse("push int32[1, 2, 3]\ndump\npush int8(65)\nprint\nexit\n"));
+	ASSERT_EQ(testing::internal::GetCapturedStdout(), "");
+	ASSERT_TRUE(l_interpreter.HasExited());
+}
+
+// A dump of a million values is handed over in a few large chunks
+TEST(Output, LargeDump)
+{
+	Interpreter l_interpreter;
+	size_t l_chunks = 0;
+	size_t l_lines = 0;
+	String l_last;
+
+	l_interpreter.SetOutput(MakeShared<CallbackSink>([&] (StringView p_chunk) {
+		l_chunks++;
+		l_lines += static_cast<size_t>(std::count(p_chunk.begin(), p_chunk.end(), '\n'));
+		l_last = String(p_chunk.substr(p_chunk.size() - 2));
+	}));
+
+	std::ostringstream l_source;
+
+	l_source << "push int32[";
+	for (size_t l_i = 0; l_i < 1000000; l_i++)
+	{
+		l_source << (l_i ? ", " : "") << l_i % 10;
+	}
+	l_source << "]\ndump\n";
+
+	l_interpreter.Run(*Parse(l_source.str()));
+	ASSERT_EQ(l_lines, 1000000u);
+	ASSERT_EQ(l_last, "0\n");
+	ASSERT_LE(l_chunks, 2000000 / OutputSink::s_bufferSize + 1);
+}
+
+// Blocks leave flushing to the instruction that runs them
+TEST(Output, Blocks)
+{
+	Interpreter l_interpreter;
+	size_t l_chunks = 0;
+	size_t l_lines = 0;
+
+	l_interpreter.SetOutput(MakeShared<CallbackSink>([&] (StringView p_chunk) {
+		l_chunks++;
+		l_lines += static_cast<size_t>(std::count(p_chunk.begin(), p_chunk.end(), '\n'));
+	}));
+
+	l_interpreter.Run(*Parse("push int8(7)\nrepeat 1000 { dump }\nmacro show { dump\ndump }\nrepeat 10 { show }\n"));
+	ASSERT_EQ(l_lines, 1020u);
+	ASSERT_EQ(l_chunks, 1u);
+
+	l_chunks = 0;
+	Evaluate(l_interpreter, *Parse("repeat 1000 { dump }\nrepeat 3 { dump\nexit }\ndump\n"));
+	ASSERT_EQ(l_lines, 2021u);
+	ASSERT_EQ(l_chunks, 2u);
+}
+
+TEST(Output, File)
+{
+	String const l_path = testing::TempDir() + "/avm-output.txt";
+	int const l_fd = open(l_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+	ASSERT_GE(l_fd, 0);
+	{
+		Interpreter l_interpreter;
+
+		l_interpreter.SetOutput(MakeShared<FileSink>(l_fd));
+		l_interpreter.Run(*Parse("push int16(-3)\npush float(1.5)\ndump\n"));
+	}
+	close(l_fd);
+
+	std::ifstream l_file(l_path);
+	std::ostringstream l_contents;
+
+	l_contents << l_file.rdbuf();
+	ASSERT_EQ(l_contents.str(), "1.50\n-3\n");
+	unlink(l_path.c_str());
+}
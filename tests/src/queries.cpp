@@ -0,0 +1,213 @@
+#include "Helpers.hpp"
+#include "src/OperandStack.hpp"
+#include "src/analysis/IntervalAnalysis.hpp"
+#include "src/ct/FrontEnd.hpp"
+#include <cmath>
+#include <random>
+
+using namespace avm;
+using namespace avm::test;
+using analysis::IntervalAnalysis;
+using Type = ast::Instruction::Type;
+
+static double ValueAt(OperandStack const &p_stack, size_t p_index)
+{
+	OperandStack::Payload const l_payload = p_stack.GetPayload(p_index);
+
+	return p_stack.GetType(p_index) < eOperandType::FLOAT ? static_cast<double>(l_payload.m_integer) : l_payload.m_real;
+}
+
+// Runs a query and takes its result back off the stack
+static Pair<eOperandType, double> Query(OperandStack &p_stack, Type p_type)
+{
+	p_stack.Query(p_type);
+
+	Pair<eOperandType, double> const l_result { p_stack.GetType(p_stack.Size() - 1), ValueAt(p_stack, p_stack.Size() - 1) };
+
+	p_stack.Drop();
+	return l_result;
+}
+
+TEST(Queries, Parse)
+{
+	auto l_program = Parse("stackmin\nstackmax\nstacksum\nstackcount\n");
+	Vector<Type> l_types;
+
+	for (auto const &l_instruction : l_program->GetInstructions())
+	{
+		l_types.push_back(l_instruction->GetType());
+	}
+	ASSERT_EQ(l_types, (Vector<Type>{ Type::STACKMIN, Type::STACKMAX, Type::STACKSUM, Type::STACKCOUNT }));
+}
+
+TEST(Queries, Programs)
+{
+	// The values stay below the result
+	ASSERT_EQ(Output("push int32[4, -2, 9]\nstackmin\ndump\n"), "-2\n9\n-2\n4\n");
+	ASSERT_EQ(Output("push int32[4, -2, 9]\nstackmax\nstacksum\nstackcount\ndump\n"), "5\n20\n9\n9\n-2\n4\n");
+	ASSERT_EQ(Output("stackcount\ndump\n"), "0\n");
+
+	// Results take the most precise type of the stack
+	ASSERT_EQ(Output("push int8(5)\npush float(-0.5)\npush int16(3)\nstackmin\nassert float(-0.5)\npop\n"
+		"stackmax\nassert float(5.0)\npop\nstacksum\nassert float(7.5)\n"), "");
+
+	// Only the total has to fit, not the partial sums
+	ASSERT_EQ(Output("push int8(100)\npush int8(100)\npush int8(-100)\nstacksum\ndump\n"), "100\n-100\n100\n100\n");
+	ASSERT_EQ(Output("push int8(100)\npush int8(100)\nstacksum\n"), "Fatal Error: Sum of the stack > 127\n");
+	ASSERT_EQ(Output("push int8(-100)\npush int8(-100)\nstacksum\n"), "Fatal Error: Sum of the stack < -128\n");
+	ASSERT_EQ(Output("stackmin\n"), "Fatal Error: Stack is empty\n");
+	ASSERT_EQ(Output("stacksum\n"), "Fatal Error: Stack is empty\n");
+}
+
+// Random pushes, pops and moves between queries, checked against a scan of the stack
+TEST(Queries, FollowTheStack)
+{
+	OperandStack l_stack;
+	std::mt19937 l_random(7);
+
+	for (size_t l_step = 0; l_step < 20000; l_step++)
+	{
+		int const l_operation = std::uniform_int_distribution<int>(0, 11)(l_random);
+
+		if (l_operation < 5 || l_stack.Size() < 3)
+		{
+			eOperandType const l_type = static_cast<eOperandType>(std::uniform_int_distribution<int>(0, 4)(l_random));
+			int const l_value = std::uniform_int_distribution<int>(-50, 50)(l_random);
+			OperandStack::Payload l_payload;
+
+			if (l_type < eOperandType::FLOAT)
+			{
+				l_payload.m_integer = l_value;
+			}
+			else
+			{
+				l_payload.m_real = l_value / 2.0;
+			}
+			l_stack.Push(l_type, l_payload);
+		}
+		else if (l_operation < 7)
+		{
+			l_stack.Drop();
+		}
+		else if (l_operation == 7)
+		{
+			l_stack.Rot();
+		}
+		else if (l_operation == 8)
+		{
+			l_stack.Sort(3);
+		}
+		else if (l_operation == 9)
+		{
+			l_stack.Reduce(Type::MAX, 2);
+		}
+		else if (l_operation == 10)
+		{
+			l_stack.Swap();
+		}
+		else
+		{
+			l_stack.Dup();
+		}
+
+		if (l_step % 7 != 0 || l_stack.Empty())
+		{
+			continue;
+		}
+
+		eOperandType l_type = l_stack.GetType(0);
+		double l_min = ValueAt(l_stack, 0);
+		double l_max = l_min;
+		double l_sum = 0.0;
+
+		for (size_t l_i = 0; l_i < l_stack.Size(); l_i++)
+		{
+			l_type = std::max(l_type, l_stack.GetType(l_i));
+			l_min = std::min(l_min, ValueAt(l_stack, l_i));
+			l_max = std::max(l_max, ValueAt(l_stack, l_i));
+			l_sum += ValueAt(l_stack, l_i);
+		}
+
+		ASSERT_EQ(Query(l_stack, Type::STACKMIN), std::make_pair(l_type, l_min)) << l_step;
+		ASSERT_EQ(Query(l_stack, Type::STACKMAX), std::make_pair(l_type, l_max)) << l_step;
+		ASSERT_EQ(Query(l_stack, Type::STACKCOUNT), std::make_pair(eOperandType::INT32, double(l_stack.Size()))) << l_step;
+		// Sums that fit in every type but int8
+		if (l_type != eOperandType::INT8 && std::abs(l_sum) <= std::numeric_limits<int16_t>::max())
+		{
+			ASSERT_EQ(Query(l_stack, Type::STACKSUM), std::make_pair(l_type, l_sum)) << l_step;
+		}
+	}
+}
+
+TEST(Queries, Incremental)
+{
+	OperandStack l_stack;
+	OperandStack::Payload l_payload;
+
+	// A query after every push only looks at the new value
+	for (int64_t l_i = 0; l_i < (1 << 18); l_i++)
+	{
+		l_payload.m_integer = l_i % 1000;
+		l_stack.Push(eOperandType::INT32, l_payload);
+		ASSERT_EQ(Query(l_stack, Type::STACKMAX).second, std::min<int64_t>(l_i, 999));
+	}
+	ASSERT_EQ(Query(l_stack, Type::STACKMIN).second, 0);
+}
+
+TEST(Queries, BulkPushes)
+{
+	OperandStack l_stack;
+	double const l_reals[] = { 0.25, -8.0, std::nan(""), 1.0 };
+
+	l_stack.TrackAggregates();
+	l_stack.Append(eOperandType::INT16, { 3, -4, 10 });
+	ASSERT_EQ(Query(l_stack, Type::STACKSUM), std::make_pair(eOperandType::INT16, 9.0));
+
+	// A rejected bulk push leaves nothing behind in the aggregates either
+	ASSERT_EQ(l_stack.AppendRaw(eOperandType::DOUBLE, reinterpret_cast<unsigned char const *>(l_reals), 4), 2u);
+	ASSERT_EQ(Query(l_stack, Type::STACKMIN), std::make_pair(eOperandType::INT16, -4.0));
+	ASSERT_EQ(l_stack.AppendRaw(eOperandType::DOUBLE, reinterpret_cast<unsigned char const *>(l_reals), 2), NullOpt);
+	ASSERT_EQ(Query(l_stack, Type::STACKMIN), std::make_pair(eOperandType::DOUBLE, -8.0));
+	ASSERT_EQ(Query(l_stack, Type::STACKSUM), std::make_pair(eOperandType::DOUBLE, 1.25));
+
+	// Sorting the whole stack only reorders the slots the aggregates point to
+	l_stack.Sort();
+	ASSERT_EQ(Query(l_stack, Type::STACKMAX), std::make_pair(eOperandType::DOUBLE, 10.0));
+	l_stack.Drop(3);
+	ASSERT_EQ(Query(l_stack, Type::STACKMAX), std::make_pair(eOperandType::DOUBLE, -4.0));
+	ASSERT_EQ(Query(l_stack, Type::STACKSUM), std::make_pair(eOperandType::DOUBLE, -12.0));
+}
+
+// The interpreter tracks the aggregates from the start when the program has a query
+TEST(Queries, HasQuery)
+{
+	ASSERT_TRUE(Parse("push int8(1)\nstackcount\n")->HasQuery());
+	ASSERT_TRUE(Parse("push int8(1)\nrepeat 2 { repeat 2 { stacksum } }\n")->HasQuery());
+	ASSERT_TRUE(Parse("macro top { stackmax }\npush int8(1)\ntop\n")->HasQuery());
+	ASSERT_FALSE(Parse("push int8(1)\nrepeat 2 { dup }\nsum\n")->HasQuery());
+}
+
+TEST(Queries, Analysis)
+{
+	IntervalAnalysis l_analysis;
+
+	// The extremes of the stack are known, the sum is not modelled
+	auto l_program = Parse("push int8(100)\npush int8(50)\nstackcount\npop\nstackmin\nadd\nstackmax\nadd\n");
+
+	l_analysis.Run(*l_program);
+	ASSERT_EQ(l_analysis.GetVerdict(**std::next(l_program->GetInstructions().begin(), 5)), analysis::Verdict::SAFE);
+	ASSERT_TRUE(l_analysis.GetFault());
+	ASSERT_EQ(l_analysis.GetFault()->m_line, 8);
+
+	auto l_sum = Parse("push int8(100)\nstacksum\npush int8(100)\npush int8(100)\nadd\n");
+
+	l_analysis.Run(*l_sum);
+	ASSERT_FALSE(l_analysis.GetFault());
+}
+
+TEST(Queries, CompileTime)
+{
+	constexpr auto l_image = AVM_CT_COMPILE("push int16(5)\npush int16(-5)\nstackmin\nstackmax\nstacksum\nstackcount\ndump\n");
+
+	ASSERT_EQ(Execute(*ct::Load(l_image)), "5\n0\n5\n-5\n-5\n5\n");
+}
@@ -0,0 +1,143 @@
+#include "Helpers.hpp"
+#include "src/Arithmetic.hpp"
+#include "src/OperandFactory.hpp"
+#include "src/Quickening.hpp"
+#include <typeinfo>
+
+using namespace avm;
+using namespace avm::test;
+using Type = ast::Instruction::Type;
+
+// Result or exception of one arithmetic operation, to compare both paths
+template <typename Fn>
+static String Result(Fn p_fn)
+{
+	try
+	{
+		UniquePtr<IOperand const> l_result(p_fn());
+		return fmt::format("{} {}", static_cast<int>(l_result->getType()), l_result->toString());
+	}
+	catch (std::exception const &l_e)
+	{
+		return fmt::format("{}: {}", typeid(l_e).name(), l_e.what());
+	}
+}
+
+TEST(Quickening, SitesAreSpecializedAfterFirstRun)
+{
+	auto l_program = Parse(
+		"push int32(42)\n"
+		"push int8(33)\n"
+		"add\n"
+		"push double(2.5)\n"
+		"mul\n"
+		"push int16(-7)\n"
+		"push int16(2)\n"
+		"div\n"
+		"dump\n");
+	Vector<ast::Instruction const *> l_sites;
+
+	for (auto const &l_instruction : l_program->GetInstructions())
+	{
+		if (IsArithmetic(l_instruction->GetType()))
+		{
+			l_sites.push_back(l_instruction.get());
+		}
+	}
+
+	Interpreter l_interpreter;
+	auto l_name = [&] (Interpreter const &p_interpreter, size_t p_site) {
+		return QuickenedName(p_interpreter.GetSite(*l_sites[p_site]), *l_sites[p_site]);
+	};
+
+	ASSERT_EQ(l_name(l_interpreter, 0), "add");
+	String const l_first = Capture([&] { l_interpreter.Run(*l_program); });
+
+	ASSERT_EQ(l_name(l_interpreter, 0), "add_i32_i8");
+	ASSERT_EQ(l_name(l_interpreter, 1), "mul_i32_f64");
+	ASSERT_EQ(l_name(l_interpreter, 2), "div_i16_i16");
+	ASSERT_EQ(Execute(*l_program), l_first);
+	ASSERT_EQ(l_first, "-3\n1.9e+02\n");
+
+	// The sites belong to the interpreter, the program is left as it was
+	Interpreter l_other;
+
+	ASSERT_EQ(l_name(l_other, 0), "add");
+}
+
+TEST(Quickening, GuardFallsBackToGenericPath)
+{
+	auto l_add = Parse("add\nmul\n");
+	ast::Instruction const &l_instruction = *l_add->GetInstructions().front();
+	QuickSite l_site;
+	UniquePtr<IOperand const> l_int(OperandFactory::Get().CreateOperand(eOperandType::INT32, "40"));
+	UniquePtr<IOperand const> l_float(OperandFactory::Get().CreateOperand(eOperandType::FLOAT, "1.5"));
+
+	UniquePtr<IOperand const> l_result(Quicken(l_site, l_instruction, *l_int, *l_int, true));
+	ASSERT_EQ(QuickenedName(l_site, l_instruction), "add_i32_i32");
+
+	l_result.reset(Quicken(l_site, l_instruction, *l_float, *l_int, true));
+	ASSERT_EQ(l_result->getType(), eOperandType::FLOAT);
+	ASSERT_EQ(l_result->toString(), "41.50");
+	ASSERT_EQ(QuickenedName(l_site, l_instruction), "add");
+	ASSERT_TRUE(l_site.m_polymorphic);
+
+	// Polymorphic sites are not specialized again
+	l_result.reset(Quicken(l_site, l_instruction, *l_int, *l_int, true));
+	ASSERT_EQ(l_result->toString(), "80");
+	ASSERT_EQ(QuickenedName(l_site, l_instruction), "add");
+
+	// A site left by another operation starts over
+	ast::Instruction const &l_mul = *l_add->GetInstructions().back();
+
+	l_site = QuickSite();
+	l_result.reset(Quicken(l_site, l_instruction, *l_int, *l_int, true));
+	ASSERT_EQ(QuickenedName(l_site, l_mul), "mul");
+	l_result.reset(Quicken(l_site, l_mul, *l_int, *l_int, true));
+	ASSERT_EQ(l_result->toString(), "1600");
+	l_result.reset(Quicken(l_site, l_mul, *l_int, *l_int, true));
+	ASSERT_EQ(l_result->toString(), "1600");
+	ASSERT_EQ(QuickenedName(l_site, l_mul), "mul_i32_i32");
+}
+
+TEST(Quickening, SpecializedVariantsMatchOperands)
+{
+	Vector<Pair<eOperandType, Vector<String>>> const l_values {
+		{ eOperandType::INT8,   { "-128", "-7", "-1", "0", "1", "3", "100", "127" } },
+		{ eOperandType::INT16,  { "-32768", "-300", "-1", "0", "2", "255", "32767" } },
+		{ eOperandType::INT32,  { "-2147483648", "-70000", "-1", "0", "9", "65536", "2147483647" } },
+		{ eOperandType::FLOAT,  { "-2.5", "0.0", "1.25", "300.75" } },
+		{ eOperandType::DOUBLE, { "-12.5", "0.0", "7.0", "1234.5" } },
+	};
+
+	for (Type l_op : { Type::ADD, Type::SUB, Type::MUL, Type::DIV, Type::MOD })
+	{
+		for (auto const &[l_lhsType, l_lhsValues] : l_values)
+		{
+			for (auto const &[l_rhsType, l_rhsValues] : l_values)
+			{
+				QuickHandler const l_handler = Specialize(l_op, l_lhsType, l_rhsType);
+
+				for (String const &l_lhsValue : l_lhsValues)
+				{
+					for (String const &l_rhsValue : l_rhsValues)
+					{
+						UniquePtr<IOperand const> l_lhs(OperandFactory::Get().CreateOperand(l_lhsType, l_lhsValue));
+						UniquePtr<IOperand const> l_rhs(OperandFactory::Get().CreateOperand(l_rhsType, l_rhsValue));
+
+						// Modulo by zero is NaN, converting it to an integer is undefined
+						if (l_op == Type::MOD && l_rhs->toString().find_first_not_of("0.") == String::npos
+							&& l_rhsType < eOperandType::FLOAT && l_lhsType < eOperandType::FLOAT)
+						{
+							continue;
+						}
+
+						ASSERT_EQ(Result([&] { return l_handler(*l_lhs, *l_rhs, true); }),
+							Result([&] { return Apply(l_op, *l_lhs, *l_rhs); }))
+							<< l_lhsValue << " " << l_rhsValue;
+					}
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,124 @@
+#include "Helpers.hpp"
+#include "src/LazyInterpreter.hpp"
+#include "src/OperandStack.hpp"
+#include "src/dataflow/DataflowInterpreter.hpp"
+#include <random>
+
+using namespace avm;
+using namespace avm::test;
+using Type = ast::Instruction::Type;
+
+static String RandomPush(std::mt19937 &p_random, bool p_integers)
+{
+	static char const *const l_types[] = { "int8", "int16", "int32", "float", "double" };
+	static int const l_limits[] = { 127, 32767, 2147483647 };
+
+	size_t const l_type = std::uniform_int_distribution<size_t>(0, p_integers ? 2 : 4)(p_random);
+
+	if (l_type < 3)
+	{
+		// Mostly small values, so that some folds succeed
+		int const l_limit = std::bernoulli_distribution(0.9)(p_random) ? 12 : l_limits[l_type];
+		int const l_value = std::uniform_int_distribution<int>(-l_limit, l_limit)(p_random);
+
+		return fmt::format("push {}({})\n", l_types[l_type], l_value);
+	}
+	return fmt::format("push {}({:.2f})\n", l_types[l_type], std::uniform_real_distribution<double>(-50, 50)(p_random));
+}
+
+TEST(Reductions, SumAndProdMatchScalarFolds)
+{
+	std::mt19937 l_random(42);
+
+	for (int l_round = 0; l_round < 400; l_round++)
+	{
+		size_t const l_size = std::uniform_int_distribution<size_t>(1, 40)(l_random);
+		size_t const l_count = std::uniform_int_distribution<size_t>(1, l_size)(l_random);
+		bool const l_sum = l_round % 2 == 0;
+		String l_pushes;
+
+		for (size_t l_i = 0; l_i < l_size; l_i++)
+		{
+			l_pushes += RandomPush(l_random, l_round % 4 < 2);
+		}
+
+		String l_folds;
+		for (size_t l_i = 1; l_i < l_count; l_i++)
+		{
+			l_folds += l_sum ? "add\n" : "mul\n";
+		}
+
+		String const l_bulk = fmt::format("{} {}\n", l_sum ? "sum" : "prod", l_count);
+
+		ASSERT_EQ(Output(l_pushes + l_bulk + "dump\n"), Output(l_pushes + l_folds + "dump\n")) << l_pushes << l_bulk;
+	}
+}
+
+TEST(Reductions, WholeStack)
+{
+	ASSERT_EQ(Output(
+		"push int32(1)\n"
+		"push int32(2)\n"
+		"push int8(3)\n"
+		"push int8(4)\n"
+		"sum 2\n"
+		"dump\n"
+		"mean\n"
+		"dump\n"
+		"push float(1.5)\n"
+		"push int16(-4)\n"
+		"push int32(7)\n"
+		"min 3\n"
+		"dump\n"
+		"max\n"
+		"dump\n"
+		"push double(2.5)\n"
+		"prod\n"
+		"dump\n"),
+		"7\n2\n1\n3\n-4.00\n3\n3.00\n7.5\n");
+}
+
+TEST(Reductions, Faults)
+{
+	ASSERT_EQ(Output("sum\n"), "Fatal Error: Stack is empty\n");
+	ASSERT_EQ(Output("push int8(1)\nmax 2\n"), "Fatal Error: Stack is empty\n");
+	ASSERT_EQ(Output("push int8(100)\npush int8(20)\npush int8(10)\nsum\n"), "Fatal Error: (100 + 30) > 127\n");
+	ASSERT_EQ(Output("push int8(1)\npush int16(-1)\nmean\ndump\n"), "0\n");
+	ASSERT_EQ(Output("push int32(7)\nmean 1\ndump\n"), "7\n");
+
+	ASSERT_EQ(Parse("sum 0\npop\n")->GetInstructions().size(), 1U);
+}
+
+TEST(Reductions, BulkStack)
+{
+	OperandStack l_stack;
+	size_t const l_size = 1000000;
+	OperandStack::Payload l_payload;
+
+	for (size_t l_i = 0; l_i < l_size; l_i++)
+	{
+		l_payload.m_integer = static_cast<int64_t>(l_i % 200) - 100;
+		l_stack.Push(eOperandType::INT32, l_payload);
+	}
+	l_payload.m_integer = 1;
+	l_stack.Push(eOperandType::INT8, l_payload);
+
+	l_stack.Reduce(Type::SUM);
+	ASSERT_EQ(l_stack.Size(), 1U);
+	ASSERT_EQ(l_stack.Top().getType(), eOperandType::INT32);
+	ASSERT_EQ(l_stack.Top().toString(), "-499999");
+}
+
+TEST(Reductions, OtherEngines)
+{
+	auto l_program = Parse("push int8(1)\npush int8(2)\nsum\ndump\n");
+	LazyInterpreter l_lazy;
+	dataflow::DataflowInterpreter l_dataflow;
+
+	ASSERT_FALSE(l_program->HasOnlyBaseInstructions());
+	ASSERT_THROW(l_lazy.Evaluate(**std::next(l_program->GetInstructions().begin(), 2)), UnsupportedInstruction);
+
+	testing::internal::CaptureStdout();
+	l_dataflow.Run(*l_program);
+	ASSERT_EQ(testing::internal::GetCapturedStdout(), "3\n");
+}
@@ -0,0 +1,107 @@
+#include "Helpers.hpp"
+#include "src/RegisterFile.hpp"
+#include "src/analysis/IntervalAnalysis.hpp"
+#include "src/ct/FrontEnd.hpp"
+
+using namespace avm;
+using namespace avm::test;
+using analysis::IntervalAnalysis;
+using analysis::Verdict;
+
+TEST(Registers, Parse)
+{
+	auto l_program = Parse("store r0\nload r15\n");
+	auto const &l_store = dynamic_cast<ast::InstructionWithArgument const &>(At(*l_program, 0));
+	auto const &l_load = dynamic_cast<ast::InstructionWithArgument const &>(At(*l_program, 1));
+
+	ASSERT_EQ(l_store.GetType(), ast::Instruction::Type::STORE);
+	ASSERT_EQ(l_store.GetArgument(), 0u);
+	ASSERT_EQ(l_load.GetType(), ast::Instruction::Type::LOAD);
+	ASSERT_EQ(l_load.GetArgument(), 15u);
+
+	testing::internal::CaptureStdout();
+	ASSERT_EQ(Parse("store r16\nload\nstore 3\n")->GetInstructions().size(), 0u);
+	ASSERT_EQ(testing::internal::GetCapturedStdout(),
+		"[line 1] Error  at 'r16': Expected a register from r0 to r15\n"
+		"[line 3] Error  at '\n': Expected a register or a type\n"
+		"[line 3] Error  at '3': Expected a register\n");
+}
+
+TEST(Registers, Programs)
+{
+	// The register keeps its value across loads, values keep their type
+	ASSERT_EQ(Output("push int16(7)\nstore r1\nload r1\nload r1\nmul\ndump\n"), "49\n");
+	ASSERT_EQ(Output("push float(0.5)\nstore r3\npush float(1.25)\nload r3\nadd\ndump\n"), "1.75\n");
+	ASSERT_EQ(Output("push int8(65)\nstore r0\npush int8(66)\nstore r0\nload r0\nprint\n"), "B");
+
+	// Running accumulator
+	String l_source = "push int32(0)\nstore r2\n";
+	for (int l_i = 1; l_i <= 100; l_i++)
+	{
+		l_source += fmt::format("load r2\npush int32({})\nadd\nstore r2\n", l_i);
+	}
+	ASSERT_EQ(Output(l_source + "load r2\ndump\n"), "5050\n");
+
+	ASSERT_EQ(Output("load r4\n"), "Fatal Error: Register is empty\n");
+	ASSERT_EQ(Output("store r4\n"), "Fatal Error: Stack is empty\n");
+}
+
+TEST(Registers, OperandMovesWithTheValue)
+{
+	OperandStack l_stack;
+	RegisterFile l_registers;
+
+	l_stack.Push(UniquePtr<IOperand const>(OperandFactory::Get().CreateOperand(eOperandType::DOUBLE, "2.5")));
+	l_registers.Store(5, l_stack);
+
+	ASSERT_TRUE(l_stack.Empty());
+	ASSERT_TRUE(l_registers.IsSet(5));
+	ASSERT_FALSE(l_registers.IsSet(4));
+
+	l_registers.Load(5, l_stack);
+	ASSERT_EQ(l_stack.GetType(0), eOperandType::DOUBLE);
+	ASSERT_EQ(l_stack.GetPayload(0).m_real, 2.5);
+	ASSERT_THROW(l_registers.Load(4, l_stack), EmptyRegisterError);
+}
+
+TEST(Registers, Analysis)
+{
+	auto l_program = Parse(
+		"push int8(100)\n"
+		"store r0\n"
+		"push int8(1)\n"
+		"load r0\n"
+		"add\n"
+		"load r0\n"
+		"swap\n"
+		"dup\n"
+		"add\n"
+		"add\n");
+
+	IntervalAnalysis l_analysis;
+	l_analysis.Run(*l_program);
+
+	ASSERT_EQ(l_analysis.GetVerdict(At(*l_program, 4)), Verdict::SAFE);
+	ASSERT_EQ(l_analysis.GetVerdict(At(*l_program, 8)), Verdict::FAULT);
+	ASSERT_TRUE(l_analysis.GetFault());
+	ASSERT_EQ(l_analysis.GetFault()->m_line, 9);
+
+	auto l_empty = Parse("push int8(1)\nstore r1\nload r2\n");
+	l_analysis.Run(*l_empty);
+	ASSERT_TRUE(l_analysis.GetFault());
+	ASSERT_EQ(l_analysis.GetFault()->m_line, 3);
+	ASSERT_EQ(l_analysis.GetFault()->m_message, "Register is empty");
+}
+
+TEST(Registers, CompileTime)
+{
+	static_assert(ct::Compile<2>("store r9\nload r0\n")[0].m_argument == 9);
+
+	auto l_program = ct::Load(AVM_CT_COMPILE("push int8(3)\nstore r0\nload r0\nload r0\nmul\ndump\n"));
+	auto const &l_load = dynamic_cast<ast::InstructionWithArgument const &>(At(*l_program, 2));
+
+	ASSERT_EQ(l_load.GetArgument(), 0u);
+	ASSERT_THROW(ct::Count("load r16"), ct::CompileError);
+	ASSERT_THROW(ct::Count("store x1"), ct::CompileError);
+	ASSERT_THROW(ct::Count("store"), ct::CompileError);
+}
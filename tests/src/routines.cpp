@@ -0,0 +1,124 @@
+#include "Helpers.hpp"
+#include "src/ast/Code.hpp"
+#include "src/analysis/IntervalAnalysis.hpp"
+#include "src/opt/Optimizer.hpp"
+
+using namespace avm;
+using namespace avm::test;
+using analysis::IntervalAnalysis;
+using analysis::Verdict;
+
+static String const s_square = "def square (int32 -- int32)\ndup\nmul\nend\n";
+
+TEST(Routines, Parse)
+{
+	auto l_program = Parse("call inc\ndef inc (int32 -- int32)\npush int32(1)\nadd\nret\nend\ndef show\ndump\nend\n");
+
+	ASSERT_EQ(l_program->GetInstructions().size(), 9u);
+	ASSERT_EQ(At(*l_program, 0).GetType(), ast::Instruction::Type::CALL);
+
+	auto const &l_inc = dynamic_cast<ast::InstructionWithEffect const &>(At(*l_program, 1));
+
+	ASSERT_EQ(l_inc.GetLabel(), "inc");
+	ASSERT_TRUE(l_inc.GetEffect());
+	ASSERT_EQ(l_inc.GetEffect()->m_inputs, Vector<eOperandType>{ eOperandType::INT32 });
+	ASSERT_EQ(l_inc.GetEffect()->m_outputs, Vector<eOperandType>{ eOperandType::INT32 });
+	ASSERT_FALSE(dynamic_cast<ast::InstructionWithEffect const &>(At(*l_program, 6)).GetEffect());
+
+	// Calls resolve to their routine, routines to the instruction after their end
+	ast::Code l_code(*l_program);
+
+	ASSERT_EQ(l_code.GetTarget(0), 1u);
+	ASSERT_EQ(l_code.GetTarget(1), 6u);
+	ASSERT_EQ(l_code.GetTarget(6), 9u);
+}
+
+TEST(Routines, Programs)
+{
+	// Straight-line code skips routines, calls may come before them
+	ASSERT_EQ(Output("push int32(7)\ncall square\ndump\nexit\n" + s_square), "49\n");
+	ASSERT_EQ(Output(s_square + "push int32(3)\ncall square\ncall square\ndump\n"), "81\n");
+	ASSERT_EQ(Output("def hello\npush int8(72)\nprint\npop\nend\ncall hello\ncall hello\n"), "HH");
+
+	// Nested calls, early returns and recursion
+	ASSERT_EQ(Output(s_square + "def quad (int32 -- int32)\ncall square\ncall square\nend\n"
+		"push int32(2)\ncall quad\ndump\n"), "16\n");
+	ASSERT_EQ(Output("def first\npush int8(1)\nret\npush int8(2)\nend\ncall first\ndump\n"), "1\n");
+	ASSERT_EQ(Output("def count (int32 --)\ndup\njz done\ndump\npush int32(1)\nsub\ncall count\nret\n"
+		"done:\npop\nend\npush int32(3)\ncall count\n"), "3\n2\n1\n");
+
+	// Exit stops the whole program
+	ASSERT_EQ(Output("def stop\npush int8(83)\nprint\nexit\nend\ncall stop\npush int8(0)\nprint\n"), "S");
+}
+
+TEST(Routines, Errors)
+{
+	ASSERT_EQ(Output(s_square + "push int16(3)\ncall square\n"),
+		"Fatal Error: Call to square: expected int32 on top of the stack\n");
+	ASSERT_EQ(Output(s_square + "call square\n"),
+		"Fatal Error: Call to square: expected int32 on top of the stack\n");
+	ASSERT_EQ(Output("def bad (int32 -- int32)\npush int8(1)\nend\npush int32(1)\ncall bad\n"),
+		"Fatal Error: Return from bad: expected int32 in place of its inputs\n");
+	ASSERT_EQ(Output("def drop (int32 int32 --)\npop\nend\npush int32(1)\npush int32(2)\ncall drop\n"),
+		"Fatal Error: Return from drop: expected nothing in place of its inputs\n");
+	ASSERT_EQ(Output("def loop\ncall loop\nend\ncall loop\n"), "Fatal Error: Return stack overflow\n");
+
+	testing::internal::CaptureStdout();
+	ASSERT_EQ(Parse("ret\ndef f\ndef g\nend\ndef f\nend\ncall h\ndef k (int32 --\n")->GetInstructions().size(), 2u);
+	ASSERT_EQ(testing::internal::GetCapturedStdout(),
+		"[line 1] Error  at 'ret': Expected a routine\n"
+		"[line 3] Error  at 'def': Expected \"end\" before \"def\"\n"
+		"[line 5] Error  at 'f': Routine already defined\n"
+		"[line 6] Error  at 'end': Expected a routine\n"
+		"[line 9] Error  at '\n': Expected a type or \")\"\n"
+		"[line 7] Error  at 'h': Undefined routine\n");
+
+	testing::internal::CaptureStdout();
+	Parse("def f\nl:\nend\njmp l\ndef g\n");
+	ASSERT_EQ(testing::internal::GetCapturedStdout(),
+		"[line 6] Error at end: Expected \"end\" after routine\n"
+		"[line 4] Error  at 'l': Expected a label of the same routine\n");
+}
+
+TEST(Routines, Analysis)
+{
+	IntervalAnalysis l_analysis;
+
+	// The body is proven from any int8, the call from the declared effect
+	auto l_program = Parse("def half (int8 -- int8)\npush int8(2)\ndiv\nend\n"
+		"push int8(100)\ncall half\npush int8(1)\nadd\n");
+
+	l_analysis.Run(*l_program);
+	ASSERT_FALSE(l_analysis.GetFault());
+	ASSERT_EQ(l_analysis.GetVerdict(At(*l_program, 2)), Verdict::SAFE);
+	ASSERT_EQ(l_analysis.GetVerdict(At(*l_program, 7)), Verdict::UNKNOWN);
+
+	// A call with the wrong types is a fault before the program runs
+	auto l_mismatch = Parse("def half (int8 -- int8)\npush int8(2)\ndiv\nend\npush int32(100)\ncall half\n");
+
+	l_analysis.Run(*l_mismatch);
+	ASSERT_TRUE(l_analysis.GetFault());
+	ASSERT_EQ(l_analysis.GetFault()->m_line, 6);
+	ASSERT_EQ(l_analysis.GetFault()->m_message, "Call to half: expected int8 on top of the stack");
+
+	// Without an effect, the analysis stops at the call
+	auto l_opaque = Parse("def f\nend\ncall f\npush int8(100)\npush int8(100)\nadd\n");
+
+	l_analysis.Run(*l_opaque);
+	ASSERT_FALSE(l_analysis.GetFault());
+}
+
+TEST(Routines, ExitTruncationKeepsRoutines)
+{
+	auto l_program = Parse("push int32(5)\ncall square\ndump\nexit\npush int8(1)\n" + s_square + "dump\nexit\ndump\n");
+
+	ASSERT_EQ(opt::ExitTruncation().Run(*l_program), 2u);
+	ASSERT_EQ(Execute(*l_program), "25\n");
+
+	// An exit inside a routine keeps its end
+	auto l_inner = Parse("def f\nexit\npush int8(1)\nend\ncall f\n");
+
+	ASSERT_EQ(opt::ExitTruncation().Run(*l_inner), 1u);
+	ASSERT_EQ(l_inner->GetInstructions().size(), 4u);
+	ASSERT_EQ(Execute(*l_inner), "");
+}
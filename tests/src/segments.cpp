@@ -0,0 +1,166 @@
+#include "Helpers.hpp"
+#include "src/OperandStack.hpp"
+#include "src/SegmentMap.hpp"
+#include <malloc.h>
+
+using namespace avm;
+using namespace avm::test;
+using Type = ast::Instruction::Type;
+
+static size_t const s_segment = OperandStack::s_segmentSize;
+
+static OperandStack::Payload Integer(int64_t p_value)
+{
+	OperandStack::Payload l_payload;
+
+	l_payload.m_integer = p_value;
+	return l_payload;
+}
+
+// Pushes its index as int32 up to p_count values, in batches that end inside segments
+static void Fill(OperandStack &p_stack, size_t p_count)
+{
+	Vector<int64_t> l_values;
+
+	for (size_t l_i = p_stack.Size(); l_i < p_count; l_i++)
+	{
+		l_values.push_back(static_cast<int64_t>(l_i));
+		if (l_values.size() == 1000)
+		{
+			p_stack.Append(eOperandType::INT32, l_values);
+			l_values.clear();
+		}
+	}
+	p_stack.Append(eOperandType::INT32, l_values);
+}
+
+static void ExpectValues(OperandStack const &p_stack)
+{
+	for (size_t l_i = 0; l_i < p_stack.Size(); l_i++)
+	{
+		ASSERT_EQ(p_stack.GetType(l_i), eOperandType::INT32) << l_i;
+		ASSERT_EQ(p_stack.GetPayload(l_i).m_integer, static_cast<int64_t>(l_i)) << l_i;
+	}
+}
+
+TEST(Segments, Boundaries)
+{
+	OperandStack l_stack;
+
+	Fill(l_stack, 3 * s_segment + 5);
+	ASSERT_EQ(l_stack.Size(), 3 * s_segment + 5);
+	ExpectValues(l_stack);
+
+	// Operand objects and moves across the end of a segment
+	l_stack.Drop(5);
+	ASSERT_EQ(l_stack.Top().toString(), std::to_string(3 * s_segment - 1));
+	l_stack.Push(eOperandType::INT32, Integer(-1));
+	l_stack.Rot();
+	l_stack.Swap();
+	ASSERT_EQ(l_stack.Pop()->toString(), "-1");
+	ASSERT_EQ(l_stack.Pop()->toString(), std::to_string(3 * s_segment - 2));
+	ASSERT_EQ(l_stack.Pop()->toString(), std::to_string(3 * s_segment - 1));
+	ASSERT_EQ(l_stack.Size(), 3 * s_segment - 2);
+
+	// Slots mapped again hold no operand of their previous values
+	l_stack.Drop(2 * s_segment);
+	l_stack.Push(eOperandType::INT8, Integer(4));
+	l_stack.Push(eOperandType::INT8, Integer(5));
+	l_stack.Swap();
+	ASSERT_EQ(l_stack.Pop()->toString(), "4");
+	ASSERT_EQ(l_stack.Size(), s_segment - 1);
+	l_stack.Drop();
+	ExpectValues(l_stack);
+}
+
+// Runs of the kernels stop at the end of a segment
+TEST(Segments, Reduce)
+{
+	OperandStack l_max;
+	OperandStack l_sum;
+
+	Fill(l_max, s_segment + 10);
+	l_max.Reduce(Type::MAX);
+	ASSERT_EQ(l_max.Top().toString(), std::to_string(s_segment + 9));
+
+	Fill(l_sum, s_segment + 10);
+	l_sum.Reduce(Type::SUM, 20);
+	ASSERT_EQ(l_sum.Top().toString(), std::to_string(20 * s_segment - 10));
+	ASSERT_EQ(l_sum.Size(), s_segment - 9);
+}
+
+TEST(Segments, AppendRaw)
+{
+	OperandStack l_stack;
+	Vector<unsigned char> l_data((s_segment + 3) * sizeof(float), 0);
+	float const l_infinity = std::numeric_limits<float>::infinity();
+
+	Fill(l_stack, s_segment - 2);
+	std::memcpy(&l_data[(s_segment + 1) * sizeof(float)], &l_infinity, sizeof(float));
+
+	// Nothing pushed, and the index counts from the first value of the data
+	ASSERT_EQ(l_stack.AppendRaw(eOperandType::FLOAT, l_data.data(), s_segment + 3), Optional<size_t>(s_segment + 1));
+	ASSERT_EQ(l_stack.Size(), s_segment - 2);
+	ASSERT_FALSE(l_stack.AppendRaw(eOperandType::FLOAT, l_data.data(), s_segment));
+	ASSERT_EQ(l_stack.Size(), 2 * s_segment - 2);
+	ASSERT_EQ(l_stack.GetType(2 * s_segment - 3), eOperandType::FLOAT);
+}
+
+// A few resident segments of a file: the values come back from it
+TEST(Segments, Spilled)
+{
+	OperandStack l_stack;
+	SegmentStorage l_storage;
+
+	l_storage.m_residentBudget = 1;
+	l_storage.m_directory = testing::TempDir();
+	l_stack.Reserve(10);
+	l_stack.SetStorage(l_storage);
+
+	Fill(l_stack, 6 * s_segment + 7);
+	ExpectValues(l_stack);
+	l_stack.Query(Type::STACKMAX);
+	ASSERT_EQ(l_stack.Pop()->toString(), std::to_string(6 * s_segment + 6));
+
+	// The whole stack goes down and up again
+	l_stack.Sort();
+	ExpectValues(l_stack);
+	l_stack.Drop(4 * s_segment);
+	ASSERT_EQ(l_stack.Size(), 2 * s_segment + 7);
+	Fill(l_stack, 7 * s_segment);
+	ExpectValues(l_stack);
+
+	// Only an empty stack changes its storage
+	ASSERT_THROW(l_stack.SetStorage(SegmentStorage()), std::runtime_error);
+}
+
+// Pushed values and results keep no heap memory: all of it is in the blocks the budget spills
+TEST(Segments, ScalarPushes)
+{
+#if defined(__GLIBC__) && __GLIBC_PREREQ(2, 33)
+	Interpreter l_interpreter;
+	SegmentStorage l_storage;
+
+	l_storage.m_residentBudget = 1;
+	l_storage.m_directory = testing::TempDir();
+	l_interpreter.SetStackStorage(l_storage);
+
+	auto l_program = Parse("repeat 400000 {\npush int32(7)\npush int16(-1)\nadd\n}\n");
+	auto l_heap = [] { struct mallinfo2 const l_info = mallinfo2(); return l_info.uordblks + l_info.hblkhd; };
+	size_t const l_before = l_heap();
+
+	l_interpreter.Run(*l_program);
+	ASSERT_LT(l_heap(), l_before + s_segment);
+#else
+	GTEST_SKIP();
+#endif
+}
+
+TEST(Segments, BadDirectory)
+{
+	Interpreter l_interpreter;
+	SegmentStorage l_storage;
+
+	l_storage.m_directory = testing::TempDir() + "/no-such-directory";
+	ASSERT_THROW(l_interpreter.SetStackStorage(l_storage), StackOverflowError);
+}
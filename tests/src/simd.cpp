@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include "avm.hpp"
+#include "src/OperandStack.hpp"
+#include "src/simd/Kernels.hpp"
+#include <random>
+
+using namespace avm;
+
+static Vector<simd::Level> Levels()
+{
+	Vector<simd::Level> l_levels;
+
+	for (simd::Level l_level : { simd::Level::SCALAR, simd::Level::AVX2, simd::Level::AVX512 })
+	{
+		if (l_level <= simd::DetectLevel())
+		{
+			l_levels.push_back(l_level);
+		}
+	}
+	return l_levels;
+}
+
+TEST(Simd, Levels)
+{
+	ASSERT_EQ(simd::ParseLevel("avx2"), simd::Level::AVX2);
+	ASSERT_EQ(simd::ParseLevel("scalar"), simd::Level::SCALAR);
+	ASSERT_FALSE(simd::ParseLevel("sse9"));
+	ASSERT_STREQ(simd::GetLevelName(simd::Level::AVX512), "avx512");
+
+	simd::Level const l_initial = simd::GetLevel();
+
+	// Never above what the host runs
+	simd::SetLevel(simd::Level::AVX512);
+	ASSERT_EQ(simd::GetLevel(), simd::DetectLevel());
+	simd::SetLevel(simd::Level::SCALAR);
+	ASSERT_EQ(simd::GetLevel(), simd::Level::SCALAR);
+	simd::SetLevel(l_initial);
+}
+
+TEST(Simd, EveryLevelAgrees)
+{
+	std::mt19937 l_random(7);
+	simd::Level const l_initial = simd::GetLevel();
+
+	for (size_t l_count = 1; l_count < 80; l_count++)
+	{
+		Vector<simd::Payload> l_integers(l_count);
+		Vector<simd::Payload> l_reals(l_count);
+
+		for (size_t l_i = 0; l_i < l_count; l_i++)
+		{
+			l_integers[l_i].m_integer = std::uniform_int_distribution<int64_t>(-2147483648LL, 2147483647LL)(l_random);
+			l_reals[l_i].m_real = std::uniform_real_distribution<double>(-1e6, 1e6)(l_random);
+		}
+
+		simd::SetLevel(simd::Level::SCALAR);
+		simd::Sums const l_sums = simd::SumIntegers(l_integers.data(), l_count);
+		int64_t const l_min = simd::MinInteger(l_integers.data(), l_count);
+		int64_t const l_max = simd::MaxInteger(l_integers.data(), l_count);
+		double const l_minReal = simd::MinReal(l_reals.data(), l_count);
+		double const l_maxReal = simd::MaxReal(l_reals.data(), l_count);
+
+		for (simd::Level l_level : Levels())
+		{
+			simd::SetLevel(l_level);
+
+			simd::Sums const l_levelSums = simd::SumIntegers(l_integers.data(), l_count);
+			ASSERT_EQ(l_levelSums.m_sum, l_sums.m_sum);
+			ASSERT_EQ(l_levelSums.m_positive, l_sums.m_positive);
+			ASSERT_EQ(l_levelSums.m_negative, l_sums.m_negative);
+			ASSERT_EQ(simd::MinInteger(l_integers.data(), l_count), l_min);
+			ASSERT_EQ(simd::MaxInteger(l_integers.data(), l_count), l_max);
+			ASSERT_EQ(simd::MinReal(l_reals.data(), l_count), l_minReal);
+			ASSERT_EQ(simd::MaxReal(l_reals.data(), l_count), l_maxReal);
+		}
+	}
+	simd::SetLevel(l_initial);
+}
+
+TEST(Simd, StackReductionsOnEveryLevel)
+{
+	simd::Level const l_initial = simd::GetLevel();
+
+	for (simd::Level l_level : Levels())
+	{
+		simd::SetLevel(l_level);
+
+		for (ast::Instruction::Type l_type : { ast::Instruction::Type::SUM, ast::Instruction::Type::MIN,
+			ast::Instruction::Type::MAX })
+		{
+			OperandStack l_stack;
+			simd::Payload l_payload;
+			int64_t l_sum = 0;
+
+			for (int64_t l_i = 0; l_i < 1001; l_i++)
+			{
+				l_payload.m_integer = (l_i * 37) % 101 - 50;
+				l_sum += l_payload.m_integer;
+				l_stack.Push(eOperandType::INT16, l_payload);
+			}
+			l_stack.Reduce(l_type);
+
+			ASSERT_EQ(l_stack.Top().toString(), l_type == ast::Instruction::Type::SUM ? std::to_string(l_sum)
+				: l_type == ast::Instruction::Type::MIN ? "-50" : "50");
+		}
+	}
+	simd::SetLevel(l_initial);
+}
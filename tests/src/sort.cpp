@@ -0,0 +1,146 @@
+#include "Helpers.hpp"
+#include "src/OperandStack.hpp"
+#include "src/analysis/IntervalAnalysis.hpp"
+#include "src/ct/FrontEnd.hpp"
+#include <random>
+
+using namespace avm;
+using namespace avm::test;
+using analysis::IntervalAnalysis;
+using analysis::Verdict;
+
+static double ValueAt(OperandStack const &p_stack, size_t p_index)
+{
+	OperandStack::Payload const l_payload = p_stack.GetPayload(p_index);
+
+	return p_stack.GetType(p_index) < eOperandType::FLOAT ? static_cast<double>(l_payload.m_integer) : l_payload.m_real;
+}
+
+// Mixed values with many ties, within the range of their type
+static void Fill(OperandStack &p_stack, size_t p_count, unsigned p_seed)
+{
+	std::mt19937 l_random(p_seed);
+
+	for (size_t l_i = 0; l_i < p_count; l_i++)
+	{
+		eOperandType const l_type = static_cast<eOperandType>(std::uniform_int_distribution<int>(0, 4)(l_random));
+		int const l_value = std::uniform_int_distribution<int>(-100, 100)(l_random);
+		OperandStack::Payload l_payload;
+
+		if (l_type < eOperandType::FLOAT)
+		{
+			l_payload.m_integer = l_value;
+		}
+		else
+		{
+			l_payload.m_real = l_value / 4.0;
+		}
+		p_stack.Push(l_type, l_payload);
+	}
+}
+
+// Checks the stack against a stable sort of the same values, by value then by type
+static void ExpectSorted(size_t p_count, unsigned p_seed)
+{
+	OperandStack l_stack;
+	Vector<Pair<double, eOperandType>> l_expected;
+
+	Fill(l_stack, p_count, p_seed);
+	for (size_t l_i = 0; l_i < p_count; l_i++)
+	{
+		l_expected.emplace_back(ValueAt(l_stack, l_i), l_stack.GetType(l_i));
+	}
+	std::stable_sort(l_expected.begin(), l_expected.end());
+
+	l_stack.Sort();
+	ASSERT_EQ(l_stack.Size(), p_count);
+	for (size_t l_i = 0; l_i < p_count; l_i++)
+	{
+		ASSERT_EQ(ValueAt(l_stack, l_i), l_expected[l_i].first) << l_i;
+		ASSERT_EQ(l_stack.GetType(l_i), l_expected[l_i].second) << l_i;
+	}
+}
+
+TEST(Sort, Parse)
+{
+	auto l_program = Parse("sort\nsort 3\n");
+
+	ASSERT_EQ(l_program->GetInstructions().size(), 2u);
+	ASSERT_EQ(l_program->GetInstructions().front()->GetType(), ast::Instruction::Type::SORT);
+	ASSERT_EQ(dynamic_cast<ast::InstructionWithArgument const &>(*l_program->GetInstructions().back()).GetArgument(), 3u);
+}
+
+TEST(Sort, Programs)
+{
+	// The greatest value ends on top, dump starts from it
+	ASSERT_EQ(Output("push int32[3, -1, 2]\nsort\ndump\n"), "3\n2\n-1\n");
+	ASSERT_EQ(Output("push int8(9)\npush int32[3, -1, 2]\nsort 2\ndump\n"), "2\n-1\n3\n9\n");
+
+	// Values keep their type, ties go from the least precise type
+	ASSERT_EQ(Output("push double(1.5)\npush int8(2)\npush float(-0.5)\npush int16(1)\nsort\ndump\n"), "2\n1.5\n1\n-0.50\n");
+	ASSERT_EQ(Output("push double(2.0)\npush int32(2)\npush int8(2)\nsort\nassert double(2.0)\npop\nassert int32(2)\n"
+		"pop\nassert int8(2)\n"), "");
+	ASSERT_EQ(Output("push int8(127)\npush int8(5)\nsort\npush int8(1)\nadd\n"), "Fatal Error: (127 + 1) > 127\n");
+
+	ASSERT_EQ(Output("sort\npush int8(1)\nsort 1\ndump\n"), "1\n");
+	ASSERT_EQ(Output("push int8(1)\nsort 2\n"), "Fatal Error: Stack is empty\n");
+}
+
+TEST(Sort, LargeStacks)
+{
+	// Both sides of the threshold give the same order
+	ExpectSorted(1000, 1);
+	ExpectSorted(OperandStack::s_parallelSort, 2);
+	ExpectSorted(OperandStack::s_parallelSort + 1, 3);
+	ExpectSorted(OperandStack::s_parallelSort * 5 + 3, 4);
+}
+
+TEST(Sort, KeepsOperands)
+{
+	OperandStack l_stack;
+
+	Fill(l_stack, OperandStack::s_parallelSort * 2, 5);
+
+	// An operand object moves with its slot
+	IOperand const *l_operand = &l_stack.At(0);
+	String const l_value = l_operand->toString();
+
+	l_stack.Sort();
+
+	size_t l_found = 0;
+
+	for (size_t l_i = 0; l_i < l_stack.Size(); l_i++)
+	{
+		if (&l_stack.At(l_i) == l_operand)
+		{
+			l_found++;
+			ASSERT_EQ(l_stack.At(l_i).toString(), l_value);
+		}
+	}
+	ASSERT_EQ(l_found, 1u);
+}
+
+TEST(Sort, Analysis)
+{
+	IntervalAnalysis l_analysis;
+
+	// Values of one type: each slot may hold any of them
+	auto l_program = Parse("push int8(100)\npush int8(40)\npush int8(30)\nsort 2\nadd\nadd\n");
+
+	l_analysis.Run(*l_program);
+	ASSERT_EQ(l_analysis.GetVerdict(**std::next(l_program->GetInstructions().begin(), 4)), Verdict::SAFE);
+	ASSERT_TRUE(l_analysis.GetFault());
+
+	auto l_mixed = Parse("push int16(1)\npush int8(1)\nsort\npush int8(1)\nadd\n");
+
+	l_analysis.Run(*l_mixed);
+	ASSERT_FALSE(l_analysis.GetFault());
+	ASSERT_EQ(l_analysis.GetVerdict(**std::next(l_mixed->GetInstructions().begin(), 4)), Verdict::UNKNOWN);
+}
+
+TEST(Sort, CompileTime)
+{
+	constexpr auto l_image = AVM_CT_COMPILE("push int16(5)\npush int16(-5)\npush int16(0)\nsort 2\nsort\ndump\n");
+
+	ASSERT_EQ(Execute(*ct::Load(l_image)), "5\n0\n-5\n");
+}
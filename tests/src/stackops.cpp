@@ -0,0 +1,92 @@
+#include "Helpers.hpp"
+#include "src/OperandStack.hpp"
+#include "src/ct/FrontEnd.hpp"
+
+using namespace avm;
+using namespace avm::test;
+
+static String Contents(OperandStack const &p_stack)
+{
+	String l_contents;
+
+	for (size_t l_index = 0; l_index < p_stack.Size(); l_index++)
+	{
+		l_contents += p_stack.At(l_index).toString() + " ";
+	}
+	return l_contents;
+}
+
+static OperandStack &PushAll(OperandStack &p_stack, std::initializer_list<int> p_values)
+{
+	for (int l_value : p_values)
+	{
+		p_stack.Push(UniquePtr<IOperand const>(OperandFactory::Get().CreateOperand(eOperandType::INT32, std::to_string(l_value))));
+	}
+	return p_stack;
+}
+
+TEST(StackOps, Shapes)
+{
+	OperandStack l_dup, l_swap, l_over, l_rot;
+
+	PushAll(l_dup, { 1, 2, 3 }).Dup();
+	PushAll(l_swap, { 1, 2, 3 }).Swap();
+	PushAll(l_over, { 1, 2, 3 }).Over();
+	PushAll(l_rot, { 1, 2, 3 }).Rot();
+
+	ASSERT_EQ(Contents(l_dup), "1 2 3 3 ");
+	ASSERT_EQ(Contents(l_swap), "1 3 2 ");
+	ASSERT_EQ(Contents(l_over), "1 2 3 2 ");
+	ASSERT_EQ(Contents(l_rot), "2 3 1 ");
+}
+
+TEST(StackOps, OperandsMoveWithTheirSlot)
+{
+	OperandStack l_stack;
+	PushAll(l_stack, { 1, 2, 3 });
+
+	IOperand const *const l_bottom = &l_stack.At(0);
+	IOperand const *const l_top = &l_stack.At(2);
+
+	l_stack.Rot();
+	ASSERT_EQ(&l_stack.Top(), l_bottom);
+	l_stack.Swap();
+	ASSERT_EQ(&l_stack.At(1), l_bottom);
+	ASSERT_EQ(&l_stack.Top(), l_top);
+}
+
+TEST(StackOps, TooFewValues)
+{
+	OperandStack l_stack;
+
+	ASSERT_THROW(l_stack.Dup(), EmptyStackError);
+	PushAll(l_stack, { 1 });
+	ASSERT_THROW(l_stack.Swap(), EmptyStackError);
+	ASSERT_THROW(l_stack.Over(), EmptyStackError);
+	PushAll(l_stack, { 2 });
+	ASSERT_THROW(l_stack.Rot(), EmptyStackError);
+	ASSERT_EQ(Contents(l_stack), "1 2 ");
+}
+
+TEST(StackOps, Programs)
+{
+	// Copies keep the type and printed value of their source
+	ASSERT_EQ(Output("push float(1.5)\ndup\nadd\ndump\n"), "3.00\n");
+	ASSERT_EQ(Output("push double(0.25)\npush int8(3)\nover\ndump\n"), "0.25\n3\n0.25\n");
+	ASSERT_EQ(Output("push int8(72)\ndup\nprint\npop\nprint\n"), "HH");
+	ASSERT_EQ(Output("push int32(10)\npush int32(3)\nswap\nsub\ndump\n"), "-7\n");
+	ASSERT_EQ(Output("push int8(1)\npush int16(2)\npush int32(3)\nrot\nassert int8(1)\ndump\n"), "1\n3\n2\n");
+	ASSERT_EQ(Output("push int8(100)\ndup\nadd\n"), "Fatal Error: (100 + 100) > 127\n");
+	ASSERT_EQ(Output("push int8(1)\nswap\n"), "Fatal Error: Stack is empty\n");
+}
+
+TEST(StackOps, CompileTime)
+{
+	static_assert(ct::Compile<4>("dup\nswap\nover\nrot\n")[3].m_type == ast::Instruction::Type::ROT);
+
+	ASSERT_THROW(ct::Count("dup 2"), ct::CompileError);
+
+	testing::internal::CaptureStdout();
+	Parse("push int8(1)\ndup 2\n");
+	ASSERT_EQ(testing::internal::GetCapturedStdout(), "[line 2] Error  at '2': Expected newline\n");
+}